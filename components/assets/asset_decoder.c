@@ -0,0 +1,97 @@
+#include "asset_decoder.h"
+
+#include "asset_pack.h"
+#include "lvgl.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+static const AssetPack_Image_t* GetPackedImage(const void *pSrc);
+static lv_res_t InfoCb(lv_img_decoder_t *pDecoder, const void *pSrc, lv_img_header_t *pHeader);
+static lv_res_t OpenCb(lv_img_decoder_t *pDecoder, lv_img_decoder_dsc_t *pDsc);
+static lv_res_t ReadLineCb(lv_img_decoder_t *pDecoder, lv_img_decoder_dsc_t *pDsc, lv_coord_t x, lv_coord_t y, lv_coord_t Length, uint8_t *pBuf);
+static void CloseCb(lv_img_decoder_t *pDecoder, lv_img_decoder_dsc_t *pDsc);
+
+// New decoders go to the front of LVGL's list, so the built-in one never sees a packed image
+void AssetDecoder_Init(void)
+{
+    lv_img_decoder_t *const pDecoder = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(pDecoder, InfoCb);
+    lv_img_decoder_set_open_cb(pDecoder, OpenCb);
+    lv_img_decoder_set_read_line_cb(pDecoder, ReadLineCb);
+    lv_img_decoder_set_close_cb(pDecoder, CloseCb);
+}
+
+// Called for every image on every draw since the image cache is off, so only the header is checked. The rows were
+// checked when the pack was built.
+static const AssetPack_Image_t* GetPackedImage(const void *pSrc)
+{
+    if (lv_img_src_get_type(pSrc) != LV_IMG_SRC_VARIABLE)
+    {
+        return NULL;
+    }
+
+    const lv_img_dsc_t *const pImg = (const lv_img_dsc_t*)pSrc;
+    const AssetPack_Image_t *const pPacked = (const AssetPack_Image_t*)pImg->data;
+    if ((pImg->header.cf != LV_IMG_CF_USER_ENCODED_0) || (pPacked == NULL) || (pImg->data_size < sizeof(*pPacked)) ||
+        (pPacked->Width != pImg->header.w) || (pPacked->Height != pImg->header.h) ||
+        (AssetPack_BytesPerPixel(pPacked->Format) == 0))
+    {
+        return NULL;
+    }
+
+    return pPacked;
+}
+
+static lv_res_t InfoCb(lv_img_decoder_t *pDecoder, const void *pSrc, lv_img_header_t *pHeader)
+{
+    (void)pDecoder;
+
+    const AssetPack_Image_t *const pPacked = GetPackedImage(pSrc);
+    if (pPacked == NULL)
+    {
+        return LV_RES_INV;
+    }
+
+    pHeader->cf = pPacked->Format;
+    pHeader->always_zero = 0;
+    pHeader->w = pPacked->Width;
+    pHeader->h = pPacked->Height;
+    return LV_RES_OK;
+}
+
+static lv_res_t OpenCb(lv_img_decoder_t *pDecoder, lv_img_decoder_dsc_t *pDsc)
+{
+    (void)pDecoder;
+
+    const AssetPack_Image_t *const pPacked = GetPackedImage(pDsc->src);
+    if (pPacked == NULL)
+    {
+        return LV_RES_INV;
+    }
+
+    // Without image data LVGL reads the image line by line
+    pDsc->img_data = NULL;
+    pDsc->user_data = (void*)pPacked;
+    return LV_RES_OK;
+}
+
+static lv_res_t ReadLineCb(lv_img_decoder_t *pDecoder, lv_img_decoder_dsc_t *pDsc, lv_coord_t x, lv_coord_t y, lv_coord_t Length, uint8_t *pBuf)
+{
+    (void)pDecoder;
+
+    const AssetPack_Image_t *const pPacked = (const AssetPack_Image_t*)pDsc->user_data;
+    if ((x < 0) || (y < 0) || (Length <= 0) || (x + Length > pPacked->Width) || (y >= pPacked->Height))
+    {
+        return LV_RES_INV;
+    }
+
+    AssetPack_DecodeRow(pPacked, (uint32_t)y, (uint32_t)x, (uint32_t)Length, pBuf);
+    return LV_RES_OK;
+}
+
+static void CloseCb(lv_img_decoder_t *pDecoder, lv_img_decoder_dsc_t *pDsc)
+{
+    (void)pDecoder;
+    pDsc->user_data = NULL;
+}
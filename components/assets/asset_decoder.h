@@ -0,0 +1,9 @@
+#pragma once
+
+// LVGL image decoder for the images in an asset pack (see asset_pack.h). A packed image is an lv_img_dsc_t with
+// LV_IMG_CF_USER_ENCODED_0 whose data is the pack entry. LVGL sees the format the image had before packing, and asks
+// for it one line at a time as it draws, so nothing is decoded ahead or cached.
+
+#include "lvgl.h"
+
+void AssetDecoder_Init(void);
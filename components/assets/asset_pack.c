@@ -0,0 +1,179 @@
+#include "asset_pack.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Lets a pixel be stored as one halfword without breaking strict aliasing
+typedef uint16_t __attribute__((may_alias)) Pixel_t;
+
+static inline void PutPixels(uint8_t *pOut, const AssetPack_Color_t Color, uint32_t Count, const size_t BytesPerPixel);
+static bool IsValidRow(const uint8_t *pCode, const uint8_t *const pEnd, const uint32_t Width, const uint32_t NumColors);
+
+size_t AssetPack_BytesPerPixel(const uint8_t Format)
+{
+    switch (Format)
+    {
+        case kAssetPack_Format_TrueColor:
+        case kAssetPack_Format_TrueColorChromaKeyed:
+            return 2;
+
+        case kAssetPack_Format_TrueColorAlpha:
+            return 3;
+
+        default:
+            return 0;
+    }
+}
+
+// Walks every row once, so that decoding can trust the data afterwards
+bool AssetPack_IsValidImage(const AssetPack_Image_t *const pImage, const size_t Size)
+{
+    if ((pImage == NULL) || (Size < sizeof(*pImage)) || (pImage->DataSize > Size - sizeof(*pImage)) ||
+        (((uintptr_t)pImage % kAssetPackConsts_Align) != 0) || (pImage->Width == 0) || (pImage->Height == 0))
+    {
+        return false;
+    }
+
+    const size_t BytesPerPixel = AssetPack_BytesPerPixel(pImage->Format);
+    if (BytesPerPixel == 0)
+    {
+        return false;
+    }
+
+    if (pImage->Encoding == kAssetPack_Encoding_Raw)
+    {
+        return pImage->DataSize >= (size_t)pImage->Width * pImage->Height * BytesPerPixel;
+    }
+
+    if ((pImage->Encoding != kAssetPack_Encoding_PaletteRLE) || (pImage->NumColors == 0) ||
+        (pImage->NumColors > kAssetPackConsts_MaxColors))
+    {
+        return false;
+    }
+
+    const size_t TablesSize = pImage->NumColors * sizeof(AssetPack_Color_t) + pImage->Height * sizeof(uint32_t);
+    if (TablesSize > pImage->DataSize)
+    {
+        return false;
+    }
+
+    const AssetPack_Color_t *const pPalette = (const AssetPack_Color_t*)(pImage + 1);
+    const uint32_t *const pRows = (const uint32_t*)&pPalette[pImage->NumColors];
+    const uint8_t *const pCode = (const uint8_t*)&pRows[pImage->Height];
+    const uint8_t *const pEnd = (const uint8_t*)(pImage + 1) + pImage->DataSize;
+
+    for (uint32_t y = 0; y < pImage->Height; y++)
+    {
+        if ((pRows[y] >= (size_t)(pEnd - pCode)) || !IsValidRow(&pCode[pRows[y]], pEnd, pImage->Width, pImage->NumColors))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Pixels x..x + Length - 1 of row y, in LVGL's layout for the format. pOut must be halfword aligned, and the image
+// must have passed AssetPack_IsValidImage() since nothing is checked here.
+void AssetPack_DecodeRow(const AssetPack_Image_t *const pImage, const uint32_t y, const uint32_t x, const uint32_t Length, uint8_t *const pOut)
+{
+    const size_t BytesPerPixel = AssetPack_BytesPerPixel(pImage->Format);
+    const uint8_t *const pData = (const uint8_t*)(pImage + 1);
+
+    if (pImage->Encoding == kAssetPack_Encoding_Raw)
+    {
+        memcpy(pOut, &pData[((size_t)y * pImage->Width + x) * BytesPerPixel], Length * BytesPerPixel);
+        return;
+    }
+
+    const AssetPack_Color_t *const pPalette = (const AssetPack_Color_t*)pData;
+    const uint32_t *const pRows = (const uint32_t*)&pPalette[pImage->NumColors];
+    const uint8_t *pCode = (const uint8_t*)&pRows[pImage->Height] + pRows[y];
+
+    // Codes before x are only stepped over, LVGL mostly asks for whole rows anyway
+    const uint32_t End = x + Length;
+    uint32_t Pos = 0;
+    while (Pos < End)
+    {
+        const uint8_t Control = *pCode++;
+        const uint32_t Count = (uint32_t)(Control & ~kAssetPackConsts_RunFlag) + 1;
+        const uint32_t From = (Pos > x) ? Pos : x;
+        const uint32_t To = (Pos + Count < End) ? (Pos + Count) : End;
+
+        if ((Control & kAssetPackConsts_RunFlag) != 0)
+        {
+            if (From < To)
+            {
+                PutPixels(&pOut[(From - x) * BytesPerPixel], pPalette[*pCode], To - From, BytesPerPixel);
+            }
+            pCode++;
+        }
+        else
+        {
+            for (uint32_t i = From; i < To; i++)
+            {
+                PutPixels(&pOut[(i - x) * BytesPerPixel], pPalette[pCode[i - Pos]], 1, BytesPerPixel);
+            }
+            pCode += Count;
+        }
+
+        Pos += Count;
+    }
+}
+
+static inline void PutPixels(uint8_t *pOut, const AssetPack_Color_t Color, uint32_t Count, const size_t BytesPerPixel)
+{
+    if (BytesPerPixel == 2)
+    {
+        Pixel_t *pPixel = (Pixel_t*)pOut;
+        while (Count-- > 0)
+        {
+            *pPixel++ = (uint16_t)Color;
+        }
+        return;
+    }
+
+    while (Count-- > 0)
+    {
+        pOut[0] = (uint8_t)Color;
+        pOut[1] = (uint8_t)(Color >> 8);
+        pOut[2] = (uint8_t)(Color >> 16);
+        pOut += 3;
+    }
+}
+
+static bool IsValidRow(const uint8_t *pCode, const uint8_t *const pEnd, const uint32_t Width, const uint32_t NumColors)
+{
+    uint32_t Pos = 0;
+    while (Pos < Width)
+    {
+        if (pCode >= pEnd)
+        {
+            return false;
+        }
+
+        const uint8_t Control = *pCode++;
+        const uint32_t Count = (uint32_t)(Control & ~kAssetPackConsts_RunFlag) + 1;
+        const uint32_t NumIndices = ((Control & kAssetPackConsts_RunFlag) != 0) ? 1 : Count;
+        if ((size_t)(pEnd - pCode) < NumIndices)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < NumIndices; i++)
+        {
+            if (pCode[i] >= NumColors)
+            {
+                return false;
+            }
+        }
+
+        pCode += NumIndices;
+        Pos += Count;
+    }
+
+    // A code running past the end of the row would spill into the next one
+    return Pos == Width;
+}
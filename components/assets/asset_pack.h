@@ -0,0 +1,53 @@
+#pragma once
+
+// Packed OSD images. tools/asset_pack compiles the images in components/images into a pack that gives each image its
+// own palette and stores every row as run-length coded palette indices, which suits the OSD art's large flat areas.
+// Rows are decoded on demand, straight into the line LVGL asks for, so an image never needs a decoded copy in RAM.
+// Images that a palette can't hold, or that would come out bigger, are stored as they were.
+//
+// All fields are little endian and every entry starts on a 4-byte boundary.
+//
+// Free of FreeRTOS/IDF and LVGL headers so that it can be built against the host tools.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kAssetPackConsts_Align       = 4,           // [bytes] Entries, palettes and row tables
+    kAssetPackConsts_MaxColors   = 256,
+    kAssetPackConsts_MaxRun      = 128,         // [px] Longest run or literal one control byte covers
+    kAssetPackConsts_RunFlag     = 0x80,        // Set in a control byte for a run, clear for literals
+} AssetPackConsts_t;
+
+typedef enum {
+    kAssetPack_Encoding_Raw,                    // The pixels as LVGL stores them
+    kAssetPack_Encoding_PaletteRLE,
+} AssetPack_Encoding_t;
+
+// Same values as LVGL's lv_img_cf_t, kept here so the format doesn't depend on LVGL
+typedef enum {
+    kAssetPack_Format_TrueColor            = 4,
+    kAssetPack_Format_TrueColorAlpha       = 5,
+    kAssetPack_Format_TrueColorChromaKeyed = 6,
+} AssetPack_Format_t;
+
+// Followed by the pixels for kAssetPack_Encoding_Raw. For kAssetPack_Encoding_PaletteRLE it is followed by NumColors
+// palette entries, Height row offsets into the coded data and the coded data itself. Each row is a sequence of control
+// bytes: with kAssetPackConsts_RunFlag set, the next index repeats (Control & 0x7F) + 1 times, otherwise Control + 1
+// indices follow as they are.
+typedef struct AssetPack_Image {
+    uint16_t Width;
+    uint16_t Height;
+    uint8_t Format;                             // AssetPack_Format_t
+    uint8_t Encoding;                           // AssetPack_Encoding_t
+    uint16_t NumColors;
+    uint32_t DataSize;                          // [bytes] Everything after this header
+} AssetPack_Image_t;
+
+// RGB565 in the low half, alpha above it for kAssetPack_Format_TrueColorAlpha
+typedef uint32_t AssetPack_Color_t;
+
+size_t AssetPack_BytesPerPixel(const uint8_t Format);
+bool AssetPack_IsValidImage(const AssetPack_Image_t *const pImage, const size_t Size);
+void AssetPack_DecodeRow(const AssetPack_Image_t *const pImage, const uint32_t y, const uint32_t x, const uint32_t Length, uint8_t *const pOut);
@@ -0,0 +1,391 @@
+#include "asset_store.h"
+
+#include "asset_pack.h"
+#include "lvgl.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_partition.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Font entries are used in place, so LVGL's glyph descriptor must have the layout the tool writes
+_Static_assert(sizeof(lv_font_fmt_txt_glyph_dsc_t) == 8, "Glyph descriptors don't match the asset store's");
+
+typedef struct {
+    lv_font_t Font;
+    lv_font_fmt_txt_dsc_t Dsc;
+    lv_font_fmt_txt_glyph_cache_t Cache;
+    lv_font_fmt_txt_cmap_t Cmaps[];
+} Font_t;
+
+static struct {
+    const uint8_t *pBlob;
+    const AssetStore_Entry_t *pDir;
+    size_t NumEntries;
+    void *pObjects[kAssetStoreConsts_MaxEntries];   // lv_img_dsc_t or Font_t, by directory index
+#if defined(ESP_PLATFORM)
+    esp_partition_mmap_handle_t hMap;
+#endif
+    size_t MapSize;                                 // [bytes] 0 if the blob isn't mapped by this module
+} _Store;
+
+// Stands in for an image that isn't in the store, LVGL draws it as one transparent pixel
+static const uint8_t _PlaceholderPixel[LV_IMG_PX_SIZE_ALPHA_BYTE];
+static const lv_img_dsc_t _Placeholder = {
+    .header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA,
+    .header.always_zero = 0,
+    .header.reserved = 0,
+    .header.w = 1,
+    .header.h = 1,
+    .data_size = sizeof(_PlaceholderPixel),
+    .data = _PlaceholderPixel,
+};
+
+static bool IsValidEntry(const AssetStore_Entry_t *const pEntry, const size_t BlobSize);
+static void* LoadImage(const uint8_t *const pEntry, const size_t Size);
+static void* LoadFont(const uint8_t *const pEntry, const size_t Size);
+static bool IsValidCmap(const AssetStore_Cmap_t *const pCmap, const uint8_t *const pEntry, const size_t Size, const size_t NumGlyphs);
+static bool IsInside(const size_t Offset, const size_t Length, const size_t Size);
+static const void* Find(const char *const pName, const AssetStore_Type_t eType);
+
+uint32_t AssetStore_Checksum(const void *const pData, const size_t Size)
+{
+    const uint8_t *const pBytes = (const uint8_t*)pData;
+    uint32_t Hash = 2166136261u;
+
+    for (size_t i = 0; i < Size; i++)
+    {
+        Hash = (Hash ^ pBytes[i]) * 16777619u;
+    }
+
+    return Hash;
+}
+
+// Checks the whole blob and builds the descriptors for it. pBlob must stay valid until AssetStore_Close().
+bool AssetStore_Open(const void *const pBlob, const size_t Size)
+{
+    AssetStore_Close();
+
+    const AssetStore_Header_t *const pHeader = (const AssetStore_Header_t*)pBlob;
+    if ((pBlob == NULL) || (((uintptr_t)pBlob % kAssetStoreConsts_Align) != 0) || (Size < sizeof(*pHeader)) ||
+        (pHeader->Magic != kAssetStoreConsts_Magic) || (pHeader->Version != kAssetStoreConsts_Version) ||
+        (pHeader->Size < sizeof(*pHeader)) || (pHeader->Size > Size) ||
+        (pHeader->NumEntries > kAssetStoreConsts_MaxEntries) ||
+        !IsInside(sizeof(*pHeader), pHeader->NumEntries * sizeof(AssetStore_Entry_t), pHeader->Size))
+    {
+        return false;
+    }
+
+    // Catches a partition that was only partly written, or written for another layout
+    if (AssetStore_Checksum(pHeader + 1, pHeader->Size - sizeof(*pHeader)) != pHeader->Checksum)
+    {
+        return false;
+    }
+
+    _Store.pBlob = (const uint8_t*)pBlob;
+    _Store.pDir = (const AssetStore_Entry_t*)(pHeader + 1);
+    _Store.NumEntries = pHeader->NumEntries;
+
+    for (size_t i = 0; i < _Store.NumEntries; i++)
+    {
+        const AssetStore_Entry_t *const pEntry = &_Store.pDir[i];
+        if (!IsValidEntry(pEntry, pHeader->Size))
+        {
+            AssetStore_Close();
+            return false;
+        }
+
+        const uint8_t *const pData = &_Store.pBlob[pEntry->Offset];
+        _Store.pObjects[i] = (pEntry->Type == kAssetStore_Type_Image) ? LoadImage(pData, pEntry->Size)
+                                                                      : LoadFont(pData, pEntry->Size);
+        if (_Store.pObjects[i] == NULL)
+        {
+            AssetStore_Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// pName is the partition's label, or a file's path on a host
+bool AssetStore_Map(const char *const pName)
+{
+    AssetStore_Close();
+
+#if defined(ESP_PLATFORM)
+    const esp_partition_t *const pPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, pName);
+    if (pPartition == NULL)
+    {
+        return false;
+    }
+
+    const void *pBlob;
+    esp_partition_mmap_handle_t hMap;
+    if (esp_partition_mmap(pPartition, 0, pPartition->size, ESP_PARTITION_MMAP_DATA, &pBlob, &hMap) != ESP_OK)
+    {
+        return false;
+    }
+
+    if (!AssetStore_Open(pBlob, pPartition->size))
+    {
+        esp_partition_munmap(hMap);
+        return false;
+    }
+
+    _Store.hMap = hMap;
+    _Store.MapSize = pPartition->size;
+#else
+    const int File = open(pName, O_RDONLY);
+    if (File < 0)
+    {
+        return false;
+    }
+
+    struct stat Stat;
+    void *pBlob = MAP_FAILED;
+    if ((fstat(File, &Stat) == 0) && (Stat.st_size > 0))
+    {
+        pBlob = mmap(NULL, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+    }
+    close(File);
+
+    if (pBlob == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if (!AssetStore_Open(pBlob, (size_t)Stat.st_size))
+    {
+        munmap(pBlob, (size_t)Stat.st_size);
+        return false;
+    }
+
+    _Store.MapSize = (size_t)Stat.st_size;
+#endif
+
+    return true;
+}
+
+// Anything looked up before stays allocated only until here, so it's meant for the tools and a failed open
+void AssetStore_Close(void)
+{
+    for (size_t i = 0; i < _Store.NumEntries; i++)
+    {
+        free(_Store.pObjects[i]);
+    }
+
+    if (_Store.MapSize > 0)
+    {
+#if defined(ESP_PLATFORM)
+        esp_partition_munmap(_Store.hMap);
+#else
+        munmap((void*)_Store.pBlob, _Store.MapSize);
+#endif
+    }
+
+    memset(&_Store, 0x0, sizeof(_Store));
+}
+
+// Never NULL, a missing image is drawn as nothing rather than taking the OSD down with it
+const lv_img_dsc_t* AssetStore_GetImage(const char *const pName)
+{
+    const lv_img_dsc_t *const pImg = Find(pName, kAssetStore_Type_Image);
+    return (pImg != NULL) ? pImg : &_Placeholder;
+}
+
+// Falls back to LVGL's default font, so that text stays readable without the store
+const lv_font_t* AssetStore_GetFont(const char *const pName)
+{
+    const lv_font_t *const pFont = Find(pName, kAssetStore_Type_Font);
+#if defined(LV_FONT_DEFAULT)
+    return (pFont != NULL) ? pFont : LV_FONT_DEFAULT;
+#else
+    return pFont;
+#endif
+}
+
+size_t AssetStore_GetNumEntries(void)
+{
+    return _Store.NumEntries;
+}
+
+const AssetStore_Entry_t* AssetStore_GetEntry(const size_t Index)
+{
+    return (Index < _Store.NumEntries) ? &_Store.pDir[Index] : NULL;
+}
+
+static bool IsValidEntry(const AssetStore_Entry_t *const pEntry, const size_t BlobSize)
+{
+    return (memchr(pEntry->Name, '\0', sizeof(pEntry->Name)) != NULL) &&
+           ((pEntry->Offset % kAssetStoreConsts_Align) == 0) && IsInside(pEntry->Offset, pEntry->Size, BlobSize) &&
+           ((pEntry->Type == kAssetStore_Type_Image) || (pEntry->Type == kAssetStore_Type_Font));
+}
+
+// Same descriptors as tools/asset_pack generates for linking the pack in
+static void* LoadImage(const uint8_t *const pEntry, const size_t Size)
+{
+    const AssetPack_Image_t *const pPacked = (const AssetPack_Image_t*)pEntry;
+    if (!AssetPack_IsValidImage(pPacked, Size) || (pPacked->Width > 2047) || (pPacked->Height > 2047))
+    {
+        return NULL;
+    }
+
+    lv_img_dsc_t *const pImg = calloc(1, sizeof(*pImg));
+    if (pImg == NULL)
+    {
+        return NULL;
+    }
+
+    const bool IsRaw = (pPacked->Encoding == kAssetPack_Encoding_Raw);
+    pImg->header.cf = IsRaw ? pPacked->Format : LV_IMG_CF_USER_ENCODED_0;
+    pImg->header.w = pPacked->Width;
+    pImg->header.h = pPacked->Height;
+    pImg->data = IsRaw ? (const uint8_t*)(pPacked + 1) : pEntry;
+    pImg->data_size = IsRaw ? pPacked->DataSize : (sizeof(*pPacked) + pPacked->DataSize);
+    return pImg;
+}
+
+static void* LoadFont(const uint8_t *const pEntry, const size_t Size)
+{
+    const AssetStore_Font_t *const pHeader = (const AssetStore_Font_t*)pEntry;
+    if ((Size < sizeof(*pHeader)) || (pHeader->NumGlyphs == 0) || (pHeader->NumCmaps == 0) ||
+        ((pHeader->Bpp != 1) && (pHeader->Bpp != 2) && (pHeader->Bpp != 4) && (pHeader->Bpp != 8)))
+    {
+        return NULL;
+    }
+
+    // The tables are laid out back to back, each 4-byte aligned
+    const size_t CmapsOffset = sizeof(*pHeader);
+    const size_t GlyphsOffset = CmapsOffset + pHeader->NumCmaps * sizeof(AssetStore_Cmap_t);
+    const size_t BitmapOffset = GlyphsOffset + pHeader->NumGlyphs * sizeof(lv_font_fmt_txt_glyph_dsc_t);
+    if (!IsInside(BitmapOffset, pHeader->BitmapSize, Size))
+    {
+        return NULL;
+    }
+
+    const AssetStore_Cmap_t *const pCmaps = (const AssetStore_Cmap_t*)&pEntry[CmapsOffset];
+    const lv_font_fmt_txt_glyph_dsc_t *const pGlyphs = (const lv_font_fmt_txt_glyph_dsc_t*)&pEntry[GlyphsOffset];
+
+    for (size_t g = 1; g < pHeader->NumGlyphs; g++)
+    {
+        const size_t GlyphSize = ((size_t)pGlyphs[g].box_w * pGlyphs[g].box_h * pHeader->Bpp + 7) / 8;
+        if (!IsInside(pGlyphs[g].bitmap_index, GlyphSize, pHeader->BitmapSize))
+        {
+            return NULL;
+        }
+    }
+
+    for (size_t c = 0; c < pHeader->NumCmaps; c++)
+    {
+        if (!IsValidCmap(&pCmaps[c], pEntry, Size, pHeader->NumGlyphs))
+        {
+            return NULL;
+        }
+    }
+
+    Font_t *const pFont = calloc(1, sizeof(*pFont) + pHeader->NumCmaps * sizeof(pFont->Cmaps[0]));
+    if (pFont == NULL)
+    {
+        return NULL;
+    }
+
+    for (size_t c = 0; c < pHeader->NumCmaps; c++)
+    {
+        const AssetStore_Cmap_t *const pCmap = &pCmaps[c];
+        pFont->Cmaps[c].range_start = pCmap->RangeStart;
+        pFont->Cmaps[c].range_length = pCmap->RangeLength;
+        pFont->Cmaps[c].glyph_id_start = pCmap->GlyphIdStart;
+        pFont->Cmaps[c].unicode_list = (pCmap->UnicodeListOffset != 0) ? (const uint16_t*)&pEntry[pCmap->UnicodeListOffset] : NULL;
+        pFont->Cmaps[c].glyph_id_ofs_list = (pCmap->GlyphIdOfsListOffset != 0) ? &pEntry[pCmap->GlyphIdOfsListOffset] : NULL;
+        pFont->Cmaps[c].list_length = pCmap->ListLength;
+        pFont->Cmaps[c].type = (lv_font_fmt_txt_cmap_type_t)pCmap->Type;
+    }
+
+    pFont->Dsc.glyph_bitmap = &pEntry[BitmapOffset];
+    pFont->Dsc.glyph_dsc = pGlyphs;
+    pFont->Dsc.cmaps = pFont->Cmaps;
+    pFont->Dsc.kern_dsc = NULL;
+    pFont->Dsc.kern_scale = 0;
+    pFont->Dsc.cmap_num = pHeader->NumCmaps;
+    pFont->Dsc.bpp = pHeader->Bpp;
+    pFont->Dsc.kern_classes = 0;
+    pFont->Dsc.bitmap_format = 0;
+    pFont->Dsc.cache = &pFont->Cache;
+
+    pFont->Font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+    pFont->Font.get_glyph_bitmap = lv_font_get_bitmap_fmt_txt;
+    pFont->Font.line_height = pHeader->LineHeight;
+    pFont->Font.base_line = pHeader->BaseLine;
+    pFont->Font.subpx = pHeader->Subpx;
+    pFont->Font.underline_position = pHeader->UnderlinePosition;
+    pFont->Font.underline_thickness = pHeader->UnderlineThickness;
+    pFont->Font.dsc = &pFont->Dsc;
+    pFont->Font.fallback = NULL;
+    pFont->Font.user_data = NULL;
+    return pFont;
+}
+
+// Every glyph id the cmap can give must be in the font, since LVGL indexes the glyph descriptors with it unchecked
+static bool IsValidCmap(const AssetStore_Cmap_t *const pCmap, const uint8_t *const pEntry, const size_t Size, const size_t NumGlyphs)
+{
+    const bool IsSparse = (pCmap->Type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) || (pCmap->Type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL);
+    const bool HasOfsList = (pCmap->Type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL) || (pCmap->Type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL);
+    const size_t NumCodes = IsSparse ? pCmap->ListLength : pCmap->RangeLength;
+    const size_t OfsSize = (pCmap->Type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) ? sizeof(uint16_t) : sizeof(uint8_t);
+
+    if ((pCmap->Type > LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) ||
+        (IsSparse && (((pCmap->UnicodeListOffset % sizeof(uint16_t)) != 0) || (pCmap->UnicodeListOffset == 0) ||
+                      !IsInside(pCmap->UnicodeListOffset, NumCodes * sizeof(uint16_t), Size))) ||
+        (HasOfsList && (((pCmap->GlyphIdOfsListOffset % OfsSize) != 0) || (pCmap->GlyphIdOfsListOffset == 0) ||
+                        !IsInside(pCmap->GlyphIdOfsListOffset, NumCodes * OfsSize, Size))))
+    {
+        return false;
+    }
+
+    if (!HasOfsList)
+    {
+        return (size_t)pCmap->GlyphIdStart + NumCodes <= NumGlyphs;
+    }
+
+    for (size_t i = 0; i < NumCodes; i++)
+    {
+        const size_t Ofs = (OfsSize == sizeof(uint16_t))
+            ? ((const uint16_t*)&pEntry[pCmap->GlyphIdOfsListOffset])[i]
+            : pEntry[pCmap->GlyphIdOfsListOffset + i];
+        if ((size_t)pCmap->GlyphIdStart + Ofs >= NumGlyphs)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool IsInside(const size_t Offset, const size_t Length, const size_t Size)
+{
+    return (Offset <= Size) && (Length <= Size - Offset);
+}
+
+static const void* Find(const char *const pName, const AssetStore_Type_t eType)
+{
+    for (size_t i = 0; (pName != NULL) && (i < _Store.NumEntries); i++)
+    {
+        if ((_Store.pDir[i].Type == (uint32_t)eType) && (strcmp(_Store.pDir[i].Name, pName) == 0))
+        {
+            return _Store.pObjects[i];
+        }
+    }
+
+    return NULL;
+}
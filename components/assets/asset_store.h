@@ -0,0 +1,91 @@
+#pragma once
+
+// OSD images and fonts kept outside the app, in the `assets` partition. tools/asset_pack writes them as one blob:
+// a header, a directory of named entries, then the entries themselves, each on a 4-byte boundary. The blob is mapped
+// into the address space as it is, and looked up by name into lv_img_dsc_t and lv_font_t that point straight into the
+// mapping. Only the descriptors are built in RAM, the pixels and glyphs are never copied.
+//
+// Image entries are asset pack entries (see asset_pack.h) and need AssetDecoder_Init() if they are packed. Font
+// entries hold LVGL's own glyph descriptors and bitmaps, so fonts with kerning or compressed bitmaps aren't supported.
+//
+// All fields are little endian. On a host the blob is mapped from a file, so that the tools load it the same way.
+
+#include "lvgl.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kAssetStoreConsts_Magic      = 0x54534143,  // "CAST"
+    kAssetStoreConsts_Version    = 1,
+    kAssetStoreConsts_MaxName    = 24,          // [chars] Including the terminator
+    kAssetStoreConsts_Align      = 4,           // [bytes] Entries and the tables in font entries
+    kAssetStoreConsts_MaxEntries = 64,
+} AssetStoreConsts_t;
+
+typedef enum {
+    kAssetStore_Type_Image = 1,
+    kAssetStore_Type_Font  = 2,
+} AssetStore_Type_t;
+
+typedef struct AssetStore_Header {
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t NumEntries;
+    uint32_t Size;                              // [bytes] The whole blob, this header included
+    uint32_t Checksum;                          // FNV-1a of everything after this header
+} AssetStore_Header_t;
+
+// The directory follows the header
+typedef struct AssetStore_Entry {
+    char Name[kAssetStoreConsts_MaxName];       // The symbol the asset has when it is linked in
+    uint32_t Type;                              // AssetStore_Type_t
+    uint32_t Offset;                            // [bytes] From the start of the blob
+    uint32_t Size;                              // [bytes]
+} AssetStore_Entry_t;
+
+// Followed by NumCmaps cmaps, NumGlyphs glyph descriptors in LVGL's layout (glyph 0 is the unused one LVGL expects)
+// and BitmapSize bytes of bitmaps, each table starting on a 4-byte boundary. The cmaps' lists come after the bitmaps.
+typedef struct AssetStore_Font {
+    int16_t LineHeight;                         // [px]
+    int16_t BaseLine;                           // [px]
+    int8_t UnderlinePosition;
+    int8_t UnderlineThickness;
+    uint8_t Subpx;
+    uint8_t Bpp;
+    uint16_t NumGlyphs;
+    uint16_t NumCmaps;
+    uint32_t BitmapSize;                        // [bytes]
+} AssetStore_Font_t;
+
+typedef struct AssetStore_Cmap {
+    uint32_t RangeStart;
+    uint16_t RangeLength;
+    uint16_t GlyphIdStart;
+    uint32_t UnicodeListOffset;                 // [bytes] From the start of the font entry, 0 without a list
+    uint32_t GlyphIdOfsListOffset;              // [bytes] Likewise
+    uint16_t ListLength;
+    uint8_t Type;                               // lv_font_fmt_txt_cmap_type_t
+    uint8_t Reserved;
+} AssetStore_Cmap_t;
+
+// With the asset partition the images and fonts aren't linked in, so code that uses them looks them up instead. The
+// LV_IMG_DECLARE()s can stay, a declaration alone doesn't pull the asset in. Lookups are by name and meant for when
+// widgets are created, not for every draw.
+#if CONFIG_CHROMATIC_OSD_ASSET_PARTITION
+    #define ASSET_IMG(Name)             AssetStore_GetImage(#Name)
+    #define ASSET_FONT(Name)            AssetStore_GetFont(#Name)
+#else
+    #define ASSET_IMG(Name)             (&(Name))
+    #define ASSET_FONT(Name)            (&(Name))
+#endif
+
+uint32_t AssetStore_Checksum(const void *const pData, const size_t Size);
+bool AssetStore_Open(const void *const pBlob, const size_t Size);
+bool AssetStore_Map(const char *const pName);
+void AssetStore_Close(void);
+const lv_img_dsc_t* AssetStore_GetImage(const char *const pName);
+const lv_font_t* AssetStore_GetFont(const char *const pName);
+size_t AssetStore_GetNumEntries(void);
+const AssetStore_Entry_t* AssetStore_GetEntry(const size_t Index);
@@ -0,0 +1,51 @@
+# asset_pack_generate(<OUT_C|OUT_BIN> <output>)
+#
+# Builds tools/asset_pack with the host compiler and runs it to write the packed images as C source (OUT_C) or the
+# images and fonts as an asset store for the assets partition (OUT_BIN). The output is remade whenever an image, a
+# font or the packer changes, so it can't go stale against the sources. The tool fails the build if an asset doesn't
+# decode back to what it was packed from.
+
+get_filename_component(ASSET_PACK_REPO_DIR "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+
+function(asset_pack_generate kind output)
+    if(kind STREQUAL "OUT_C")
+        set(out_arg "--out-c")
+    elseif(kind STREQUAL "OUT_BIN")
+        set(out_arg "--out-bin")
+    else()
+        message(FATAL_ERROR "asset_pack_generate: unknown output kind '${kind}'")
+    endif()
+
+    # The project's compiler targets the ESP32, the packer has to run here
+    find_program(ASSET_PACK_HOST_CC NAMES cc gcc clang)
+    if(NOT ASSET_PACK_HOST_CC)
+        message(FATAL_ERROR "asset_pack_generate: no host C compiler (cc, gcc or clang) found to build tools/asset_pack")
+    endif()
+
+    file(GLOB image_srcs "${ASSET_PACK_REPO_DIR}/components/images/*.c")
+    file(GLOB font_srcs "${ASSET_PACK_REPO_DIR}/components/fonts/*.c")
+    set(tool_srcs
+        "${ASSET_PACK_REPO_DIR}/tools/asset_pack/asset_pack.c"
+        "${ASSET_PACK_REPO_DIR}/components/assets/asset_pack.c"
+        "${ASSET_PACK_REPO_DIR}/components/assets/asset_store.c"
+    )
+    set(tool_hdrs
+        "${ASSET_PACK_REPO_DIR}/components/assets/asset_pack.h"
+        "${ASSET_PACK_REPO_DIR}/components/assets/asset_store.h"
+        "${ASSET_PACK_REPO_DIR}/tools/palette_check/lvgl.h"
+    )
+
+    get_filename_component(output_name "${output}" NAME_WE)
+    set(tool "${CMAKE_CURRENT_BINARY_DIR}/asset_pack_${output_name}")
+
+    add_custom_command(OUTPUT "${output}"
+        COMMAND "${ASSET_PACK_HOST_CC}" -O2 -DLV_LVGL_H_INCLUDE_SIMPLE
+            "-I${ASSET_PACK_REPO_DIR}/tools/palette_check" "-I${ASSET_PACK_REPO_DIR}/components/assets"
+            ${tool_srcs} ${image_srcs} ${font_srcs} -o "${tool}"
+        COMMAND "${tool}" --iterations 1 ${out_arg} "${output}"
+        DEPENDS ${tool_srcs} ${tool_hdrs} ${image_srcs} ${font_srcs}
+        COMMENT "Packing OSD assets into ${output}"
+        VERBATIM
+    )
+    set_property(DIRECTORY APPEND PROPERTY ADDITIONAL_CLEAN_FILES "${output}" "${tool}")
+endfunction()
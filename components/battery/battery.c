@@ -2,6 +2,7 @@
 
 #include "osd_shared.h"
 #include "line.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "esp_log.h"
@@ -133,6 +134,7 @@ typedef struct Battery {
     #endif
 
     lv_obj_t* pIconChargingObj;
+    OSD_Widget_t* pWidget;
 
 } Battery_t;
 
@@ -151,11 +153,8 @@ LV_IMG_DECLARE(icon_bat_large_y);
 LV_IMG_DECLARE(icon_bat_large_r);
 LV_IMG_DECLARE(icon_charging);
 
-const void * _batt_borders[kNumBorderImages] = {
-    &icon_bat_large_g,
-    &icon_bat_large_y,
-    &icon_bat_large_r
-};
+// Filled in at init, the images may only be found once the asset partition is mapped
+const void * _batt_borders[kNumBorderImages];
 
 static OSD_Result_t Battery_Draw(void* arg);
 static void set_fill_color(const float batt_V, const BatteryKind_t eKind);
@@ -180,6 +179,10 @@ OSD_Result_t Battery_Init(OSD_Widget_t *const pWidget)
 
     _ctx.firstDraw = true;
 
+    _batt_borders[kBorderImgGreen]  = ASSET_IMG(icon_bat_large_g);
+    _batt_borders[kBorderImgYellow] = ASSET_IMG(icon_bat_large_y);
+    _batt_borders[kBorderImgRed]    = ASSET_IMG(icon_bat_large_r);
+
     // Assume no charge and AA chemistry until we get enough data from the FPGA
     _ctx.eBattKind   = kBatteryKind_AA;
     _ctx.battLevel_V = kLevel_MinValid_V;
@@ -193,6 +196,7 @@ OSD_Result_t Battery_Init(OSD_Widget_t *const pWidget)
     #endif
 
     pWidget->fnDraw = Battery_Draw;
+    _ctx.pWidget = pWidget;
 
     return kOSD_Result_Ok;
 }
@@ -261,6 +265,8 @@ void Battery_UpdateVoltage(const float batt_V, const BatteryKind_t eKind)
             (void) Mutex_Give(kMutexKey_Battery);
         }
     }
+
+    OSD_Widget_MarkDirty(_ctx.pWidget);
 }
 
 void Battery_SetChargingStatus(const bool IsCharging)
@@ -274,11 +280,19 @@ void Battery_SetChargingStatus(const bool IsCharging)
         _ctx.LiPoIsCharging ^= 1;
     }
     #else
+    bool IsChanged = false;
     if (Mutex_Take(kMutexKey_Battery) == kMutexResult_Ok)
     {
-        _ctx.LiPoIsCharging = (IsCharging ? kLipoChargeStatus_Enabled : kLipoChargeStatus_Disabled);
+        const LipoChargeStatus_t eStatus = (IsCharging ? kLipoChargeStatus_Enabled : kLipoChargeStatus_Disabled);
+        IsChanged = (_ctx.LiPoIsCharging != eStatus);
+        _ctx.LiPoIsCharging = eStatus;
         (void) Mutex_Give(kMutexKey_Battery);
     }
+
+    if (IsChanged)
+    {
+        OSD_Widget_MarkDirty(_ctx.pWidget);
+    }
     #endif
 }
 
@@ -372,15 +386,14 @@ static OSD_Result_t Battery_Draw(void* arg)
         lv_obj_set_style_line_color(_fill[i].pObj, lv_color_hex(_fill[i].color), LV_PART_MAIN);
     }
 
-    if (_ctx.pIconChargingObj == NULL)
-    {
-        _ctx.pIconChargingObj = lv_img_create(pScreen);
-    }
-
     if (_ctx.LiPoIsCharging == kLipoChargeStatus_Enabled)
     {
-        lv_img_set_src(_ctx.pIconChargingObj, &icon_charging);
-        lv_obj_align(_ctx.pIconChargingObj, LV_ALIGN_CENTER, -1, 52);
+        if (_ctx.pIconChargingObj == NULL)
+        {
+            _ctx.pIconChargingObj = lv_img_create(pScreen);
+            lv_img_set_src(_ctx.pIconChargingObj, ASSET_IMG(icon_charging));
+            lv_obj_align(_ctx.pIconChargingObj, LV_ALIGN_CENTER, -1, 52);
+        }
     }
     else
     {
@@ -53,6 +53,7 @@ static int poke_button_command(int argc, char **argv);
 void Button_Update(uint16_t NewButtons)
 {
     NewButtons = NewButtons & kButtonBitsMask;
+    bool IsNewPress = false;
 
     if (Mutex_Take(kMutexKey_Buttons) == kMutexResult_Ok)
     {
@@ -68,6 +69,7 @@ void Button_Update(uint16_t NewButtons)
             {
                 // Button was not pressed, now pressed
                 _Ctx[b].State = kButtonState_Pressed;
+                IsNewPress = true;
             }
         }
 
@@ -75,6 +77,11 @@ void Button_Update(uint16_t NewButtons)
 
         (void) Mutex_Give(kMutexKey_Buttons);
     }
+
+    if (IsNewPress)
+    {
+        OSD_RequestRedraw();
+    }
 }
 
 void Button_ResetAll(void)
@@ -1,6 +1,10 @@
 #include "osd_shared.h"
 #include "color.h"
+#include "asset_store.h"
 #include "lvgl.h"
+#include "esp_timer.h"
+
+#include <string.h>
 
 LV_FONT_DECLARE(chibit_mr);
 LV_FONT_DECLARE(fingfai);
@@ -10,6 +14,15 @@ static lv_style_t _StyleTextWhite;
 static lv_style_t _StyleTextGrey;
 static lv_style_t _StyleTextBlack;
 static lv_style_t _StyleTextWhite_L;
+static fnOnUpdateCb_t _OnRedraw;
+
+// Bumped to mark every widget dirty at once, a widget is clean when it has been drawn since the last bump
+static volatile uint32_t _InvalidGen = 1;
+
+static OSD_Widget_t* _Profiled[kOSD_MaxProfiledWidgets];
+static size_t _NumProfiled;
+
+static bool _IsRetained;
 
 OSD_Result_t OSD_Common_Init(void)
 {
@@ -19,16 +32,16 @@ OSD_Result_t OSD_Common_Init(void)
     lv_style_init(&_StyleTextWhite_L);
 
     lv_style_set_text_color(&_StyleTextWhite, lv_color_hex(kColor_White));
-    lv_style_set_text_font(&_StyleTextWhite, &fingfai);
+    lv_style_set_text_font(&_StyleTextWhite, ASSET_FONT(fingfai));
 
     lv_style_set_text_color(&_StyleTextGrey,lv_color_hex(kColor_Grey));
-    lv_style_set_text_font(&_StyleTextGrey, &fingfai);
+    lv_style_set_text_font(&_StyleTextGrey, ASSET_FONT(fingfai));
 
     lv_style_set_text_color(&_StyleTextBlack,lv_color_hex(kColor_Black));
-    lv_style_set_text_font(&_StyleTextBlack, &fingfai);
+    lv_style_set_text_font(&_StyleTextBlack, ASSET_FONT(fingfai));
 
     lv_style_set_text_color(&_StyleTextWhite_L, lv_color_hex(kColor_White));
-    lv_style_set_text_font(&_StyleTextWhite_L, &jf_dot_k14);
+    lv_style_set_text_font(&_StyleTextWhite_L, ASSET_FONT(jf_dot_k14));
 
     return kOSD_Result_Ok;
 }
@@ -52,3 +65,156 @@ lv_style_t* OSD_GetStyleTextWhite_L(void)
 {
     return &_StyleTextWhite_L;
 }
+
+void OSD_RegisterOnRedrawCb(fnOnUpdateCb_t Handler)
+{
+    _OnRedraw = Handler;
+}
+
+// May be called from any task, the handler only wakes the render task
+void OSD_RequestRedraw(void)
+{
+    if (_OnRedraw != NULL)
+    {
+        _OnRedraw();
+    }
+}
+
+// May be called from any task
+void OSD_Widget_MarkDirty(OSD_Widget_t *const pWidget)
+{
+    for (OSD_Widget_t* pDirty = pWidget; pDirty != NULL; pDirty = pDirty->pParent)
+    {
+        pDirty->IsDirty = true;
+    }
+
+    OSD_RequestRedraw();
+}
+
+// For changes that are not tied to one widget, such as a setting written from the console
+void OSD_InvalidateAll(void)
+{
+    _InvalidGen++;
+    OSD_RequestRedraw();
+}
+
+bool OSD_Widget_NeedsDraw(OSD_Widget_t const *const pWidget)
+{
+    return (pWidget != NULL) && (pWidget->IsDirty || (pWidget->DrawnGen != _InvalidGen));
+}
+
+void OSD_Widget_SetDrawn(OSD_Widget_t *const pWidget)
+{
+    if (pWidget != NULL)
+    {
+        pWidget->IsDirty = false;
+        pWidget->DrawnGen = _InvalidGen;
+    }
+}
+
+// Draws the widget if it is dirty, otherwise only counts the skip
+OSD_Result_t OSD_Widget_Draw(OSD_Widget_t *const pWidget, void* arg)
+{
+    if (pWidget == NULL)
+    {
+        return kOSD_Result_Err_NullDataPtr;
+    }
+
+    OSD_WidgetProfile_t *const pProfile = &pWidget->Profile;
+    if (((pProfile->NumDraws | pProfile->NumSkips) == 0) && (_NumProfiled < kOSD_MaxProfiledWidgets))
+    {
+        _Profiled[_NumProfiled++] = pWidget;
+    }
+
+    if (!OSD_Widget_NeedsDraw(pWidget))
+    {
+        pProfile->NumSkips++;
+        return kOSD_Result_Ok;
+    }
+
+    // Cleared first so that state changing while drawing is picked up by the next pass
+    OSD_Widget_SetDrawn(pWidget);
+
+    if (pWidget->fnDraw == NULL)
+    {
+        return kOSD_Result_Ok;
+    }
+
+    const uint32_t Start_us = (uint32_t)esp_timer_get_time();
+    const OSD_Result_t eResult = pWidget->fnDraw(arg);
+    const uint32_t Draw_us = (uint32_t)esp_timer_get_time() - Start_us;
+
+    pProfile->NumDraws++;
+    pProfile->LastDraw_us = Draw_us;
+    pProfile->MaxDraw_us = MAX(pProfile->MaxDraw_us, Draw_us);
+    pProfile->TotalDraw_us += Draw_us;
+
+    return eResult;
+}
+
+// Widgets are listed in the order they were first drawn
+size_t OSD_GetProfiledWidgets(OSD_Widget_t const** ppWidgets, const size_t MaxWidgets)
+{
+    const size_t NumWidgets = MIN(_NumProfiled, MaxWidgets);
+    for (size_t i = 0; (ppWidgets != NULL) && (i < NumWidgets); i++)
+    {
+        ppWidgets[i] = _Profiled[i];
+    }
+
+    return NumWidgets;
+}
+
+void OSD_ResetWidgetProfiles(void)
+{
+    for (size_t i = 0; i < _NumProfiled; i++)
+    {
+        memset(&_Profiled[i]->Profile, 0, sizeof(OSD_WidgetProfile_t));
+    }
+
+    _NumProfiled = 0;
+}
+
+// Must be set before any widget is drawn
+void OSD_SetRetainedMode(const bool IsRetained)
+{
+    _IsRetained = IsRetained;
+}
+
+bool OSD_IsRetainedMode(void)
+{
+    return _IsRetained;
+}
+
+// In retained mode every widget draws into its own transparent, full-size container. Navigating away hides the
+// container rather than deleting the widget's objects, so they are only ever created once. Returns the parent the
+// widget should create its objects in, which is pParent itself when not retained.
+lv_obj_t* OSD_Widget_Show(OSD_Widget_t *const pWidget, lv_obj_t *const pParent)
+{
+    if (!_IsRetained || (pWidget == NULL))
+    {
+        return pParent;
+    }
+
+    if (pWidget->pRoot == NULL)
+    {
+        pWidget->pRoot = lv_obj_create(pParent);
+        lv_obj_remove_style_all(pWidget->pRoot);
+        lv_obj_set_size(pWidget->pRoot, LV_PCT(100), LV_PCT(100));
+        lv_obj_clear_flag(pWidget->pRoot, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    }
+    else if (lv_obj_has_flag(pWidget->pRoot, LV_OBJ_FLAG_HIDDEN))
+    {
+        // Changing the flag invalidates the area even when it is already clear
+        lv_obj_clear_flag(pWidget->pRoot, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    return pWidget->pRoot;
+}
+
+void OSD_Widget_Hide(OSD_Widget_t *const pWidget)
+{
+    if ((pWidget != NULL) && (pWidget->pRoot != NULL) && !lv_obj_has_flag(pWidget->pRoot, LV_OBJ_FLAG_HIDDEN))
+    {
+        lv_obj_add_flag(pWidget->pRoot, LV_OBJ_FLAG_HIDDEN);
+    }
+}
@@ -3,6 +3,8 @@
 #include "dlist.h"
 #include "lvgl.h"
 #include "button.h"
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
@@ -47,6 +49,8 @@ typedef enum OSD_Result {
     kOSD_Result_Err_UnexpectedSettingDataType,
     kOSD_Result_Err_CmdRegFailed,
     kOSD_Result_Err_FailedToReadSN,
+    kOSD_Result_Err_InvalidMsgID,
+    kOSD_Result_Err_NoFreeSlot,
 
     kOSD_Result_Err_FirstUserErr,
 } OSD_Result_t;
@@ -55,6 +59,20 @@ typedef void (*fnOnUpdateCb_t)(void);
 typedef OSD_Result_t (*fnOSDCb_t)(void* arg);
 typedef OSD_Result_t (*fnOSDButtonCb_t)(const Button_t Button, const ButtonState_t State, void *arg);
 
+enum {
+    // Widgets beyond this are drawn but not profiled
+    kOSD_MaxProfiledWidgets = 32,
+};
+
+// Time spent in a widget's fnDraw, see OSD_Widget_Draw()
+typedef struct OSD_WidgetProfile {
+    uint32_t NumDraws;
+    uint32_t NumSkips;          // Draw passes where the widget was clean
+    uint32_t LastDraw_us;
+    uint32_t MaxDraw_us;
+    uint64_t TotalDraw_us;
+} OSD_WidgetProfile_t;
+
 typedef struct OSD_Widget {
     // The node must not be relocated as we use this for menu rearrangement.
     sys_dnode_t Node;
@@ -71,9 +89,33 @@ typedef struct OSD_Widget {
 
     // A human-friendly name for the widget specified by the user.
     const char* Name;
+
+    // Widgets are only drawn when dirty. Marking a widget dirty marks its parents too so that the draw pass reaches
+    // it. Set by the container that owns the widget, top-level widgets have none.
+    struct OSD_Widget* pParent;
+    bool IsDirty;
+    uint32_t DrawnGen;
+
+    // Retained mode only, the container holding the widget's objects. See OSD_Widget_Show().
+    lv_obj_t* pRoot;
+
+    OSD_WidgetProfile_t Profile;
 } OSD_Widget_t;
 
 OSD_Result_t OSD_Common_Init(void);
+void OSD_RegisterOnRedrawCb(fnOnUpdateCb_t Handler);
+void OSD_RequestRedraw(void);
+void OSD_Widget_MarkDirty(OSD_Widget_t *const pWidget);
+void OSD_InvalidateAll(void);
+bool OSD_Widget_NeedsDraw(OSD_Widget_t const *const pWidget);
+void OSD_Widget_SetDrawn(OSD_Widget_t *const pWidget);
+OSD_Result_t OSD_Widget_Draw(OSD_Widget_t *const pWidget, void* arg);
+void OSD_SetRetainedMode(const bool IsRetained);
+bool OSD_IsRetainedMode(void);
+lv_obj_t* OSD_Widget_Show(OSD_Widget_t *const pWidget, lv_obj_t *const pParent);
+void OSD_Widget_Hide(OSD_Widget_t *const pWidget);
+size_t OSD_GetProfiledWidgets(OSD_Widget_t const** ppWidgets, const size_t MaxWidgets);
+void OSD_ResetWidgetProfiles(void);
 lv_style_t* OSD_GetStyleTextWhite(void);
 lv_style_t* OSD_GetStyleTextGrey(void);
 lv_style_t* OSD_GetStyleTextBlack(void);
@@ -11,29 +11,60 @@ enum {
     kInitCRC = 0xFF,
 };
 
+// Shift one bit through the CRC register
+#define CRC8_XTIME(c) ((uint8_t)((((c) << 1) ^ (((c) & 0x80) ? kPolynomial : 0)) & 0xFF))
+
+// The CRC is linear over GF(2), so every table entry is the XOR of the entries for each set bit of the index.
+// Each single-bit entry is the previous one shifted once more through the register.
+enum {
+    kCrcBit0 = kPolynomial,  // Index 0x01 shifted through all eight bits
+    kCrcBit1 = CRC8_XTIME(kCrcBit0),
+    kCrcBit2 = CRC8_XTIME(kCrcBit1),
+    kCrcBit3 = CRC8_XTIME(kCrcBit2),
+    kCrcBit4 = CRC8_XTIME(kCrcBit3),
+    kCrcBit5 = CRC8_XTIME(kCrcBit4),
+    kCrcBit6 = CRC8_XTIME(kCrcBit5),
+    kCrcBit7 = CRC8_XTIME(kCrcBit6),
+};
+
+#define CRC8_ENTRY(n) ((uint8_t)(                   \
+    (((n) & 0x01) ? kCrcBit0 : 0) ^                 \
+    (((n) & 0x02) ? kCrcBit1 : 0) ^                 \
+    (((n) & 0x04) ? kCrcBit2 : 0) ^                 \
+    (((n) & 0x08) ? kCrcBit3 : 0) ^                 \
+    (((n) & 0x10) ? kCrcBit4 : 0) ^                 \
+    (((n) & 0x20) ? kCrcBit5 : 0) ^                 \
+    (((n) & 0x40) ? kCrcBit6 : 0) ^                 \
+    (((n) & 0x80) ? kCrcBit7 : 0)))
+
+#define CRC8_ROW(n)                                                                 \
+    CRC8_ENTRY((n) + 0x0), CRC8_ENTRY((n) + 0x1), CRC8_ENTRY((n) + 0x2), CRC8_ENTRY((n) + 0x3), \
+    CRC8_ENTRY((n) + 0x4), CRC8_ENTRY((n) + 0x5), CRC8_ENTRY((n) + 0x6), CRC8_ENTRY((n) + 0x7), \
+    CRC8_ENTRY((n) + 0x8), CRC8_ENTRY((n) + 0x9), CRC8_ENTRY((n) + 0xA), CRC8_ENTRY((n) + 0xB), \
+    CRC8_ENTRY((n) + 0xC), CRC8_ENTRY((n) + 0xD), CRC8_ENTRY((n) + 0xE), CRC8_ENTRY((n) + 0xF)
+
+// Generated entirely by the preprocessor so it lives in flash and costs nothing at boot
+const uint8_t crc8_sae_j1850_table[256] = {
+    CRC8_ROW(0x00), CRC8_ROW(0x10), CRC8_ROW(0x20), CRC8_ROW(0x30),
+    CRC8_ROW(0x40), CRC8_ROW(0x50), CRC8_ROW(0x60), CRC8_ROW(0x70),
+    CRC8_ROW(0x80), CRC8_ROW(0x90), CRC8_ROW(0xA0), CRC8_ROW(0xB0),
+    CRC8_ROW(0xC0), CRC8_ROW(0xD0), CRC8_ROW(0xE0), CRC8_ROW(0xF0),
+};
+
+_Static_assert(CRC8_ENTRY(0x01) == 0x1D, "CRC8 table generation is broken");
+_Static_assert(CRC8_ENTRY(0x80) == 0x26, "CRC8 table generation is broken");
+
 static uint8_t crc8_sae_j1850(const uint8_t *pData, const size_t Length) {
     if (pData == NULL)
     {
         return 0;
     }
 
-    uint8_t crc = kInitCRC;
+    uint8_t crc = crc8_sae_j1850_init();
 
     for (size_t i = 0; i < Length; i++)
     {
-        crc ^= pData[i];
-
-        for (uint8_t bit = 0; bit < 8; bit++)
-        {
-            if (crc & 0x80)
-            {
-                crc = (crc << 1) ^ kPolynomial;
-            }
-            else
-            {
-                crc <<= 1;
-            }
-        }
+        crc = crc8_sae_j1850_update(crc, pData[i]);
     }
 
     return crc;
@@ -65,38 +96,154 @@ bool crc8_sae_j1850_decode(const uint8_t *const pMsg, const size_t Length) {
     const uint8_t crc = crc8_sae_j1850(pMsg, Length);
 
     // If CRC is 0, the message is valid
-    return (crc == 0);
+    return crc8_sae_j1850_is_valid(crc);
 }
 
-#if 0
+// Host-side golden vector check and benchmark against the original bit-by-bit implementation.
+// Build and run with: gcc -O2 -DCRC8_SAE_J1850_SELFTEST crc8_sae_j1850.c -o crc8_selftest && ./crc8_selftest
+#if defined(CRC8_SAE_J1850_SELFTEST)
+#include <stdlib.h>
+#include <time.h>
+
+static uint8_t crc8_sae_j1850_bitwise(const uint8_t *pData, const size_t Length) {
+    uint8_t crc = kInitCRC;
+
+    for (size_t i = 0; i < Length; i++)
+    {
+        crc ^= pData[i];
+
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            if (crc & 0x80)
+            {
+                crc = (crc << 1) ^ kPolynomial;
+            }
+            else
+            {
+                crc <<= 1;
+            }
+        }
+    }
+
+    return crc;
+}
+
+typedef struct GoldenVector {
+    const uint8_t* pMsg;
+    size_t Length;
+    uint8_t CRC;
+} GoldenVector_t;
+
 int main() {
-    uint8_t message[] = {0x12, 0x34, 0x56, 0x78};
-    const size_t message_length = sizeof(message);
+    static const uint8_t kCheck[] = "123456789";
+    static const uint8_t kSysCtl[] = {0x8F, 0x04, 0x02, 0x00, 0x12};
+    static const uint8_t kBacklight[] = {0x8F, 0x05, 0x02, 0x00, 0x0F};
+    static const uint8_t kPalette[] = {0x8F, 0x0B, 0x08, 0x7F, 0xFF, 0xBF, 0x32, 0xD0, 0x00, 0x00, 0x00};
+
+    // Values produced by the bit-by-bit implementation shipped up to v0.13.3
+    const GoldenVector_t Vectors[] = {
+        { kCheck,     sizeof(kCheck) - 1, 0xB4 },
+        { kSysCtl,    sizeof(kSysCtl),    0x0A },
+        { kBacklight, sizeof(kBacklight), 0xDB },
+        { kPalette,   sizeof(kPalette),   0x4B },
+    };
+
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(Vectors)/sizeof(Vectors[0]); i++)
+    {
+        const uint8_t Reference = crc8_sae_j1850_bitwise(Vectors[i].pMsg, Vectors[i].Length);
+        const uint8_t Table = crc8_sae_j1850(Vectors[i].pMsg, Vectors[i].Length);
+
+        if (Reference != Vectors[i].CRC)
+        {
+            printf("Golden vector %zu: reference %02X expected %02X\n", i, Reference, Vectors[i].CRC);
+            failures++;
+        }
+
+        if (Table != Reference)
+        {
+            printf("Golden vector %zu: table %02X reference %02X\n", i, Table, Reference);
+            failures++;
+        }
+    }
+
+    // Every table entry must match a single byte pushed through the reference from the initial value
+    for (unsigned n = 0; n < 256; n++)
+    {
+        const uint8_t Byte = (uint8_t)(n ^ kInitCRC);
+        if (crc8_sae_j1850_table[n] != crc8_sae_j1850_bitwise(&Byte, 1))
+        {
+            printf("Table entry %02X mismatch\n", n);
+            failures++;
+        }
+    }
+
+    // Random messages through the whole-buffer, incremental and encode/decode paths
+    uint8_t Msg[64];
+    srand(1850);
+    for (size_t iter = 0; iter < 100000; iter++)
+    {
+        const size_t Length = 1 + (rand() % (sizeof(Msg) - 1));
+        for (size_t i = 0; i < Length; i++)
+        {
+            Msg[i] = (uint8_t)rand();
+        }
+
+        const uint8_t Reference = crc8_sae_j1850_bitwise(Msg, Length);
+
+        uint8_t Running = crc8_sae_j1850_init();
+        for (size_t i = 0; i < Length; i++)
+        {
+            Running = crc8_sae_j1850_update(Running, Msg[i]);
+        }
 
-    uint8_t encoded_message[message_length + 1];
-    memset(encoded_message, 0x0, sizeof(encoded_message));
+        if ((crc8_sae_j1850(Msg, Length) != Reference) || (Running != Reference))
+        {
+            printf("Random vector %zu mismatch\n", iter);
+            failures++;
+            break;
+        }
 
-    // Encode the message
-    size_t encoded_length = encode_message(message, message_length, encoded_message);
+        uint8_t Encoded[sizeof(Msg) + 1];
+        memcpy(Encoded, Msg, Length);
+        if ((crc8_sae_j1850_encode(Encoded, Length, Encoded) != Length + 1) || !crc8_sae_j1850_decode(Encoded, Length + 1))
+        {
+            printf("Encode/decode round trip %zu failed\n", iter);
+            failures++;
+            break;
+        }
+    }
 
-    // Print encoded message
-    printf("Encoded Message with CRC: ");
-    for (size_t i = 0; i < encoded_length; i++)
+    // Benchmark with V2 frame sized messages
+    enum { kBenchIters = 2000000, kFrameLen = 13 };
+    uint8_t Frame[kFrameLen];
+    for (size_t i = 0; i < kFrameLen; i++)
     {
-        printf("%02X ", encoded_message[i]);
+        Frame[i] = (uint8_t)(i * 37u);
     }
-    printf("\n");
 
-    // Decode the message and check CRC
-    if (decode_message(encoded_message, encoded_length))
+    volatile uint8_t Sink = 0;
+    clock_t Start = clock();
+    for (size_t i = 0; i < kBenchIters; i++)
     {
-        printf("Message is valid.\n");
+        Frame[0] = (uint8_t)i;
+        Sink ^= crc8_sae_j1850_bitwise(Frame, kFrameLen);
     }
-    else
+    const double Bitwise_s = (double)(clock() - Start) / CLOCKS_PER_SEC;
+
+    Start = clock();
+    for (size_t i = 0; i < kBenchIters; i++)
     {
-        printf("Message is invalid.\n");
+        Frame[0] = (uint8_t)i;
+        Sink ^= crc8_sae_j1850(Frame, kFrameLen);
     }
+    const double Table_s = (double)(clock() - Start) / CLOCKS_PER_SEC;
+
+    printf("%d-byte frames x %d: bitwise %.3f s, table %.3f s (%.1fx)\n",
+        kFrameLen, kBenchIters, Bitwise_s, Table_s, (Table_s > 0) ? (Bitwise_s / Table_s) : 0.0);
 
-    return 0;
+    printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+    return (failures == 0) ? 0 : 1;
 }
 #endif
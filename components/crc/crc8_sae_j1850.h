@@ -4,5 +4,25 @@
 #include <stddef.h>
 #include <stdint.h>
 
+extern const uint8_t crc8_sae_j1850_table[256];
+
 size_t crc8_sae_j1850_encode(const uint8_t *pMsg, const size_t Length, uint8_t *const pOutput);
 bool crc8_sae_j1850_decode(const uint8_t *const pMsg, const size_t Length);
+
+// Incremental API for callers that see one byte at a time, e.g. the FPGA receive state machine.
+// Start with crc8_sae_j1850_init(), feed every byte including the trailing CRC byte, then check the result.
+static inline uint8_t crc8_sae_j1850_init(void)
+{
+    return 0xFF;
+}
+
+static inline uint8_t crc8_sae_j1850_update(const uint8_t Crc, const uint8_t NextByte)
+{
+    return crc8_sae_j1850_table[Crc ^ NextByte];
+}
+
+static inline bool crc8_sae_j1850_is_valid(const uint8_t Crc)
+{
+    // A message followed by its own CRC always leaves the register at zero
+    return (Crc == 0);
+}
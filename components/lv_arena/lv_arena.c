@@ -0,0 +1,412 @@
+#include "lv_arena.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Blocks are addressed by their offset from the base, which keeps the links 4 bytes wide on a 64-bit host too. Headers
+// sit 4 bytes before an 8-byte boundary so that the data after them is aligned. A free block has the offsets of its
+// neighbours in the list after its header and its size again in its last word, so that the block after it can find
+// its start. Offset 0 is never a block and ends the lists.
+enum {
+    kHeaderSize = 4,                            // [bytes]
+    kFlagUsed   = 1 << 0,
+    kFlagPrevFree = 1 << 1,                     // The block before this one is in the free list
+    kFlagMask   = kLvArenaConsts_Align - 1,
+    kFirst      = kHeaderSize,
+};
+
+static struct {
+    uint8_t *pBase;
+    uint32_t End;                               // Offset of the used, empty block that stops merges at the end
+    uint32_t FreeHead;
+    uint32_t Pools[kLvArenaConsts_NumPools];
+    uint32_t MaxPooled;                         // [bytes] Across all pools
+    bool UsePools;
+} Arena;
+
+static LvArena_Stats_t Stats;
+
+static uint32_t* Word(const uint32_t Offset);
+static uint32_t SizeOf(const uint32_t Block);
+static void SetFree(const uint32_t Block, const uint32_t Size);
+static void Link(const uint32_t Block, const uint32_t Prev, const uint32_t Next);
+static void Unlink(const uint32_t Block);
+static void Insert(const uint32_t Block);
+static uint32_t TakeFree(const uint32_t Size);
+static void Release(uint32_t Block);
+static void FlushPools(void);
+static uint32_t BlockSize(const size_t Size);
+static uint32_t ToBlock(const void *const pData);
+static void UpdatePeak(void);
+
+// The whole region becomes one free block between the first aligned header and the end marker
+bool LvArena_Init(void *const pMem, const size_t Size, const bool UsePools)
+{
+    const uintptr_t Start = (uintptr_t)pMem;
+    const uintptr_t Base = (Start + kLvArenaConsts_Align - 1) & ~(uintptr_t)kFlagMask;
+    const size_t Available = ((pMem != NULL) && (Size > Base - Start)) ? (Size - (Base - Start)) : 0;
+    if ((Available < kFirst + kLvArenaConsts_MinBlock + kHeaderSize) || (Available > UINT32_MAX))
+    {
+        return false;
+    }
+
+    memset(&Arena, 0x0, sizeof(Arena));
+    memset(&Stats, 0x0, sizeof(Stats));
+    Arena.pBase = (uint8_t*)Base;
+    Arena.End = (uint32_t)((Available - 2 * kHeaderSize) & ~(size_t)kFlagMask) + kHeaderSize;
+    Arena.UsePools = UsePools;
+
+    Stats.Size = Arena.End - kFirst;
+    Arena.MaxPooled = Stats.Size / kLvArenaConsts_PoolShare;
+
+    *Word(Arena.End) = kFlagUsed;
+    SetFree(kFirst, Stats.Size);
+    Link(kFirst, 0, 0);
+    Arena.FreeHead = kFirst;
+    return true;
+}
+
+void* LvArena_Alloc(size_t Size)
+{
+    const uint32_t Need = BlockSize(Size);
+    if ((Arena.pBase == NULL) || (Need == 0))
+    {
+        Stats.NumFailed++;
+        return NULL;
+    }
+
+    uint32_t Block = 0;
+    const size_t Pool = (Need - kLvArenaConsts_MinBlock) / kLvArenaConsts_Align;
+    if (Arena.UsePools && (Need <= kLvArenaConsts_MaxPooled) && (Arena.Pools[Pool] != 0))
+    {
+        Block = Arena.Pools[Pool];
+        Arena.Pools[Pool] = *Word(Block + kHeaderSize);
+        Stats.Pooled -= Need;
+        Stats.PoolBlocks[Pool]--;
+        Stats.NumPoolHits++;
+    }
+    else
+    {
+        Block = TakeFree(Need);
+        if ((Block == 0) && (Stats.Pooled > 0))
+        {
+            // What the pools hold may merge into a block that fits
+            FlushPools();
+            Block = TakeFree(Need);
+        }
+    }
+
+    if (Block == 0)
+    {
+        Stats.NumFailed++;
+        return NULL;
+    }
+
+    Stats.Used += SizeOf(Block);
+    Stats.NumLive++;
+    Stats.NumAllocs++;
+    UpdatePeak();
+    return Word(Block + kHeaderSize);
+}
+
+void LvArena_Free(void *pData)
+{
+    const uint32_t Block = ToBlock(pData);
+    if (Block == 0)
+    {
+        return;
+    }
+
+    const uint32_t Size = SizeOf(Block);
+    Stats.Used -= Size;
+    Stats.NumLive--;
+    Stats.NumFrees++;
+
+    // Pooled blocks stay marked as used, so that nothing merges with them
+    if (Arena.UsePools && (Size <= kLvArenaConsts_MaxPooled) && (Stats.Pooled + Size <= Arena.MaxPooled))
+    {
+        const size_t Pool = (Size - kLvArenaConsts_MinBlock) / kLvArenaConsts_Align;
+        *Word(Block + kHeaderSize) = Arena.Pools[Pool];
+        Arena.Pools[Pool] = Block;
+        Stats.Pooled += Size;
+        Stats.PoolBlocks[Pool]++;
+        return;
+    }
+
+    Release(Block);
+}
+
+// Grows into the next block when it is free, and shrinks in place
+void* LvArena_Realloc(void *pData, size_t Size)
+{
+    Stats.NumReallocs++;
+
+    const uint32_t Block = ToBlock(pData);
+    if (Block == 0)
+    {
+        return LvArena_Alloc(Size);
+    }
+
+    if (Size == 0)
+    {
+        LvArena_Free(pData);
+        return NULL;
+    }
+
+    const uint32_t Need = BlockSize(Size);
+    const uint32_t Current = SizeOf(Block);
+    const uint32_t Next = Block + Current;
+    const uint32_t NextSize = ((*Word(Next) & kFlagUsed) == 0) ? SizeOf(Next) : 0;
+    if ((Need != 0) && (Need <= Current + NextSize))
+    {
+        uint32_t Total = Current;
+        if (Need > Current)
+        {
+            Unlink(Next);
+            Total += NextSize;
+            *Word(Block + Total) &= ~(uint32_t)kFlagPrevFree;
+        }
+
+        // Whatever is left over goes back to the free list, merged with what follows
+        if (Total - Need >= kLvArenaConsts_MinBlock)
+        {
+            *Word(Block + Need) = (Total - Need) | kFlagUsed;
+            Total = Need;
+            Release(Block + Need);
+        }
+
+        *Word(Block) = Total | (*Word(Block) & kFlagMask);
+        Stats.Used = Stats.Used - Current + Total;
+        UpdatePeak();
+        return pData;
+    }
+
+    void *const pNew = LvArena_Alloc(Size);
+    if (pNew != NULL)
+    {
+        memcpy(pNew, pData, Current - kHeaderSize);
+        LvArena_Free(pData);
+    }
+
+    return pNew;
+}
+
+const LvArena_Stats_t* LvArena_GetStats(void)
+{
+    return &Stats;
+}
+
+// Walks the free list, so not for every allocation
+void LvArena_GetFrag(LvArena_Frag_t *const pFrag)
+{
+    memset(pFrag, 0x0, sizeof(*pFrag));
+    for (uint32_t Block = Arena.FreeHead; Block != 0; Block = *Word(Block + kHeaderSize))
+    {
+        const uint32_t Size = SizeOf(Block);
+        pFrag->FreeBytes += Size;
+        pFrag->FreeBiggest = (Size > pFrag->FreeBiggest) ? Size : pFrag->FreeBiggest;
+        pFrag->NumFreeBlocks++;
+    }
+
+    pFrag->Frag_pct = (pFrag->FreeBytes > 0) ? (uint8_t)(100 - ((uint64_t)pFrag->FreeBiggest * 100) / pFrag->FreeBytes) : 0;
+}
+
+// Counters and the peak start over, what is live and pooled stays
+void LvArena_ResetStats(void)
+{
+    Stats.NumAllocs = 0;
+    Stats.NumFrees = 0;
+    Stats.NumReallocs = 0;
+    Stats.NumPoolHits = 0;
+    Stats.NumFlushes = 0;
+    Stats.NumFailed = 0;
+    Stats.Peak = Stats.Used + Stats.Pooled;
+}
+
+static uint32_t* Word(const uint32_t Offset)
+{
+    return (uint32_t*)(void*)&Arena.pBase[Offset];
+}
+
+static uint32_t SizeOf(const uint32_t Block)
+{
+    return *Word(Block) & ~(uint32_t)kFlagMask;
+}
+
+// A free block never follows another, they would have been merged
+static void SetFree(const uint32_t Block, const uint32_t Size)
+{
+    *Word(Block) = Size;
+    *Word(Block + Size - kHeaderSize) = Size;
+    *Word(Block + Size) |= kFlagPrevFree;
+}
+
+static void Link(const uint32_t Block, const uint32_t Prev, const uint32_t Next)
+{
+    *Word(Block + kHeaderSize) = Next;
+    *Word(Block + 2 * kHeaderSize) = Prev;
+    if (Prev != 0)
+    {
+        *Word(Prev + kHeaderSize) = Block;
+    }
+    else
+    {
+        Arena.FreeHead = Block;
+    }
+
+    if (Next != 0)
+    {
+        *Word(Next + 2 * kHeaderSize) = Block;
+    }
+}
+
+static void Unlink(const uint32_t Block)
+{
+    const uint32_t Next = *Word(Block + kHeaderSize);
+    const uint32_t Prev = *Word(Block + 2 * kHeaderSize);
+    if (Prev != 0)
+    {
+        *Word(Prev + kHeaderSize) = Next;
+    }
+    else
+    {
+        Arena.FreeHead = Next;
+    }
+
+    if (Next != 0)
+    {
+        *Word(Next + 2 * kHeaderSize) = Prev;
+    }
+}
+
+// The list is kept in address order, which is what makes first fit pack the low end of the arena
+static void Insert(const uint32_t Block)
+{
+    uint32_t Prev = 0;
+    uint32_t Next = Arena.FreeHead;
+    while ((Next != 0) && (Next < Block))
+    {
+        Prev = Next;
+        Next = *Word(Next + kHeaderSize);
+    }
+
+    Link(Block, Prev, Next);
+}
+
+// First fit, splitting off what is left of the block in its place in the list
+static uint32_t TakeFree(const uint32_t Size)
+{
+    uint32_t Block = Arena.FreeHead;
+    while ((Block != 0) && (SizeOf(Block) < Size))
+    {
+        Block = *Word(Block + kHeaderSize);
+    }
+
+    if (Block == 0)
+    {
+        return 0;
+    }
+
+    const uint32_t Have = SizeOf(Block);
+    if (Have - Size < kLvArenaConsts_MinBlock)
+    {
+        Unlink(Block);
+        *Word(Block) = Have | kFlagUsed;
+        *Word(Block + Have) &= ~(uint32_t)kFlagPrevFree;
+        return Block;
+    }
+
+    const uint32_t Next = *Word(Block + kHeaderSize);
+    const uint32_t Prev = *Word(Block + 2 * kHeaderSize);
+    SetFree(Block + Size, Have - Size);
+    Link(Block + Size, Prev, Next);
+    *Word(Block) = Size | kFlagUsed;
+    return Block;
+}
+
+// Back into the free list, merged with a free block on either side
+static void Release(uint32_t Block)
+{
+    uint32_t Size = SizeOf(Block);
+    const uint32_t Next = Block + Size;
+    const bool IsNextFree = ((*Word(Next) & kFlagUsed) == 0);
+    const uint32_t NextLinks[2] = {
+        IsNextFree ? *Word(Next + kHeaderSize) : 0,
+        IsNextFree ? *Word(Next + 2 * kHeaderSize) : 0,
+    };
+    Size += IsNextFree ? SizeOf(Next) : 0;
+
+    if ((*Word(Block) & kFlagPrevFree) != 0)
+    {
+        // The block before keeps its place in the list, the next one's is given up
+        const uint32_t Prev = Block - *Word(Block - kHeaderSize);
+        if (IsNextFree)
+        {
+            Unlink(Next);
+        }
+
+        SetFree(Prev, SizeOf(Prev) + Size);
+    }
+    else if (IsNextFree)
+    {
+        SetFree(Block, Size);
+        Link(Block, NextLinks[1], NextLinks[0]);
+    }
+    else
+    {
+        SetFree(Block, Size);
+        Insert(Block);
+    }
+}
+
+static void FlushPools(void)
+{
+    for (size_t i = 0; i < kLvArenaConsts_NumPools; i++)
+    {
+        while (Arena.Pools[i] != 0)
+        {
+            const uint32_t Block = Arena.Pools[i];
+            Arena.Pools[i] = *Word(Block + kHeaderSize);
+            Release(Block);
+        }
+
+        Stats.PoolBlocks[i] = 0;
+    }
+
+    Stats.Pooled = 0;
+    Stats.NumFlushes++;
+}
+
+// 0 if it can never fit
+static uint32_t BlockSize(const size_t Size)
+{
+    if (Size > UINT32_MAX / 2)
+    {
+        return 0;
+    }
+
+    const uint32_t Block = ((uint32_t)Size + kHeaderSize + kFlagMask) & ~(uint32_t)kFlagMask;
+    return (Block < kLvArenaConsts_MinBlock) ? kLvArenaConsts_MinBlock : Block;
+}
+
+// 0 for anything that isn't a block handed out by this arena
+static uint32_t ToBlock(const void *const pData)
+{
+    const uintptr_t Address = (uintptr_t)pData;
+    const uintptr_t Base = (uintptr_t)Arena.pBase;
+    if ((pData == NULL) || (Address < Base + kFirst + kHeaderSize) || (Address >= Base + Arena.End) ||
+        (((Address - Base) & kFlagMask) != 0))
+    {
+        return 0;
+    }
+
+    return (uint32_t)(Address - Base) - kHeaderSize;
+}
+
+static void UpdatePeak(void)
+{
+    const uint32_t Taken = Stats.Used + Stats.Pooled;
+    Stats.Peak = (Taken > Stats.Peak) ? Taken : Stats.Peak;
+}
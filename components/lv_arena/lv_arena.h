@@ -0,0 +1,54 @@
+#pragma once
+
+// LVGL's heap, in an arena of its own. Every block carries a 4-byte header with its size and lies on an 8-byte
+// boundary. Blocks come from an address ordered first fit list whose neighbours are merged on free. With pools, blocks
+// up to kLvArenaConsts_MaxPooled bytes are freed into a pool for their exact size and handed out again from there
+// instead. Pools hold at most 1/kLvArenaConsts_PoolShare of the arena, and are emptied back into the list before an
+// allocation is allowed to fail. tools/arena_replay compares the two.
+//
+// Not thread safe, LVGL only runs on the render task. Built into LVGL through LV_MEM_CUSTOM, see CMakeLists.txt.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host harness.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kLvArenaConsts_Align     = 8,               // [bytes]
+    kLvArenaConsts_MinBlock  = 16,              // [bytes] Header included
+    kLvArenaConsts_MaxPooled = 136,             // [bytes] Largest block kept in a pool, a 132-byte request
+    kLvArenaConsts_NumPools  = (kLvArenaConsts_MaxPooled - kLvArenaConsts_MinBlock) / kLvArenaConsts_Align + 1,
+    kLvArenaConsts_PoolShare = 128,             // Pools hold up to 1/128 of the arena
+} LvArenaConsts_t;
+
+typedef struct LvArena_Stats {
+    uint32_t Size;                              // [bytes] Usable, after alignment
+    uint32_t Used;                              // [bytes] Live blocks, headers included
+    uint32_t Pooled;                            // [bytes] Free blocks held in the pools
+    uint32_t Peak;                              // [bytes] Most ever taken out of the free list, by Used and Pooled
+    uint32_t NumLive;
+    uint32_t NumAllocs;
+    uint32_t NumFrees;
+    uint32_t NumReallocs;
+    uint32_t NumPoolHits;                       // Allocations served from a pool
+    uint32_t NumFlushes;                        // Times the pools were emptied to make room
+    uint32_t NumFailed;
+    uint16_t PoolBlocks[kLvArenaConsts_NumPools];   // Free blocks of 16, 24, ... bytes held
+} LvArena_Stats_t;
+
+// The free list, walked on demand
+typedef struct LvArena_Frag {
+    uint32_t FreeBytes;                         // [bytes] Outside the pools
+    uint32_t FreeBiggest;                       // [bytes] Largest block, which bounds the next allocation
+    uint32_t NumFreeBlocks;
+    uint8_t Frag_pct;                           // How much of the free space isn't in the largest block, as LVGL measures it
+} LvArena_Frag_t;
+
+bool LvArena_Init(void *const pMem, const size_t Size, const bool UsePools);
+void* LvArena_Alloc(size_t Size);
+void LvArena_Free(void *pData);
+void* LvArena_Realloc(void *pData, size_t Size);
+const LvArena_Stats_t* LvArena_GetStats(void);
+void LvArena_GetFrag(LvArena_Frag_t *const pFrag);
+void LvArena_ResetStats(void);
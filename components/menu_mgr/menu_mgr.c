@@ -12,6 +12,7 @@ typedef struct MenuMgrCtx
 {
     TabID_t eCurTab;
     MenuTab_t* pMenus[kNumTabIDs];
+    OSD_Widget_t* pWidget;
 } MenuMgrCtx_t;
 
 const lv_point_t _MenuOrigin_px = {
@@ -26,6 +27,7 @@ static OSD_Result_t MenuMgr_Draw(void* arg);
 static OSD_Result_t MenuMgr_OnTransition(void *arg);
 static void MenuMgr_NextTab(void);
 static void MenuMgr_PrevTab(void);
+static void ChangeTab(const TabID_t eNewID);
 
 OSD_Result_t MenuMgr_Initialize(OSD_Widget_t* const pWidget, lv_obj_t *const pScreen)
 {
@@ -44,6 +46,7 @@ OSD_Result_t MenuMgr_Initialize(OSD_Widget_t* const pWidget, lv_obj_t *const pSc
     pWidget->fnOnTransition = MenuMgr_OnTransition;
 
     _Ctx.eCurTab = kTabID_First;
+    _Ctx.pWidget = pWidget;
 
     return kOSD_Result_Ok;
 }
@@ -66,10 +69,65 @@ OSD_Result_t MenuMgr_AddTab(TabID_t eID, MenuTab_t *const pTab)
     }
 
     _Ctx.pMenus[eID] = pTab;
+    pTab->Widget.pParent = _Ctx.pWidget;
+    Tab_SetOwner(pTab->Menu, &pTab->Widget);
 
     return kOSD_Result_Ok;
 }
 
+// Retained mode only. Walks every item of every tab once so that all objects exist before the OSD is first shown,
+// after which navigation only hides and shows them. Ends on the first item of the first tab, as it started.
+OSD_Result_t MenuMgr_CreateAll(lv_obj_t *const pScreen)
+{
+    if ((pScreen == NULL) || (_Ctx.pWidget == NULL))
+    {
+        return kOSD_Result_Err_NullDataPtr;
+    }
+
+    if (!OSD_IsRetainedMode())
+    {
+        return kOSD_Result_Ok;
+    }
+
+    for (size_t t = 0; t < kNumTabIDs; t++)
+    {
+        MenuTab_t *const pTab = _Ctx.pMenus[_Ctx.eCurTab];
+        const size_t NumItems = ((pTab != NULL) && (pTab->Menu != NULL)) ? sys_dlist_len(&pTab->Menu->WidgetList) : 0;
+
+        for (size_t i = 0; i < NumItems; i++)
+        {
+            (void) OSD_Widget_Draw(_Ctx.pWidget, pScreen);
+            Tab_Next(pTab->Menu);
+        }
+
+        (void) OSD_Widget_Draw(_Ctx.pWidget, pScreen);
+        MenuMgr_NextTab();
+    }
+
+    return kOSD_Result_Ok;
+}
+
+// Render task only, for when something other than the buttons has to show a given tab
+OSD_Result_t MenuMgr_SelectTab(const TabID_t eID)
+{
+    if ((unsigned)eID >= kNumTabIDs)
+    {
+        return kOSD_Result_Err_InvalidTabID;
+    }
+
+    if (eID != _Ctx.eCurTab)
+    {
+        ChangeTab(eID);
+    }
+
+    return kOSD_Result_Ok;
+}
+
+TabID_t MenuMgr_GetTab(void)
+{
+    return _Ctx.eCurTab;
+}
+
 static OSD_Result_t MenuMgr_Draw(void* arg)
 {
     if (arg == NULL)
@@ -92,18 +150,21 @@ static OSD_Result_t MenuMgr_Draw(void* arg)
         return kOSD_Result_Err_NullDataPtr;
     }
 
+    lv_obj_t *const pTabScreen = OSD_Widget_Show(&pTab->Widget, pScreen);
+
+    // Setting the source invalidates the image even when unchanged, so only do so when it is created
     if (pTab->pImgObj == NULL)
     {
-        pTab->pImgObj = lv_img_create(pScreen);
+        pTab->pImgObj = lv_img_create(pTabScreen);
         lv_obj_align(pTab->pImgObj , LV_ALIGN_TOP_LEFT, _MenuOrigin_px.x, _MenuOrigin_px.y);
+        lv_img_set_src(pTab->pImgObj, pTab->pImageDesc);
     }
 
-    lv_img_set_src(pTab->pImgObj, pTab->pImageDesc);
-
-    if (pTab->Widget.fnDraw != NULL)
+    Tab_DrawCtx_t Ctx = { pTab->Menu, pTabScreen, pTab->Accent };
+    const OSD_Result_t eResult = OSD_Widget_Draw(&pTab->Widget, &Ctx);
+    if (eResult != kOSD_Result_Ok)
     {
-        Tab_DrawCtx_t Ctx = { pTab->Menu, pScreen, pTab->Accent };
-        pTab->Widget.fnDraw(&Ctx);
+        ESP_LOGD(TAG, "Error %d during %s draw", eResult, pTab->Widget.Name);
     }
 
     return kOSD_Result_Ok;
@@ -171,10 +232,7 @@ static void MenuMgr_NextTab(void)
         eNextID = kTabID_First;
     }
 
-    // Clean up the old tab data
-    MenuMgr_OnTransition(NULL);
-
-    _Ctx.eCurTab = eNextID;
+    ChangeTab(eNextID);
 }
 
 static void MenuMgr_PrevTab(void)
@@ -185,10 +243,34 @@ static void MenuMgr_PrevTab(void)
         ePrevID = kTabID_Last;
     }
 
-    // Clean up the old tab data
-    MenuMgr_OnTransition(NULL);
+    ChangeTab(ePrevID);
+}
+
+static void ChangeTab(const TabID_t eNewID)
+{
+    if (OSD_IsRetainedMode())
+    {
+        MenuTab_t *const pOldTab = _Ctx.pMenus[_Ctx.eCurTab];
+        if (pOldTab != NULL)
+        {
+            OSD_Widget_Hide(&pOldTab->Widget);
+        }
 
-    _Ctx.eCurTab = ePrevID;
+        _Ctx.eCurTab = eNewID;
+
+        // Only the tab's container has to be shown, anything that changed while hidden is still marked dirty
+        OSD_Widget_MarkDirty(_Ctx.pWidget);
+    }
+    else
+    {
+        // Clean up the old tab data
+        MenuMgr_OnTransition(NULL);
+
+        _Ctx.eCurTab = eNewID;
+
+        // The old tab deleted its objects, everything on the new one is drawn from scratch
+        OSD_InvalidateAll();
+    }
 }
 
 static OSD_Result_t MenuMgr_OnTransition(void *arg)
@@ -27,7 +27,7 @@ typedef struct MenuTab {
     lv_obj_t* pImgObj;
 
     // A pointer to the image descriptor typically generated by the image converter tool.
-    lv_img_dsc_t const *const pImageDesc;
+    lv_img_dsc_t const *pImageDesc;
 
     // A pointer to a the contents of the menu.
     union {
@@ -38,3 +38,6 @@ typedef struct MenuTab {
 
 OSD_Result_t MenuMgr_Initialize(OSD_Widget_t* const pWidget, lv_obj_t *const pScreen);
 OSD_Result_t MenuMgr_AddTab(TabID_t eID, MenuTab_t *const pTab);
+OSD_Result_t MenuMgr_CreateAll(lv_obj_t *const pScreen);
+OSD_Result_t MenuMgr_SelectTab(const TabID_t eID);
+TabID_t MenuMgr_GetTab(void);
@@ -2,6 +2,7 @@
 
 #include "esp_log.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "settings.h"
@@ -54,7 +55,7 @@ OSD_Result_t FrameBlend_Draw(void* arg)
         {
             _Ctx.pImgToggleOffObj = lv_img_create(pScreen);
             lv_obj_align(_Ctx.pImgToggleOffObj, LV_ALIGN_TOP_LEFT, kToggleBtnX_px, kToggleBtnY_px);
-            lv_img_set_src(_Ctx.pImgToggleOffObj, &img_toggle_off);
+            lv_img_set_src(_Ctx.pImgToggleOffObj, ASSET_IMG(img_toggle_off));
 
             // In the Off state, the text should be displayed in the area where On normally is
             lv_obj_set_pos(_Ctx.pMsgStateObj, kMsgStateOff_px, kMsgStateY_px);
@@ -67,7 +68,7 @@ OSD_Result_t FrameBlend_Draw(void* arg)
         {
             _Ctx.pImgToggleOnObj = lv_img_create(pScreen);
             lv_obj_align(_Ctx.pImgToggleOnObj, LV_ALIGN_TOP_LEFT, kToggleBtnX_px, kToggleBtnY_px);
-            lv_img_set_src(_Ctx.pImgToggleOnObj, &img_toggle_on);
+            lv_img_set_src(_Ctx.pImgToggleOnObj, ASSET_IMG(img_toggle_on));
 
             // In the On state, the text should be displayed in the area where Off normally is
             lv_obj_set_pos(_Ctx.pMsgStateObj, kMsgStateOnX_px, kMsgStateY_px);
@@ -2,6 +2,7 @@
 
 #include "esp_log.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "settings.h"
@@ -57,13 +58,13 @@ OSD_Result_t LowBattIconCtl_Draw(void* arg)
             _Ctx.pImgOptionObjs[i] = lv_img_create(pScreen);
 
             lv_obj_align(_Ctx.pImgOptionObjs[i], LV_ALIGN_TOP_LEFT, OptionPos[i].x, OptionPos[i].y);
-            lv_img_set_src(_Ctx.pImgOptionObjs[i], &img_option_dis);
+            lv_img_set_src(_Ctx.pImgOptionObjs[i], ASSET_IMG(img_option_dis));
         }
     }
 
     if ((unsigned) _Ctx.eCurrentState < kNumLowBattIconCtlState)
     {
-        lv_img_set_src(_Ctx.pImgOptionObjs[_Ctx.eCurrentState], &img_option_en);
+        lv_img_set_src(_Ctx.pImgOptionObjs[_Ctx.eCurrentState], ASSET_IMG(img_option_en));
     }
 
     for (uint32_t i = 0; i < kNumLowBattIconCtlState; i++)
@@ -74,7 +75,11 @@ OSD_Result_t LowBattIconCtl_Draw(void* arg)
             lv_obj_align(_Ctx.pOptionTextObj[i], LV_ALIGN_CENTER, 1, 0);
             lv_label_set_long_mode(_Ctx.pOptionTextObj[i], LV_LABEL_LONG_WRAP);
             lv_obj_set_style_text_align(_Ctx.pOptionTextObj[i], LV_TEXT_ALIGN_CENTER, 0);
-            lv_obj_set_width(_Ctx.pOptionTextObj[i], img_option_en.header.w * 0.80);
+            const lv_img_dsc_t *const pOption = ASSET_IMG(img_option_en);
+            if (pOption != NULL)
+            {
+                lv_obj_set_width(_Ctx.pOptionTextObj[i], pOption->header.w * 0.80);
+            }
             lv_obj_add_style(_Ctx.pOptionTextObj[i], OSD_GetStyleTextBlack(), 0);
             lv_label_set_text(_Ctx.pOptionTextObj[i], OptionText[i]);
         }
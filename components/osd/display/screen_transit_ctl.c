@@ -2,6 +2,7 @@
 
 #include "esp_log.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "settings.h"
@@ -47,7 +48,7 @@ OSD_Result_t ScreenTransitCtl_Draw(void* arg)
 
         lv_obj_t* pOff = _Ctx.pImgOptionTopObj;
         lv_obj_align(pOff, LV_ALIGN_TOP_LEFT, kToggleOptX_px, IsDisabled ? kToggleOptBtm_Y_px : kToggleOptTop_Y_px);
-        lv_img_set_src(pOff, &img_option_dis);
+        lv_img_set_src(pOff, ASSET_IMG(img_option_dis));
     }
 
     if (_Ctx.pImgOptionBtmObj == NULL)
@@ -56,7 +57,7 @@ OSD_Result_t ScreenTransitCtl_Draw(void* arg)
 
         lv_obj_t* pOn = _Ctx.pImgOptionBtmObj;
         lv_obj_align(pOn, LV_ALIGN_TOP_LEFT, kToggleOptX_px, IsDisabled ? kToggleOptTop_Y_px : kToggleOptBtm_Y_px);
-        lv_img_set_src(pOn, &img_option_en);
+        lv_img_set_src(pOn, ASSET_IMG(img_option_en));
     }
 
     if (_Ctx.pOptionTopTextObj == NULL)
@@ -65,7 +66,11 @@ OSD_Result_t ScreenTransitCtl_Draw(void* arg)
         lv_obj_align(_Ctx.pOptionTopTextObj, LV_ALIGN_CENTER, 1, 0);
         lv_label_set_long_mode(_Ctx.pOptionTopTextObj, LV_LABEL_LONG_WRAP);
         lv_obj_set_style_text_align(_Ctx.pOptionTopTextObj, LV_TEXT_ALIGN_CENTER, 0);
-        lv_obj_set_width(_Ctx.pOptionTopTextObj, img_option_en.header.w * 0.60);
+        const lv_img_dsc_t *const pOption = ASSET_IMG(img_option_en);
+        if (pOption != NULL)
+        {
+            lv_obj_set_width(_Ctx.pOptionTopTextObj, pOption->header.w * 0.60);
+        }
         lv_obj_add_style(_Ctx.pOptionTopTextObj, OSD_GetStyleTextBlack(), 0);
         lv_label_set_text(_Ctx.pOptionTopTextObj, "CLASSIC");
     }
@@ -76,7 +81,11 @@ OSD_Result_t ScreenTransitCtl_Draw(void* arg)
         lv_obj_align(_Ctx.pOptionBtmTextObj, LV_ALIGN_CENTER, 1, 0);
         lv_label_set_long_mode(_Ctx.pOptionBtmTextObj, LV_LABEL_LONG_WRAP);
         lv_obj_set_style_text_align(_Ctx.pOptionBtmTextObj, LV_TEXT_ALIGN_CENTER, 0);
-        lv_obj_set_width(_Ctx.pOptionBtmTextObj, img_option_en.header.w * 0.80);
+        const lv_img_dsc_t *const pOption = ASSET_IMG(img_option_en);
+        if (pOption != NULL)
+        {
+            lv_obj_set_width(_Ctx.pOptionBtmTextObj, pOption->header.w * 0.80);
+        }
         lv_obj_add_style(_Ctx.pOptionBtmTextObj, OSD_GetStyleTextBlack(), 0);
         lv_label_set_text(_Ctx.pOptionBtmTextObj, "SMOOTH");
     }
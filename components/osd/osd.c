@@ -7,6 +7,13 @@
 
 #include "esp_log.h"
 
+#if defined(ESP_PLATFORM)
+#include "argtable3/argtable3.h"
+#include "esp_console.h"
+#endif
+
+#include <stdio.h>
+
 #include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
@@ -74,20 +81,20 @@ void OSD_Draw(void* arg)
         {
             OSD_Widget_t *const pWidget = (OSD_Widget_t*)pNode;
 
-            if (pWidget->fnDraw != NULL)
+            // Clean widgets are skipped, their LVGL objects still hold what was last drawn
+            OSD_Result_t eResult = OSD_Widget_Draw(pWidget, arg);
+            if (eResult != kOSD_Result_Ok)
             {
-                OSD_Result_t eResult = pWidget->fnDraw(arg);
-                if (eResult != kOSD_Result_Ok)
-                {
-                    ESP_LOGD(TAG, "Error %d during %s draw", eResult, pWidget->Name);
-                }
+                ESP_LOGD(TAG, "Error %d during %s draw", eResult, pWidget->Name);
             }
         }
     }
 }
 
-void OSD_HandleInputs(void)
+// Returns true if any button was pressed
+bool OSD_HandleInputs(void)
 {
+    bool IsHandled = false;
     sys_dnode_t* pNode = NULL;
 
     SYS_DLIST_FOR_EACH_NODE(&OSD.WidgetList, pNode)
@@ -107,6 +114,7 @@ void OSD_HandleInputs(void)
                     //ESP_LOGD(TAG, "%s is %s", Button_GetNameStr(b), Button_GetStateStr(s));
 
                     const OSD_Result_t eResult = pWidget->fnOnButton(b, s, pWidget->pFocusNodeArg);
+                    IsHandled = true;
 
                     if (eResult != kOSD_Result_Ok)
                     {
@@ -116,6 +124,8 @@ void OSD_HandleInputs(void)
             }
         }
     }
+
+    return IsHandled;
 }
 
 bool OSD_IsVisible(void)
@@ -125,5 +135,72 @@ bool OSD_IsVisible(void)
 
 void OSD_SetVisiblityState(const bool IsVisible)
 {
+    const bool WasVisible = OSD.IsVisible;
     OSD.IsVisible = IsVisible;
+
+    // Nothing is rendered while hidden, so catch up as soon as the OSD is shown
+    if (IsVisible && !WasVisible)
+    {
+        OSD_InvalidateAll();
+    }
+}
+
+#if defined(ESP_PLATFORM)
+static struct {
+    struct arg_lit *reset;
+    struct arg_end *end;
+} osd_prof_args;
+
+static int osd_prof_command(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&osd_prof_args);
+    if (nerrors != 0)
+    {
+        arg_print_errors(stderr, osd_prof_args.end, argv[0]);
+        return 1;
+    }
+
+    OSD_Widget_t const* pWidgets[kOSD_MaxProfiledWidgets];
+    const size_t NumWidgets = OSD_GetProfiledWidgets(pWidgets, ARRAY_SIZE(pWidgets));
+
+    printf("%-16s %8s %8s %8s %8s %8s\n", "Widget", "Draws", "Skips", "Last", "Max", "Avg");
+    for (size_t i = 0; i < NumWidgets; i++)
+    {
+        const OSD_WidgetProfile_t *const pProfile = &pWidgets[i]->Profile;
+        const uint32_t Avg_us = (pProfile->NumDraws > 0) ? (uint32_t)(pProfile->TotalDraw_us / pProfile->NumDraws) : 0;
+
+        printf("%-16s %8lu %8lu %8lu %8lu %8lu\n", (pWidgets[i]->Name != NULL) ? pWidgets[i]->Name : "?",
+            pProfile->NumDraws, pProfile->NumSkips, pProfile->LastDraw_us, pProfile->MaxDraw_us, Avg_us);
+    }
+
+    if (osd_prof_args.reset->count > 0)
+    {
+        OSD_ResetWidgetProfiles();
+    }
+
+    return 0;
+}
+
+void OSD_RegisterCommands(void)
+{
+    osd_prof_args.reset = arg_lit0("r", "reset", "Clear the profile after printing");
+    osd_prof_args.end = arg_end(1);
+
+    esp_console_cmd_t command = {
+        .command = "osd_prof",
+        .help = "Shows how often each OSD widget was drawn or skipped and its draw time in us",
+        .func = &osd_prof_command,
+        .argtable = &osd_prof_args,
+    };
+
+    esp_err_t err;
+    if ((err = esp_console_cmd_register(&command)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Registering '%s' command failed: %s", command.command, esp_err_to_name(err));
+    }
+}
+#else
+void OSD_RegisterCommands(void)
+{
 }
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+// The size of the OSD, kept apart from osd.h so that code built against the host can use it without pulling in LVGL
+
+// The pixel number in horizontal and vertical
+#ifndef DISP_W_RES_PX
+#define DISP_W_RES_PX 160u
+#endif
+
+#ifndef DISP_H_RES_PX
+#define DISP_H_RES_PX 144u
+#endif
+
+enum {
+    kOSD_Width_px  = DISP_W_RES_PX,
+    kOSD_Height_px = DISP_H_RES_PX,
+    kOSD_NumPixels = kOSD_Height_px * kOSD_Width_px,
+};
@@ -2,8 +2,11 @@
 
 #include "esp_log.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "tab_shared.h"
 
+#include <string.h>
+
 LV_IMG_DECLARE(img_chromatic_eyebrow);
 
 enum {
@@ -79,6 +82,7 @@ typedef struct PaletteCtl {
     StyleID_t HotKeyStyleID;
     fnOnUpdateCb_t fnOnUpdateCb;
     bool GBCMode;   // True if the current game is a GBC game
+    bool IsTableGBC;    // The mode the table was last drawn for
     bool Initialized;
     bool TableCbAdded;
 } PaletteCtl_t;
@@ -105,14 +109,32 @@ OSD_Result_t Style_Draw(void* arg)
         return kOSD_Result_Err_NullDataPtr;
     }
 
+    // A table that is kept across navigation may have been drawn for the other mode, undo that first
+    if ((CurrID == kPalette_Default) && (_Ctx.IsTableGBC != _Ctx.GBCMode))
+    {
+        lv_obj_clean(pItem->DataObj);
+
+        if (_Ctx.TableCbAdded)
+        {
+            lv_obj_remove_event_cb(pTable, StyleOnEventDrawCb);
+            lv_table_set_row_cnt(pTable, 1);
+            lv_table_set_col_cnt(pTable, 1);
+            lv_table_set_cell_value(pTable, 0, 0, "");
+            _Ctx.TableCbAdded = false;
+        }
+
+        _Ctx.IsTableGBC = _Ctx.GBCMode;
+    }
+
     // When in GBC mode, render eyebrow and text msg
     if (_Ctx.GBCMode)
     {
-        // Style_Draw is called kNumPalette times. When in GBC mode, we only want to draw the eyebrow and text once
-        if (CurrID == kPalette_Default)
+        // Style_Draw is called kNumPalette times. When in GBC mode, we only want to draw the eyebrow and text once,
+        // and only once per item object as the table may be drawn again without it being recreated.
+        if ((CurrID == kPalette_Default) && (lv_obj_get_child_cnt(pItem->DataObj) == 0))
         {
             lv_obj_t* pEyebrow = lv_img_create(pItem->DataObj); 
-            lv_img_set_src(pEyebrow, &img_chromatic_eyebrow);
+            lv_img_set_src(pEyebrow, ASSET_IMG(img_chromatic_eyebrow));
             lv_obj_align(pEyebrow, LV_ALIGN_TOP_LEFT, kGBCImgOffsetX_px, kGBCImgOffsetY_px);
 
             lv_obj_t* pText = lv_label_create(pItem->DataObj);
@@ -136,7 +158,12 @@ OSD_Result_t Style_Draw(void* arg)
             CellText = pItem->Widget.Name;
         }
 
-        lv_table_set_cell_value(pTable, CurrID % kNumRows, CurrID / kNumRows, CellText);
+        // Setting a cell reallocates its text, skip it when a redraw leaves it unchanged
+        const char* pOldText = lv_table_get_cell_value(pTable, CurrID % kNumRows, CurrID / kNumRows);
+        if ((pOldText == NULL) || (strcmp(pOldText, CellText) != 0))
+        {
+            lv_table_set_cell_value(pTable, CurrID % kNumRows, CurrID / kNumRows, CellText);
+        }
 
         // Draw callback only needs to be added to table once
         if (!_Ctx.TableCbAdded)
@@ -278,7 +305,13 @@ void Style_RegisterOnUpdateCb(fnOnUpdateCb_t fnOnUpdate)
 
 void Style_SetGBCMode(const bool GBCMode)
 {
+    const bool IsChanged = (_Ctx.GBCMode != GBCMode);
     _Ctx.GBCMode = GBCMode;
+
+    if (IsChanged)
+    {
+        OSD_InvalidateAll();
+    }
 }
 
 void Style_SetHKPaletteBG(const uint64_t paletteBG)
@@ -286,7 +319,11 @@ void Style_SetHKPaletteBG(const uint64_t paletteBG)
     for (StyleID_t i = 0; i < kNumPalettes; i++) {
         if (PaletteStyleBG[i] == paletteBG)
         {
-            _Ctx.HotKeyStyleID = i;
+            if (_Ctx.HotKeyStyleID != i)
+            {
+                _Ctx.HotKeyStyleID = i;
+                OSD_InvalidateAll();
+            }
             break;
         }
     }
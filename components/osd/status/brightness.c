@@ -3,6 +3,7 @@
 #include "line.h"
 #include "osd_shared.h"
 #include "esp_log.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "settings.h"
@@ -87,7 +88,7 @@ OSD_Result_t Brightness_Draw(void* arg)
     }
 
     // Draw the brightness image indicating no brightness
-    lv_img_set_src(_Ctx.pBrightImgObj, &img_brightness);
+    lv_img_set_src(_Ctx.pBrightImgObj, ASSET_IMG(img_brightness));
 
     static uint8_t PrevBrightness = 0;
     const bool RecalculateBars = (_Ctx.BrightnessLevel != PrevBrightness);
@@ -346,8 +347,15 @@ void Brightness_RegisterOnUpdateCb(fnOnUpdateCb_t fnOnUpdate)
 
 void Brightness_SetLowPowerOverride(const bool Enable)
 {
+    const bool IsChanged = (_Ctx.LowPowerOverride != Enable);
     _Ctx.LowPowerOverride = Enable;
 
+    // Reported by the FPGA rather than the menus, so nothing else marks the widget dirty
+    if (IsChanged)
+    {
+        OSD_InvalidateAll();
+    }
+
     if (_Ctx.fnOnUpdateCb != NULL)
     {
         _Ctx.fnOnUpdateCb();
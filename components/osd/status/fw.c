@@ -1,6 +1,7 @@
 #include "fw.h"
 
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "esp_log.h"
 
@@ -65,12 +66,15 @@ typedef struct Firmware {
     uint8_t FPGAVersionMajor;       // 0 means unknown or not supported by the connected FPGA
     uint8_t FPGAVersionMinor;       // 0 means unknown or not supported by the connected FPGA
     uint8_t FPGA_IsDebugBuild;      // 0 means unknown or not supported by the connected FPGA
+    bool IsFPGAVerChanged;
     bool ShowDetails;
 } Firmware_t;
 
 static Firmware_t _Ctx;
 static const char* TAG = "fw";
 
+static void FormatFPGAVersion(void);
+
 #if defined(ESP_PLATFORM)
 static int version_command(int argc, char **argv);
 static OSD_Result_t register_version_dump(void);
@@ -104,7 +108,7 @@ OSD_Result_t Firmware_Draw(void* arg)
     if (_Ctx.pChromaticImgObj == NULL)
     {
         _Ctx.pChromaticImgObj = lv_img_create(pScreen);
-        lv_img_set_src(_Ctx.pChromaticImgObj, &img_chromatic);
+        lv_img_set_src(_Ctx.pChromaticImgObj, ASSET_IMG(img_chromatic));
         lv_obj_align(_Ctx.pChromaticImgObj, LV_ALIGN_BOTTOM_RIGHT, ChromaticOrigin.x, ChromaticOrigin.y);
     }
 
@@ -140,17 +144,19 @@ OSD_Result_t Firmware_Draw(void* arg)
         // FPGA Version
         if (_Ctx.pFPGAInfo == NULL) 
         {
-            lv_snprintf(
-                _Ctx.FPGAVerStr, sizeof(_Ctx.FPGAVerStr),
-                "v%u.%u%s",
-                _Ctx.FPGAVersionMajor,
-                _Ctx.FPGAVersionMinor,
-                _Ctx.FPGA_IsDebugBuild ? " (dbg)" : " "
-            );
+            FormatFPGAVersion();
             _Ctx.pFPGAInfo = lv_label_create(_Ctx.pDetailsObj);
             lv_label_set_text(_Ctx.pFPGAInfo, (const char*)_Ctx.FPGAVerStr);
             lv_obj_align(_Ctx.pFPGAInfo, LV_ALIGN_TOP_LEFT, FPGAVerOrigin.x, FPGAVerOrigin.y);
             lv_obj_add_style(_Ctx.pFPGAInfo, OSD_GetStyleTextWhite(), LV_PART_MAIN);
+            _Ctx.IsFPGAVerChanged = false;
+        }
+        else if (_Ctx.IsFPGAVerChanged)
+        {
+            // Retained labels may predate the FPGA reporting its version
+            FormatFPGAVersion();
+            lv_label_set_text(_Ctx.pFPGAInfo, (const char*)_Ctx.FPGAVerStr);
+            _Ctx.IsFPGAVerChanged = false;
         }
     }
     else 
@@ -238,9 +244,30 @@ OSD_Result_t Firmware_OnButton(const Button_t Button, const ButtonState_t State,
 
 void Firmware_SetFPGAVersion(uint8_t VersionMajor, uint8_t VersionMinor, uint8_t IsDebug)
 {
+    const bool IsChanged = (_Ctx.FPGAVersionMajor != VersionMajor) || (_Ctx.FPGAVersionMinor != VersionMinor) ||
+                           (_Ctx.FPGA_IsDebugBuild != IsDebug);
+
     _Ctx.FPGAVersionMajor = VersionMajor;
     _Ctx.FPGAVersionMinor = VersionMinor;
     _Ctx.FPGA_IsDebugBuild = IsDebug;
+
+    // Only flagged here, the label is updated on the render task
+    if (IsChanged)
+    {
+        _Ctx.IsFPGAVerChanged = true;
+        OSD_InvalidateAll();
+    }
+}
+
+static void FormatFPGAVersion(void)
+{
+    lv_snprintf(
+        _Ctx.FPGAVerStr, sizeof(_Ctx.FPGAVerStr),
+        "v%u.%u%s",
+        _Ctx.FPGAVersionMajor,
+        _Ctx.FPGAVersionMinor,
+        _Ctx.FPGA_IsDebugBuild ? " (dbg)" : " "
+    );
 }
 
 OSD_Result_t Firmware_Initialize(void)
@@ -2,6 +2,7 @@
 
 #include "esp_log.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "settings.h"
@@ -60,14 +61,14 @@ OSD_Result_t PlayerNum_Draw(void* arg)
     {
         _Ctx.pImgBLeftObj = lv_img_create(pScreen);
         lv_obj_align(_Ctx.pImgBLeftObj, LV_ALIGN_TOP_LEFT, kImgBLeftStateX_px, kImgBLeftStateY_px);
-        lv_img_set_src(_Ctx.pImgBLeftObj, &img_b_left);
+        lv_img_set_src(_Ctx.pImgBLeftObj, ASSET_IMG(img_b_left));
     }
 
     if (_Ctx.pImgARightObj == NULL)
     {
         _Ctx.pImgARightObj = lv_img_create(pScreen);
         lv_obj_align(_Ctx.pImgARightObj, LV_ALIGN_TOP_LEFT, kImgARightStateX_px, kImgARightStateY_px);
-        lv_img_set_src(_Ctx.pImgARightObj, &img_a_right);
+        lv_img_set_src(_Ctx.pImgARightObj, ASSET_IMG(img_a_right));
     }
 
     lv_label_set_text_fmt(_Ctx.pMsgStateObj, "%u", _Ctx.Number);
@@ -2,6 +2,7 @@
 
 #include "esp_log.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 
@@ -53,7 +54,7 @@ OSD_Result_t SilentMode_Draw(void* arg)
         {
             _Ctx.pImgToggleOffObj = lv_img_create(pScreen);
             lv_obj_align(_Ctx.pImgToggleOffObj, LV_ALIGN_TOP_LEFT, kToggleBtnX_px, kToggleBtnY_px);
-            lv_img_set_src(_Ctx.pImgToggleOffObj, &img_toggle_off);
+            lv_img_set_src(_Ctx.pImgToggleOffObj, ASSET_IMG(img_toggle_off));
 
             lv_obj_set_pos(_Ctx.pMsgStateObj, kMsgStateOff_px, kMsgStateY_px);
             lv_label_set_text_static(_Ctx.pMsgStateObj, "OFF");
@@ -65,7 +66,7 @@ OSD_Result_t SilentMode_Draw(void* arg)
         {
             _Ctx.pImgToggleOnObj = lv_img_create(pScreen);
             lv_obj_align(_Ctx.pImgToggleOnObj, LV_ALIGN_TOP_LEFT, kToggleBtnX_px, kToggleBtnY_px);
-            lv_img_set_src(_Ctx.pImgToggleOnObj, &img_toggle_on);
+            lv_img_set_src(_Ctx.pImgToggleOnObj, ASSET_IMG(img_toggle_on));
 
             lv_obj_set_pos(_Ctx.pMsgStateObj, kMsgStateOnX_px, kMsgStateY_px);
             lv_label_set_text_static(_Ctx.pMsgStateObj, "ON");
@@ -3,10 +3,13 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "osd_shared.h"
+#include "asset_store.h"
 #include "lvgl.h"
 #include "mutex.h"
 #include "settings.h"
 
+#include <string.h>
+
 LV_IMG_DECLARE(img_toggle_on);
 LV_IMG_DECLARE(img_toggle_off);
 
@@ -60,11 +63,16 @@ OSD_Result_t WiFiFileServer_Draw(void* arg)
     {
         _Ctx.pInfoTextObj = lv_label_create(pScreen);
         lv_obj_add_style(_Ctx.pInfoTextObj, OSD_GetStyleTextWhite(), 0);
-        const char *ip = wifi_file_server_get_ip();
-        lv_label_set_text(_Ctx.pInfoTextObj, ip);
         lv_obj_set_style_text_align(_Ctx.pInfoTextObj, LV_TEXT_ALIGN_CENTER, 0);
     }
 
+    // Retained labels may predate the access point coming up
+    const char *ip = wifi_file_server_get_ip();
+    if (strcmp(lv_label_get_text(_Ctx.pInfoTextObj), ip) != 0)
+    {
+        lv_label_set_text(_Ctx.pInfoTextObj, ip);
+    }
+
     // Create toggle button images
     if (_Ctx.bEnabled)
     {
@@ -72,7 +80,7 @@ OSD_Result_t WiFiFileServer_Draw(void* arg)
         {
             _Ctx.pImgToggleOnObj = lv_img_create(pScreen);
             lv_obj_align(_Ctx.pImgToggleOnObj, LV_ALIGN_TOP_LEFT, kToggleBtnX_px, kToggleBtnY_px);
-            lv_img_set_src(_Ctx.pImgToggleOnObj, &img_toggle_on);
+            lv_img_set_src(_Ctx.pImgToggleOnObj, ASSET_IMG(img_toggle_on));
 
             lv_obj_set_pos(_Ctx.pMsgStateObj, kMsgStateOnX_px, kMsgStateY_px);
             lv_label_set_text_static(_Ctx.pMsgStateObj, "ON");
@@ -87,7 +95,7 @@ OSD_Result_t WiFiFileServer_Draw(void* arg)
         {
             _Ctx.pImgToggleOffObj = lv_img_create(pScreen);
             lv_obj_align(_Ctx.pImgToggleOffObj, LV_ALIGN_TOP_LEFT, kToggleBtnX_px, kToggleBtnY_px);
-            lv_img_set_src(_Ctx.pImgToggleOffObj, &img_toggle_off);
+            lv_img_set_src(_Ctx.pImgToggleOffObj, ASSET_IMG(img_toggle_off));
 
             lv_obj_set_pos(_Ctx.pMsgStateObj, kMsgStateOffX_px, kMsgStateY_px);
             lv_label_set_text_static(_Ctx.pMsgStateObj, "OFF");
@@ -138,6 +138,10 @@ OSD_Result_t Settings_Update(const SettingKey_t eKey, const uint32_t Value)
         return kOSD_Result_Err_SettingUpdateFailed;
     }
 
+    // Settings also change from the console and the FPGA hotkeys, not only from the menus, and the widget showing
+    // the setting isn't known here
+    OSD_InvalidateAll();
+
     return kOSD_Result_Ok;
 }
 
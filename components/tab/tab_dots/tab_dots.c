@@ -5,6 +5,7 @@
 #include "dlist.h"
 #include "osd_shared.h"
 
+#include "asset_store.h"
 #include "lvgl.h"
 #include "esp_log.h"
 
@@ -24,9 +25,6 @@ enum {
     kDotPosX_px   = 18,
 };
 
-static lv_obj_t* pArrowUpObj;
-static lv_obj_t* pArrowDownObj;
-
 static const char* TAG = "TabDot";
 
 OSD_Result_t TabDot_Draw(void* arg)
@@ -79,6 +77,13 @@ OSD_Result_t TabDot_Draw(void* arg)
             OSD_Widget_t *const pWidget = (OSD_Widget_t*)pNode;
             TabItem_t *const pItem = (TabItem_t*)pWidget;
 
+            // Dots only change with the selection, which dirties both the old and the new item
+            if ((pItem->DataObj != NULL) && !OSD_Widget_NeedsDraw(pWidget))
+            {
+                i++;
+                continue;
+            }
+
             if (pItem->DataObj == NULL)
             {
                 pItem->DataObj = lv_img_create(pScreen);
@@ -93,40 +98,46 @@ OSD_Result_t TabDot_Draw(void* arg)
 
             if (pList->pCurrent == pItem)
             {
-                lv_img_set_src(pItem->DataObj, &img_dot_white);
+                lv_img_set_src(pItem->DataObj, ASSET_IMG(img_dot_white));
             }
             else
             {
-                lv_img_set_src(pItem->DataObj, &img_dot_grey);
+                lv_img_set_src(pItem->DataObj, ASSET_IMG(img_dot_grey));
+
+                // The current item is left dirty for its own draw below
+                OSD_Widget_SetDrawn(pWidget);
             }
 
             i++;
         }
     }
 
-    const lv_coord_t Arrows_X_pos = FirstDot.x - img_arrow_up.header.w/2;
-    const lv_point_t ArrowUpPos = {Arrows_X_pos, FirstDot.y - kDotGap_px - img_arrow_up.header.h};
+    // Without the image there is no arrow to make room for
+    const lv_img_dsc_t *const pArrowUp = ASSET_IMG(img_arrow_up);
+    const lv_coord_t ArrowUp_W = (pArrowUp != NULL) ? pArrowUp->header.w : 0;
+    const lv_coord_t ArrowUp_H = (pArrowUp != NULL) ? pArrowUp->header.h : 0;
+
+    const lv_coord_t Arrows_X_pos = FirstDot.x - ArrowUp_W/2;
+    const lv_point_t ArrowUpPos = {Arrows_X_pos, FirstDot.y - kDotGap_px - ArrowUp_H};
     const lv_point_t ArrowDownPos = {Arrows_X_pos, FirstDot.y + (NumItems * kDotGap_px) + 1};
 
-    if (pArrowUpObj == NULL)
+    if (pList->pArrowUpObj == NULL)
     {
-        pArrowUpObj = lv_img_create(pScreen);
-        lv_img_set_src(pArrowUpObj, &img_arrow_up);
-        lv_obj_align(pArrowUpObj, LV_ALIGN_TOP_LEFT, ArrowUpPos.x, ArrowUpPos.y);
+        pList->pArrowUpObj = lv_img_create(pScreen);
+        lv_img_set_src(pList->pArrowUpObj, pArrowUp);
+        lv_obj_align(pList->pArrowUpObj, LV_ALIGN_TOP_LEFT, ArrowUpPos.x, ArrowUpPos.y);
     }
 
-    if (pArrowDownObj == NULL)
+    if (pList->pArrowDownObj == NULL)
     {
-        pArrowDownObj = lv_img_create(pScreen);
-        lv_img_set_src(pArrowDownObj, &img_arrow_down);
-        lv_obj_align(pArrowDownObj, LV_ALIGN_TOP_LEFT, ArrowDownPos.x, ArrowDownPos.y);
+        pList->pArrowDownObj = lv_img_create(pScreen);
+        lv_img_set_src(pList->pArrowDownObj, ASSET_IMG(img_arrow_down));
+        lv_obj_align(pList->pArrowDownObj, LV_ALIGN_TOP_LEFT, ArrowDownPos.x, ArrowDownPos.y);
     }
 
     // Draw the right-hand-side content associated with this menu item
-    if (pList->pCurrent->Widget.fnDraw != NULL)
-    {
-        pList->pCurrent->Widget.fnDraw(pScreen);
-    }
+    OSD_Widget_t *const pCurrent = &pList->pCurrent->Widget;
+    (void) OSD_Widget_Draw(pCurrent, OSD_Widget_Show(pCurrent, pScreen));
 
     return kOSD_Result_Ok;
 }
@@ -143,8 +154,8 @@ OSD_Result_t TabDot_OnTransition(void *arg)
     lv_obj_t** ToDelete[] = {
         &pList->pDividerObj,
         &pList->pSelectedObj,
-        &pArrowUpObj,
-        &pArrowDownObj,
+        &pList->pArrowUpObj,
+        &pList->pArrowDownObj,
     };
 
     for (size_t i = 0; i < ARRAY_SIZE(ToDelete); i++)
@@ -76,6 +76,7 @@ OSD_Result_t TabList_Draw(void* arg)
     }
 
     size_t i = 0;
+    bool MoveDivider = false;
     sys_dnode_t *pNode = NULL;
     SYS_DLIST_FOR_EACH_NODE(&pList->WidgetList, pNode) {
         if (pNode == NULL)
@@ -88,16 +89,25 @@ OSD_Result_t TabList_Draw(void* arg)
             OSD_Widget_t *const pWidget = (OSD_Widget_t*)pNode;
             TabItem_t *const pItem = (TabItem_t*)pWidget;
 
-            if (pItem->DataObj == NULL)
-            {
-                pItem->DataObj = lv_label_create(pScreen);
-            }
-
             if (pList->pDividerObj == NULL)
             {
                 pList->pDividerObj = lv_line_create(pScreen);
                 lv_obj_set_style_line_width(pList->pDividerObj, kDividerWidth_px, LV_PART_MAIN);
                 lv_obj_set_style_line_color(pList->pDividerObj, lv_color_hex(kColorDivider), LV_PART_MAIN);
+                lv_line_set_points(pList->pDividerObj, DividerOffset, ARRAY_SIZE(DividerOffset));
+                MoveDivider = true;
+            }
+
+            // Labels only change with the selection, which dirties both the old and the new item
+            if ((pItem->DataObj != NULL) && !OSD_Widget_NeedsDraw(pWidget))
+            {
+                i++;
+                continue;
+            }
+
+            if (pItem->DataObj == NULL)
+            {
+                pItem->DataObj = lv_label_create(pScreen);
             }
 
             const lv_point_t TextOrigin = {
@@ -125,32 +135,36 @@ OSD_Result_t TabList_Draw(void* arg)
                     const lv_color_t AccentColor = (((Tab_DrawCtx_t*)arg)->AccentColor);
 
                     lv_obj_set_size(pList->pSelectedObj, kRectSelectedW_px, kRectSelectedH_px);
-                    lv_obj_set_pos(pList->pSelectedObj, TextOrigin.x - kRectSelectedXOffset_px, TextOrigin.y - kRectSelectedYOffset_px);
                     lv_obj_set_style_border_color(pList->pSelectedObj, AccentColor, 0);
                     lv_obj_set_style_border_width(pList->pSelectedObj, kRectBoundWidth_px, 0);
                     lv_obj_set_style_bg_opa(pList->pSelectedObj, LV_OPA_0, 0);
                 }
+
+                // Retained selections follow the current item instead of being recreated
+                lv_obj_set_pos(pList->pSelectedObj, TextOrigin.x - kRectSelectedXOffset_px, TextOrigin.y - kRectSelectedYOffset_px);
             }
             else
             {
                 lv_obj_add_style(pItem->DataObj, OSD_GetStyleTextGrey(), 0);
+
+                // The current item is left dirty for its own draw below
+                OSD_Widget_SetDrawn(pWidget);
             }
 
+            MoveDivider = true;
             i++;
         }
     }
 
-    if (pList->pDividerObj != NULL)
+    // Restyled labels are moved to the foreground, so the divider has to follow
+    if ((pList->pDividerObj != NULL) && MoveDivider)
     {
-        lv_line_set_points(pList->pDividerObj, DividerOffset, ARRAY_SIZE(DividerOffset));
         lv_obj_move_foreground(pList->pDividerObj);
     }
 
     // Draw the right-hand-side content associated with this menu item
-    if (pList->pCurrent->Widget.fnDraw != NULL)
-    {
-        pList->pCurrent->Widget.fnDraw(pScreen);
-    }
+    OSD_Widget_t *const pCurrent = &pList->pCurrent->Widget;
+    (void) OSD_Widget_Draw(pCurrent, OSD_Widget_Show(pCurrent, pScreen));
 
     return kOSD_Result_Ok;
 }
@@ -39,6 +39,7 @@ OSD_Result_t Tab_AddItem(TabCollection_t *const pList, TabItem_t *const pItem, l
 
     sys_dnode_init(&pItem->Widget.Node);
     sys_dlist_append( &pList->WidgetList, &pItem->Widget.Node );
+    pItem->Widget.pParent = pList->pOwner;
 
     ESP_LOGI(TAG, "Added menu item %s", pItem->Widget.Name);
 
@@ -78,6 +79,9 @@ OSD_Result_t Tab_OnButton(const Button_t Button, const ButtonState_t State, void
                         ESP_LOGE(TAG, "%s OnButton call failed with %d", pList->pCurrent->Widget.Name, eResult);
                     }
                 }
+
+                // Items don't know their own widget, so assume a handled press changed what they show
+                OSD_Widget_MarkDirty(&pList->pCurrent->Widget);
             }
             break;
         default:
@@ -106,6 +110,30 @@ OSD_Result_t Tab_OnButton(const Button_t Button, const ButtonState_t State, void
     return kOSD_Result_Ok;
 }
 
+// Items added before the owner is known are linked here, later ones in Tab_AddItem()
+void Tab_SetOwner(TabCollection_t *const pList, OSD_Widget_t *const pOwner)
+{
+    if (pList == NULL)
+    {
+        return;
+    }
+
+    pList->pOwner = pOwner;
+
+    sys_dnode_t* pNode = NULL;
+    SYS_DLIST_FOR_EACH_NODE(&pList->WidgetList, pNode) {
+        if (pNode == NULL)
+        {
+            // List is empty or we are at the tail
+            break;
+        }
+        else
+        {
+            ((OSD_Widget_t*)pNode)->pParent = pOwner;
+        }
+    }
+}
+
 void Tab_Next(TabCollection_t *const pList)
 {
     if (pList == NULL)
@@ -125,17 +153,29 @@ void Tab_Next(TabCollection_t *const pList)
     OSD_Widget_t* pWidget = (OSD_Widget_t*)pNode;
     ESP_LOGI(TAG, "Widget in list: %s Next: %s", pWidget->Name, pNextItem->Widget.Name);
 
-    if (pList->pCurrent->Widget.fnOnTransition != NULL)
+    if (OSD_IsRetainedMode())
     {
-        pList->pCurrent->Widget.fnOnTransition(NULL);
+        // The item's objects and the selection are kept and only hidden or moved
+        OSD_Widget_Hide(&pList->pCurrent->Widget);
     }
-
-    if (pList->pSelectedObj != NULL)
+    else
     {
-        lv_obj_del(pList->pSelectedObj);
-        pList->pSelectedObj = NULL;
+        if (pList->pCurrent->Widget.fnOnTransition != NULL)
+        {
+            pList->pCurrent->Widget.fnOnTransition(NULL);
+        }
+
+        if (pList->pSelectedObj != NULL)
+        {
+            lv_obj_del(pList->pSelectedObj);
+            pList->pSelectedObj = NULL;
+        }
     }
 
+    // Both items change how their label is drawn and the new one has to create its objects
+    OSD_Widget_MarkDirty(&pList->pCurrent->Widget);
+    OSD_Widget_MarkDirty(&pNextItem->Widget);
+
     pList->pCurrent = pNextItem;
 }
 
@@ -158,16 +198,28 @@ void Tab_Prev(TabCollection_t *const pList)
     OSD_Widget_t* pWidget=(OSD_Widget_t*)pNode;
     ESP_LOGI(TAG, "Widget in list: %s Next: %s", pWidget->Name, pPrevItem->Widget.Name);
 
-    if (pList->pCurrent->Widget.fnOnTransition != NULL)
+    if (OSD_IsRetainedMode())
     {
-        pList->pCurrent->Widget.fnOnTransition(NULL);
+        // The item's objects and the selection are kept and only hidden or moved
+        OSD_Widget_Hide(&pList->pCurrent->Widget);
     }
-
-    if (pList->pSelectedObj != NULL)
+    else
     {
-        lv_obj_del(pList->pSelectedObj);
-        pList->pSelectedObj = NULL;
+        if (pList->pCurrent->Widget.fnOnTransition != NULL)
+        {
+            pList->pCurrent->Widget.fnOnTransition(NULL);
+        }
+
+        if (pList->pSelectedObj != NULL)
+        {
+            lv_obj_del(pList->pSelectedObj);
+            pList->pSelectedObj = NULL;
+        }
     }
 
+    // Both items change how their label is drawn and the new one has to create its objects
+    OSD_Widget_MarkDirty(&pList->pCurrent->Widget);
+    OSD_Widget_MarkDirty(&pPrevItem->Widget);
+
     pList->pCurrent = pPrevItem;
 }
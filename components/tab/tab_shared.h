@@ -11,8 +11,14 @@ typedef struct TabItem {
 typedef struct TabCollection {
     sys_dlist_t WidgetList;
     TabItem_t* pCurrent;
+
+    // The widget drawing this collection, made the parent of every item so that a dirty item gets drawn
+    OSD_Widget_t* pOwner;
+
     lv_obj_t* pDividerObj;
     lv_obj_t* pSelectedObj;
+    lv_obj_t* pArrowUpObj;
+    lv_obj_t* pArrowDownObj;
 } TabCollection_t;
 
 typedef struct Tab_DrawCtx {
@@ -29,5 +35,6 @@ typedef struct TabTable_DrawCtx {
 
 OSD_Result_t Tab_AddItem(TabCollection_t *const pList, TabItem_t *const pItem, lv_obj_t* pScreen);
 OSD_Result_t Tab_OnButton(const Button_t Button, const ButtonState_t State, void *arg);
+void Tab_SetOwner(TabCollection_t *const pList, OSD_Widget_t *const pOwner);
 void Tab_Next(TabCollection_t *const pList);
 void Tab_Prev(TabCollection_t *const pList);
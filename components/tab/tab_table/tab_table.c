@@ -65,11 +65,44 @@ OSD_Result_t TabTable_Draw(void* arg)
                 };
                 pWidget->fnDraw(&Tbl_Ctx);
 
+                // Items are only drawn while the table is built, so none of them are dirty afterwards
+                OSD_Widget_SetDrawn(pWidget);
+
                 i++;
             }
         }
         pList->pSelectedObj = pTable;
     }
+    else
+    {
+        // A retained table outlives item navigation. Let the items update their cells and repaint the indicators
+        // drawn by the table's callbacks.
+        uint16_t i = 0;
+        sys_dnode_t *pNode = NULL;
+        SYS_DLIST_FOR_EACH_NODE(&pList->WidgetList, pNode) {
+            if (pNode == NULL)
+            {
+                // List is empty or we are at the tail
+                break;
+            }
+            else
+            {
+                OSD_Widget_t *const pWidget = (OSD_Widget_t*)pNode;
+
+                TabTable_DrawCtx_t Tbl_Ctx = {
+                    .pTable = pList->pSelectedObj,
+                    .pItem = (TabItem_t*)pWidget,
+                    .CurrID = i,
+                };
+                pWidget->fnDraw(&Tbl_Ctx);
+                OSD_Widget_SetDrawn(pWidget);
+
+                i++;
+            }
+        }
+
+        lv_obj_invalidate(pList->pSelectedObj);
+    }
 
     return kOSD_Result_Ok;
 }
@@ -0,0 +1,96 @@
+#include "band_render.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+void BandRender_Init(BandRender_t *const pBands, const BandRender_Sync_t *const pSync)
+{
+    if (pBands == NULL)
+    {
+        return;
+    }
+
+    memset(pBands, 0x0, sizeof(*pBands));
+    pBands->MinPixels = kBandRenderConsts_MinPixels;
+
+    // Without a way to reach a helper every job stays on the caller
+    if ((pSync != NULL) && (pSync->fnKick != NULL) && (pSync->fnWait != NULL))
+    {
+        pBands->Sync = *pSync;
+        pBands->IsEnabled = true;
+    }
+}
+
+void BandRender_SetEnabled(BandRender_t *const pBands, const bool IsEnabled)
+{
+    if (pBands == NULL)
+    {
+        return;
+    }
+
+    pBands->IsEnabled = IsEnabled && (pBands->Sync.fnKick != NULL);
+}
+
+// The top band gets the odd row since the caller starts on it while the helper is still waking up
+bool BandRender_Split(const int32_t y1, const int32_t y2, const int32_t Width, const uint32_t MinPixels, int32_t *const pSplitY)
+{
+    const int32_t Rows = y2 - y1 + 1;
+    if ((Rows < 2) || (Width <= 0) || ((uint32_t)Rows * (uint32_t)Width < MinPixels))
+    {
+        return false;
+    }
+
+    if (pSplitY != NULL)
+    {
+        *pSplitY = y1 + (Rows + 1) / 2;
+    }
+
+    return true;
+}
+
+void BandRender_Run(BandRender_t *const pBands, const fnBandJob_t fnJob, void *const pArg, const int32_t y1, const int32_t y2, const int32_t Width)
+{
+    if ((pBands == NULL) || (fnJob == NULL) || (y1 > y2))
+    {
+        return;
+    }
+
+    pBands->Stats.NumJobs++;
+
+    int32_t SplitY;
+    if (!pBands->IsEnabled || !BandRender_Split(y1, y2, Width, pBands->MinPixels, &SplitY))
+    {
+        pBands->Stats.PixelsMain += (uint64_t)(y2 - y1 + 1) * (uint32_t)Width;
+        fnJob(pArg, y1, y2);
+        return;
+    }
+
+    pBands->fnJob = fnJob;
+    pBands->pJobArg = pArg;
+    pBands->JobY1 = SplitY;
+    pBands->JobY2 = y2;
+    pBands->Sync.fnKick(pBands->Sync.pCtx);
+
+    fnJob(pArg, y1, SplitY - 1);
+
+    // The barrier, the job's inputs belong to the caller and may be gone as soon as this returns
+    pBands->Sync.fnWait(pBands->Sync.pCtx);
+    pBands->fnJob = NULL;
+
+    pBands->Stats.NumSplit++;
+    pBands->Stats.PixelsMain += (uint64_t)(SplitY - y1) * (uint32_t)Width;
+    pBands->Stats.PixelsHelper += (uint64_t)(y2 - SplitY + 1) * (uint32_t)Width;
+}
+
+// Helper side, once woken by the kick and before signalling the wait
+void BandRender_RunHelper(BandRender_t *const pBands)
+{
+    if ((pBands == NULL) || (pBands->fnJob == NULL))
+    {
+        return;
+    }
+
+    pBands->fnJob(pBands->pJobArg, pBands->JobY1, pBands->JobY2);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Splits a raster job across both cores by rows. The render task runs the top band and a helper task on the other
+// core the bottom one, into the same buffer, and BandRender_Run() only returns once both are done, so the next draw
+// call and the flush always see the whole range. The bands never share a row, so as long as a job writes nothing but
+// the rows it is given the result is the same as running it on one core.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host benchmark, which provides the helper as a
+// thread.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    kBandRenderConsts_MinPixels = 2048,     // Smaller jobs cost more to hand over than the helper saves on them
+} BandRenderConsts_t;
+
+typedef void (*fnBandJob_t)(void *pArg, const int32_t y1, const int32_t y2);
+
+// How the render task wakes the helper and waits for it to finish, both must act as memory barriers
+typedef struct BandRender_Sync {
+    void (*fnKick)(void *pCtx);
+    void (*fnWait)(void *pCtx);
+    void *pCtx;
+} BandRender_Sync_t;
+
+typedef struct BandRender_Stats {
+    uint32_t NumJobs;
+    uint32_t NumSplit;
+    uint64_t PixelsMain;
+    uint64_t PixelsHelper;
+} BandRender_Stats_t;
+
+typedef struct BandRender {
+    BandRender_Sync_t Sync;
+    uint32_t MinPixels;
+    bool IsEnabled;
+
+    // Handed to the helper, only valid between the kick and the wait
+    fnBandJob_t fnJob;
+    void *pJobArg;
+    int32_t JobY1;
+    int32_t JobY2;
+
+    BandRender_Stats_t Stats;
+} BandRender_t;
+
+void BandRender_Init(BandRender_t *const pBands, const BandRender_Sync_t *const pSync);
+void BandRender_SetEnabled(BandRender_t *const pBands, const bool IsEnabled);
+bool BandRender_Split(const int32_t y1, const int32_t y2, const int32_t Width, const uint32_t MinPixels, int32_t *const pSplitY);
+void BandRender_Run(BandRender_t *const pBands, const fnBandJob_t fnJob, void *const pArg, const int32_t y1, const int32_t y2, const int32_t Width);
+void BandRender_RunHelper(BandRender_t *const pBands);
@@ -0,0 +1,411 @@
+#include "disp_flush.h"
+
+#include "disp_palette.h"
+#include "disp_stats.h"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kDispCmdWrite = 0x400 | 1023,
+    kDispNumBufs  = 2,
+    kDispWordsPerXfer = kDisp_FlushConsts_BytesPerXfer / sizeof(uint32_t),
+    kDispIndexedWordsPerXfer = kDisp_FlushConsts_PixelsPerXfer / sizeof(uint32_t),
+};
+
+static const char* TAG = "DispFlush";
+
+static spi_device_handle_t hSPI;
+static Disp_FlushStats_t Stats;
+static lv_color_t *pBufs[kDispNumBufs];
+
+// Only the address and buffer depend on the transaction index, so the descriptors are built once per buffer. The
+// SPI driver keeps using them after they are queued, hence static. The FPGA takes at most one transaction's worth
+// of data per write command, so a frame can't go out as a single longer transfer.
+static spi_transaction_t Trans[kDispNumBufs][kDisp_FlushConsts_NumTrans];
+static volatile uint32_t RenderStart_us;
+static volatile uint32_t QueuedAt_us;
+
+static Disp_Plan_t Plan;
+static Disp_PlanDone_t Done;
+
+// Double buffered only, given back once the previous frame is off the wire
+static SemaphoreHandle_t xTransferDone;
+static StaticSemaphore_t xTransferDoneBuffer;
+
+#if CONFIG_CHROMATIC_OSD_INDEXED
+// Indexed only. Transactions complete in order, so the bounce buffers are taken round-robin and each completion frees
+// the oldest one.
+static uint8_t *pIndexFrame;
+static Disp_Palette_t Palette;
+static DMA_ATTR uint16_t Bounce[kDisp_FlushConsts_NumBounceBufs][kDisp_FlushConsts_PixelsPerXfer];
+static spi_transaction_t BounceTrans[kDisp_FlushConsts_NumBounceBufs];
+static uint32_t BounceQueuedAt_us[kDisp_FlushConsts_NumBounceBufs];
+static size_t NextBounce;
+static SemaphoreHandle_t xBounceFree;
+static StaticSemaphore_t xBounceFreeBuffer;
+
+typedef struct QueueIndexedCtx {
+    lv_disp_drv_t *pDrv;
+    uint32_t QueuedAt_us;
+} QueueIndexedCtx_t;
+
+static void FlushIndexed(lv_disp_drv_t *pDrv, const lv_area_t *pArea, const lv_color_t *pColorMap);
+static void QueueIndexed(void *pCtx, const Disp_PlanXfer_t *const pXfer);
+#endif
+
+typedef struct QueueCtx {
+    lv_disp_drv_t *pDrv;
+    size_t Buf;
+} QueueCtx_t;
+
+static uint64_t GetDirtyMask(const lv_disp_t *const pDisp);
+static uint32_t RecordDirty(const uint64_t DirtyMask);
+static void Queue(void *pCtx, const Disp_PlanXfer_t *const pXfer);
+static void RecordFrameDone(void);
+
+void Disp_Flush_Init(spi_device_handle_t hDevice, lv_color_t *const pBuf1, lv_color_t *const pBuf2)
+{
+    hSPI = hDevice;
+    pBufs[0] = pBuf1;
+    pBufs[1] = pBuf2;
+    Stats.IsDoubleBuffered = (pBuf2 != NULL);
+    Disp_Plan_Init(&Plan);
+
+    for (size_t b = 0; b < kDispNumBufs; b++)
+    {
+        for (size_t x = 0; (pBufs[b] != NULL) && (x < kDisp_FlushConsts_NumTrans); x++)
+        {
+            spi_transaction_t *const pTrans = &Trans[b][x];
+            memset(pTrans, 0, sizeof(spi_transaction_t));
+            pTrans->tx_buffer = &pBufs[b][x * kDisp_FlushConsts_PixelsPerXfer];
+            pTrans->length = kDisp_FlushConsts_BytesPerXfer * 8;  // Data length, in bits
+            pTrans->flags = SPI_TRANS_MODE_QIO;
+            pTrans->cmd = kDispCmdWrite;
+            pTrans->addr = x * kDisp_FlushConsts_BytesPerXfer;
+        }
+    }
+
+    if (Stats.IsDoubleBuffered)
+    {
+        xTransferDone = xSemaphoreCreateBinaryStatic(&xTransferDoneBuffer);
+        (void) xSemaphoreGive(xTransferDone);
+    }
+}
+
+#if CONFIG_CHROMATIC_OSD_INDEXED
+void Disp_Flush_InitIndexed(spi_device_handle_t hDevice, uint8_t *const pFrame)
+{
+    hSPI = hDevice;
+    pIndexFrame = pFrame;
+    Stats.IsIndexed = true;
+    Disp_Plan_Init(&Plan);
+
+    // Index 0 is the chroma key, which is what the FPGA shows before the first flush anyway
+    Disp_Palette_Init(&Palette);
+    memset(pFrame, 0x0, kOSD_NumPixels);
+
+    for (size_t b = 0; b < kDisp_FlushConsts_NumBounceBufs; b++)
+    {
+        spi_transaction_t *const pTrans = &BounceTrans[b];
+        memset(pTrans, 0, sizeof(spi_transaction_t));
+        pTrans->tx_buffer = Bounce[b];
+        pTrans->length = kDisp_FlushConsts_BytesPerXfer * 8;  // Data length, in bits
+        pTrans->flags = SPI_TRANS_MODE_QIO;
+        pTrans->cmd = kDispCmdWrite;
+    }
+
+    xBounceFree = xSemaphoreCreateCountingStatic(kDisp_FlushConsts_NumBounceBufs, kDisp_FlushConsts_NumBounceBufs, &xBounceFreeBuffer);
+}
+#endif
+
+// Render task only, before drawing. Once the palette filled up some colors were drawn approximately, so it starts
+// over and the caller redraws the whole screen, after which it only holds the colors actually on it.
+bool Disp_Flush_CheckPalette(void)
+{
+#if CONFIG_CHROMATIC_OSD_INDEXED
+    if ((pIndexFrame == NULL) || (Palette.NumApprox == 0))
+    {
+        return false;
+    }
+
+    Stats.NumPaletteApprox += Palette.NumApprox;
+    Stats.NumPaletteResets++;
+    Disp_Palette_Init(&Palette);
+
+    // The indices in the frame changed meaning, so none of the hashes of what was sent can be trusted
+    Disp_Plan_Forget(&Plan);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Disp_Flush_OnRenderStart(lv_disp_drv_t *pDrv)
+{
+    (void)pDrv;
+
+    RenderStart_us = (uint32_t)esp_timer_get_time();
+}
+
+void Disp_Flush_Cb(lv_disp_drv_t *pDrv, const lv_area_t *pArea, lv_color_t *pColorMap)
+{
+#if CONFIG_CHROMATIC_OSD_INDEXED
+    if (pIndexFrame != NULL)
+    {
+        FlushIndexed(pDrv, pArea, pColorMap);
+        return;
+    }
+#endif
+
+    (void)pArea;
+
+    // LVGL flushes once per invalidated area, all of which are already drawn into the one buffer. Send them
+    // together on the last one.
+    if (!lv_disp_flush_is_last(pDrv))
+    {
+        lv_disp_flush_ready(pDrv);
+        return;
+    }
+
+    const uint32_t SubmitStart_us = (uint32_t)esp_timer_get_time();
+    Disp_Stats_Record(kDisp_Probe_Render, SubmitStart_us - RenderStart_us);
+
+    const size_t Buf = (Stats.IsDoubleBuffered && (pColorMap == pBufs[1])) ? 1 : 0;
+    const uint64_t DirtyMask = Disp_Plan_DropUnchanged(&Plan, (const uint32_t*)pBufs[Buf], kDispWordsPerXfer, GetDirtyMask(_lv_refr_get_disp_refreshing()));
+    const uint32_t NumDirty = RecordDirty(DirtyMask);
+
+    Disp_Stats_Record(kDisp_Probe_QueueDepth, NumDirty);
+
+    if (Stats.IsDoubleBuffered)
+    {
+        // The other buffer is still being read by the previous frame's DMA. LVGL moves on to it once released, even
+        // when this frame has nothing to send.
+        (void) xSemaphoreTake(xTransferDone, portMAX_DELAY);
+    }
+
+    if (NumDirty == 0)
+    {
+        if (Stats.IsDoubleBuffered)
+        {
+            (void) xSemaphoreGive(xTransferDone);
+        }
+
+        Stats.NumFramesSkipped++;
+        Disp_Stats_Record(kDisp_Probe_FlushSubmit, (uint32_t)esp_timer_get_time() - SubmitStart_us);
+        RecordFrameDone();
+        lv_disp_flush_ready(pDrv);
+        return;
+    }
+
+    QueueCtx_t Ctx = {
+        .pDrv = pDrv,
+        .Buf = Buf,
+    };
+    QueuedAt_us = (uint32_t)esp_timer_get_time();
+    (void) Disp_Plan_Queue(DirtyMask, Queue, &Ctx);
+
+    Disp_Stats_Record(kDisp_Probe_FlushSubmit, (uint32_t)esp_timer_get_time() - SubmitStart_us);
+
+    if (Stats.IsDoubleBuffered)
+    {
+        // LVGL draws the next frame into the other buffer on top of what it holds, so bring it up to date first.
+        // Reading while the DMA reads the same rows is fine.
+        Disp_Plan_SyncBands(pBufs[Buf], pBufs[Buf ^ 1], DirtyMask);
+        RecordFrameDone();
+        lv_disp_flush_ready(pDrv);
+    }
+}
+
+// The driver calls this from its ISR after every transaction, not just the last one of a frame. Only that one,
+// the one carrying the driver, gets past the check.
+void Disp_Flush_OnTransDone(spi_transaction_t *pTransaction)
+{
+    const bool IsLast = Disp_Plan_OnTransDone(&Done, pTransaction->user != NULL);
+
+#if CONFIG_CHROMATIC_OSD_INDEXED
+    if (pIndexFrame != NULL)
+    {
+        // Flagged on the last transaction of a frame, which all carry the time the frame started queueing
+        if (IsLast)
+        {
+            Stats.LastTransfer_us = (uint32_t)esp_timer_get_time() - BounceQueuedAt_us[pTransaction - BounceTrans];
+            Disp_Stats_Record(kDisp_Probe_FlushComplete, Stats.LastTransfer_us);
+        }
+
+        BaseType_t HigherPriorityTaskWoken = pdFALSE;
+        (void) xSemaphoreGiveFromISR(xBounceFree, &HigherPriorityTaskWoken);
+        if (HigherPriorityTaskWoken == pdTRUE)
+        {
+            portYIELD_FROM_ISR();
+        }
+        return;
+    }
+#endif
+
+    if (!IsLast)
+    {
+        return;
+    }
+
+    lv_disp_drv_t *const pDrv = (lv_disp_drv_t*)pTransaction->user;
+
+    Stats.LastTransfer_us = (uint32_t)esp_timer_get_time() - QueuedAt_us;
+    Disp_Stats_Record(kDisp_Probe_FlushComplete, Stats.LastTransfer_us);
+
+    if (Stats.IsDoubleBuffered)
+    {
+        BaseType_t HigherPriorityTaskWoken = pdFALSE;
+        (void) xSemaphoreGiveFromISR(xTransferDone, &HigherPriorityTaskWoken);
+        if (HigherPriorityTaskWoken == pdTRUE)
+        {
+            portYIELD_FROM_ISR();
+        }
+        return;
+    }
+
+    RecordFrameDone();
+    lv_disp_flush_ready(pDrv);
+}
+
+const Disp_FlushStats_t* Disp_Flush_GetStats(void)
+{
+    Stats.NumBandHits = Plan.NumHits;
+    Stats.NumBandMisses = Plan.NumMisses;
+    Stats.NumTransDone = Done.NumCallbacks;
+    return &Stats;
+}
+
+static uint64_t GetDirtyMask(const lv_disp_t *const pDisp)
+{
+    if (pDisp == NULL)
+    {
+        ESP_LOGW(TAG, "Flush outside of a refresh, sending the full frame");
+        return Disp_Plan_RowsToMask(0, kOSD_Height_px - 1);
+    }
+
+    // Areas that were merged into another one are flagged rather than removed
+    uint64_t Mask = 0;
+    for (uint16_t i = 0; i < pDisp->inv_p; i++)
+    {
+        if (!pDisp->inv_area_joined[i])
+        {
+            Mask |= Disp_Plan_RowsToMask(pDisp->inv_areas[i].y1, pDisp->inv_areas[i].y2);
+        }
+    }
+
+    return Mask;
+}
+
+#if CONFIG_CHROMATIC_OSD_INDEXED
+static void FlushIndexed(lv_disp_drv_t *pDrv, const lv_area_t *pArea, const lv_color_t *pColorMap)
+{
+    // Areas that don't fit the draw buffer come in several parts, each one is kept as soon as it's drawn
+    const lv_coord_t Width = lv_area_get_width(pArea);
+    for (lv_coord_t y = pArea->y1; y <= pArea->y2; y++)
+    {
+        const uint16_t *const pRow = (const uint16_t*)&pColorMap[(size_t)(y - pArea->y1) * Width];
+        Disp_Palette_Quantize(&Palette, pRow, &pIndexFrame[(size_t)y * kOSD_Width_px + pArea->x1], (size_t)Width);
+    }
+
+    if (!lv_disp_flush_is_last(pDrv))
+    {
+        lv_disp_flush_ready(pDrv);
+        return;
+    }
+
+    const uint32_t SubmitStart_us = (uint32_t)esp_timer_get_time();
+    Disp_Stats_Record(kDisp_Probe_Render, SubmitStart_us - RenderStart_us);
+
+    const uint64_t DirtyMask = Disp_Plan_DropUnchanged(&Plan, (const uint32_t*)pIndexFrame, kDispIndexedWordsPerXfer, GetDirtyMask(_lv_refr_get_disp_refreshing()));
+    const uint32_t NumDirty = RecordDirty(DirtyMask);
+    Stats.NumPaletteColors = Palette.NumColors;
+
+    Disp_Stats_Record(kDisp_Probe_QueueDepth, NumDirty);
+
+    QueueIndexedCtx_t Ctx = {
+        .pDrv = pDrv,
+        .QueuedAt_us = SubmitStart_us,
+    };
+    (void) Disp_Plan_Queue(DirtyMask, QueueIndexed, &Ctx);
+
+    if (NumDirty == 0)
+    {
+        Stats.NumFramesSkipped++;
+    }
+
+    Disp_Stats_Record(kDisp_Probe_FlushSubmit, (uint32_t)esp_timer_get_time() - SubmitStart_us);
+    RecordFrameDone();
+    lv_disp_flush_ready(pDrv);
+}
+
+static void QueueIndexed(void *pCtx, const Disp_PlanXfer_t *const pXfer)
+{
+    const QueueIndexedCtx_t *const pQueue = (const QueueIndexedCtx_t*)pCtx;
+
+    // Waits for the DMA when it's a full set of buffers behind
+    (void) xSemaphoreTake(xBounceFree, portMAX_DELAY);
+    const size_t b = NextBounce;
+    NextBounce = (NextBounce + 1) % kDisp_FlushConsts_NumBounceBufs;
+
+    Disp_Palette_Expand(&Palette, &pIndexFrame[pXfer->Index * kDisp_FlushConsts_PixelsPerXfer], Bounce[b], kDisp_FlushConsts_PixelsPerXfer);
+    BounceTrans[b].addr = pXfer->Addr;
+    BounceTrans[b].user = pXfer->IsLast ? pQueue->pDrv : NULL;
+    BounceQueuedAt_us[b] = pQueue->QueuedAt_us;
+
+    const esp_err_t ret = spi_device_queue_trans(hSPI, &BounceTrans[b], portMAX_DELAY);
+    assert(ret == ESP_OK);
+    (void)ret;
+}
+#endif
+
+static uint32_t RecordDirty(const uint64_t DirtyMask)
+{
+    const uint32_t NumDirty = (uint32_t)__builtin_popcountll(DirtyMask);
+    const uint32_t NumBands = Disp_Plan_CountBands(DirtyMask);
+
+    // Indexed frames are expanded before they are sent, so the bus carries RGB565 either way
+    const uint32_t BytesSent = NumDirty * kDisp_FlushConsts_BytesPerXfer;
+    Stats.NumFrames++;
+    Stats.NumTrans += NumDirty;
+    Stats.NumBands += NumBands;
+    Stats.BytesSent += BytesSent;
+    Stats.BytesSaved += kDisp_FlushConsts_BytesPerFrame - BytesSent;
+    Stats.LastBytesSent = BytesSent;
+    Stats.LastBytesSaved = kDisp_FlushConsts_BytesPerFrame - BytesSent;
+
+    return NumDirty;
+}
+
+// Only the last transaction of the frame carries the driver for the completion callback
+static void Queue(void *pCtx, const Disp_PlanXfer_t *const pXfer)
+{
+    const QueueCtx_t *const pQueue = (const QueueCtx_t*)pCtx;
+    spi_transaction_t *const pTrans = &Trans[pQueue->Buf][pXfer->Index];
+
+    pTrans->user = pXfer->IsLast ? pQueue->pDrv : NULL;
+    const esp_err_t ret = spi_device_queue_trans(hSPI, pTrans, portMAX_DELAY);
+    assert(ret == ESP_OK);
+    (void)ret;
+}
+
+// Called from the SPI ISR when single buffered
+static void RecordFrameDone(void)
+{
+    const uint32_t Done_us = (uint32_t)esp_timer_get_time();
+    const uint32_t Frame_us = Done_us - RenderStart_us;
+
+    Stats.LastFrame_us = Frame_us;
+    Stats.MaxFrame_us = (Frame_us > Stats.MaxFrame_us) ? Frame_us : Stats.MaxFrame_us;
+    Stats.TotalFrame_us += Frame_us;
+    Disp_Stats_RecordFrame(Done_us, Frame_us);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// Sends the OSD frame buffer to the FPGA over QSPI. LVGL renders straight into the full-screen buffer (direct mode)
+// and only redraws what was invalidated, so only the transactions covering the invalidated rows are queued. Each
+// transaction carries the byte offset of its chunk in the address phase, which is what lets the FPGA place a
+// partial update. Invalidated transactions whose content hashes the same as when last sent are skipped as well.
+//
+// Given a second buffer, LVGL is released as soon as a frame is queued and renders the next one into the other
+// buffer while the DMA drains the first. The rows sent are copied across before the buffers swap, so both always
+// hold the frame the FPGA has.
+//
+// In indexed mode the frame is kept as 8-bit palette indices instead (see disp_palette.h). LVGL renders the
+// invalidated areas into a small draw buffer, each area is quantized into the frame as it is flushed, and the dirty
+// transactions are expanded back to RGB565 through a few DMA bounce buffers as they are queued. LVGL is released as
+// soon as a frame is queued, since the transfer only reads the bounce buffers.
+
+#include "disp_plan.h"
+#include "driver/spi_master.h"
+#include "lvgl.h"
+#include "osd.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct Disp_FlushStats {
+    uint32_t NumFrames;
+    uint32_t NumTrans;
+    uint32_t NumBands;              // Runs of consecutive dirty transactions
+    uint64_t BytesSent;
+    uint64_t BytesSaved;            // Compared to sending every frame in full
+    uint32_t LastBytesSent;
+    uint32_t LastBytesSaved;
+    uint32_t NumBandHits;           // Invalidated transactions skipped because their content matched the last sent
+    uint32_t NumBandMisses;
+    uint32_t NumFramesSkipped;      // Refreshes that had nothing left to send
+    uint32_t NumTransDone;          // SPI post callbacks, the driver runs one per transaction rather than per frame
+
+    // Frame time is from LVGL starting to render until it may render again, which is what double buffering cuts
+    uint32_t LastFrame_us;
+    uint32_t MaxFrame_us;
+    uint64_t TotalFrame_us;
+    uint32_t LastTransfer_us;       // First transaction queued until the last one completed
+    bool IsDoubleBuffered;
+
+    // Indexed mode only
+    bool IsIndexed;
+    uint16_t NumPaletteColors;
+    uint32_t NumPaletteApprox;      // Lookups that fell back to the nearest color because the palette was full
+    uint32_t NumPaletteResets;      // Full redraws after the palette filled up
+} Disp_FlushStats_t;
+
+void Disp_Flush_Init(spi_device_handle_t hDevice, lv_color_t *const pBuf1, lv_color_t *const pBuf2);
+void Disp_Flush_InitIndexed(spi_device_handle_t hDevice, uint8_t *const pFrame);
+bool Disp_Flush_CheckPalette(void);
+void Disp_Flush_OnRenderStart(lv_disp_drv_t *pDrv);
+void Disp_Flush_Cb(lv_disp_drv_t *pDrv, const lv_area_t *pArea, lv_color_t *pColorMap);
+void Disp_Flush_OnTransDone(spi_transaction_t *pTransaction);
+const Disp_FlushStats_t* Disp_Flush_GetStats(void);
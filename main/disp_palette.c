@@ -0,0 +1,154 @@
+#include "disp_palette.h"
+
+#include "color.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kChromaKey = 0xFF00FF,      // The FPGA shows the game wherever the OSD has this color
+};
+
+// Seeded so the colors every frame uses get the same low indices on every boot
+static const uint32_t SeedColors[] = {
+    kChromaKey,
+    kColor_Black,
+    kColor_White,
+    kColor_Grey,
+};
+
+static bool Insert(Disp_Palette_t *const pPalette, const uint16_t Color, uint8_t *const pIndex);
+static uint8_t FindNearest(const Disp_Palette_t *const pPalette, const uint16_t Color);
+static inline size_t Hash(const uint16_t Color);
+
+void Disp_Palette_Init(Disp_Palette_t *const pPalette)
+{
+    if (pPalette == NULL)
+    {
+        return;
+    }
+
+    memset(pPalette, 0x0, sizeof(*pPalette));
+
+    for (size_t i = 0; i < sizeof(SeedColors) / sizeof(SeedColors[0]); i++)
+    {
+        (void) Disp_Palette_Lookup(pPalette, Disp_Palette_FromRGB888(SeedColors[i]));
+    }
+}
+
+// Same rounding as lv_color_hex() at 16-bit depth
+uint16_t Disp_Palette_FromRGB888(const uint32_t Color)
+{
+    const uint16_t R = (uint16_t)((Color >> 16) & 0xFF);
+    const uint16_t G = (uint16_t)((Color >> 8) & 0xFF);
+    const uint16_t B = (uint16_t)(Color & 0xFF);
+    return (uint16_t)(((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3));
+}
+
+uint8_t Disp_Palette_Lookup(Disp_Palette_t *const pPalette, const uint16_t Color)
+{
+    size_t Slot = Hash(Color);
+    while (pPalette->Slots[Slot].IsUsed)
+    {
+        if (pPalette->Slots[Slot].Color == Color)
+        {
+            return pPalette->Slots[Slot].Index;
+        }
+
+        Slot = (Slot + 1) % kDisp_PaletteConsts_NumSlots;
+    }
+
+    uint8_t Index;
+    if (Insert(pPalette, Color, &Index))
+    {
+        return Index;
+    }
+
+    pPalette->NumApprox++;
+    return FindNearest(pPalette, Color);
+}
+
+// Runs of one color are by far the most common, so only changes go through the lookup
+void Disp_Palette_Quantize(Disp_Palette_t *const pPalette, const uint16_t *const pSrc, uint8_t *const pDst, const size_t NumPixels)
+{
+    if (NumPixels == 0)
+    {
+        return;
+    }
+
+    uint16_t Last = pSrc[0];
+    uint8_t LastIndex = Disp_Palette_Lookup(pPalette, Last);
+
+    for (size_t i = 0; i < NumPixels; i++)
+    {
+        if (pSrc[i] != Last)
+        {
+            Last = pSrc[i];
+            LastIndex = Disp_Palette_Lookup(pPalette, Last);
+        }
+
+        pDst[i] = LastIndex;
+    }
+}
+
+void Disp_Palette_Expand(const Disp_Palette_t *const pPalette, const uint8_t *const pSrc, uint16_t *const pDst, const size_t NumPixels)
+{
+    for (size_t i = 0; i < NumPixels; i++)
+    {
+        pDst[i] = pPalette->Colors[pSrc[i]];
+    }
+}
+
+static bool Insert(Disp_Palette_t *const pPalette, const uint16_t Color, uint8_t *const pIndex)
+{
+    if (pPalette->NumColors >= kDisp_PaletteConsts_NumColors)
+    {
+        return false;
+    }
+
+    size_t Slot = Hash(Color);
+    while (pPalette->Slots[Slot].IsUsed)
+    {
+        Slot = (Slot + 1) % kDisp_PaletteConsts_NumSlots;
+    }
+
+    const uint8_t Index = (uint8_t)pPalette->NumColors++;
+    pPalette->Colors[Index] = Color;
+    pPalette->Slots[Slot].Color = Color;
+    pPalette->Slots[Slot].Index = Index;
+    pPalette->Slots[Slot].IsUsed = true;
+
+    *pIndex = Index;
+    return true;
+}
+
+// Squared distance with green halved back to 5 bits, so the channels weigh the same
+static uint8_t FindNearest(const Disp_Palette_t *const pPalette, const uint16_t Color)
+{
+    uint32_t Best = UINT32_MAX;
+    uint8_t BestIndex = 0;
+
+    for (size_t i = 0; i < pPalette->NumColors; i++)
+    {
+        const int32_t dR = (int32_t)((Color >> 11) & 0x1F) - (int32_t)((pPalette->Colors[i] >> 11) & 0x1F);
+        const int32_t dG = ((int32_t)((Color >> 5) & 0x3F) - (int32_t)((pPalette->Colors[i] >> 5) & 0x3F)) / 2;
+        const int32_t dB = (int32_t)(Color & 0x1F) - (int32_t)(pPalette->Colors[i] & 0x1F);
+        const uint32_t Distance = (uint32_t)(dR * dR + dG * dG + dB * dB);
+
+        if (Distance < Best)
+        {
+            Best = Distance;
+            BestIndex = (uint8_t)i;
+        }
+    }
+
+    return BestIndex;
+}
+
+static inline size_t Hash(const uint16_t Color)
+{
+    // Fibonacci hashing, the top bits of the product are the best mixed
+    return (size_t)(((uint32_t)Color * 2654435761u) >> 23) % kDisp_PaletteConsts_NumSlots;
+}
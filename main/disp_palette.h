@@ -0,0 +1,37 @@
+#pragma once
+
+// Maps the RGB565 colors the OSD renders to 8-bit indices and back. The OSD only draws a few dozen distinct colors, so
+// the frame can be kept as indices and expanded through the palette as it is sent. Colors are added the first time
+// they are seen and never move, which keeps an index valid for as long as it sits in the frame. Once all 256 entries
+// are taken new colors map to the nearest one and are counted, and the owner is expected to reset the palette and
+// redraw the whole frame.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host verification harness.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kDisp_PaletteConsts_NumColors = 256,
+    kDisp_PaletteConsts_NumSlots  = 512,    // Reverse lookup, kept at most half full
+} Disp_PaletteConsts_t;
+
+typedef struct Disp_PaletteSlot {
+    uint16_t Color;
+    uint8_t Index;
+    bool IsUsed;
+} Disp_PaletteSlot_t;
+
+typedef struct Disp_Palette {
+    uint16_t Colors[kDisp_PaletteConsts_NumColors];    // RGB565, as sent to the FPGA
+    uint16_t NumColors;
+    uint32_t NumApprox;                                 // Lookups that fell back to the nearest color
+    Disp_PaletteSlot_t Slots[kDisp_PaletteConsts_NumSlots];
+} Disp_Palette_t;
+
+void Disp_Palette_Init(Disp_Palette_t *const pPalette);
+uint16_t Disp_Palette_FromRGB888(const uint32_t Color);
+uint8_t Disp_Palette_Lookup(Disp_Palette_t *const pPalette, const uint16_t Color);
+void Disp_Palette_Quantize(Disp_Palette_t *const pPalette, const uint16_t *const pSrc, uint8_t *const pDst, const size_t NumPixels);
+void Disp_Palette_Expand(const Disp_Palette_t *const pPalette, const uint8_t *const pSrc, uint16_t *const pDst, const size_t NumPixels);
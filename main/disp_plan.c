@@ -0,0 +1,147 @@
+#include "disp_plan.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kPlanRowBytes = kOSD_Width_px * 2,      // [bytes] RGB565
+};
+
+void Disp_Plan_Init(Disp_Plan_t *const pPlan)
+{
+    memset(pPlan, 0x0, sizeof(*pPlan));
+}
+
+// For when what the FPGA holds can no longer be told from the frame, every invalidated transaction is sent again
+void Disp_Plan_Forget(Disp_Plan_t *const pPlan)
+{
+    pPlan->SentMask = 0;
+}
+
+// Transactions don't start on row boundaries, so a band covers every transaction that holds part of its rows
+uint64_t Disp_Plan_RowsToMask(int32_t y1, int32_t y2)
+{
+    y1 = (y1 < 0) ? 0 : y1;
+    y2 = (y2 >= kOSD_Height_px) ? (kOSD_Height_px - 1) : y2;
+    if (y1 > y2)
+    {
+        return 0;
+    }
+
+    const size_t First = ((size_t)y1 * kPlanRowBytes) / kDisp_FlushConsts_BytesPerXfer;
+    const size_t Last = (((size_t)y2 + 1) * kPlanRowBytes - 1) / kDisp_FlushConsts_BytesPerXfer;
+
+    uint64_t Mask = 0;
+    for (size_t x = First; x <= Last; x++)
+    {
+        Mask |= (1ull << x);
+    }
+
+    return Mask;
+}
+
+// Widgets often redraw identical content, so an invalidated transaction is only sent if its hash differs from what
+// the FPGA already has. Works on RGB565 and indexed frames alike, both are word aligned.
+uint64_t Disp_Plan_DropUnchanged(Disp_Plan_t *const pPlan, const uint32_t *const pFrame, const size_t WordsPerXfer, const uint64_t DirtyMask)
+{
+    uint64_t Mask = DirtyMask;
+
+    for (size_t x = 0; x < kDisp_FlushConsts_NumTrans; x++)
+    {
+        if (((DirtyMask >> x) & 1) == 0)
+        {
+            continue;
+        }
+
+        // MurmurHash3's mix over words. FNV-1a a word at a time let changes to the top bits of two words cancel out,
+        // since its multiply only carries upwards, which is just where the odd pixel's red sits.
+        const uint32_t *const pWords = &pFrame[x * WordsPerXfer];
+        uint32_t Hash = 2166136261u;
+        for (size_t w = 0; w < WordsPerXfer; w++)
+        {
+            uint32_t Word = pWords[w] * 0xCC9E2D51u;
+            Word = (Word << 15) | (Word >> 17);
+            Hash ^= Word * 0x1B873593u;
+            Hash = (Hash << 13) | (Hash >> 19);
+            Hash = Hash * 5 + 0xE6546B64u;
+        }
+
+        if (((pPlan->SentMask >> x) & 1) && (pPlan->SentHash[x] == Hash))
+        {
+            Mask &= ~(1ull << x);
+            pPlan->NumHits++;
+        }
+        else
+        {
+            pPlan->SentHash[x] = Hash;
+            pPlan->NumMisses++;
+        }
+    }
+
+    pPlan->SentMask |= Mask;
+    return Mask;
+}
+
+// Runs of consecutive dirty transactions
+uint32_t Disp_Plan_CountBands(const uint64_t DirtyMask)
+{
+    return (uint32_t)__builtin_popcountll(DirtyMask & ~(DirtyMask << 1));
+}
+
+// Hands the dirty transactions over in order and returns how many there were
+uint32_t Disp_Plan_Queue(const uint64_t DirtyMask, fnDisp_PlanQueue_t fnQueue, void *pCtx)
+{
+    if (DirtyMask == 0)
+    {
+        return 0;
+    }
+
+    const size_t Last = 63 - (size_t)__builtin_clzll(DirtyMask);
+    uint32_t NumQueued = 0;
+
+    for (size_t x = 0; x <= Last; x++)
+    {
+        if (((DirtyMask >> x) & 1) == 0)
+        {
+            continue;
+        }
+
+        const Disp_PlanXfer_t Xfer = {
+            .Index = x,
+            .Addr = (uint32_t)(x * kDisp_FlushConsts_BytesPerXfer),
+            .IsLast = (x == Last),
+        };
+        fnQueue(pCtx, &Xfer);
+        NumQueued++;
+    }
+
+    return NumQueued;
+}
+
+// Copies the transactions that were sent from one RGB565 buffer to the other, one copy per band
+void Disp_Plan_SyncBands(const void *const pFrom, void *const pTo, const uint64_t DirtyMask)
+{
+    const uint8_t *const pSrc = (const uint8_t*)pFrom;
+    uint8_t *const pDst = (uint8_t*)pTo;
+
+    size_t x = 0;
+    while (x < kDisp_FlushConsts_NumTrans)
+    {
+        if (((DirtyMask >> x) & 1) == 0)
+        {
+            x++;
+            continue;
+        }
+
+        const size_t First = x;
+        while ((x < kDisp_FlushConsts_NumTrans) && (((DirtyMask >> x) & 1) != 0))
+        {
+            x++;
+        }
+
+        const size_t Offset = First * kDisp_FlushConsts_BytesPerXfer;
+        memcpy(&pDst[Offset], &pSrc[Offset], (x - First) * kDisp_FlushConsts_BytesPerXfer);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// Works out which transactions of an OSD flush go out and which of them ends the frame. The frame is cut into
+// fixed-size transactions, the invalidated rows select the ones to send, and the ones whose content hashes the same as
+// when last sent are dropped. The rest are handed to the caller in order, which queues them on the SPI device, and
+// only the last one is flagged to end the frame.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host flush check, which stands in for the SPI
+// driver.
+
+#include "osd_geometry.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Having some issue with floating point here so scale 9.6 10x
+typedef enum {
+    kDisp_FlushConsts_RowsPerXferX10 = 32,
+    kDisp_FlushConsts_NumTrans       = (kOSD_Height_px * 10) / kDisp_FlushConsts_RowsPerXferX10,
+    kDisp_FlushConsts_PixelsPerXfer  = (kOSD_Width_px * kDisp_FlushConsts_RowsPerXferX10) / 10,
+    kDisp_FlushConsts_BytesPerXfer   = kDisp_FlushConsts_PixelsPerXfer * 2,     // [bytes] RGB565
+    kDisp_FlushConsts_BytesPerFrame  = kDisp_FlushConsts_NumTrans * kDisp_FlushConsts_BytesPerXfer,
+
+    // Indexed mode only
+    kDisp_FlushConsts_IndexedDrawPixels = kOSD_Width_px * 24,   // LVGL's draw buffer, rendered areas are split to fit
+    kDisp_FlushConsts_NumBounceBufs     = 4,                    // Transactions expanded ahead of the DMA
+} Disp_FlushConsts_t;
+
+_Static_assert(kDisp_FlushConsts_NumTrans <= 64, "Dirty transactions are tracked in a 64-bit mask");
+
+typedef struct Disp_Plan {
+    uint32_t SentHash[kDisp_FlushConsts_NumTrans];     // Hash of what was last sent, valid where the bit in SentMask is set
+    uint64_t SentMask;
+    uint32_t NumHits;                                   // Invalidated transactions dropped because their content matched
+    uint32_t NumMisses;
+} Disp_Plan_t;
+
+typedef struct Disp_PlanXfer {
+    size_t Index;
+    uint32_t Addr;          // [bytes] Offset of the transaction in the frame, sent in the address phase
+    bool IsLast;            // Ends the frame, the only one whose completion has anything to do
+} Disp_PlanXfer_t;
+
+// Counted from the SPI post callback, which the driver runs in its ISR for every transaction
+typedef struct Disp_PlanDone {
+    uint32_t NumCallbacks;
+    uint32_t NumFrames;
+} Disp_PlanDone_t;
+
+typedef void (*fnDisp_PlanQueue_t)(void *pCtx, const Disp_PlanXfer_t *const pXfer);
+
+void Disp_Plan_Init(Disp_Plan_t *const pPlan);
+void Disp_Plan_Forget(Disp_Plan_t *const pPlan);
+uint64_t Disp_Plan_RowsToMask(int32_t y1, int32_t y2);
+uint64_t Disp_Plan_DropUnchanged(Disp_Plan_t *const pPlan, const uint32_t *const pFrame, const size_t WordsPerXfer, const uint64_t DirtyMask);
+uint32_t Disp_Plan_CountBands(const uint64_t DirtyMask);
+uint32_t Disp_Plan_Queue(const uint64_t DirtyMask, fnDisp_PlanQueue_t fnQueue, void *pCtx);
+void Disp_Plan_SyncBands(const void *const pFrom, void *const pTo, const uint64_t DirtyMask);
+
+// Transactions on one device complete in order, so the frame is done once the one flagged last is
+static inline bool Disp_Plan_OnTransDone(Disp_PlanDone_t *const pDone, const bool IsLast)
+{
+    pDone->NumCallbacks++;
+    pDone->NumFrames += IsLast ? 1 : 0;
+    return IsLast;
+}
@@ -0,0 +1,252 @@
+#include "disp_stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "argtable3/argtable3.h"
+#include "disp_flush.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "gfx.h"
+#endif
+
+enum {
+    kDumpBytesPerLine = 32,
+};
+
+typedef struct Window {
+    uint32_t Samples[kDisp_StatsConsts_Window];
+    uint32_t Count;             // Saturates at the window size
+    uint32_t Next;
+} Window_t;
+
+// Each probe is written by one task or the SPI ISR and read by the console. Samples are 32-bit so a reader never sees
+// a torn value, though a summary may straddle an update.
+static Window_t Windows[kNumDispProbes];
+static Window_t FrameDone_us;
+static uint32_t NumFrames;
+static uint32_t NumOverruns;
+
+static void WindowAdd(Window_t *const pWindow, const uint32_t Value);
+static void Summarize(const Window_t *const pWindow, Disp_ProbeSummary_t *const pSummary);
+static int CompareSamples(const void *pA, const void *pB);
+
+void Disp_Stats_Reset(void)
+{
+    memset(Windows, 0x0, sizeof(Windows));
+    memset(&FrameDone_us, 0x0, sizeof(FrameDone_us));
+    NumFrames = 0;
+    NumOverruns = 0;
+}
+
+void Disp_Stats_Record(const Disp_Probe_t eProbe, const uint32_t Value)
+{
+    if ((unsigned)eProbe < kNumDispProbes)
+    {
+        WindowAdd(&Windows[eProbe], Value);
+    }
+}
+
+void Disp_Stats_RecordFrame(const uint32_t Done_us, const uint32_t Frame_us)
+{
+    WindowAdd(&Windows[kDisp_Probe_Frame], Frame_us);
+    WindowAdd(&FrameDone_us, Done_us);
+
+    NumFrames++;
+    NumOverruns += (Frame_us > kDisp_StatsConsts_FrameBudget_us) ? 1 : 0;
+}
+
+void Disp_Stats_GetSummary(Disp_StatsSummary_t *const pSummary)
+{
+    if (pSummary == NULL)
+    {
+        return;
+    }
+
+    memset(pSummary, 0x0, sizeof(*pSummary));
+    pSummary->Version = kDisp_StatsConsts_Version;
+    pSummary->Size = sizeof(*pSummary);
+    pSummary->NumFrames = NumFrames;
+    pSummary->NumOverruns = NumOverruns;
+    pSummary->FrameBudget_us = kDisp_StatsConsts_FrameBudget_us;
+
+    for (size_t p = 0; p < kNumDispProbes; p++)
+    {
+        Summarize(&Windows[p], &pSummary->Probes[p]);
+    }
+
+    // Oldest to newest completion in the window, the subtraction is fine across the 32-bit wrap
+    const uint32_t Count = FrameDone_us.Count;
+    if (Count >= 2)
+    {
+        const uint32_t Newest = FrameDone_us.Samples[(FrameDone_us.Next + kDisp_StatsConsts_Window - 1) % kDisp_StatsConsts_Window];
+        const uint32_t Oldest = FrameDone_us.Samples[(Count < kDisp_StatsConsts_Window) ? 0 : FrameDone_us.Next];
+        const uint32_t Span_us = Newest - Oldest;
+        pSummary->FPS_x10 = (Span_us > 0) ? (uint32_t)(((uint64_t)(Count - 1) * 10000000u) / Span_us) : 0;
+    }
+}
+
+static void WindowAdd(Window_t *const pWindow, const uint32_t Value)
+{
+    pWindow->Samples[pWindow->Next] = Value;
+    pWindow->Next = (pWindow->Next + 1) % kDisp_StatsConsts_Window;
+    pWindow->Count += (pWindow->Count < kDisp_StatsConsts_Window) ? 1 : 0;
+}
+
+// Sorts a copy, which is fine for a console command but keeps this out of the recording path
+static void Summarize(const Window_t *const pWindow, Disp_ProbeSummary_t *const pSummary)
+{
+    uint32_t Sorted[kDisp_StatsConsts_Window];
+    const uint32_t Count = pWindow->Count;
+    if (Count == 0)
+    {
+        return;
+    }
+
+    memcpy(Sorted, pWindow->Samples, Count * sizeof(Sorted[0]));
+    qsort(Sorted, Count, sizeof(Sorted[0]), CompareSamples);
+
+    uint64_t Total = 0;
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        Total += Sorted[i];
+    }
+
+    // Nearest rank
+    const uint32_t Rank99 = (Count * 99 + 99) / 100;
+
+    pSummary->NumSamples = Count;
+    pSummary->Last = pWindow->Samples[(pWindow->Next + kDisp_StatsConsts_Window - 1) % kDisp_StatsConsts_Window];
+    pSummary->Min = Sorted[0];
+    pSummary->Max = Sorted[Count - 1];
+    pSummary->Avg = (uint32_t)(Total / Count);
+    pSummary->P99 = Sorted[Rank99 - 1];
+}
+
+static int CompareSamples(const void *pA, const void *pB)
+{
+    const uint32_t A = *(const uint32_t*)pA;
+    const uint32_t B = *(const uint32_t*)pB;
+    return (A > B) - (A < B);
+}
+
+#if defined(ESP_PLATFORM)
+static const char* TAG = "DispStats";
+
+static const char* ProbeNames[kNumDispProbes] = {
+    [kDisp_Probe_Update]        = "Update",
+    [kDisp_Probe_Render]        = "Render",
+    [kDisp_Probe_FlushSubmit]   = "Flush submit",
+    [kDisp_Probe_FlushComplete] = "Flush complete",
+    [kDisp_Probe_Frame]         = "Frame",
+    [kDisp_Probe_QueueDepth]    = "Queue depth",
+};
+
+static struct {
+    struct arg_lit *binary;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} disp_stats_args;
+
+static void PrintBinary(const Disp_StatsSummary_t *const pSummary)
+{
+    // One header line followed by hex lines, so a host script can rebuild the struct from a console capture
+    const uint8_t *const pBytes = (const uint8_t*)pSummary;
+    printf("DISP_STATS v%u %u\n", pSummary->Version, pSummary->Size);
+    for (size_t i = 0; i < sizeof(*pSummary); i++)
+    {
+        printf("%02X", pBytes[i]);
+        if (((i + 1) % kDumpBytesPerLine == 0) || (i + 1 == sizeof(*pSummary)))
+        {
+            printf("\n");
+        }
+    }
+}
+
+static void PrintText(const Disp_StatsSummary_t *const pSummary)
+{
+    printf("%-14s %7s %7s %7s %7s %7s %7s\n", "Stage (us)", "Samples", "Last", "Min", "Avg", "P99", "Max");
+    for (size_t p = 0; p < kNumDispProbes; p++)
+    {
+        const Disp_ProbeSummary_t *const pProbe = &pSummary->Probes[p];
+        printf("%-14s %7lu %7lu %7lu %7lu %7lu %7lu\n", ProbeNames[p], pProbe->NumSamples, pProbe->Last, pProbe->Min,
+            pProbe->Avg, pProbe->P99, pProbe->Max);
+    }
+
+    printf("Frames: %lu, %lu over the %lu us budget, %lu.%lu fps over the window\n", pSummary->NumFrames,
+        pSummary->NumOverruns, pSummary->FrameBudget_us, pSummary->FPS_x10 / 10, pSummary->FPS_x10 % 10);
+
+    const Disp_FlushStats_t *const pFlush = Disp_Flush_GetStats();
+    printf("Flush: %lu frames, %lu with nothing to send, %llu bytes sent, %llu saved, %s buffered\n", pFlush->NumFrames,
+        pFlush->NumFramesSkipped, pFlush->BytesSent, pFlush->BytesSaved, pFlush->IsDoubleBuffered ? "double" : "single");
+    printf("Transactions: %lu sent in %lu bands, %lu unchanged skipped, %lu post callbacks\n", pFlush->NumTrans,
+        pFlush->NumBands, pFlush->NumBandHits, pFlush->NumTransDone);
+
+    if (pFlush->IsIndexed)
+    {
+        printf("Palette: %u colors, %lu approximated, %lu resets\n", pFlush->NumPaletteColors, pFlush->NumPaletteApprox,
+            pFlush->NumPaletteResets);
+    }
+
+    const Gfx_RenderStats_t *const pRender = Gfx_GetRenderStats();
+    printf("Render task: %lu wakeups, %lu renders\n", pRender->NumWakeups, pRender->NumRenders);
+}
+
+static int disp_stats_command(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&disp_stats_args);
+    if (nerrors != 0)
+    {
+        arg_print_errors(stderr, disp_stats_args.end, argv[0]);
+        return 1;
+    }
+
+    Disp_StatsSummary_t Summary;
+    Disp_Stats_GetSummary(&Summary);
+
+    if (disp_stats_args.binary->count > 0)
+    {
+        PrintBinary(&Summary);
+    }
+    else
+    {
+        PrintText(&Summary);
+    }
+
+    if (disp_stats_args.reset->count > 0)
+    {
+        Disp_Stats_Reset();
+    }
+
+    return 0;
+}
+
+void Disp_Stats_RegisterCommands(void)
+{
+    disp_stats_args.binary = arg_lit0("b", "binary", "Dump the raw summary struct as hex");
+    disp_stats_args.reset = arg_lit0("r", "reset", "Clear the statistics after printing");
+    disp_stats_args.end = arg_end(2);
+
+    esp_console_cmd_t command = {
+        .command = "disp_stats",
+        .help = "Shows OSD render and flush timings, frame rate and budget overruns",
+        .func = &disp_stats_command,
+        .argtable = &disp_stats_args,
+    };
+
+    esp_err_t err;
+    if ((err = esp_console_cmd_register(&command)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Registering '%s' command failed: %s", command.command, esp_err_to_name(err));
+    }
+}
+#else
+void Disp_Stats_RegisterCommands(void)
+{
+}
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+// Timing probes along the OSD display pipeline. Each probe keeps its last kDisp_StatsConsts_Window samples, from
+// which the rolling minimum, maximum, average and 99th percentile are worked out on request, so recording stays
+// cheap enough for the SPI ISR. Frames taking longer than the budget are counted since the last reset.
+
+#include <stdint.h>
+
+typedef enum {
+    kDisp_Probe_Update,         // Render task wakeup until the frame is refreshed: inputs, widget draws, LVGL timers
+    kDisp_Probe_Render,         // LVGL rasterizing the invalidated areas
+    kDisp_Probe_FlushSubmit,    // Change check and queueing, including waiting for the other buffer when double buffered
+    kDisp_Probe_FlushComplete,  // First transaction queued until the last one is off the wire
+    kDisp_Probe_Frame,          // Render start until LVGL may render again, checked against the budget
+    kDisp_Probe_QueueDepth,     // [transactions] Queued to the SPI driver per frame
+
+    kNumDispProbes,
+} Disp_Probe_t;
+
+typedef enum {
+    kDisp_StatsConsts_Version        = 1,
+    kDisp_StatsConsts_Window         = 128,     // [samples]
+    kDisp_StatsConsts_FrameBudget_us = 16743,   // One Game Boy frame at 59.73 Hz
+} Disp_StatsConsts_t;
+
+// Over the samples in the window, [us] unless the probe says otherwise
+typedef struct Disp_ProbeSummary {
+    uint32_t NumSamples;
+    uint32_t Last;
+    uint32_t Min;
+    uint32_t Max;
+    uint32_t Avg;
+    uint32_t P99;
+} Disp_ProbeSummary_t;
+
+// Dumped as-is by `disp_stats -b`, so only ever append fields and bump the version when the layout changes
+typedef struct Disp_StatsSummary {
+    uint16_t Version;
+    uint16_t Size;
+
+    uint32_t NumFrames;                 // Since the last reset
+    uint32_t NumOverruns;               // Frames over the budget since the last reset
+    uint32_t FrameBudget_us;
+    uint32_t FPS_x10;                   // Frames completed over the window. The OSD renders on demand, so this is low when idle.
+
+    Disp_ProbeSummary_t Probes[kNumDispProbes];
+} Disp_StatsSummary_t;
+
+void Disp_Stats_Reset(void);
+void Disp_Stats_Record(const Disp_Probe_t eProbe, const uint32_t Value);
+void Disp_Stats_RecordFrame(const uint32_t Done_us, const uint32_t Frame_us);
+void Disp_Stats_GetSummary(Disp_StatsSummary_t *const pSummary);
+void Disp_Stats_RegisterCommands(void);
@@ -0,0 +1,163 @@
+#include "fpga_ack.h"
+
+#include "fpga_proto.h"
+#include "fpga_schema.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kAckedSeq_Valid = (1 << 8),     // Distinguishes sequence number 0 from no acknowledgement yet
+
+    kAckOffset_Addr = 0,
+    kAckOffset_Seq  = 1,
+    kAckLen         = 2,
+};
+
+void FPGA_Ack_Init(FPGA_AckTracker_t *const pTracker)
+{
+    if (pTracker == NULL)
+    {
+        return;
+    }
+
+    memset(pTracker, 0x0, sizeof(*pTracker));
+}
+
+uint8_t FPGA_Ack_Track(FPGA_AckTracker_t *const pTracker, const uint8_t Addr, const uint64_t Value, const uint32_t Now_ms)
+{
+    if ((pTracker == NULL) || (Addr >= kFPGA_AckConsts_NumCmds))
+    {
+        return 0;
+    }
+
+    // A single counter across commands means a newer write never reuses the sequence number of the one it replaces
+    FPGA_AckSlot_t *const pSlot = &pTracker->Slots[Addr];
+    pSlot->Value = Value;
+    pSlot->Seq = pTracker->NextSeq++;
+    pSlot->NumRetries = 0;
+    pSlot->Deadline_ms = Now_ms + kFPGA_AckConsts_Timeout;
+    pSlot->IsPending = true;
+
+    return pSlot->Seq;
+}
+
+void FPGA_Ack_OnAck(FPGA_AckTracker_t *const pTracker, const FPGA_Frame_t *const pFrame)
+{
+    if ((pTracker == NULL) || (pFrame == NULL) || (pFrame->Len < kAckLen))
+    {
+        return;
+    }
+
+    const uint8_t Addr = pFrame->pPayload[kAckOffset_Addr];
+    if (Addr < kFPGA_AckConsts_NumCmds)
+    {
+        pTracker->AckedSeq[Addr] = kAckedSeq_Valid | pFrame->pPayload[kAckOffset_Seq];
+    }
+}
+
+FPGA_AckResult_t FPGA_Ack_Poll(FPGA_AckTracker_t *const pTracker, const uint32_t Now_ms)
+{
+    FPGA_AckResult_t Result = { 0 };
+
+    if (pTracker == NULL)
+    {
+        return Result;
+    }
+
+    for (size_t i = 0; i < kFPGA_AckConsts_NumCmds; i++)
+    {
+        FPGA_AckSlot_t *const pSlot = &pTracker->Slots[i];
+        if (!pSlot->IsPending)
+        {
+            continue;
+        }
+
+        if (pTracker->AckedSeq[i] == (kAckedSeq_Valid | pSlot->Seq))
+        {
+            pSlot->IsPending = false;
+            Result.AckedMask |= (1u << i);
+            continue;
+        }
+
+        if ((int32_t)(Now_ms - pSlot->Deadline_ms) < 0)
+        {
+            continue;
+        }
+
+        if (pSlot->NumRetries >= kFPGA_AckConsts_MaxRetries)
+        {
+            pSlot->IsPending = false;
+            Result.GiveUpMask |= (1u << i);
+            continue;
+        }
+
+        pSlot->NumRetries++;
+        pSlot->Deadline_ms = Now_ms + ((uint32_t)kFPGA_AckConsts_Timeout << pSlot->NumRetries);
+        Result.ResendMask |= (1u << i);
+    }
+
+    return Result;
+}
+
+uint32_t FPGA_Ack_GetTimeout(const FPGA_AckTracker_t *const pTracker, const uint32_t Now_ms)
+{
+    uint32_t Timeout_ms = UINT32_MAX;
+
+    if (pTracker == NULL)
+    {
+        return Timeout_ms;
+    }
+
+    for (size_t i = 0; i < kFPGA_AckConsts_NumCmds; i++)
+    {
+        const FPGA_AckSlot_t *const pSlot = &pTracker->Slots[i];
+        if (pSlot->IsPending)
+        {
+            const int32_t Remaining_ms = (int32_t)(pSlot->Deadline_ms - Now_ms);
+            const uint32_t Wait_ms = (Remaining_ms > 0) ? (uint32_t)Remaining_ms : 0;
+            Timeout_ms = (Wait_ms < Timeout_ms) ? Wait_ms : Timeout_ms;
+        }
+    }
+
+    return Timeout_ms;
+}
+
+bool FPGA_Ack_IsIdle(const FPGA_AckTracker_t *const pTracker)
+{
+    if (pTracker == NULL)
+    {
+        return true;
+    }
+
+    for (size_t i = 0; i < kFPGA_AckConsts_NumCmds; i++)
+    {
+        if (pTracker->Slots[i].IsPending)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t FPGA_Ack_EncodeFrame(uint8_t *const pBuffer, const size_t Size, const uint8_t Addr, const uint64_t Value, const uint8_t Width, const uint8_t Seq)
+{
+    uint8_t Payload[sizeof(uint64_t) + 1];
+
+    if (Width > sizeof(uint64_t))
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < Width; i++)
+    {
+        Payload[i] = (uint8_t)(Value >> (8 * (Width - 1 - i)));
+    }
+    Payload[Width] = Seq;
+
+    // Sequenced writes only exist on V2 framing
+    return FPGA_Schema_EncodeFrame(pBuffer, Size, Addr, Payload, (uint8_t)(Width + 1), false);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Sequenced, acknowledged delivery of configuration writes, used once both ends negotiated kFPGA_LinkFeature_Ack.
+// Every cacheable write carries one sequence byte after its payload and the FPGA answers with ConfigAck holding the
+// address and sequence number once it applied the write. Unconfirmed writes are resent with exponential backoff
+// until they are acknowledged, superseded by a newer write to the same command, or given up on.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host FPGA simulator.
+
+#include "fpga_decode.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kFPGA_AckConsts_Timeout    = 20,    // [ms] Before the first resend, doubled for each one after
+    kFPGA_AckConsts_MaxRetries = 5,
+    kFPGA_AckConsts_NumCmds    = 16,    // Tx address space
+} FPGA_AckConsts_t;
+
+typedef struct FPGA_AckSlot {
+    uint64_t Value;
+    uint32_t Deadline_ms;
+    uint8_t Seq;
+    uint8_t NumRetries;
+    bool IsPending;
+} FPGA_AckSlot_t;
+
+// Outcome of a poll, one bit per command address
+typedef struct FPGA_AckResult {
+    uint32_t AckedMask;
+    uint32_t ResendMask;
+    uint32_t GiveUpMask;
+} FPGA_AckResult_t;
+
+// The Rx task records acknowledgements through FPGA_Ack_OnAck(), everything else belongs to the Tx task
+typedef struct FPGA_AckTracker {
+    volatile uint32_t AckedSeq[kFPGA_AckConsts_NumCmds];   // Last acknowledged sequence number, 0 if none
+
+    FPGA_AckSlot_t Slots[kFPGA_AckConsts_NumCmds];
+    uint8_t NextSeq;
+} FPGA_AckTracker_t;
+
+void FPGA_Ack_Init(FPGA_AckTracker_t *const pTracker);
+uint8_t FPGA_Ack_Track(FPGA_AckTracker_t *const pTracker, const uint8_t Addr, const uint64_t Value, const uint32_t Now_ms);
+void FPGA_Ack_OnAck(FPGA_AckTracker_t *const pTracker, const FPGA_Frame_t *const pFrame);
+FPGA_AckResult_t FPGA_Ack_Poll(FPGA_AckTracker_t *const pTracker, const uint32_t Now_ms);
+uint32_t FPGA_Ack_GetTimeout(const FPGA_AckTracker_t *const pTracker, const uint32_t Now_ms);
+bool FPGA_Ack_IsIdle(const FPGA_AckTracker_t *const pTracker);
+size_t FPGA_Ack_EncodeFrame(uint8_t *const pBuffer, const size_t Size, const uint8_t Addr, const uint64_t Value, const uint8_t Width, const uint8_t Seq);
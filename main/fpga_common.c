@@ -1,4 +1,6 @@
 #include "fpga_common.h"
+#include "fpga_stats.h"
+#include "fpga_tx.h"
 #include "freertos/task.h"
 
 #include <stddef.h>
@@ -6,6 +8,7 @@
 static TaskHandle_t TxTaskHandle = NULL;
 static TaskHandle_t RxTaskHandle = NULL;
 static bool IsV1 = false; // Default to V2
+static FPGA_Link_t Link;
 
 TaskHandle_t* FPGA_GetTxTaskHandle(void)
 {
@@ -17,6 +20,11 @@ TaskHandle_t* FPGA_GetRxTaskHandle(void)
     return &RxTaskHandle;
 }
 
+FPGA_Link_t* FPGA_GetLink(void)
+{
+    return &Link;
+}
+
 bool FPGA_IsProtoV1(void)
 {
     return IsV1;
@@ -24,5 +32,13 @@ bool FPGA_IsProtoV1(void)
 
 void FPGA_SetProtoV1(const bool V1)
 {
-    IsV1 = V1;
+    if (IsV1 != V1)
+    {
+        // The FPGA was swapped or reconfigured, so nothing it was previously sent can be trusted
+        IsV1 = V1;
+        FPGA_Stats_RecordProtoSwitch();
+        FPGA_Link_Reset(&Link);
+        FPGA_Tx_ForceResync();
+        FPGA_Tx_SendAll();
+    }
 }
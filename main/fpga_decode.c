@@ -0,0 +1,694 @@
+#include "fpga_decode.h"
+
+#include "crc8_sae_j1850.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_log.h"
+#else
+#define ESP_LOGE(tag, fmt, ...) ((void)(tag))
+#endif
+
+enum {
+    kV1FrameLen    = kSysMgmtConsts_MaxMsgProtoV1Len,
+    kV2HeaderLen   = 3,     // Marker, address and length
+    kV2LenOffset   = kSysMgmtConsts_MsgProtoV2MsgLenOffset,
+};
+
+#define WORD_LOW_BITS   0x01010101u
+#define WORD_HIGH_BITS  0x80808080u
+
+static const char* TAG = "FpgaDecode";
+
+static inline bool IsHeaderMarker(const uint8_t NextByte);
+static inline bool WordHasHeaderMarker(const uint32_t Word);
+static size_t FindHeaderMarker(FPGA_Decoder_t *const pDecoder, const uint8_t *const pData, size_t Start, const size_t Length);
+static void DeliverFrame(FPGA_Decoder_t *const pDecoder, const uint8_t *const pRaw);
+static void ResetState(FPGA_Decoder_t *const pDecoder);
+static void ReportError(FPGA_Decoder_t *const pDecoder, const FPGA_DecodeError_t eError, const uint8_t Addr);
+
+void FPGA_Decoder_Init(FPGA_Decoder_t *const pDecoder, fnFPGA_FrameHandler_t fnHandler, void* pArg)
+{
+    if (pDecoder == NULL)
+    {
+        return;
+    }
+
+    memset(pDecoder, 0x0, sizeof(*pDecoder));
+
+    pDecoder->fnHandler = fnHandler;
+    pDecoder->pHandlerArg = pArg;
+    pDecoder->eState = kFPGA_DecodeState_ScanForHeaderMarker;
+}
+
+void FPGA_Decoder_SetErrorHandler(FPGA_Decoder_t *const pDecoder, fnFPGA_DecodeErrorHandler_t fnOnError, void* pArg)
+{
+    if (pDecoder == NULL)
+    {
+        return;
+    }
+
+    pDecoder->fnOnError = fnOnError;
+    pDecoder->pErrorArg = pArg;
+}
+
+void FPGA_Decoder_Resync(FPGA_Decoder_t *const pDecoder)
+{
+    if (pDecoder == NULL)
+    {
+        return;
+    }
+
+    pDecoder->NumDiscardedBytes += pDecoder->BufferIndex;
+    ResetState(pDecoder);
+}
+
+size_t FPGA_Decoder_Feed(FPGA_Decoder_t *const pDecoder, const uint8_t *const pData, const size_t Length)
+{
+    if ((pDecoder == NULL) || (pData == NULL))
+    {
+        return 0;
+    }
+
+    const uint32_t StartFrames = pDecoder->NumFrames;
+    size_t i = 0;
+
+    // Finish off any frame that started in the previous chunk
+    while ((i < Length) && (pDecoder->eState != kFPGA_DecodeState_ScanForHeaderMarker))
+    {
+        (void) FPGA_Decoder_FeedByte(pDecoder, pData[i++]);
+    }
+
+    while (i < Length)
+    {
+        const size_t Start = FindHeaderMarker(pDecoder, pData, i, Length);
+        if (Start >= Length)
+        {
+            i = Length;
+            break;
+        }
+
+        const uint8_t *const pRaw = &pData[Start];
+        const size_t Remaining = Length - Start;
+
+        if (pRaw[0] == kSysMgmtConsts_HeaderV1Marker)
+        {
+            if (Remaining < kV1FrameLen)
+            {
+                i = Start;
+                break;
+            }
+
+            // Another V1 marker inside the frame means we did not receive a complete message. Like the byte
+            // state machine, drop everything up to and including that marker and start over.
+            size_t Abort = 0;
+            for (size_t k = 1; k < kV1FrameLen; k++)
+            {
+                if (pRaw[k] == kSysMgmtConsts_HeaderV1Marker)
+                {
+                    Abort = k;
+                    break;
+                }
+            }
+
+            if (Abort != 0)
+            {
+                i = Start + Abort + 1;
+                continue;
+            }
+
+            DeliverFrame(pDecoder, pRaw);
+            i = Start + kV1FrameLen;
+        }
+        else
+        {
+            if (Remaining < kV2HeaderLen)
+            {
+                i = Start;
+                break;
+            }
+
+            const uint8_t Len = pRaw[kV2LenOffset];
+            if (Len > kSysMgmtConsts_MsgProtoV2Len)
+            {
+                ESP_LOGE(TAG, "Msg for addr %d with len %d exceeds limit %d", pRaw[1], Len, kSysMgmtConsts_MsgProtoV2Len);
+                ReportError(pDecoder, kFPGA_DecodeError_OversizeLen, pRaw[1]);
+                i = Start + kV2HeaderLen;
+                continue;
+            }
+
+            // The payload state always consumes at least one byte, even for zero-length messages
+            const size_t FrameLen = kV2HeaderLen + ((Len == 0) ? 1 : Len) + 1;
+            if (Remaining < FrameLen)
+            {
+                i = Start;
+                break;
+            }
+
+            if (crc8_sae_j1850_decode(pRaw, FrameLen))
+            {
+                DeliverFrame(pDecoder, pRaw);
+            }
+            else
+            {
+                ESP_LOGE(TAG, "CRC check failed for addr=%02x", pRaw[1]);
+                ReportError(pDecoder, kFPGA_DecodeError_CRC, pRaw[1]);
+            }
+
+            i = Start + FrameLen;
+        }
+    }
+
+    // Whatever is left is the start of a frame that continues in the next chunk
+    while (i < Length)
+    {
+        (void) FPGA_Decoder_FeedByte(pDecoder, pData[i++]);
+    }
+
+    return (size_t)(pDecoder->NumFrames - StartFrames);
+}
+
+bool FPGA_Decoder_FeedByte(FPGA_Decoder_t *const pDecoder, const uint8_t NextByte)
+{
+    if (pDecoder == NULL)
+    {
+        return false;
+    }
+
+    switch (pDecoder->eState)
+    {
+        case kFPGA_DecodeState_ScanForHeaderMarker:
+            if (IsHeaderMarker(NextByte))
+            {
+                pDecoder->DecodeBuffer[0] = NextByte;
+                pDecoder->BufferIndex = 1;
+                pDecoder->MsgLen = 0;
+                pDecoder->RunningCRC = crc8_sae_j1850_update(crc8_sae_j1850_init(), NextByte);
+
+                if (NextByte == kSysMgmtConsts_HeaderV2Marker)
+                {
+                    pDecoder->eState = kFPGA_DecodeState_WaitForV2Addr;
+                }
+                else
+                {
+                    pDecoder->eState = kFPGA_DecodeState_WaitForFullV1Msg;
+                }
+            }
+            else
+            {
+                pDecoder->NumDiscardedBytes++;
+            }
+            break;
+
+        case kFPGA_DecodeState_WaitForFullV1Msg:
+            if (NextByte == kSysMgmtConsts_HeaderV1Marker)
+            {
+                // We did not receive a complete message. Start over.
+                ResetState(pDecoder);
+                break;
+            }
+
+            pDecoder->DecodeBuffer[pDecoder->BufferIndex++] = NextByte;
+            if (pDecoder->BufferIndex == kV1FrameLen)
+            {
+                ResetState(pDecoder);
+                DeliverFrame(pDecoder, pDecoder->DecodeBuffer);
+                return true;
+            }
+            break;
+        case kFPGA_DecodeState_WaitForV2Addr:
+            pDecoder->DecodeBuffer[pDecoder->BufferIndex++] = NextByte;
+            pDecoder->RunningCRC = crc8_sae_j1850_update(pDecoder->RunningCRC, NextByte);
+            pDecoder->eState = kFPGA_DecodeState_WaitForV2Len;
+            break;
+        case kFPGA_DecodeState_WaitForV2Len:
+            if (NextByte > kSysMgmtConsts_MsgProtoV2Len)
+            {
+                ESP_LOGE(TAG, "Msg for addr %d with len %d exceeds limit %d", pDecoder->DecodeBuffer[pDecoder->BufferIndex - 1], NextByte, kSysMgmtConsts_MsgProtoV2Len);
+                ReportError(pDecoder, kFPGA_DecodeError_OversizeLen, pDecoder->DecodeBuffer[pDecoder->BufferIndex - 1]);
+                ResetState(pDecoder);
+                break;
+            }
+            pDecoder->DecodeBuffer[pDecoder->BufferIndex++] = NextByte;
+            pDecoder->RunningCRC = crc8_sae_j1850_update(pDecoder->RunningCRC, NextByte);
+            pDecoder->MsgLen = NextByte;
+            pDecoder->eState = kFPGA_DecodeState_WaitForV2Payload;
+            break;
+        case kFPGA_DecodeState_WaitForV2Payload:
+            pDecoder->DecodeBuffer[pDecoder->BufferIndex++] = NextByte;
+            pDecoder->RunningCRC = crc8_sae_j1850_update(pDecoder->RunningCRC, NextByte);
+            if (pDecoder->BufferIndex > (uint32_t)(kV2LenOffset + pDecoder->MsgLen))
+            {
+                pDecoder->eState = kFPGA_DecodeState_WaitForV2CRC;
+            }
+            break;
+        case kFPGA_DecodeState_WaitForV2CRC:
+        {
+            pDecoder->DecodeBuffer[pDecoder->BufferIndex++] = NextByte;
+
+            // The CRC has been accumulated as the bytes arrived so only the final byte needs to be folded in
+            const bool IsValid = crc8_sae_j1850_is_valid(crc8_sae_j1850_update(pDecoder->RunningCRC, NextByte));
+            ResetState(pDecoder);
+
+            if (IsValid)
+            {
+                DeliverFrame(pDecoder, pDecoder->DecodeBuffer);
+                return true;
+            }
+
+            ESP_LOGE(TAG, "CRC check failed for addr=%02x", pDecoder->DecodeBuffer[1]);
+            ReportError(pDecoder, kFPGA_DecodeError_CRC, pDecoder->DecodeBuffer[1]);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return false;  // No valid message reconstructed yet
+}
+
+uint16_t FPGA_Frame_GetU16(const FPGA_Frame_t *const pFrame)
+{
+    if (pFrame == NULL)
+    {
+        return 0;
+    }
+
+    if (pFrame->Header == kSysMgmtConsts_HeaderV1Marker)
+    {
+        // V1 of the protocol has a weird quirk where only the lower 7-bits are used. I suspect it's because it
+        // keeps the header marker unique (0x8A) which has the most significant bit set.
+        return (uint16_t)((uint16_t)pFrame->pPayload[0] << 7 | pFrame->pPayload[1]);
+    }
+
+    // Missing bytes read as zero, matching the zero-filled message the decoder used to reconstruct
+    const uint8_t Hi = (pFrame->Len > 0) ? pFrame->pPayload[0] : 0;
+    const uint8_t Lo = (pFrame->Len > 1) ? pFrame->pPayload[1] : 0;
+
+    return (uint16_t)((uint16_t)Hi << 8 | Lo);
+}
+
+uint32_t FPGA_Frame_GetU32(const FPGA_Frame_t *const pFrame)
+{
+    if (pFrame == NULL)
+    {
+        return 0;
+    }
+
+    if (pFrame->Header == kSysMgmtConsts_HeaderV1Marker)
+    {
+        return ((uint32_t)pFrame->pPayload[0] << 8) | pFrame->pPayload[1];
+    }
+
+    // Little endian, as the payload was previously read through a uint32_t union member
+    uint32_t Value = 0;
+    const size_t Len = (pFrame->Len < sizeof(Value)) ? pFrame->Len : sizeof(Value);
+    for (size_t i = 0; i < Len; i++)
+    {
+        Value |= (uint32_t)pFrame->pPayload[i] << (8 * i);
+    }
+
+    return Value;
+}
+
+uint64_t FPGA_Frame_GetU64(const FPGA_Frame_t *const pFrame)
+{
+    if (pFrame == NULL)
+    {
+        return 0;
+    }
+
+    if (pFrame->Header == kSysMgmtConsts_HeaderV1Marker)
+    {
+        return ((uint64_t)pFrame->pPayload[0] << 8) | pFrame->pPayload[1];
+    }
+
+    // Big endian, as sent by the palette readback
+    uint64_t Value = 0;
+    const size_t Len = (pFrame->Len < sizeof(Value)) ? pFrame->Len : sizeof(Value);
+    for (size_t i = 0; i < Len; i++)
+    {
+        Value = (Value << 8) | pFrame->pPayload[i];
+    }
+
+    return Value;
+}
+
+static void DeliverFrame(FPGA_Decoder_t *const pDecoder, const uint8_t *const pRaw)
+{
+    FPGA_Frame_t Frame = {
+        .pRaw   = pRaw,
+        .Header = pRaw[0],
+        .Addr   = pRaw[1],
+    };
+
+    if (Frame.Header == kSysMgmtConsts_HeaderV1Marker)
+    {
+        Frame.Len = kSysMgmtConsts_MsgProtoV1Len;
+        Frame.pPayload = &pRaw[2];
+    }
+    else
+    {
+        Frame.Len = pRaw[kV2LenOffset];
+        Frame.pPayload = &pRaw[kV2HeaderLen];
+    }
+
+    pDecoder->NumFrames++;
+
+    if (pDecoder->fnHandler != NULL)
+    {
+        pDecoder->fnHandler(&Frame, pDecoder->pHandlerArg);
+    }
+}
+
+static void ResetState(FPGA_Decoder_t *const pDecoder)
+{
+    pDecoder->eState = kFPGA_DecodeState_ScanForHeaderMarker;
+    pDecoder->BufferIndex = 0;
+}
+
+static void ReportError(FPGA_Decoder_t *const pDecoder, const FPGA_DecodeError_t eError, const uint8_t Addr)
+{
+    if (eError == kFPGA_DecodeError_CRC)
+    {
+        pDecoder->NumCRCErrors++;
+    }
+    else
+    {
+        pDecoder->NumOversizeLen++;
+    }
+
+    if (pDecoder->fnOnError != NULL)
+    {
+        pDecoder->fnOnError(eError, Addr, pDecoder->pErrorArg);
+    }
+}
+
+static size_t FindHeaderMarker(FPGA_Decoder_t *const pDecoder, const uint8_t *const pData, size_t Start, const size_t Length)
+{
+    size_t i = Start;
+
+    // Walk up to a word boundary so the word loads below are aligned
+    while ((i < Length) && (((uintptr_t)&pData[i] & (sizeof(uint32_t) - 1)) != 0))
+    {
+        if (IsHeaderMarker(pData[i]))
+        {
+            pDecoder->NumDiscardedBytes += (uint32_t)(i - Start);
+            return i;
+        }
+        i++;
+    }
+
+    while ((i + sizeof(uint32_t)) <= Length)
+    {
+        uint32_t Word;
+        memcpy(&Word, &pData[i], sizeof(Word));
+
+        if (WordHasHeaderMarker(Word))
+        {
+            // The word test can flag a false positive, so confirm byte by byte
+            for (size_t k = 0; k < sizeof(Word); k++)
+            {
+                if (IsHeaderMarker(pData[i + k]))
+                {
+                    pDecoder->NumDiscardedBytes += (uint32_t)(i + k - Start);
+                    return i + k;
+                }
+            }
+        }
+
+        i += sizeof(Word);
+    }
+
+    while (i < Length)
+    {
+        if (IsHeaderMarker(pData[i]))
+        {
+            pDecoder->NumDiscardedBytes += (uint32_t)(i - Start);
+            return i;
+        }
+        i++;
+    }
+
+    pDecoder->NumDiscardedBytes += (uint32_t)(Length - Start);
+    return Length;
+}
+
+static inline bool WordHasHeaderMarker(const uint32_t Word)
+{
+    // Both markers have the most significant bit set, which the 7-bit V1 data and most payload bytes never do
+    if ((Word & WORD_HIGH_BITS) == 0)
+    {
+        return false;
+    }
+
+    // Classic "has zero byte" test applied to the word XOR'd with each marker
+    const uint32_t V1 = Word ^ (WORD_LOW_BITS * kSysMgmtConsts_HeaderV1Marker);
+    const uint32_t V2 = Word ^ (WORD_LOW_BITS * kSysMgmtConsts_HeaderV2Marker);
+
+    return ((((V1 - WORD_LOW_BITS) & ~V1) | ((V2 - WORD_LOW_BITS) & ~V2)) & WORD_HIGH_BITS) != 0;
+}
+
+static inline bool IsHeaderMarker(const uint8_t NextByte)
+{
+    return ((NextByte == kSysMgmtConsts_HeaderV1Marker) || (NextByte == kSysMgmtConsts_HeaderV2Marker));
+}
+
+// Host-side throughput benchmark comparing the block scanner against the byte state machine.
+// Build and run with:
+//   gcc -O2 -DFPGA_DECODE_BENCHMARK -I../components/crc fpga_decode.c ../components/crc/crc8_sae_j1850.c -o fpga_decode_bench
+//   ./fpga_decode_bench [recorded_uart_capture.bin]
+#if defined(FPGA_DECODE_BENCHMARK)
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum {
+    kBenchNumFrames = 200000,
+    kBenchRepeats   = 10,
+};
+
+typedef struct BenchDigest {
+    uint32_t NumFrames;
+    uint32_t Hash;
+} BenchDigest_t;
+
+typedef struct BenchStream {
+    const char* Name;
+    uint8_t* pData;
+    size_t Length;
+} BenchStream_t;
+
+static void BenchHandler(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    BenchDigest_t *const pDigest = (BenchDigest_t*)pArg;
+
+    // FNV-1a over everything a message handler can observe
+    uint32_t Hash = pDigest->Hash ^ pFrame->Header;
+    Hash = (Hash ^ pFrame->Addr) * 16777619u;
+    Hash = (Hash ^ pFrame->Len) * 16777619u;
+    Hash = (Hash ^ FPGA_Frame_GetU16(pFrame)) * 16777619u;
+    Hash = (Hash ^ FPGA_Frame_GetU32(pFrame)) * 16777619u;
+    for (size_t i = 0; (pFrame->Header == kSysMgmtConsts_HeaderV2Marker) && (i < pFrame->Len); i++)
+    {
+        Hash = (Hash ^ pFrame->pPayload[i]) * 16777619u;
+    }
+
+    pDigest->Hash = Hash;
+    pDigest->NumFrames++;
+}
+
+static size_t BenchAppendV2(uint8_t *const pOut, const uint8_t Addr, const uint8_t Len)
+{
+    pOut[0] = kSysMgmtConsts_HeaderV2Marker;
+    pOut[1] = Addr;
+    pOut[2] = Len;
+    for (size_t i = 0; i < Len; i++)
+    {
+        pOut[kV2HeaderLen + i] = (uint8_t)rand();
+    }
+
+    return crc8_sae_j1850_encode(pOut, kV2HeaderLen + Len, pOut);
+}
+
+static size_t BenchAppendV1(uint8_t *const pOut, const uint8_t Addr)
+{
+    pOut[0] = kSysMgmtConsts_HeaderV1Marker;
+    pOut[1] = Addr;
+    pOut[2] = (uint8_t)(rand() & 0x7F);
+    pOut[3] = (uint8_t)(rand() & 0x7F);
+    return kV1FrameLen;
+}
+
+// Traffic mix seen on a running unit: buttons, voltages, audio/brightness, PMIC, StatusExtended and palettes
+static size_t BenchSynthesize(uint8_t *const pOut, const size_t NumFrames, const bool UseV1)
+{
+    static const uint8_t Addrs[] = {0x0, 0x1, 0x2, 0x2, 0x2, 0x3, 0x5, 0x6, 0x8, 0x9};
+    size_t Length = 0;
+
+    for (size_t n = 0; n < NumFrames; n++)
+    {
+        const uint8_t Addr = Addrs[rand() % sizeof(Addrs)];
+
+        if (UseV1)
+        {
+            Length += BenchAppendV1(&pOut[Length], Addr);
+        }
+        else
+        {
+            const uint8_t Len = (Addr == 0x9) ? 8 : ((Addr == 0x8) ? 4 : 2);
+            Length += BenchAppendV2(&pOut[Length], Addr, Len);
+        }
+
+        // Occasional idle-line garbage between frames
+        if ((rand() % 16) == 0)
+        {
+            pOut[Length++] = (uint8_t)(rand() & 0x7F);
+        }
+    }
+
+    return Length;
+}
+
+static size_t BenchCorrupt(uint8_t *const pOut, const uint8_t *const pIn, const size_t Length)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < Length; i++)
+    {
+        const int Roll = rand() % 1000;
+        if (Roll < 3)
+        {
+            continue;  // Dropped byte
+        }
+        else if (Roll < 6)
+        {
+            pOut[o++] = (rand() & 1) ? kSysMgmtConsts_HeaderV1Marker : kSysMgmtConsts_HeaderV2Marker;  // Spurious marker
+        }
+        else if (Roll < 9)
+        {
+            pOut[o++] = (uint8_t)(pIn[i] ^ (1u << (rand() % 8)));  // Bit flip
+            continue;
+        }
+
+        pOut[o++] = pIn[i];
+    }
+
+    return o;
+}
+
+static double BenchRun(const BenchStream_t *const pStream, const bool UseBlocks, BenchDigest_t *const pDigest, FPGA_Decoder_t *const pDecoder)
+{
+    const clock_t Start = clock();
+
+    for (size_t r = 0; r < kBenchRepeats; r++)
+    {
+        memset(pDigest, 0x0, sizeof(*pDigest));
+        FPGA_Decoder_Init(pDecoder, BenchHandler, pDigest);
+
+        // Chunk sizes vary like uart_read_bytes() results so that frames regularly straddle chunks
+        srand(8);
+        size_t i = 0;
+        while (i < pStream->Length)
+        {
+            size_t Chunk = 1 + (rand() % kSysMgmtConsts_RxBufferSize);
+            if (Chunk > (pStream->Length - i))
+            {
+                Chunk = pStream->Length - i;
+            }
+
+            if (UseBlocks)
+            {
+                (void) FPGA_Decoder_Feed(pDecoder, &pStream->pData[i], Chunk);
+            }
+            else
+            {
+                for (size_t k = 0; k < Chunk; k++)
+                {
+                    (void) FPGA_Decoder_FeedByte(pDecoder, pStream->pData[i + k]);
+                }
+            }
+
+            i += Chunk;
+        }
+    }
+
+    return (double)(clock() - Start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t MaxLength = (size_t)kBenchNumFrames * (kSysMgmtConsts_MaxMsgProtoV2Len + 1);
+    BenchStream_t Streams[4] = {0};
+    size_t NumStreams = 0;
+
+    srand(1);
+    uint8_t *const pSynthetic = malloc(MaxLength);
+    Streams[NumStreams++] = (BenchStream_t){ "synthetic-v2", pSynthetic, BenchSynthesize(pSynthetic, kBenchNumFrames, false) };
+
+    uint8_t *const pCorrupt = malloc(MaxLength * 2);
+    Streams[NumStreams++] = (BenchStream_t){ "corrupted-v2", pCorrupt, BenchCorrupt(pCorrupt, pSynthetic, Streams[0].Length) };
+
+    uint8_t *const pV1 = malloc(MaxLength);
+    Streams[NumStreams++] = (BenchStream_t){ "synthetic-v1", pV1, BenchSynthesize(pV1, kBenchNumFrames, true) };
+
+    if (argc > 1)
+    {
+        FILE* pFile = fopen(argv[1], "rb");
+        if (pFile == NULL)
+        {
+            printf("Cannot open %s\n", argv[1]);
+            return 1;
+        }
+
+        fseek(pFile, 0, SEEK_END);
+        const long Size = ftell(pFile);
+        fseek(pFile, 0, SEEK_SET);
+
+        uint8_t *const pRecorded = malloc((Size > 0) ? (size_t)Size : 1);
+        const size_t Read = fread(pRecorded, 1, (Size > 0) ? (size_t)Size : 0, pFile);
+        fclose(pFile);
+
+        Streams[NumStreams++] = (BenchStream_t){ "recorded", pRecorded, Read };
+    }
+
+    int failures = 0;
+    for (size_t s = 0; s < NumStreams; s++)
+    {
+        BenchDigest_t ByteDigest, BlockDigest;
+        FPGA_Decoder_t ByteDecoder, BlockDecoder;
+
+        const double Byte_s = BenchRun(&Streams[s], false, &ByteDigest, &ByteDecoder);
+        const double Block_s = BenchRun(&Streams[s], true, &BlockDigest, &BlockDecoder);
+
+        const bool Match = (ByteDigest.NumFrames == BlockDigest.NumFrames) &&
+                           (ByteDigest.Hash == BlockDigest.Hash) &&
+                           (ByteDecoder.NumCRCErrors == BlockDecoder.NumCRCErrors) &&
+                           (ByteDecoder.NumOversizeLen == BlockDecoder.NumOversizeLen) &&
+                           (ByteDecoder.NumDiscardedBytes == BlockDecoder.NumDiscardedBytes);
+
+        const double MBytes = (double)Streams[s].Length * kBenchRepeats / (1024.0 * 1024.0);
+        printf("%-14s %8zu bytes %7u frames %5u crc %5u len %6u skipped | byte %7.1f MB/s  block %7.1f MB/s  %s\n",
+            Streams[s].Name, Streams[s].Length, BlockDigest.NumFrames, BlockDecoder.NumCRCErrors,
+            BlockDecoder.NumOversizeLen, BlockDecoder.NumDiscardedBytes,
+            (Byte_s > 0) ? MBytes / Byte_s : 0.0, (Block_s > 0) ? MBytes / Block_s : 0.0,
+            Match ? "match" : "MISMATCH");
+
+        if (!Match)
+        {
+            failures++;
+        }
+    }
+
+    for (size_t s = 0; s < NumStreams; s++)
+    {
+        free(Streams[s].pData);
+    }
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+    return (failures == 0) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "fpga_proto.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kFPGA_DecodeState_ScanForHeaderMarker,
+    kFPGA_DecodeState_WaitForFullV1Msg,
+
+    kFPGA_DecodeState_WaitForV2Addr,
+    kFPGA_DecodeState_WaitForV2Len,
+    kFPGA_DecodeState_WaitForV2Payload,
+    kFPGA_DecodeState_WaitForV2CRC,
+} FPGA_DecodeState_t;
+
+// A validated frame. All pointers reference the caller's receive buffer (or the decoder's own buffer for frames
+// that straddled two chunks) and are only valid for the duration of the handler call.
+typedef struct FPGA_Frame {
+    const uint8_t* pRaw;        // Header marker onwards, including the trailing CRC for V2
+    const uint8_t* pPayload;    // First payload byte
+    uint8_t Header;
+    uint8_t Addr;
+    uint8_t Len;                // Payload length in bytes
+} FPGA_Frame_t;
+
+typedef void (*fnFPGA_FrameHandler_t)(const FPGA_Frame_t *const pFrame, void* pArg);
+
+typedef enum {
+    kFPGA_DecodeError_CRC,
+    kFPGA_DecodeError_OversizeLen,
+} FPGA_DecodeError_t;
+
+typedef void (*fnFPGA_DecodeErrorHandler_t)(const FPGA_DecodeError_t eError, const uint8_t Addr, void* pArg);
+
+typedef struct FPGA_Decoder {
+    fnFPGA_FrameHandler_t fnHandler;
+    void* pHandlerArg;
+    fnFPGA_DecodeErrorHandler_t fnOnError;
+    void* pErrorArg;
+
+    // Byte state machine used for frames that span chunk boundaries
+    FPGA_DecodeState_t eState;
+    uint8_t DecodeBuffer[kSysMgmtConsts_MaxMsgProtoV2Len];
+    uint32_t BufferIndex;
+    uint8_t MsgLen;
+    uint8_t RunningCRC;
+
+    uint32_t NumFrames;
+    uint32_t NumCRCErrors;
+    uint32_t NumOversizeLen;
+    uint32_t NumDiscardedBytes;
+} FPGA_Decoder_t;
+
+void FPGA_Decoder_Init(FPGA_Decoder_t *const pDecoder, fnFPGA_FrameHandler_t fnHandler, void* pArg);
+void FPGA_Decoder_SetErrorHandler(FPGA_Decoder_t *const pDecoder, fnFPGA_DecodeErrorHandler_t fnOnError, void* pArg);
+void FPGA_Decoder_Resync(FPGA_Decoder_t *const pDecoder);
+size_t FPGA_Decoder_Feed(FPGA_Decoder_t *const pDecoder, const uint8_t *const pData, const size_t Length);
+bool FPGA_Decoder_FeedByte(FPGA_Decoder_t *const pDecoder, const uint8_t NextByte);
+
+uint16_t FPGA_Frame_GetU16(const FPGA_Frame_t *const pFrame);
+uint32_t FPGA_Frame_GetU32(const FPGA_Frame_t *const pFrame);
+uint64_t FPGA_Frame_GetU64(const FPGA_Frame_t *const pFrame);
@@ -0,0 +1,313 @@
+#include "fpga_link.h"
+
+#include "fpga_proto.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kCapsOffset_ProtoVersion = 2,
+    kCapsOffset_BaudMask     = 3,
+    kCapsOffset_Features     = 4,
+};
+
+const uint32_t FPGA_BaudRates[kNumFPGA_Bauds] = {
+    [kFPGA_Baud_115200]  = kSysMgmtConsts_DefaultBaudRate,
+    [kFPGA_Baud_230400]  = 230400,
+    [kFPGA_Baud_460800]  = 460800,
+    [kFPGA_Baud_921600]  = 921600,
+    [kFPGA_Baud_2000000] = 2000000,
+};
+
+static FPGA_LinkAction_t Fallback(FPGA_Link_t *const pLink);
+static FPGA_Baud_t GetBestCommonBaud(const FPGA_Link_t *const pLink);
+static uint32_t GetRemaining(const uint32_t Deadline_ms, const uint32_t Now_ms);
+
+void FPGA_Link_Init(FPGA_Link_t *const pLink, const uint32_t MaxBaudRate, const uint8_t Features)
+{
+    if (pLink == NULL)
+    {
+        return;
+    }
+
+    memset(pLink, 0x0, sizeof(*pLink));
+
+    pLink->LocalBaudMask = (1 << kFPGA_Baud_115200);
+    for (size_t i = 0; i < kNumFPGA_Bauds; i++)
+    {
+        if (FPGA_BaudRates[i] <= MaxBaudRate)
+        {
+            pLink->LocalBaudMask |= (uint8_t)(1 << i);
+        }
+    }
+
+    pLink->LocalFeatures = Features;
+    pLink->eState = kFPGA_LinkState_Default;
+    pLink->eBaud = kFPGA_Baud_115200;
+}
+
+void FPGA_Link_Reset(FPGA_Link_t *const pLink)
+{
+    if (pLink == NULL)
+    {
+        return;
+    }
+
+    pLink->ResetRequested = true;
+}
+
+uint16_t FPGA_Link_GetCapsRequest(const FPGA_Link_t *const pLink)
+{
+    if (pLink == NULL)
+    {
+        return 0;
+    }
+
+    return (uint16_t)(kFPGA_LinkConsts_CapsRequest | (pLink->LocalBaudMask & ~pLink->FailedBaudMask));
+}
+
+uint16_t FPGA_Link_GetLinkCtl(const FPGA_Link_t *const pLink)
+{
+    if (pLink == NULL)
+    {
+        return 0;
+    }
+
+    return (uint16_t)((kFPGA_LinkConsts_SetBaud << 8) | pLink->eBaud);
+}
+
+// Sent before the MCU goes quiet for longer than kFPGA_LinkConsts_LinkLoss, so that the FPGA doesn't have to time out
+uint16_t FPGA_Link_GetRevertCtl(void)
+{
+    return (uint16_t)((kFPGA_LinkConsts_SetBaud << 8) | kFPGA_Baud_115200);
+}
+
+uint32_t FPGA_Link_GetBaudRate(const FPGA_Link_t *const pLink)
+{
+    if (pLink == NULL)
+    {
+        return kSysMgmtConsts_DefaultBaudRate;
+    }
+
+    return FPGA_BaudRates[pLink->eBaud];
+}
+
+bool FPGA_Link_HasFeature(const FPGA_Link_t *const pLink, const FPGA_LinkFeature_t eFeature)
+{
+    if (pLink == NULL)
+    {
+        return false;
+    }
+
+    const uint8_t RemoteFeatures = (uint8_t)(pLink->RemoteCaps & 0xFF);
+    return ((pLink->LocalFeatures & RemoteFeatures & eFeature) != 0);
+}
+
+void FPGA_Link_OnFWVer(FPGA_Link_t *const pLink, const FPGA_Frame_t *const pFrame)
+{
+    if ((pLink == NULL) || (pFrame == NULL))
+    {
+        return;
+    }
+
+    uint32_t Caps = 0;
+    if ((pFrame->Header == kSysMgmtConsts_HeaderV2Marker) && (pFrame->Len >= kFPGA_LinkConsts_CapsLen) &&
+        (pFrame->pPayload[kCapsOffset_ProtoVersion] >= kFPGA_LinkConsts_ProtoVersion))
+    {
+        Caps = ((uint32_t)pFrame->pPayload[kCapsOffset_ProtoVersion] << 16) |
+               ((uint32_t)pFrame->pPayload[kCapsOffset_BaudMask] << 8) |
+               pFrame->pPayload[kCapsOffset_Features];
+    }
+
+    pLink->RemoteCaps = Caps;
+    pLink->NumReplies++;
+}
+
+void FPGA_Link_OnCRCError(FPGA_Link_t *const pLink)
+{
+    if (pLink == NULL)
+    {
+        return;
+    }
+
+    pLink->NumCRCErrors++;
+}
+
+FPGA_LinkAction_t FPGA_Link_Poll(FPGA_Link_t *const pLink, const uint32_t Now_ms)
+{
+    if (pLink == NULL)
+    {
+        return kFPGA_LinkAction_None;
+    }
+
+    const uint32_t NumReplies = pLink->NumReplies;
+    const uint32_t NumCRCErrors = pLink->NumCRCErrors;
+
+    if (pLink->ResetRequested)
+    {
+        // The FPGA was reconfigured and is back at its power-on rate, with capabilities that may have changed.
+        // Rates that failed before stay excluded since the board, not the bitstream, decides what holds up.
+        pLink->ResetRequested = false;
+        pLink->RemoteCaps = 0;
+        pLink->RepliesSeen = NumReplies;
+        pLink->CRCErrorsSeen = NumCRCErrors;
+        pLink->eState = kFPGA_LinkState_Default;
+
+        if (pLink->eBaud != kFPGA_Baud_115200)
+        {
+            pLink->eBaud = kFPGA_Baud_115200;
+            return kFPGA_LinkAction_Revert;
+        }
+
+        return kFPGA_LinkAction_None;
+    }
+
+    switch (pLink->eState)
+    {
+        case kFPGA_LinkState_Default:
+        {
+            if (NumReplies == pLink->RepliesSeen)
+            {
+                break;
+            }
+            pLink->RepliesSeen = NumReplies;
+
+            const FPGA_Baud_t eBest = GetBestCommonBaud(pLink);
+            if (eBest == pLink->eBaud)
+            {
+                break;
+            }
+
+            pLink->eBaud = eBest;
+            pLink->eState = kFPGA_LinkState_Confirming;
+            pLink->Deadline_ms = Now_ms + kFPGA_LinkConsts_ConfirmTimeout;
+            return kFPGA_LinkAction_SwitchBaud;
+        }
+
+        case kFPGA_LinkState_Confirming:
+            if (NumReplies != pLink->RepliesSeen)
+            {
+                // Any reply decoded at the new rate proves both ends moved
+                pLink->RepliesSeen = NumReplies;
+                pLink->CRCErrorsSeen = NumCRCErrors;
+                pLink->eState = kFPGA_LinkState_Negotiated;
+                pLink->Deadline_ms = Now_ms + kFPGA_LinkConsts_ErrorWindow;
+                pLink->LastReply_ms = Now_ms;
+                pLink->NextKeepAlive_ms = Now_ms + kFPGA_LinkConsts_KeepAlive;
+                break;
+            }
+
+            if ((int32_t)(Now_ms - pLink->Deadline_ms) >= 0)
+            {
+                return Fallback(pLink);
+            }
+            break;
+
+        case kFPGA_LinkState_Negotiated:
+            if (NumReplies != pLink->RepliesSeen)
+            {
+                pLink->RepliesSeen = NumReplies;
+                pLink->LastReply_ms = Now_ms;
+            }
+
+            if (((NumCRCErrors - pLink->CRCErrorsSeen) >= kFPGA_LinkConsts_MaxErrors) ||
+                ((Now_ms - pLink->LastReply_ms) >= kFPGA_LinkConsts_LinkLoss))
+            {
+                return Fallback(pLink);
+            }
+
+            if ((int32_t)(Now_ms - pLink->Deadline_ms) >= 0)
+            {
+                pLink->CRCErrorsSeen = NumCRCErrors;
+                pLink->Deadline_ms = Now_ms + kFPGA_LinkConsts_ErrorWindow;
+            }
+
+            if ((int32_t)(Now_ms - pLink->NextKeepAlive_ms) >= 0)
+            {
+                pLink->NextKeepAlive_ms = Now_ms + kFPGA_LinkConsts_KeepAlive;
+                return kFPGA_LinkAction_KeepAlive;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return kFPGA_LinkAction_None;
+}
+
+// Time until FPGA_Link_Poll() has something to do, UINT32_MAX if only a report from the Rx task can change that
+uint32_t FPGA_Link_GetTimeout(const FPGA_Link_t *const pLink, const uint32_t Now_ms)
+{
+    if (pLink == NULL)
+    {
+        return UINT32_MAX;
+    }
+
+    if (pLink->ResetRequested || (pLink->NumReplies != pLink->RepliesSeen))
+    {
+        return 0;
+    }
+
+    switch (pLink->eState)
+    {
+        case kFPGA_LinkState_Confirming:
+            return GetRemaining(pLink->Deadline_ms, Now_ms);
+
+        case kFPGA_LinkState_Negotiated:
+        {
+            const uint32_t Window_ms = GetRemaining(pLink->Deadline_ms, Now_ms);
+            const uint32_t KeepAlive_ms = GetRemaining(pLink->NextKeepAlive_ms, Now_ms);
+            const uint32_t Loss_ms = GetRemaining(pLink->LastReply_ms + kFPGA_LinkConsts_LinkLoss, Now_ms);
+            const uint32_t Timeout_ms = (Window_ms < KeepAlive_ms) ? Window_ms : KeepAlive_ms;
+            return (Loss_ms < Timeout_ms) ? Loss_ms : Timeout_ms;
+        }
+
+        default:
+            // Waiting for a capability reply, which the Rx task reports
+            return UINT32_MAX;
+    }
+}
+
+static FPGA_LinkAction_t Fallback(FPGA_Link_t *const pLink)
+{
+    // Never retry a rate that failed, the next capability reply negotiates the next one down
+    pLink->FailedBaudMask |= (uint8_t)(1 << pLink->eBaud);
+    pLink->eBaud = kFPGA_Baud_115200;
+    pLink->eState = kFPGA_LinkState_Default;
+    pLink->RepliesSeen = pLink->NumReplies;
+    pLink->CRCErrorsSeen = pLink->NumCRCErrors;
+    pLink->NumFallbacks++;
+
+    return kFPGA_LinkAction_Fallback;
+}
+
+static uint32_t GetRemaining(const uint32_t Deadline_ms, const uint32_t Now_ms)
+{
+    const int32_t Remaining_ms = (int32_t)(Deadline_ms - Now_ms);
+    return (Remaining_ms > 0) ? (uint32_t)Remaining_ms : 0;
+}
+
+static FPGA_Baud_t GetBestCommonBaud(const FPGA_Link_t *const pLink)
+{
+    const uint32_t Caps = pLink->RemoteCaps;
+    if (Caps == 0)
+    {
+        return kFPGA_Baud_115200;
+    }
+
+    const uint8_t RemoteBaudMask = (uint8_t)((Caps >> 8) & 0xFF);
+    const uint8_t Common = pLink->LocalBaudMask & RemoteBaudMask & (uint8_t)~pLink->FailedBaudMask;
+
+    for (int i = kNumFPGA_Bauds - 1; i > kFPGA_Baud_115200; i--)
+    {
+        if ((Common & (1 << i)) != 0)
+        {
+            return (FPGA_Baud_t)i;
+        }
+    }
+
+    return kFPGA_Baud_115200;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+// Protocol V3 capability handshake and baud rate negotiation. Layered on the V2 framing: the MCU advertises its
+// capabilities in the ReqFWVer payload, a V3 FPGA answers with an extended FWVer frame, and the MCU then moves
+// both ends to the fastest common rate with LinkCtl. FPGAs that predate V3 ignore the payload and answer with the
+// plain two byte version, so the link simply stays at the default rate.
+//
+// While at a negotiated rate the MCU sends ReqFWVer as a keepalive. The FPGA returns to the default rate when it
+// receives LinkCtl for rate 0 or decodes nothing for kFPGA_LinkConsts_LinkLoss, and the MCU does the same when its
+// keepalives go unanswered or CRC errors pile up, never retrying a rate that failed.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host FPGA simulator.
+
+#include "fpga_decode.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kFPGA_LinkConsts_ProtoVersion     = 3,
+    kFPGA_LinkConsts_CapsRequest      = (1 << 15),  // ReqFWVer payload flag, the low byte is the MCU's baud mask
+    kFPGA_LinkConsts_CapsLen          = 5,          // [bytes] Extended FWVer: version, proto version, baud mask, features
+    kFPGA_LinkConsts_ConfirmTimeout   = 250,        // [ms] Time the FPGA has to answer at a new rate
+    kFPGA_LinkConsts_KeepAlive        = 200,        // [ms]
+    kFPGA_LinkConsts_LinkLoss         = 1000,       // [ms] Silence at a negotiated rate before either end reverts
+    kFPGA_LinkConsts_ErrorWindow      = 1000,       // [ms]
+    kFPGA_LinkConsts_MaxErrors        = 4,          // CRC errors per window before falling back
+    kFPGA_LinkConsts_SetBaud          = 0x01,       // LinkCtl command, sent in the high byte with the rate index below it
+} FPGA_LinkConsts_t;
+
+// Negotiable rates, indexed by the bits of the baud masks. Index 0 is the power-on default both ends start from.
+typedef enum {
+    kFPGA_Baud_115200,
+    kFPGA_Baud_230400,
+    kFPGA_Baud_460800,
+    kFPGA_Baud_921600,
+    kFPGA_Baud_2000000,
+
+    kNumFPGA_Bauds,
+} FPGA_Baud_t;
+
+typedef enum {
+    kFPGA_LinkFeature_None = 0,
+    kFPGA_LinkFeature_Ack  = (1 << 0),  // Configuration writes are sequenced and acknowledged, see fpga_ack.h
+} FPGA_LinkFeature_t;
+
+typedef enum {
+    kFPGA_LinkState_Default,        // At the default rate, waiting for the FPGA's capabilities
+    kFPGA_LinkState_Confirming,     // Switched, waiting for the FPGA to answer at the new rate
+    kFPGA_LinkState_Negotiated,
+} FPGA_LinkState_t;
+
+typedef enum {
+    kFPGA_LinkAction_None,
+    kFPGA_LinkAction_SwitchBaud,    // Send LinkCtl at the current rate, then move to FPGA_Link_GetBaudRate()
+    kFPGA_LinkAction_Fallback,      // As above, back towards the default rate
+    kFPGA_LinkAction_Revert,        // The FPGA is already back at the default rate, only the MCU has to follow
+    kFPGA_LinkAction_KeepAlive,     // Send ReqFWVer
+} FPGA_LinkAction_t;
+
+// The Rx task reports what it sees through FPGA_Link_OnFWVer() and FPGA_Link_OnCRCError(), the Tx task owns every
+// state change through FPGA_Link_Poll(). The shared fields are single 32-bit words so neither side sees a torn value.
+typedef struct FPGA_Link {
+    uint8_t LocalBaudMask;
+    uint8_t LocalFeatures;
+
+    // Written by the Rx task
+    volatile uint32_t RemoteCaps;       // Proto version << 16 | baud mask << 8 | features, 0 if not V3
+    volatile uint32_t NumReplies;
+    volatile uint32_t NumCRCErrors;
+    volatile bool ResetRequested;
+
+    // Owned by the Tx task
+    FPGA_LinkState_t eState;
+    FPGA_Baud_t eBaud;
+    uint8_t FailedBaudMask;             // Rates that were tried and did not hold up
+    uint32_t RepliesSeen;
+    uint32_t CRCErrorsSeen;
+    uint32_t Deadline_ms;
+    uint32_t LastReply_ms;
+    uint32_t NextKeepAlive_ms;
+    uint32_t NumFallbacks;
+} FPGA_Link_t;
+
+extern const uint32_t FPGA_BaudRates[kNumFPGA_Bauds];
+
+void FPGA_Link_Init(FPGA_Link_t *const pLink, const uint32_t MaxBaudRate, const uint8_t Features);
+void FPGA_Link_Reset(FPGA_Link_t *const pLink);
+
+uint16_t FPGA_Link_GetCapsRequest(const FPGA_Link_t *const pLink);
+uint16_t FPGA_Link_GetLinkCtl(const FPGA_Link_t *const pLink);
+uint16_t FPGA_Link_GetRevertCtl(void);
+uint32_t FPGA_Link_GetBaudRate(const FPGA_Link_t *const pLink);
+bool FPGA_Link_HasFeature(const FPGA_Link_t *const pLink, const FPGA_LinkFeature_t eFeature);
+
+void FPGA_Link_OnFWVer(FPGA_Link_t *const pLink, const FPGA_Frame_t *const pFrame);
+void FPGA_Link_OnCRCError(FPGA_Link_t *const pLink);
+FPGA_LinkAction_t FPGA_Link_Poll(FPGA_Link_t *const pLink, const uint32_t Now_ms);
+uint32_t FPGA_Link_GetTimeout(const FPGA_Link_t *const pLink, const uint32_t Now_ms);
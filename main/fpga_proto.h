@@ -0,0 +1,19 @@
+#pragma once
+
+// Wire-level constants for the system management link. Kept free of FreeRTOS/IDF headers so that the
+// protocol code can be built and exercised on the host.
+
+typedef enum {
+    kSysMgmtConsts_HeaderV1Marker = 0x8A,
+    kSysMgmtConsts_HeaderV2Marker = 0x8F,
+    kSysMgmtConsts_MsgProtoV1Len  = 2,
+    kSysMgmtConsts_MsgProtoV2Len  = 10,
+
+    kSysMgmtConsts_MsgProtoV2MsgLenOffset = 0x2,
+
+    kSysMgmtConsts_MaxMsgProtoV1Len = 4,
+    kSysMgmtConsts_MaxMsgProtoV2Len = 14,
+    kSysMgmtConsts_RxBufferSize     = 2 * 10 * kSysMgmtConsts_MaxMsgProtoV2Len + 1,
+
+    kSysMgmtConsts_DefaultBaudRate = 115200,
+} SysMgmtConsts_t;
@@ -4,14 +4,18 @@
 #include "brightness.h"
 #include "color_correct_lcd.h"
 #include "color_correct_usb.h"
-#include "crc8_sae_j1850.h"
 #include "driver/uart.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "fpga_common.h"
+#include "fpga_decode.h"
+#include "fpga_rx_latency.h"
+#include "fpga_stats.h"
 #include "fpga_tx.h"
 #include "frameblend.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/task.h"
 #include "fw.h"
 #include "osd.h"
@@ -30,31 +34,17 @@ typedef enum {
     kRxFlag_UseBrightness = (1 << 1),
 } RxFlags_t;
 
-typedef enum {
-    kScanForHeaderMarker,
-    kWaitForFullV1Msg,
-
-    kWaitForV2Addr,
-    kWaitForV2Len,
-    kWaitForV2Payload,
-    kWaitForV2CRC,
-} RxState_t;
-
-typedef struct __attribute__((packed)) RxMsg {
-    uint8_t Header;
-    uint8_t Addr;
-    uint8_t Len;
-    union {
-        uint8_t Payload[kSysMgmtConsts_MsgProtoV2Len];
-        uint32_t PayloadU32;
-    };
-    uint8_t CRC;
-} RxMsg_t;
+typedef struct RxSubscriber {
+    fnFPGA_FrameHandler_t fnHandler;
+    void* pArg;
+} RxSubscriber_t;
 
 static const char* TAG = "FpgaRx";
-static RxState_t _eState = kScanForHeaderMarker;
-static uint8_t DecodeBuffer[kSysMgmtConsts_MaxMsgProtoV2Len];
-static uint32_t BufferIndex = 0;
+static RxSubscriber_t Subscribers[kNumRxCmds][kFPGA_RxConsts_MaxSubscribers];
+static FPGA_Decoder_t Decoder;
+static FPGA_RxLatency_t Latency;
+static QueueHandle_t UartEventQueue = NULL;
+static uint32_t NumOtherProtoFrames;
 static uint8_t RxBuffer[kSysMgmtConsts_RxBufferSize]; // Allocate enough room to store several messages
 
 // Declare a variable to hold the handle of the created event group.
@@ -63,10 +53,20 @@ static EventGroupHandle_t xEventGroupHandle = NULL;
 // Declare a variable to hold the data associated with the created event group.
 static StaticEventGroup_t xCreatedEventGroup;
 
-static inline bool IsHeaderMarker(const uint8_t NextByte);
-static bool ReconstructMsg(uint8_t *pBuffer, RxMsg_t *pMsg);
-static bool ProcessByte(uint8_t NextByte, RxMsg_t *pMsg);
-static void ProcessMessage(const RxMsg_t *const pMsg);
+static void ProcessMessage(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnDecodeError(const FPGA_DecodeError_t eError, const uint8_t Addr, void* pArg);
+static void OnVoltage(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnButtons(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnAudioBrightness(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnPMIC(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnFWVer(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnStatusExtended(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnBGPalette(const FPGA_Frame_t *const pFrame, void* pArg);
+static void OnConfigAck(const FPGA_Frame_t *const pFrame, void* pArg);
+static void ProcessChunk(uint8_t *const pRxBuffer, const size_t ByteCount, const uint32_t IdleSymbols);
+#if CONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN
+static void DrainRxBuffer(uint8_t *const pRxBuffer, const bool LineIdle);
+#endif
 
 void FPGA_RxTask(void *arg)
 {
@@ -81,9 +81,22 @@ void FPGA_RxTask(void *arg)
         return;
     }
 
+    (void) FPGA_Rx_Subscribe(kRxCmd_VoltageAA, OnVoltage, (void*)(uintptr_t)kBatteryKind_AA);
+    (void) FPGA_Rx_Subscribe(kRxCmd_VoltageLiPo, OnVoltage, (void*)(uintptr_t)kBatteryKind_LiPo);
+    (void) FPGA_Rx_Subscribe(kRxCmd_Buttons, OnButtons, NULL);
+    (void) FPGA_Rx_Subscribe(kRxCmd_AudioBrightness, OnAudioBrightness, NULL);
+    (void) FPGA_Rx_Subscribe(kRxCmd_PMIC, OnPMIC, NULL);
+    (void) FPGA_Rx_Subscribe(kRxCmd_FWVer, OnFWVer, NULL);
+    (void) FPGA_Rx_Subscribe(kRxCmd_StatusExtended, OnStatusExtended, NULL);
+    (void) FPGA_Rx_Subscribe(kRxCmd_BGPalette, OnBGPalette, NULL);
+    (void) FPGA_Rx_Subscribe(kRxCmd_ConfigAck, OnConfigAck, NULL);
+
+    FPGA_RxLatency_Init(&Latency, ProcessMessage, NULL, esp_timer_get_time, kSysMgmtConsts_DefaultBaudRate);
+    FPGA_Decoder_Init(&Decoder, FPGA_RxLatency_OnFrame, &Latency);
+    FPGA_Decoder_SetErrorHandler(&Decoder, OnDecodeError, NULL);
+
     FPGA_Rx_Resume();
 
-    RxMsg_t Msg = {0};
     while (1)
     {
         //Only run when we're given permission to do so.
@@ -95,22 +108,38 @@ void FPGA_RxTask(void *arg)
             portMAX_DELAY
         );
 
-        const int32_t ByteCount = uart_read_bytes(UART_NUM_1, pRxBuffer, sizeof(RxBuffer), pdMS_TO_TICKS(10));
+#if CONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN
+        uart_event_t Event;
+        if (xQueueReceive(UartEventQueue, &Event, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
 
-        if (ByteCount > 0)
+        switch (Event.type)
         {
-            // The system will enter a low power mode if enough time passes without any received serial data to save power.
-            PwrMgr_IdleTimerPet();
+            case UART_DATA:
+                DrainRxBuffer(pRxBuffer, Event.timeout_flag);
+                break;
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // Bytes were dropped, so any partial frame is garbage. Start over from the next header marker.
+                ESP_LOGW(TAG, "Rx overflow (%d)", Event.type);
+                FPGA_Stats_RecordRxOverflow();
+                uart_flush_input(UART_NUM_1);
+                xQueueReset(UartEventQueue);
+                FPGA_Decoder_Resync(&Decoder);
+                break;
+            default:
+                break;
         }
+#else
+        const int32_t ByteCount = uart_read_bytes(UART_NUM_1, pRxBuffer, sizeof(RxBuffer), pdMS_TO_TICKS(10));
 
-        for (size_t i = 0; i < ByteCount; i++)
+        if (ByteCount > 0)
         {
-            if (ProcessByte(pRxBuffer[i], &Msg))
-            {
-                ProcessMessage(&Msg);
-                memset(&Msg, 0x0, sizeof(Msg));
-            }
+            ProcessChunk(pRxBuffer, (size_t)ByteCount, 0);
         }
+#endif
     }
 
     ESP_LOGE(TAG, "RxTask loop exited");
@@ -133,268 +162,263 @@ void FPGA_Rx_UseBrightnessReadback(void)
    (void) xEventGroupSetBits(xEventGroupHandle, kRxFlag_UseBrightness);
 }
 
-static bool ReconstructMsg(uint8_t *pBuffer, RxMsg_t *pMsg)
+// Subscriptions are expected to be made during start-up, before frames start flowing
+OSD_Result_t FPGA_Rx_Subscribe(const RxIDs_t eID, fnFPGA_FrameHandler_t fnHandler, void* pArg)
 {
-    if ((pMsg == NULL) || (pBuffer == NULL))
+    if (fnHandler == NULL)
     {
-        return false;
+        return kOSD_Result_Err_NullDataPtr;
     }
 
-    pMsg->Header  = pBuffer[0];
-    pMsg->Addr    = pBuffer[1];
+    if ((unsigned)eID >= kNumRxCmds)
+    {
+        return kOSD_Result_Err_InvalidMsgID;
+    }
 
-    if (pMsg->Header == kSysMgmtConsts_HeaderV1Marker)
+    for (size_t i = 0; i < kFPGA_RxConsts_MaxSubscribers; i++)
     {
-        pMsg->Len = kSysMgmtConsts_MsgProtoV1Len;
-        pMsg->Payload[0] = pBuffer[3];
-        pMsg->Payload[1] = pBuffer[2];
+        RxSubscriber_t *const pSubscriber = &Subscribers[eID][i];
+        if (pSubscriber->fnHandler == NULL)
+        {
+            pSubscriber->fnHandler = fnHandler;
+            pSubscriber->pArg = pArg;
+            return kOSD_Result_Ok;
+        }
     }
-    else if (pMsg->Header == kSysMgmtConsts_HeaderV2Marker)
+
+    ESP_LOGE(TAG, "No free subscriber slot for %s", FPGA_RxSchema[eID].pName);
+    return kOSD_Result_Err_NoFreeSlot;
+}
+
+QueueHandle_t* FPGA_Rx_GetUartEventQueue(void)
+{
+    return &UartEventQueue;
+}
+
+const FPGA_RxLatencyStats_t* FPGA_Rx_GetLatencyStats(void)
+{
+    return &Latency.Stats;
+}
+
+void FPGA_Rx_SetBaudRate(const uint32_t BaudRate)
+{
+    // Called from the Tx task once the UART has been switched, only the arrival time estimate depends on it
+    FPGA_RxLatency_SetBaudRate(&Latency, BaudRate);
+}
+
+#if CONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN
+static void DrainRxBuffer(uint8_t *const pRxBuffer, const bool LineIdle)
+{
+    // Events can be coalesced or stale (e.g. after a flush), so read whatever the driver actually holds
+    size_t Buffered = 0;
+    (void) uart_get_buffered_data_len(UART_NUM_1, &Buffered);
+
+    while (Buffered > 0)
     {
-        const uint8_t LenOffset = 2;
-        const uint8_t Len = pBuffer[LenOffset];
+        const size_t ToRead = (Buffered < sizeof(RxBuffer)) ? Buffered : sizeof(RxBuffer);
+        const int32_t ByteCount = uart_read_bytes(UART_NUM_1, pRxBuffer, ToRead, 0);
 
-        pMsg->Len = Len;
+        if (ByteCount <= 0)
+        {
+            break;
+        }
+
+        Buffered -= ((size_t)ByteCount < Buffered) ? (size_t)ByteCount : Buffered;
 
-        memcpy(pMsg->Payload, &pBuffer[LenOffset + 1], Len);
-        pMsg->CRC = pBuffer[LenOffset + 1 + Len];
+        // Only the final chunk of an idle event ends with the line going quiet
+        ProcessChunk(pRxBuffer, (size_t)ByteCount, (LineIdle && (Buffered == 0)) ? kFPGA_RxConsts_IdleTimeout : 0);
     }
+}
+#endif
 
-    return true;
+static void ProcessChunk(uint8_t *const pRxBuffer, const size_t ByteCount, const uint32_t IdleSymbols)
+{
+    // The system will enter a low power mode if enough time passes without any received serial data to save power.
+    PwrMgr_IdleTimerPet();
+
+    // Complete frames are validated in place and handed straight to ProcessMessage(). Only a frame cut off
+    // by the end of this chunk goes through the byte-wise state machine.
+    const uint32_t StartDiscarded = Decoder.NumDiscardedBytes;
+    (void) FPGA_RxLatency_Feed(&Latency, &Decoder, pRxBuffer, ByteCount, esp_timer_get_time(), IdleSymbols);
+    FPGA_Stats_RecordDiscarded(Decoder.NumDiscardedBytes - StartDiscarded);
 }
 
-static bool ProcessByte(uint8_t NextByte, RxMsg_t *pMsg)
+static void ProcessMessage(const FPGA_Frame_t *const pFrame, void* pArg)
 {
-    static uint8_t MsgLen = 0;
+    (void)pArg;
 
-    if (pMsg == NULL)
+    if (pFrame == NULL)
     {
-        return false;
+        return;
     }
 
-    // printf(" %X\r\n", NextByte);
-
-    switch (_eState)
+    // Switching protocol resets the link and resends everything, so it takes a run of frames that decoded, not a
+    // stray marker byte. The frame that completes the run is already handled under the new version.
+    const bool IsV1 = (pFrame->Header == kSysMgmtConsts_HeaderV1Marker);
+    if (IsV1 == FPGA_IsProtoV1())
     {
-        case kScanForHeaderMarker:
-            if (IsHeaderMarker(NextByte))
-            {
-                DecodeBuffer[0] = NextByte;
-                BufferIndex = 1;
-                MsgLen = 0;
-
-                if (NextByte == kSysMgmtConsts_HeaderV2Marker)
-                {
-                    _eState = kWaitForV2Addr;
-                    FPGA_SetProtoV1(false);
-                }
-                else
-                {
-                    _eState = kWaitForFullV1Msg;
-                    FPGA_SetProtoV1(true);
-                }
-            }
-            break;
+        NumOtherProtoFrames = 0;
+    }
+    else if (++NumOtherProtoFrames >= kFPGA_RxConsts_ProtoSwitchFrames)
+    {
+        NumOtherProtoFrames = 0;
+        FPGA_SetProtoV1(IsV1);
+    }
 
-        case kWaitForFullV1Msg:
-            if (NextByte == kSysMgmtConsts_HeaderV1Marker)
-            {
-                // We did not receive a complete message. Start over.
-                _eState = kScanForHeaderMarker;
-                BufferIndex = 0;
-                break;
-            }
+    // The payload always occupies at least one byte on the wire, see FPGA_Decoder_Feed()
+    const size_t FrameLen = (pFrame->Header == kSysMgmtConsts_HeaderV1Marker) ? kSysMgmtConsts_MaxMsgProtoV1Len : (size_t)(3 + ((pFrame->Len == 0) ? 1 : pFrame->Len) + 1);
+    FPGA_Stats_RecordFrame(kFPGA_Dir_Rx, pFrame->Addr, FrameLen);
+    FPGA_Stats_RecordRxArrival(esp_timer_get_time());
+    FPGA_Stats_RecordRxLatency(Latency.Stats.Last_us);
 
-            DecodeBuffer[BufferIndex++] = NextByte;
-            if (BufferIndex == kSysMgmtConsts_MaxMsgProtoV1Len)
-            {
-                _eState = kScanForHeaderMarker;
-                BufferIndex = 0;
+    if (pFrame->Addr >= kNumRxCmds)
+    {
+        ESP_LOGE(TAG, "Unknown cmd: %d", pFrame->Addr);
+        return;
+    }
 
-                return ReconstructMsg(DecodeBuffer, pMsg);
-            }
-            break;
-        case kWaitForV2Addr:
-            DecodeBuffer[BufferIndex++] = NextByte;
-            _eState = kWaitForV2Len;
-            break;
-        case kWaitForV2Len:
-            if (NextByte > kSysMgmtConsts_MsgProtoV2Len)
-            {
-                ESP_LOGE(TAG, "Msg for addr %d with len %d exceeds limit %d", DecodeBuffer[BufferIndex - 1], NextByte, kSysMgmtConsts_MsgProtoV2Len);
-                _eState = kScanForHeaderMarker;
-                BufferIndex = 0;
-                break;
-            }
-            DecodeBuffer[BufferIndex++] = NextByte;
-            MsgLen = NextByte;
-            _eState = kWaitForV2Payload;
-            break;
-        case kWaitForV2Payload:
-            DecodeBuffer[BufferIndex++] = NextByte;
-            if (BufferIndex > (kSysMgmtConsts_MsgProtoV2MsgLenOffset + MsgLen))
-            {
-                _eState = kWaitForV2CRC;
-            }
-            break;
-        case kWaitForV2CRC:
-            DecodeBuffer[BufferIndex++] = NextByte;
-            if (crc8_sae_j1850_decode(DecodeBuffer, BufferIndex))
-            {
-                _eState = kScanForHeaderMarker;
-                BufferIndex = 0;
-                return ReconstructMsg(DecodeBuffer, pMsg);
-            }
-            else
-            {
-                ESP_LOGE(TAG, "CRC check failed for addr=%02x", DecodeBuffer[1]);
-            }
-
-            _eState = kScanForHeaderMarker;
-            BufferIndex = 0;
-            break;
-        default:
-            break;
+    const RxSubscriber_t *const pSubscribers = Subscribers[pFrame->Addr];
+    for (size_t i = 0; (i < kFPGA_RxConsts_MaxSubscribers) && (pSubscribers[i].fnHandler != NULL); i++)
+    {
+        pSubscribers[i].fnHandler(pFrame, pSubscribers[i].pArg);
     }
 
-    return false;  // No valid message reconstructed yet
+    Brightness_SetLowPowerOverride(PwrMgr_IsLPMActive());
 }
 
-static void ProcessMessage(const RxMsg_t *const pMsg)
+static void OnDecodeError(const FPGA_DecodeError_t eError, const uint8_t Addr, void* pArg)
 {
-    if (pMsg == NULL)
+    (void)pArg;
+
+    if (eError == kFPGA_DecodeError_CRC)
     {
-        return;
+        FPGA_Stats_RecordCRCError(Addr);
+        FPGA_Link_OnCRCError(FPGA_GetLink());
+    }
+    else
+    {
+        FPGA_Stats_RecordOversizeLen(Addr);
     }
+}
+
+static void OnVoltage(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    const BatteryKind_t eKind = (BatteryKind_t)(uintptr_t)pArg;
+    const uint16_t rxdata = (eKind == kBatteryKind_AA) ? FPGA_Decode_VoltageAA(pFrame) : FPGA_Decode_VoltageLiPo(pFrame);
 
-    // Valid message reconstructed, process the message
-    float result;
-    uint16_t rxdata;
-    if (pMsg->Header == kSysMgmtConsts_HeaderV1Marker)
+    float result = (float)rxdata/2048.0f;
+    result = (10.0f + 2.2f)*(result/(2.2f));
+    const float voltage = result - 0.1f;
+    Battery_UpdateVoltage(voltage, eKind);
+}
+
+static void OnButtons(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+
+    const uint16_t rxdata = FPGA_Decode_Buttons(pFrame);
+
+    Button_Update(rxdata);
+    if ((rxdata & kButtonBits_MenuEnAlt) != 0 || (rxdata & kButtonBits_MenuEn) != 0)
     {
-        // V1 of the protocol has a weird quirk where only the lower 7-bits are used. I suspect it's because it
-        // keeps the header marker unique (0x8A) which has the most significant bit set.
-        rxdata = ((uint16_t)pMsg->Payload[1] << 7 | pMsg->Payload[0]);
+        OSD_SetVisiblityState(false);
     }
     else
     {
-        rxdata = ((uint16_t)pMsg->Payload[0] << 8 | pMsg->Payload[1]);
+        // Hack: If we're getting button data, then the OSD is displayed
+        OSD_SetVisiblityState(true);
     }
+}
+
+static void OnAudioBrightness(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
 
-    switch(pMsg->Addr)
+    const uint16_t rxdata = FPGA_Decode_AudioBrightness(pFrame);
+
+    uint8_t temp = 127-(rxdata & 0x7F);
+    temp = (uint8_t)(((float)temp)*1.08695652173913f);
+    const float volume = temp > 100 ? 100 : temp;
+    const uint8_t headphone = (rxdata >> 7) & 0x1;
+    const uint8_t lcd_brightness = rxdata >> 8;
+
+    (void)volume;
+    (void)headphone;
+
+    // Ignore this when the OSD is active since the MCU always has the latest brightness value
+    if (OSD_IsVisible() == false)
     {
-        case kRxCmd_VoltageAA:
-        {
-            result = (float)rxdata/2048.0f;
-            result = (10.0f + 2.2f)*(result/(2.2f));
-            float aa_voltage = result - 0.1f;
-            Battery_UpdateVoltage(aa_voltage, kBatteryKind_AA);
-            break;
-        }
-        case kRxCmd_VoltageLiPo:
+        if (PwrMgr_IsLPMActive() == false)
         {
-            result = (float)rxdata/2048.0f;
-            result = (10.0f + 2.2f)*(result/(2.2f));
-            float lipo_voltage = result - 0.1f;
-            Battery_UpdateVoltage(lipo_voltage, kBatteryKind_LiPo);
-            break;
+            Brightness_Update(lcd_brightness + 1);  // Brightness module expects 1-indexed data but the display uses zero-indexed
         }
-        case kRxCmd_Buttons:
-            Button_Update(rxdata);
-            if ((rxdata & kButtonBits_MenuEnAlt) != 0 || (rxdata & kButtonBits_MenuEn) != 0)
-            {
-                OSD_SetVisiblityState(false);
-            }
-            else
-            {
-                // Hack: If we're getting button data, then the OSD is displayed
-                OSD_SetVisiblityState(true);
-            }
-            break;
-        case kRxCmd_AudioBrightness:
-        {
-            uint8_t temp = 127-(rxdata & 0x7F);
-            temp = (uint8_t)(((float)temp)*1.08695652173913f);
-            const float volume = temp > 100 ? 100 : temp;
-            const uint8_t headphone = (rxdata >> 7) & 0x1;
-            const uint8_t lcd_brightness = rxdata >> 8;
-
-            (void)volume;
-            (void)headphone;
-
-            // Ignore this when the OSD is active since the MCU always has the latest brightness value
-            if (OSD_IsVisible() == false)
-            {
-                if (PwrMgr_IsLPMActive() == false)
-                {
-                    Brightness_Update(lcd_brightness + 1);  // Brightness module expects 1-indexed data but the display uses zero-indexed
-                }
-            }
-
-            if ((xEventGroupWaitBits(xEventGroupHandle, kRxFlag_UseBrightness, pdTRUE, pdFALSE, 0) & kRxFlag_UseBrightness) == kRxFlag_UseBrightness)
-            {
-                FPGA_Tx_SendAll();
-                FPGA_Tx_Resume();
-            }
-            break;
-        }
-        case kRxCmd_SysCtl:
-            (void) rxdata;
-            break;
-        case kRxCmd_PMIC:
-        {
-            const uint16_t pmic = rxdata;
-            const uint16_t kmChargingStatus = (0x3 << 4);
-            const uint16_t kChargingOn = (0x2 << 4);
-            const bool IsCharging = ((pmic & kmChargingStatus) == kChargingOn);
-            Battery_SetChargingStatus(IsCharging);
-            break;
-        }
-        case kRxCmd_FWVer:
-        {
-            const uint8_t fpga_debug = ( ((rxdata >> 12) & 1) == 1);
-            const uint8_t fpga_version_minor = (uint8_t)((rxdata >> 6) & 0x3F);
-            const uint8_t fpga_version_major = (uint8_t)((rxdata >> 0) & 0x3F);
-            Firmware_SetFPGAVersion(fpga_version_major, fpga_version_minor, fpga_debug);
-            break;
-        }
-        case kRxCmd_StatusExtended:
-        {
-            const bool InLPM = (bool)(pMsg->PayloadU32 & 1);
-            const bool GBCMode = (bool)((pMsg->PayloadU32 >> 1) & 1);
+    }
 
-            PwrMgr_SetLPM(InLPM);
-            Style_SetGBCMode(GBCMode);
-            break;
-        }
-        case kRxCmd_Reserved:
-        {
-            break;
-        }
-        case kRxCmd_BGPalette:
-        {
-            if (pMsg->Len == 8) 
-            {
-                uint64_t paletteBGRaw = 0;
-                memcpy(&paletteBGRaw, pMsg->Payload, 8);
-                const uint64_t paletteBG = __builtin_bswap64(paletteBGRaw);
-                Style_SetHKPaletteBG(paletteBG);
-            } else 
-            {
-                ESP_LOGW(TAG, "BG Palette readback: unexpected length %d", pMsg->Len);
-            }
-            break;
+    if ((xEventGroupWaitBits(xEventGroupHandle, kRxFlag_UseBrightness, pdTRUE, pdFALSE, 0) & kRxFlag_UseBrightness) == kRxFlag_UseBrightness)
+    {
+        FPGA_Tx_SendAll();
+        FPGA_Tx_Resume();
+    }
+}
 
-        }
-        default:
-            ESP_LOGE(TAG, "Unknown cmd: %d", pMsg->Addr);
-            break;
+static void OnPMIC(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+
+    const uint16_t pmic = FPGA_Decode_PMIC(pFrame);
+    const uint16_t kmChargingStatus = (0x3 << 4);
+    const uint16_t kChargingOn = (0x2 << 4);
+    const bool IsCharging = ((pmic & kmChargingStatus) == kChargingOn);
+    Battery_SetChargingStatus(IsCharging);
+}
+
+static void OnFWVer(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+
+    const uint16_t rxdata = FPGA_Decode_FWVer(pFrame);
+    const uint8_t fpga_debug = ( ((rxdata >> 12) & 1) == 1);
+    const uint8_t fpga_version_minor = (uint8_t)((rxdata >> 6) & 0x3F);
+    const uint8_t fpga_version_major = (uint8_t)((rxdata >> 0) & 0x3F);
+    Firmware_SetFPGAVersion(fpga_version_major, fpga_version_minor, fpga_debug);
+
+    // Also the answer to a capability request or keepalive
+    FPGA_Link_OnFWVer(FPGA_GetLink(), pFrame);
+    FPGA_Tx_OnLinkEvent();
+}
+
+static void OnStatusExtended(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+
+    const uint32_t Status = FPGA_Decode_StatusExtended(pFrame);
+    const bool InLPM = (bool)(Status & 1);
+    const bool GBCMode = (bool)((Status >> 1) & 1);
+
+    PwrMgr_SetLPM(InLPM);
+    Style_SetGBCMode(GBCMode);
+}
+
+static void OnBGPalette(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+
+    if (pFrame->Len == FPGA_RxSchema[kRxCmd_BGPalette].Width)
+    {
+        Style_SetHKPaletteBG(FPGA_Decode_BGPalette(pFrame));
+    }
+    else
+    {
+        ESP_LOGW(TAG, "BG Palette readback: unexpected length %d", pFrame->Len);
     }
 
-    Brightness_SetLowPowerOverride(PwrMgr_IsLPMActive());
+    // Either way the FPGA answered, so the Tx task no longer needs to hold the palette back
+    FPGA_Tx_OnBGPaletteReadback();
 }
 
-static inline bool IsHeaderMarker(const uint8_t NextByte)
+static void OnConfigAck(const FPGA_Frame_t *const pFrame, void* pArg)
 {
-    return ((NextByte == kSysMgmtConsts_HeaderV1Marker) || (NextByte == kSysMgmtConsts_HeaderV2Marker));
+    (void)pArg;
+
+    FPGA_Tx_OnConfigAck(pFrame);
 }
@@ -1,28 +1,27 @@
 #pragma once
 
 #include "fpga_common.h"
-
-typedef enum {
-    kRxCmd_VoltageAA       = 0x0,
-    kRxCmd_VoltageLiPo     = 0x1,
-    kRxCmd_Buttons         = 0x2,
-    kRxCmd_AudioBrightness = 0x3,
-    kRxCmd_SysCtl          = 0x4,
-    kRxCmd_PMIC            = 0x5,
-    kRxCmd_FWVer           = 0x6,
-    kRxCmd_Reserved        = 0x7,
-    kRxCmd_StatusExtended  = 0x8,
-    kRxCmd_BGPalette       = 0x9,
-
-    kNumRxCmds,
-} RxIDs_t;
+#include "fpga_rx_latency.h"
+#include "fpga_schema.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "osd_shared.h"
 
 typedef enum {
     kFPGA_RxConsts_BufferSize = 1024,    // [bytes]
+    kFPGA_RxConsts_EventQueueLen = 16,
+    kFPGA_RxConsts_FullThreshold = kSysMgmtConsts_MaxMsgProtoV2Len, // [bytes] Wake once a full V2 frame could be in the FIFO
+    kFPGA_RxConsts_IdleTimeout = 3,      // [symbols] Wake shortly after the FPGA stops transmitting
+    kFPGA_RxConsts_MaxSubscribers = 2,   // Per message
+    kFPGA_RxConsts_ProtoSwitchFrames = 3, // Valid frames in a row of the other protocol version before switching to it
 } FPGA_RxConsts_t;
 
 void FPGA_RxTask(void *arg);
 void FPGA_Rx_Resume(void);
 void FPGA_Rx_Pause(void);
 void FPGA_Rx_UseBrightnessReadback(void);
+OSD_Result_t FPGA_Rx_Subscribe(const RxIDs_t eID, fnFPGA_FrameHandler_t fnHandler, void* pArg);
+QueueHandle_t* FPGA_Rx_GetUartEventQueue(void);
+const FPGA_RxLatencyStats_t* FPGA_Rx_GetLatencyStats(void);
+void FPGA_Rx_SetBaudRate(const uint32_t BaudRate);
 void FPGA_Tx_PokeButtons(void);
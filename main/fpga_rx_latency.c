@@ -0,0 +1,177 @@
+#include "fpga_rx_latency.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kBitsPerSymbol = 10,    // 8N1: start bit, eight data bits and a stop bit
+};
+
+static inline int64_t BytesToTime_us(const FPGA_RxLatency_t *const pLatency, const size_t NumBytes);
+
+void FPGA_RxLatency_Init(FPGA_RxLatency_t *const pLatency, fnFPGA_FrameHandler_t fnHandler, void* pArg, fnFPGA_Clock_us_t fnNow, const uint32_t BaudRate)
+{
+    if (pLatency == NULL)
+    {
+        return;
+    }
+
+    memset(pLatency, 0x0, sizeof(*pLatency));
+
+    pLatency->fnHandler = fnHandler;
+    pLatency->pHandlerArg = pArg;
+    pLatency->fnNow = fnNow;
+
+    FPGA_RxLatency_SetBaudRate(pLatency, BaudRate);
+    FPGA_RxLatency_Reset(pLatency);
+}
+
+void FPGA_RxLatency_SetBaudRate(FPGA_RxLatency_t *const pLatency, const uint32_t BaudRate)
+{
+    if ((pLatency == NULL) || (BaudRate == 0))
+    {
+        return;
+    }
+
+    pLatency->ByteTime_ns = (uint32_t)((1000000000ull * kBitsPerSymbol) / BaudRate);
+}
+
+void FPGA_RxLatency_Reset(FPGA_RxLatency_t *const pLatency)
+{
+    if (pLatency == NULL)
+    {
+        return;
+    }
+
+    memset(&pLatency->Stats, 0x0, sizeof(pLatency->Stats));
+    pLatency->Stats.Min_us = UINT32_MAX;
+}
+
+size_t FPGA_RxLatency_Feed(FPGA_RxLatency_t *const pLatency, FPGA_Decoder_t *const pDecoder, const uint8_t *const pData, const size_t Length, const int64_t Now_us, const uint32_t IdleSymbols)
+{
+    if ((pLatency == NULL) || (pDecoder == NULL) || (pData == NULL))
+    {
+        return 0;
+    }
+
+    // A timeout event fires after the line has been idle for a number of symbol times, so the last byte arrived
+    // that long before we were woken up.
+    const int64_t LastByte_us = Now_us - BytesToTime_us(pLatency, IdleSymbols);
+
+    pLatency->pChunk = pData;
+    pLatency->ChunkLen = Length;
+    pLatency->ChunkStart_us = LastByte_us - BytesToTime_us(pLatency, (Length > 0) ? (Length - 1) : 0);
+
+    const size_t NumFrames = FPGA_Decoder_Feed(pDecoder, pData, Length);
+
+    if ((pDecoder->eState != kFPGA_DecodeState_ScanForHeaderMarker) && (pDecoder->BufferIndex <= Length))
+    {
+        // A new frame started in this chunk and has not finished yet
+        pLatency->PartialStart_us = pLatency->ChunkStart_us + BytesToTime_us(pLatency, Length - pDecoder->BufferIndex);
+    }
+
+    pLatency->pChunk = NULL;
+    pLatency->ChunkLen = 0;
+
+    return NumFrames;
+}
+
+void FPGA_RxLatency_OnFrame(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    FPGA_RxLatency_t *const pLatency = (FPGA_RxLatency_t*)pArg;
+
+    if ((pLatency == NULL) || (pFrame == NULL))
+    {
+        return;
+    }
+
+    if (pLatency->fnNow != NULL)
+    {
+        int64_t FirstByte_us = pLatency->PartialStart_us;
+
+        if ((pLatency->pChunk != NULL) && (pFrame->pRaw >= pLatency->pChunk) && (pFrame->pRaw < (pLatency->pChunk + pLatency->ChunkLen)))
+        {
+            FirstByte_us = pLatency->ChunkStart_us + BytesToTime_us(pLatency, (size_t)(pFrame->pRaw - pLatency->pChunk));
+        }
+
+        const int64_t Elapsed_us = pLatency->fnNow() - FirstByte_us;
+        const uint32_t Latency_us = (Elapsed_us < 0) ? 0 : ((Elapsed_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)Elapsed_us);
+
+        FPGA_RxLatencyStats_t *const pStats = &pLatency->Stats;
+        pStats->NumFrames++;
+        pStats->Last_us = Latency_us;
+        pStats->Total_us += Latency_us;
+        pStats->Min_us = (Latency_us < pStats->Min_us) ? Latency_us : pStats->Min_us;
+        pStats->Max_us = (Latency_us > pStats->Max_us) ? Latency_us : pStats->Max_us;
+    }
+
+    if (pLatency->fnHandler != NULL)
+    {
+        pLatency->fnHandler(pFrame, pLatency->pHandlerArg);
+    }
+}
+
+static inline int64_t BytesToTime_us(const FPGA_RxLatency_t *const pLatency, const size_t NumBytes)
+{
+    return (int64_t)(((uint64_t)NumBytes * pLatency->ByteTime_ns) / 1000u);
+}
+
+// Host stand-in for the UART driver: frames are read from a pipe (stdin) and the process only wakes when data is
+// available, mirroring the event-driven receive task.
+// Build and run with:
+//   gcc -O2 -DFPGA_RX_LATENCY_HOST -I../components/crc fpga_rx_latency.c fpga_decode.c ../components/crc/crc8_sae_j1850.c -o fpga_rx_host
+//   cat recorded_uart_capture.bin | ./fpga_rx_host [baud]
+#if defined(FPGA_RX_LATENCY_HOST)
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static int64_t HostNow_us(void)
+{
+    struct timespec Now;
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (int64_t)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+}
+
+static void HostHandler(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+    printf("hdr=%02X addr=%02X len=%u u16=%04X\n", pFrame->Header, pFrame->Addr, pFrame->Len, FPGA_Frame_GetU16(pFrame));
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t BaudRate = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 115200u;
+
+    static uint8_t RxBuffer[kSysMgmtConsts_RxBufferSize];
+    static FPGA_Decoder_t Decoder;
+    static FPGA_RxLatency_t Latency;
+
+    FPGA_RxLatency_Init(&Latency, HostHandler, NULL, HostNow_us, BaudRate);
+    FPGA_Decoder_Init(&Decoder, FPGA_RxLatency_OnFrame, &Latency);
+
+    struct pollfd Fd = { .fd = STDIN_FILENO, .events = POLLIN };
+    while (poll(&Fd, 1, -1) > 0)
+    {
+        const ssize_t ByteCount = read(STDIN_FILENO, RxBuffer, sizeof(RxBuffer));
+        if (ByteCount <= 0)
+        {
+            break;
+        }
+
+        (void) FPGA_RxLatency_Feed(&Latency, &Decoder, RxBuffer, (size_t)ByteCount, HostNow_us(), 0);
+    }
+
+    const FPGA_RxLatencyStats_t *const pStats = &Latency.Stats;
+    printf("frames=%u crc=%u len=%u skipped=%u latency_us min=%u avg=%u max=%u\n",
+        pStats->NumFrames, Decoder.NumCRCErrors, Decoder.NumOversizeLen, Decoder.NumDiscardedBytes,
+        (pStats->NumFrames > 0) ? pStats->Min_us : 0,
+        (pStats->NumFrames > 0) ? (uint32_t)(pStats->Total_us / pStats->NumFrames) : 0,
+        pStats->Max_us);
+
+    return 0;
+}
+#endif
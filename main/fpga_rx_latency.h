@@ -0,0 +1,42 @@
+#pragma once
+
+#include "fpga_decode.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int64_t (*fnFPGA_Clock_us_t)(void);
+
+typedef struct FPGA_RxLatencyStats {
+    uint32_t NumFrames;
+    uint32_t Last_us;
+    uint32_t Min_us;
+    uint32_t Max_us;
+    uint64_t Total_us;
+} FPGA_RxLatencyStats_t;
+
+// Tracks how long each frame waited between its first byte arriving on the wire and being handed to the frame
+// handler. Arrival times are not observable through the UART driver, so they are estimated by walking back from
+// the time the last byte of a chunk arrived at the configured baud rate.
+typedef struct FPGA_RxLatency {
+    fnFPGA_FrameHandler_t fnHandler;
+    void* pHandlerArg;
+    fnFPGA_Clock_us_t fnNow;
+    uint32_t ByteTime_ns;
+
+    // Context of the chunk currently being decoded
+    const uint8_t* pChunk;
+    size_t ChunkLen;
+    int64_t ChunkStart_us;
+
+    // Estimated first byte time of a frame that continues into the next chunk
+    int64_t PartialStart_us;
+
+    FPGA_RxLatencyStats_t Stats;
+} FPGA_RxLatency_t;
+
+void FPGA_RxLatency_Init(FPGA_RxLatency_t *const pLatency, fnFPGA_FrameHandler_t fnHandler, void* pArg, fnFPGA_Clock_us_t fnNow, const uint32_t BaudRate);
+void FPGA_RxLatency_SetBaudRate(FPGA_RxLatency_t *const pLatency, const uint32_t BaudRate);
+void FPGA_RxLatency_OnFrame(const FPGA_Frame_t *const pFrame, void* pArg);
+size_t FPGA_RxLatency_Feed(FPGA_RxLatency_t *const pLatency, FPGA_Decoder_t *const pDecoder, const uint8_t *const pData, const size_t Length, const int64_t Now_us, const uint32_t IdleSymbols);
+void FPGA_RxLatency_Reset(FPGA_RxLatency_t *const pLatency);
@@ -0,0 +1,205 @@
+#include "fpga_schema.h"
+
+#include "crc8_sae_j1850.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+    kV1PayloadLen  = kSysMgmtConsts_MaxMsgProtoV1Len - 2,
+    kV2HeaderLen   = 3,     // Marker, address and length
+};
+
+#define FPGA_RX_SCHEMA(Name, Addr, Codec) \
+    [kRxCmd_##Name] = { .pName = #Name, .Width = FPGA_CODEC_WIDTH_##Codec, .IsCacheable = false },
+const FPGA_MsgSchema_t FPGA_RxSchema[kNumRxCmds] = {
+    FPGA_RX_MESSAGES(FPGA_RX_SCHEMA)
+};
+#undef FPGA_RX_SCHEMA
+
+#define FPGA_TX_SCHEMA(Name, Addr, Codec, Cacheable) \
+    [kTxCmd_##Name] = { .pName = #Name, .Width = FPGA_CODEC_WIDTH_##Codec, .IsCacheable = (Cacheable) },
+const FPGA_MsgSchema_t FPGA_TxSchema[kNumTxCmds] = {
+    FPGA_TX_MESSAGES(FPGA_TX_SCHEMA)
+};
+#undef FPGA_TX_SCHEMA
+
+#define FPGA_TX_WIDTH_CHECK(Name, Addr, Codec, Cacheable) \
+    _Static_assert(FPGA_CODEC_WIDTH_##Codec <= kSysMgmtConsts_MsgProtoV2Len, #Name " payload does not fit in a V2 frame");
+FPGA_TX_MESSAGES(FPGA_TX_WIDTH_CHECK)
+#undef FPGA_TX_WIDTH_CHECK
+
+size_t FPGA_Schema_EncodeFrame(uint8_t *const pBuffer, const size_t Size, const uint8_t Addr, const uint8_t *const pPayload, const uint8_t Len, const bool V1)
+{
+    if ((pBuffer == NULL) || (Len > kSysMgmtConsts_MsgProtoV2Len) || ((pPayload == NULL) && (Len > 0)))
+    {
+        return 0;
+    }
+
+    if (V1)
+    {
+        if (Size < kSysMgmtConsts_MaxMsgProtoV1Len)
+        {
+            return 0;
+        }
+
+        // V1 frames always carry two data bytes, wider payloads are truncated to their leading bytes
+        pBuffer[0] = kSysMgmtConsts_HeaderV1Marker;
+        pBuffer[1] = Addr;
+        memset(&pBuffer[2], 0x0, kV1PayloadLen);
+        memcpy(&pBuffer[2], pPayload, (Len < kV1PayloadLen) ? Len : kV1PayloadLen);
+
+        return kSysMgmtConsts_MaxMsgProtoV1Len;
+    }
+
+    if (Size < (size_t)(kV2HeaderLen + Len + 1))
+    {
+        return 0;
+    }
+
+    pBuffer[0] = kSysMgmtConsts_HeaderV2Marker;
+    pBuffer[1] = Addr;
+    pBuffer[2] = Len;
+    if (Len > 0)
+    {
+        memcpy(&pBuffer[kV2HeaderLen], pPayload, Len);
+    }
+
+    return crc8_sae_j1850_encode(pBuffer, kV2HeaderLen + Len, pBuffer);
+}
+
+size_t FPGA_Schema_EncodeBE(uint8_t *const pBuffer, const size_t Size, const uint8_t Addr, const uint64_t Value, const uint8_t Width, const bool V1)
+{
+    uint8_t Payload[sizeof(uint64_t)];
+
+    if (Width > sizeof(Payload))
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < Width; i++)
+    {
+        Payload[i] = (uint8_t)(Value >> (8 * (Width - 1 - i)));
+    }
+
+    return FPGA_Schema_EncodeFrame(pBuffer, Size, Addr, Payload, Width, V1);
+}
+
+// Host-side round trip and fuzz check of the schema against the frame decoder.
+// Build and run with:
+//   gcc -O2 -DFPGA_SCHEMA_SELFTEST -I../components/crc fpga_schema.c fpga_decode.c ../components/crc/crc8_sae_j1850.c -o fpga_schema_selftest
+//   ./fpga_schema_selftest
+#if defined(FPGA_SCHEMA_SELFTEST)
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct SelfTest {
+    uint8_t Addr;
+    uint8_t Len;
+    uint64_t Value;
+    uint32_t NumFrames;
+} SelfTest_t;
+
+static void OnFrame(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    SelfTest_t *const pTest = (SelfTest_t*)pArg;
+
+    pTest->NumFrames++;
+    pTest->Addr = pFrame->Addr;
+    pTest->Len = pFrame->Len;
+    pTest->Value = 0;
+    for (uint8_t i = 0; i < pFrame->Len; i++)
+    {
+        pTest->Value = (pTest->Value << 8) | pFrame->pPayload[i];
+    }
+
+    // Every decoder must cope with whatever arrives on any address
+    if (pFrame->Addr < kNumRxCmds)
+    {
+#define FPGA_RX_CALL_DECODER(Name, Addr, Codec) (void)FPGA_Decode_##Name(pFrame);
+        FPGA_RX_MESSAGES(FPGA_RX_CALL_DECODER)
+#undef FPGA_RX_CALL_DECODER
+    }
+}
+
+int main() {
+    int failures = 0;
+    static FPGA_Decoder_t Decoder;
+    SelfTest_t Test = {0};
+    uint8_t Buffer[kSysMgmtConsts_MaxMsgProtoV2Len];
+
+    FPGA_Decoder_Init(&Decoder, OnFrame, &Test);
+
+    srand(6);
+    for (size_t iter = 0; iter < 100000; iter++)
+    {
+        const uint64_t Value = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+        const uint64_t Original = Value;
+        size_t Size = 0;
+        TxIDs_t eID = kTxCmd_SysCtrl;
+
+        switch (iter % 3)
+        {
+            case 0:
+                eID = kTxCmd_SysCtrl;
+                Size = FPGA_Encode_SysCtrl(Buffer, sizeof(Buffer), (uint16_t)Value, false);
+                break;
+            case 1:
+                eID = kTxCmd_PokeButton;
+                Size = FPGA_Encode_PokeButton(Buffer, sizeof(Buffer), (uint16_t)Value, false);
+                break;
+            default:
+                eID = kTxCmd_BGPaletteCtl;
+                Size = FPGA_Encode_BGPaletteCtl(Buffer, sizeof(Buffer), Value, false);
+                break;
+        }
+
+        const uint8_t Width = FPGA_TxSchema[eID].Width;
+        const uint64_t Expected = (Width < 8) ? (Original & ((1ull << (8 * Width)) - 1)) : Original;
+        const uint32_t StartFrames = Test.NumFrames;
+
+        (void) FPGA_Decoder_Feed(&Decoder, Buffer, Size);
+
+        if ((Size != (size_t)(kV2HeaderLen + Width + 1)) || (Test.NumFrames != StartFrames + 1) ||
+            (Test.Addr != eID) || (Test.Len != Width) || (Test.Value != Expected))
+        {
+            printf("Round trip %zu failed for %s\n", iter, FPGA_TxSchema[eID].pName);
+            failures++;
+            break;
+        }
+    }
+
+    // V1 frames carry the leading two bytes
+    const size_t V1Size = FPGA_Encode_BacklightCtl(Buffer, sizeof(Buffer), 0x0102, true);
+    if ((V1Size != kSysMgmtConsts_MaxMsgProtoV1Len) || (Buffer[0] != kSysMgmtConsts_HeaderV1Marker) ||
+        (Buffer[1] != kTxCmd_BacklightCtl) || (Buffer[2] != 0x01) || (Buffer[3] != 0x02))
+    {
+        printf("V1 encode failed\n");
+        failures++;
+    }
+
+    // Encoders refuse buffers that are too small
+    if (FPGA_Encode_SpritePaletteCtl(Buffer, 8, 0, false) != 0)
+    {
+        printf("Short buffer accepted\n");
+        failures++;
+    }
+
+    // Random garbage through the decoder and every typed decoder
+    uint8_t Garbage[256];
+    for (size_t iter = 0; iter < 20000; iter++)
+    {
+        for (size_t i = 0; i < sizeof(Garbage); i++)
+        {
+            Garbage[i] = (uint8_t)rand();
+        }
+        (void) FPGA_Decoder_Feed(&Decoder, Garbage, 1 + (rand() % sizeof(Garbage)));
+    }
+
+    printf("%u frames, %u CRC errors, %u oversize\n", Decoder.NumFrames, Decoder.NumCRCErrors, Decoder.NumOversizeLen);
+    printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+    return (failures == 0) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+// Single source of truth for the system management messages exchanged with the FPGA. Everything below is
+// expanded from the two lists, so adding a message means adding one line here. Free of FreeRTOS/IDF headers
+// so that the codec can be built and exercised on the host.
+
+#include "fpga_decode.h"
+#include "fpga_proto.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Messages from the FPGA: X(Name, Address, Codec)
+#define FPGA_RX_MESSAGES(X)                 \
+    X(VoltageAA,        0x0, U16)           \
+    X(VoltageLiPo,      0x1, U16)           \
+    X(Buttons,          0x2, U16)           \
+    X(AudioBrightness,  0x3, U16)           \
+    X(SysCtl,           0x4, U16)           \
+    X(PMIC,             0x5, U16)           \
+    X(FWVer,            0x6, U16)           \
+    X(Reserved,         0x7, None)          \
+    X(StatusExtended,   0x8, U32LE)         \
+    X(BGPalette,        0x9, U64BE)         \
+    X(ConfigAck,        0xA, U16)
+
+// Messages to the FPGA: X(Name, Address, Codec, IsCacheable)
+// Cacheable messages carry configuration state, so resending an unchanged payload has no effect on the FPGA.
+#define FPGA_TX_MESSAGES(X)                 \
+    X(SysCtrl,          0x4, U16BE, true)   \
+    X(BacklightCtl,     0x5, U16BE, true)   \
+    X(ReqFWVer,         0x6, U16BE, false)  \
+    X(PokeButton,       0x9, U16BE, false)  \
+    X(LinkCtl,          0xA, U16BE, false)  \
+    X(BGPaletteCtl,     0xB, U64BE, true)   \
+    X(SpritePaletteCtl, 0xC, U64BE, true)   \
+    X(ReqBGPD,          0xD, U16BE, false)
+
+// Payload codecs. U16 follows the V1/V2 packing rules of FPGA_Frame_GetU16(), the others are plain byte orders.
+#define FPGA_CODEC_TYPE_None    uint8_t
+#define FPGA_CODEC_TYPE_U16     uint16_t
+#define FPGA_CODEC_TYPE_U16BE   uint16_t
+#define FPGA_CODEC_TYPE_U32LE   uint32_t
+#define FPGA_CODEC_TYPE_U64BE   uint64_t
+
+#define FPGA_CODEC_WIDTH_None   0
+#define FPGA_CODEC_WIDTH_U16    2
+#define FPGA_CODEC_WIDTH_U16BE  2
+#define FPGA_CODEC_WIDTH_U32LE  4
+#define FPGA_CODEC_WIDTH_U64BE  8
+
+#define FPGA_CODEC_DECODE_None(pFrame)  ((void)(pFrame), 0)
+#define FPGA_CODEC_DECODE_U16(pFrame)   FPGA_Frame_GetU16(pFrame)
+#define FPGA_CODEC_DECODE_U32LE(pFrame) FPGA_Frame_GetU32(pFrame)
+#define FPGA_CODEC_DECODE_U64BE(pFrame) FPGA_Frame_GetU64(pFrame)
+
+#define FPGA_RX_ENUM(Name, Addr, Codec) kRxCmd_##Name = (Addr),
+typedef enum {
+    FPGA_RX_MESSAGES(FPGA_RX_ENUM)
+
+    kNumRxCmds,
+} RxIDs_t;
+#undef FPGA_RX_ENUM
+
+#define FPGA_TX_ENUM(Name, Addr, Codec, IsCacheable) kTxCmd_##Name = (Addr),
+typedef enum {
+    FPGA_TX_MESSAGES(FPGA_TX_ENUM)
+
+    kNumTxCmds,
+} TxIDs_t;
+#undef FPGA_TX_ENUM
+
+typedef struct FPGA_MsgSchema {
+    const char* pName;      // NULL for unused addresses
+    uint8_t Width;          // [bytes] Payload width
+    bool IsCacheable;
+} FPGA_MsgSchema_t;
+
+extern const FPGA_MsgSchema_t FPGA_RxSchema[kNumRxCmds];
+extern const FPGA_MsgSchema_t FPGA_TxSchema[kNumTxCmds];
+
+size_t FPGA_Schema_EncodeFrame(uint8_t *const pBuffer, const size_t Size, const uint8_t Addr, const uint8_t *const pPayload, const uint8_t Len, const bool V1);
+size_t FPGA_Schema_EncodeBE(uint8_t *const pBuffer, const size_t Size, const uint8_t Addr, const uint64_t Value, const uint8_t Width, const bool V1);
+
+// FPGA_Encode_<Name>(pBuffer, Size, Value, V1) writes a complete frame and returns its length, or 0 if it didn't fit.
+// The value is taken by copy, so the caller's data is never touched.
+#define FPGA_TX_ENCODER(Name, Addr, Codec, IsCacheable)                                                        \
+    static inline size_t FPGA_Encode_##Name(uint8_t *const pBuffer, const size_t Size,                          \
+                                            const FPGA_CODEC_TYPE_##Codec Value, const bool V1)                 \
+    {                                                                                                           \
+        return FPGA_Schema_EncodeBE(pBuffer, Size, (Addr), (uint64_t)Value, FPGA_CODEC_WIDTH_##Codec, V1);    \
+    }
+FPGA_TX_MESSAGES(FPGA_TX_ENCODER)
+#undef FPGA_TX_ENCODER
+
+// FPGA_Decode_<Name>(pFrame) returns the payload of a received frame as its native type
+#define FPGA_RX_DECODER(Name, Addr, Codec)                                                                      \
+    static inline FPGA_CODEC_TYPE_##Codec FPGA_Decode_##Name(const FPGA_Frame_t *const pFrame)                 \
+    {                                                                                                           \
+        return (FPGA_CODEC_TYPE_##Codec)FPGA_CODEC_DECODE_##Codec(pFrame);                                     \
+    }
+FPGA_RX_MESSAGES(FPGA_RX_DECODER)
+#undef FPGA_RX_DECODER
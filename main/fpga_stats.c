@@ -0,0 +1,293 @@
+#include "fpga_stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "argtable3/argtable3.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "fpga_rx.h"
+#endif
+
+enum {
+    kDumpBytesPerLine = 32,
+};
+
+// Written by the Rx and Tx tasks, read by the console. Individual counters are 32-bit so a reader never sees a torn
+// value, though a dump may straddle an update.
+static FPGA_Stats_t Stats;
+static int64_t LastRxArrival_us = -1;
+static uint32_t LinkBaudRate = kSysMgmtConsts_DefaultBaudRate;    // Survives a reset, it is state rather than a counter
+
+static inline FPGA_CmdStats_t* GetCmdStats(const FPGA_Dir_t eDir, const uint8_t Addr);
+
+void FPGA_Stats_Reset(void)
+{
+    memset(&Stats, 0x0, sizeof(Stats));
+    Stats.Version = kFPGA_StatsConsts_Version;
+    Stats.Size = sizeof(Stats);
+    Stats.LinkBaudRate = LinkBaudRate;
+    LastRxArrival_us = -1;
+}
+
+const FPGA_Stats_t* FPGA_Stats_Get(void)
+{
+    if (Stats.Version == 0)
+    {
+        FPGA_Stats_Reset();
+    }
+
+    return &Stats;
+}
+
+void FPGA_Stats_RecordFrame(const FPGA_Dir_t eDir, const uint8_t Addr, const size_t NumBytes)
+{
+    FPGA_CmdStats_t *const pCmd = GetCmdStats(eDir, Addr);
+    pCmd->NumFrames++;
+    pCmd->NumBytes += (uint32_t)NumBytes;
+}
+
+void FPGA_Stats_RecordCRCError(const uint8_t Addr)
+{
+    GetCmdStats(kFPGA_Dir_Rx, Addr)->NumCRCErrors++;
+}
+
+void FPGA_Stats_RecordOversizeLen(const uint8_t Addr)
+{
+    GetCmdStats(kFPGA_Dir_Rx, Addr)->NumOversizeLen++;
+}
+
+void FPGA_Stats_RecordSuppressed(const uint8_t Addr)
+{
+    GetCmdStats(kFPGA_Dir_Tx, Addr)->NumSuppressed++;
+}
+
+void FPGA_Stats_RecordDiscarded(const uint32_t NumBytes)
+{
+    Stats.NumDiscardedBytes += NumBytes;
+}
+
+void FPGA_Stats_RecordProtoSwitch(void)
+{
+    Stats.NumProtoSwitches++;
+}
+
+void FPGA_Stats_RecordRxOverflow(void)
+{
+    Stats.NumRxOverflows++;
+}
+
+void FPGA_Stats_RecordTxBatch(const uint32_t NumFrames)
+{
+    Stats.NumTxBatches++;
+    if (NumFrames > Stats.MaxFramesPerBatch)
+    {
+        Stats.MaxFramesPerBatch = NumFrames;
+    }
+}
+
+void FPGA_Stats_RecordRxArrival(const int64_t Now_us)
+{
+    if (LastRxArrival_us >= 0)
+    {
+        const int64_t Delta_us = Now_us - LastRxArrival_us;
+        FPGA_Stats_HistogramAdd(&Stats.RxInterArrival_us, (Delta_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)((Delta_us < 0) ? 0 : Delta_us));
+    }
+
+    LastRxArrival_us = Now_us;
+}
+
+void FPGA_Stats_RecordRxLatency(const uint32_t Latency_us)
+{
+    FPGA_Stats_HistogramAdd(&Stats.RxLatency_us, Latency_us);
+}
+
+void FPGA_Stats_RecordTxLatency(const uint32_t Latency_us)
+{
+    FPGA_Stats_HistogramAdd(&Stats.TxQueueToWire_us, Latency_us);
+}
+
+void FPGA_Stats_RecordLinkBaud(const uint32_t BaudRate, const bool IsFallback)
+{
+    (void) FPGA_Stats_Get();
+
+    LinkBaudRate = BaudRate;
+    Stats.LinkBaudRate = BaudRate;
+    if (IsFallback)
+    {
+        Stats.NumLinkFallbacks++;
+    }
+}
+
+void FPGA_Stats_RecordConfigAcks(const uint32_t NumAcked, const uint32_t NumResent, const uint32_t NumGivenUp)
+{
+    Stats.NumConfigAcks += NumAcked;
+    Stats.NumConfigResends += NumResent;
+    Stats.NumConfigGiveUps += NumGivenUp;
+}
+
+void FPGA_Stats_HistogramAdd(FPGA_Histogram_t *const pHistogram, const uint32_t Value)
+{
+    if (pHistogram == NULL)
+    {
+        return;
+    }
+
+    // Number of significant bits, so 0 -> 0, 1 -> 1, 2..3 -> 2, 4..7 -> 3 and so on
+    const uint32_t Bin = (Value == 0) ? 0 : (32u - (uint32_t)__builtin_clz(Value));
+    pHistogram->Bins[(Bin < kFPGA_StatsConsts_NumHistBins) ? Bin : (kFPGA_StatsConsts_NumHistBins - 1)]++;
+}
+
+static inline FPGA_CmdStats_t* GetCmdStats(const FPGA_Dir_t eDir, const uint8_t Addr)
+{
+    if (Stats.Version == 0)
+    {
+        FPGA_Stats_Reset();
+    }
+
+    const uint8_t Index = (Addr < kFPGA_StatsConsts_NumAddrs) ? Addr : (kFPGA_StatsConsts_NumAddrs - 1);
+    return &Stats.Cmds[(eDir == kFPGA_Dir_Tx) ? kFPGA_Dir_Tx : kFPGA_Dir_Rx][Index];
+}
+
+#if defined(ESP_PLATFORM)
+static const char* TAG = "FpgaStats";
+
+static struct {
+    struct arg_lit *binary;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} fpga_stats_args;
+
+static const char* GetName(const FPGA_Dir_t eDir, const uint8_t Addr)
+{
+    const FPGA_MsgSchema_t *const pSchema = (eDir == kFPGA_Dir_Rx) ? FPGA_RxSchema : FPGA_TxSchema;
+    const size_t NumCmds = (eDir == kFPGA_Dir_Rx) ? kNumRxCmds : kNumTxCmds;
+
+    if ((Addr < NumCmds) && (pSchema[Addr].pName != NULL))
+    {
+        return pSchema[Addr].pName;
+    }
+
+    return "?";
+}
+
+static void PrintHistogram(const char* pName, const FPGA_Histogram_t *const pHistogram)
+{
+    printf("%s (us):\n", pName);
+    for (size_t i = 0; i < kFPGA_StatsConsts_NumHistBins; i++)
+    {
+        if (pHistogram->Bins[i] != 0)
+        {
+            const uint32_t Lo = (i == 0) ? 0 : (1u << (i - 1));
+            printf("  >=%-8lu %lu\n", Lo, pHistogram->Bins[i]);
+        }
+    }
+}
+
+static void PrintBinary(void)
+{
+    // One header line followed by hex lines, so a host script can rebuild the struct from a console capture
+    const uint8_t *const pBytes = (const uint8_t*)&Stats;
+    printf("FPGA_STATS v%u %u\n", Stats.Version, Stats.Size);
+    for (size_t i = 0; i < sizeof(Stats); i++)
+    {
+        printf("%02X", pBytes[i]);
+        if (((i + 1) % kDumpBytesPerLine == 0) || (i + 1 == sizeof(Stats)))
+        {
+            printf("\n");
+        }
+    }
+}
+
+static void PrintText(void)
+{
+    static const char* DirNames[kNumFPGA_Dirs] = { "Rx", "Tx" };
+
+    printf("%-3s %-17s %8s %9s %6s %6s %6s\n", "Dir", "Cmd", "Frames", "Bytes", "CRC", "Len", "Supp");
+    for (size_t d = 0; d < kNumFPGA_Dirs; d++)
+    {
+        for (size_t a = 0; a < kFPGA_StatsConsts_NumAddrs; a++)
+        {
+            const FPGA_CmdStats_t *const pCmd = &Stats.Cmds[d][a];
+            if ((pCmd->NumFrames | pCmd->NumCRCErrors | pCmd->NumOversizeLen | pCmd->NumSuppressed) == 0)
+            {
+                continue;
+            }
+
+            printf("%-3s %-17s %8lu %9lu %6lu %6lu %6lu\n", DirNames[d], GetName((FPGA_Dir_t)d, (uint8_t)a),
+                pCmd->NumFrames, pCmd->NumBytes, pCmd->NumCRCErrors, pCmd->NumOversizeLen, pCmd->NumSuppressed);
+        }
+    }
+
+    printf("Discarded: %lu bytes, V1/V2 switches: %lu, Rx overflows: %lu\n", Stats.NumDiscardedBytes, Stats.NumProtoSwitches, Stats.NumRxOverflows);
+    printf("Tx batches: %lu, max frames per batch: %lu\n", Stats.NumTxBatches, Stats.MaxFramesPerBatch);
+    printf("Link: %lu baud, %lu fallbacks\n", Stats.LinkBaudRate, Stats.NumLinkFallbacks);
+    printf("Config writes: %lu acked, %lu resent, %lu given up\n", Stats.NumConfigAcks, Stats.NumConfigResends, Stats.NumConfigGiveUps);
+
+    const FPGA_RxLatencyStats_t *const pLatency = FPGA_Rx_GetLatencyStats();
+    if (pLatency->NumFrames > 0)
+    {
+        printf("Rx latency: min %lu avg %lu max %lu us\n", pLatency->Min_us, (uint32_t)(pLatency->Total_us / pLatency->NumFrames), pLatency->Max_us);
+    }
+
+    PrintHistogram("Rx inter-arrival", &Stats.RxInterArrival_us);
+    PrintHistogram("Rx latency", &Stats.RxLatency_us);
+    PrintHistogram("Tx queue to wire", &Stats.TxQueueToWire_us);
+}
+
+static int fpga_stats_command(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&fpga_stats_args);
+    if (nerrors != 0)
+    {
+        arg_print_errors(stderr, fpga_stats_args.end, argv[0]);
+        return 1;
+    }
+
+    (void) FPGA_Stats_Get();
+
+    if (fpga_stats_args.binary->count > 0)
+    {
+        PrintBinary();
+    }
+    else
+    {
+        PrintText();
+    }
+
+    if (fpga_stats_args.reset->count > 0)
+    {
+        FPGA_Stats_Reset();
+    }
+
+    return 0;
+}
+
+void FPGA_Stats_RegisterCommands(void)
+{
+    fpga_stats_args.binary = arg_lit0("b", "binary", "Dump the raw statistics struct as hex");
+    fpga_stats_args.reset = arg_lit0("r", "reset", "Clear the statistics after printing");
+    fpga_stats_args.end = arg_end(2);
+
+    esp_console_cmd_t command = {
+        .command = "fpga_stats",
+        .help = "Shows FPGA link counters and latency histograms",
+        .func = &fpga_stats_command,
+        .argtable = &fpga_stats_args,
+    };
+
+    esp_err_t err;
+    if ((err = esp_console_cmd_register(&command)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Registering '%s' command failed: %s", command.command, esp_err_to_name(err));
+    }
+}
+#else
+void FPGA_Stats_RegisterCommands(void)
+{
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "fpga_schema.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kFPGA_Dir_Rx,
+    kFPGA_Dir_Tx,
+
+    kNumFPGA_Dirs,
+} FPGA_Dir_t;
+
+typedef enum {
+    kFPGA_StatsConsts_Version     = 3,
+    kFPGA_StatsConsts_NumAddrs    = 16,   // Frames on higher addresses are lumped into the last entry
+    kFPGA_StatsConsts_NumHistBins = 24,   // [log2 us] The last bin also counts anything longer than ~4 s
+} FPGA_StatsConsts_t;
+
+typedef struct FPGA_CmdStats {
+    uint32_t NumFrames;
+    uint32_t NumBytes;
+    uint32_t NumCRCErrors;
+    uint32_t NumOversizeLen;
+    uint32_t NumSuppressed;     // Tx only, unchanged writes dropped by the shadow cache
+} FPGA_CmdStats_t;
+
+// Bin 0 counts zero, bin n counts values in [2^(n-1), 2^n)
+typedef struct FPGA_Histogram {
+    uint32_t Bins[kFPGA_StatsConsts_NumHistBins];
+} FPGA_Histogram_t;
+
+// Dumped as-is by `fpga_stats -b`, so only ever append fields and bump the version when the layout changes
+typedef struct FPGA_Stats {
+    uint16_t Version;
+    uint16_t Size;
+
+    FPGA_CmdStats_t Cmds[kNumFPGA_Dirs][kFPGA_StatsConsts_NumAddrs];
+
+    uint32_t NumDiscardedBytes;         // Skipped while scanning for a header marker
+    uint32_t NumProtoSwitches;          // V1 <-> V2
+    uint32_t NumRxOverflows;
+    uint32_t NumTxBatches;
+    uint32_t MaxFramesPerBatch;
+
+    FPGA_Histogram_t RxInterArrival_us;
+    FPGA_Histogram_t RxLatency_us;      // First byte on the wire to dispatch
+    FPGA_Histogram_t TxQueueToWire_us;  // Request to the frame's last byte leaving the UART
+
+    // Added in version 2
+    uint32_t LinkBaudRate;
+    uint32_t NumLinkFallbacks;          // Negotiated rates abandoned after errors or link loss
+
+    // Added in version 3
+    uint32_t NumConfigAcks;
+    uint32_t NumConfigResends;
+    uint32_t NumConfigGiveUps;          // Writes that were never acknowledged
+} FPGA_Stats_t;
+
+void FPGA_Stats_Reset(void);
+const FPGA_Stats_t* FPGA_Stats_Get(void);
+
+void FPGA_Stats_RecordFrame(const FPGA_Dir_t eDir, const uint8_t Addr, const size_t NumBytes);
+void FPGA_Stats_RecordCRCError(const uint8_t Addr);
+void FPGA_Stats_RecordOversizeLen(const uint8_t Addr);
+void FPGA_Stats_RecordSuppressed(const uint8_t Addr);
+void FPGA_Stats_RecordDiscarded(const uint32_t NumBytes);
+void FPGA_Stats_RecordProtoSwitch(void);
+void FPGA_Stats_RecordRxOverflow(void);
+void FPGA_Stats_RecordTxBatch(const uint32_t NumFrames);
+void FPGA_Stats_RecordRxArrival(const int64_t Now_us);
+void FPGA_Stats_RecordRxLatency(const uint32_t Latency_us);
+void FPGA_Stats_RecordTxLatency(const uint32_t Latency_us);
+void FPGA_Stats_RecordLinkBaud(const uint32_t BaudRate, const bool IsFallback);
+void FPGA_Stats_RecordConfigAcks(const uint32_t NumAcked, const uint32_t NumResent, const uint32_t NumGivenUp);
+
+void FPGA_Stats_HistogramAdd(FPGA_Histogram_t *const pHistogram, const uint32_t Value);
+void FPGA_Stats_RegisterCommands(void);
@@ -6,11 +6,16 @@
 #include "dpad_ctl.h"
 #include "color_correct_lcd.h"
 #include "color_correct_usb.h"
-#include "crc8_sae_j1850.h"
 #include "driver/uart.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "fpga_ack.h"
 #include "fpga_common.h"
+#include "fpga_link.h"
+#include "fpga_rx.h"
+#include "fpga_schema.h"
+#include "fpga_stats.h"
 #include "frameblend.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -19,6 +24,7 @@
 #include "player_num.h"
 #include "silent.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -32,6 +38,11 @@ enum {
     kFlag_SetPaletteStyle,
     kFlag_RequestBGPD,
     kNumFlags,
+
+    // Not part of kTxFlag_AllFlags so that FPGA_Tx_SendAll() can still be deduplicated
+    kFlag_ForceResync = kNumFlags,
+    kFlag_BGPDReadback,
+    kFlag_LinkEvent,
 };
 
 typedef enum {
@@ -43,24 +54,38 @@ typedef enum {
     kTxFlag_SetPaletteStyle  = (1 << kFlag_SetPaletteStyle),
     kTxFlag_RequestBGPD      = (1 << kFlag_RequestBGPD),
 
+    kTxFlag_ForceResync      = (1 << kFlag_ForceResync),
+    kTxFlag_BGPDReadback     = (1 << kFlag_BGPDReadback),
+    kTxFlag_LinkEvent        = (1 << kFlag_LinkEvent),
+
     kTxFlag_AllFlags         = ((1 << kNumFlags) - 1),
 } TxFlags_t;
 
-typedef enum {
-    kTxCmd_Reserved0        = 0x0,
-    kTxCmd_Reserved1        = 0x1,
-    kTxCmd_Reserved2        = 0x2,
-    kTxCmd_Reserved3        = 0x3,
-    kTxCmd_SysCtrl          = 0x4,
-    kTxCmd_BacklightCtl     = 0x5,
-    kTxCmd_ReqFWVer         = 0x6,
-    kTxCmd_PokeButton       = 0x9,
-    kTxCmd_BGPaletteCtl     = 0xB,
-    kTxCmd_SpritePaletteCtl = 0xC,
-    kTxCmd_ReqBGPD          = 0xD,
-
-    kNumTxCmds,
-} TxIDs_t;
+enum {
+    // Every flag produces one frame except the palette, which is sent for both the BG and sprite layers
+    kTxBatch_MaxFrames = kNumFlags,
+    kTxBatch_BufferSize = kTxBatch_MaxFrames * kSysMgmtConsts_MaxMsgProtoV2Len,
+
+    kTxBitsPerByte = 10,    // 8N1
+};
+
+// All frames requested in a single wakeup are serialized back to back and handed to the driver in one call
+typedef struct TxBatch {
+    uint8_t Buffer[kTxBatch_BufferSize];
+    size_t Length;
+    uint32_t NumFrames;
+
+    // Per frame, for the queue to wire latency histogram
+    uint32_t QueuedAt_us[kTxBatch_MaxFrames];
+    uint16_t EndOffset[kTxBatch_MaxFrames];
+} TxBatch_t;
+
+// Last payload known to have reached the FPGA for each configuration command: acknowledged when acks are active,
+// otherwise simply sent
+typedef struct TxShadow {
+    uint64_t Value;
+    bool IsValid;
+} TxShadow_t;
 
 // Declare a variable to hold the handle of the created event group.
 static EventGroupHandle_t xEventGroupHandle;
@@ -69,7 +94,26 @@ static EventGroupHandle_t xEventGroupHandle;
 static StaticEventGroup_t xCreatedEventGroup;
 static const char* TAG = "FpgaTx";
 
-static size_t SetupTxBuffer(uint8_t *const pBuffer, TxIDs_t eID, uint8_t Len, void* pData);
+static TxBatch_t Batch;
+static TxShadow_t Shadow[kNumTxCmds];
+static FPGA_AckTracker_t Acks;
+static bool IsAckActive = false;
+
+// Until the boot repeats are over, writes that can't be confirmed go out on every pass in case one was lost
+static volatile bool IsShadowHeld = true;
+
+// When each pending request was first made, 0 if unknown. Written before the flag is set and consumed with it.
+static volatile uint32_t QueuedAt_us[kNumFlags];
+
+static void RequestFlags(const EventBits_t Flags);
+static void TakeQueuedAt(const EventBits_t Flags, uint32_t *const pQueuedAt_us);
+static void Batch_Append(TxBatch_t *const pBatch, const TxIDs_t eID, const uint64_t Value, const uint32_t QueuedAt_us);
+static void Batch_Write(TxBatch_t *const pBatch, const TxIDs_t eID, const uint64_t Value, const uint32_t QueuedAt_us, const int Seq);
+static void Batch_Flush(TxBatch_t *const pBatch);
+static bool Shadow_IsUnchanged(const TxIDs_t eID, const uint64_t Value);
+static void Link_Service(void);
+static void Ack_Service(void);
+static TickType_t GetWaitTicks(void);
 
 void FPGA_TxTask(void *arg)
 {
@@ -80,8 +124,6 @@ void FPGA_TxTask(void *arg)
     FPGA_Tx_SendAll();
     FPGA_Tx_Resume();
 
-    uint8_t TxBuffer[14] = {0};
-
     while (1)
     {
         //Only run when we're given permission to do so.
@@ -95,20 +137,38 @@ void FPGA_TxTask(void *arg)
 
         const EventBits_t EventBits = xEventGroupWaitBits(
             xEventGroupHandle,
-            (kTxFlag_WriteBrightness | kTxFlag_SetSysCtl | kTxFlag_RequestFWVer | kTxFlag_PokeButton | kTxFlag_SetPaletteStyle | kTxFlag_RequestBGPD),
+            (kTxFlag_WriteBrightness | kTxFlag_SetSysCtl | kTxFlag_RequestFWVer | kTxFlag_PokeButton | kTxFlag_SetPaletteStyle | kTxFlag_RequestBGPD | kTxFlag_ForceResync | kTxFlag_LinkEvent),
             pdTRUE, // DO clear the flags to complete the request
             pdFALSE, // Any bit will do
-            pdMS_TO_TICKS(100)
+            GetWaitTicks()
         );
 
+        uint32_t RequestedAt_us[kNumFlags];
+        TakeQueuedAt(EventBits, RequestedAt_us);
+
+        if ((EventBits & kTxFlag_ForceResync) == kTxFlag_ForceResync)
+        {
+            // The FPGA may have lost its configuration, so the next write of every command goes out regardless
+            memset(Shadow, 0x0, sizeof(Shadow));
+            FPGA_Link_Reset(FPGA_GetLink());
+        }
+
+        // Frames are appended in a fixed priority order: button pokes first since a user is waiting on them, then
+        // configuration writes, then readback requests. The BG palette request must precede the palette writes so
+        // the hotkey palette is read back before it is overwritten.
+        if ((EventBits & kTxFlag_PokeButton) == kTxFlag_PokeButton)
+        {
+            const uint16_t PokedButtons = Button_GetPokedInputs();
+            Batch_Append(&Batch, kTxCmd_PokeButton, PokedButtons, RequestedAt_us[kFlag_PokeButton]);
+        }
+
         if ((EventBits & kTxFlag_WriteBrightness) == kTxFlag_WriteBrightness)
         {
             const uint16_t MaxDisplayBrightness = 16;
-            uint16_t Backlight = (uint16_t)Brightness_GetLevel();
+            const uint16_t Backlight = (uint16_t)Brightness_GetLevel();
             if (Backlight < MaxDisplayBrightness)
             {
-                const size_t Size = SetupTxBuffer(TxBuffer, kTxCmd_BacklightCtl, sizeof(Backlight), (void*)&Backlight);
-                (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size);
+                Batch_Append(&Batch, kTxCmd_BacklightCtl, Backlight, RequestedAt_us[kFlag_SetBrightness]);
             }
         }
 
@@ -126,58 +186,117 @@ void FPGA_TxTask(void *arg)
             const uint16_t LowBattIconControl = (uint16_t)(LowBattIconCtl_GetState());
 
             const uint16_t Payload = ( (frame_blending << 1) | (color_correct << 2) | ismuted | (playernum << 4) | (EnableScreenTransitionFix << 12) | (IgnoreDiagonalInputs << 11) | (LowBattIconControl << 13));
-            const size_t Size = SetupTxBuffer(TxBuffer, kTxCmd_SysCtrl, sizeof(Payload), (void*)&Payload);
-            (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size);
+            Batch_Append(&Batch, kTxCmd_SysCtrl, Payload, RequestedAt_us[kFlag_SetSysCtl]);
         }
 
         if ((EventBits & kTxFlag_RequestFWVer) == kTxFlag_RequestFWVer)
         {
-            uint16_t dummy = 0;
-            const size_t Size = SetupTxBuffer(TxBuffer, kTxCmd_ReqFWVer, sizeof(dummy), &dummy);
-            (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size);
-        }
-
-        if ((EventBits & kTxFlag_PokeButton) == kTxFlag_PokeButton)
-        {
-            const uint16_t PokedButtons = Button_GetPokedInputs();
-            const size_t Size = SetupTxBuffer(TxBuffer, kTxCmd_PokeButton, sizeof(PokedButtons), (void*)&PokedButtons);
-            (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size);
+            // V2 FPGAs ignore the payload, V3 ones answer with their capabilities
+            const uint16_t CapsRequest = FPGA_IsProtoV1() ? 0 : FPGA_Link_GetCapsRequest(FPGA_GetLink());
+            Batch_Append(&Batch, kTxCmd_ReqFWVer, CapsRequest, RequestedAt_us[kFlag_RequestFWVer]);
         }
 
         if ((EventBits & kTxFlag_RequestBGPD) == kTxFlag_RequestBGPD)
         {
-            uint16_t dummy = 0;
-            const size_t Size = SetupTxBuffer(TxBuffer, kTxCmd_ReqBGPD, sizeof(dummy), &dummy);
-            (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size);
+            (void) xEventGroupClearBits(xEventGroupHandle, kTxFlag_BGPDReadback);
+            Batch_Append(&Batch, kTxCmd_ReqBGPD, 0, RequestedAt_us[kFlag_RequestBGPD]);
         }
 
         if ((EventBits & kTxFlag_SetPaletteStyle) == kTxFlag_SetPaletteStyle)
         {
             if (!Style_IsInitialized())
             {
-                // Prevent palette from being sent fast on initail SendAll()s
-                // so that there is time to read back the hotkey data from FPGA
-                vTaskDelay( pdMS_TO_TICKS(50) );
+                // Hold the palette back on the initial SendAll()s until the hotkey data has been read back from the
+                // FPGA, or for at most 50 ms for FPGAs that never answer.
+                // Everything queued so far goes out first so the readback request isn't held up.
+                Batch_Flush(&Batch);
+                (void) xEventGroupWaitBits(xEventGroupHandle, kTxFlag_BGPDReadback, pdTRUE, pdTRUE, pdMS_TO_TICKS(50));
                 Style_Initialize();
             }
             const StyleID_t ID = Style_GetCurrID();
             const uint64_t PaletteBG = Style_GetPaletteBG(ID);
             // toggle custom palette enable bit
-            const uint64_t Payload = __builtin_bswap64(PaletteBG ^ ((uint64_t)1 << kCustomPaletteEn));
-
-            const size_t Size = SetupTxBuffer(TxBuffer, kTxCmd_BGPaletteCtl, sizeof(Payload), (void*)&Payload);
-            (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size);
+            const uint64_t Payload = PaletteBG ^ ((uint64_t)1 << kCustomPaletteEn);
 
-            const size_t Size2 = SetupTxBuffer(TxBuffer, kTxCmd_SpritePaletteCtl, sizeof(Payload), (void*)&Payload);
-            (void) uart_write_bytes(UART_NUM_1, TxBuffer, Size2);
+            Batch_Append(&Batch, kTxCmd_BGPaletteCtl, Payload, RequestedAt_us[kFlag_SetPaletteStyle]);
+            Batch_Append(&Batch, kTxCmd_SpritePaletteCtl, Payload, RequestedAt_us[kFlag_SetPaletteStyle]);
         }
 
-        memset(TxBuffer, 0x0, sizeof(TxBuffer));
+        Batch_Flush(&Batch);
+
+        // Runs when a link or acknowledgement deadline is due, or the Rx task saw a reply either of them acts on
+        Link_Service();
+        Ack_Service();
+        Batch_Flush(&Batch);
     }
 
     ESP_LOGE(TAG, "TxTask loop exited");
 }
 
+void FPGA_Tx_OnConfigAck(const FPGA_Frame_t *const pFrame)
+{
+    FPGA_Ack_OnAck(&Acks, pFrame);
+    FPGA_Tx_OnLinkEvent();
+}
+
+// The Rx task recorded a reply the link or acknowledgement tracking acts on, which the Tx task would otherwise only
+// see at its next deadline
+void FPGA_Tx_OnLinkEvent(void)
+{
+   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_LinkEvent);
+}
+
+void FPGA_Tx_OnBGPaletteReadback(void)
+{
+   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_BGPDReadback);
+}
+
+bool FPGA_Tx_IsConfigured(void)
+{
+    return IsAckActive && FPGA_Ack_IsIdle(&Acks) && Style_IsInitialized();
+}
+
+// Called once main() stops repeating FPGA_Tx_SendAll() at boot, unchanged writes are suppressed from then on
+void FPGA_Tx_EndBootRepeats(void)
+{
+    IsShadowHeld = false;
+}
+
+void FPGA_Tx_ForceResync(void)
+{
+   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_ForceResync);
+}
+
+// Called with the Tx task paused, before light sleep. The FPGA would only fall back after kFPGA_LinkConsts_LinkLoss of
+// silence, and the brightness readback that resumes the Tx task on wake can't be decoded until both ends agree on the
+// rate, so both go back to the default now. The Tx task renegotiates once it runs again.
+void FPGA_Tx_RevertLink(void)
+{
+    FPGA_Link_t *const pLink = FPGA_GetLink();
+    if (FPGA_Link_GetBaudRate(pLink) == kSysMgmtConsts_DefaultBaudRate)
+    {
+        return;
+    }
+
+    uint8_t Frame[kSysMgmtConsts_MaxMsgProtoV2Len];
+    const size_t Size = FPGA_Schema_EncodeBE(Frame, sizeof(Frame), kTxCmd_LinkCtl, FPGA_Link_GetRevertCtl(),
+                                             FPGA_TxSchema[kTxCmd_LinkCtl].Width, false);
+    (void) uart_write_bytes(UART_NUM_1, Frame, Size);
+    (void) uart_wait_tx_done(UART_NUM_1, pdMS_TO_TICKS(20));
+    FPGA_Stats_RecordFrame(kFPGA_Dir_Tx, kTxCmd_LinkCtl, Size);
+
+    esp_err_t err;
+    if ((err = uart_set_baudrate(UART_NUM_1, kSysMgmtConsts_DefaultBaudRate)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Reverting the link to %d baud failed: %s", kSysMgmtConsts_DefaultBaudRate, esp_err_to_name(err));
+    }
+    FPGA_Rx_SetBaudRate(kSysMgmtConsts_DefaultBaudRate);
+    FPGA_Stats_RecordLinkBaud(kSysMgmtConsts_DefaultBaudRate, false);
+
+    // Brings the link state down to the default rate as well, and asks for the capabilities again
+    FPGA_Link_Reset(pLink);
+}
+
 void FPGA_Tx_Resume(void)
 {
    (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_Resume);
@@ -190,63 +309,281 @@ void FPGA_Tx_Pause(void)
 
 void FPGA_Tx_SendAll(void)
 {
-   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_AllFlags);
+   RequestFlags(kTxFlag_AllFlags);
 }
 
 void FPGA_Tx_WriteBrightness(void)
 {
-   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_WriteBrightness);
+   RequestFlags(kTxFlag_WriteBrightness);
 }
 
 void FPGA_Tx_SendSysCtl(void)
 {
-   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_SetSysCtl);
+   RequestFlags(kTxFlag_SetSysCtl);
 }
 
 void FPGA_Tx_PokeButtons(void)
 {
-   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_PokeButton);
+   RequestFlags(kTxFlag_PokeButton);
 }
 
 void FPGA_Tx_WritePaletteStyle(void)
 {
-   (void) xEventGroupSetBits(xEventGroupHandle, kTxFlag_SetPaletteStyle);
+   RequestFlags(kTxFlag_SetPaletteStyle);
+}
+
+static void RequestFlags(const EventBits_t Flags)
+{
+    const uint32_t Now_us = (uint32_t)esp_timer_get_time();
+
+    for (size_t i = 0; i < kNumFlags; i++)
+    {
+        if (((Flags & (1 << i)) != 0) && (QueuedAt_us[i] == 0))
+        {
+            QueuedAt_us[i] = Now_us;
+        }
+    }
+
+   (void) xEventGroupSetBits(xEventGroupHandle, Flags);
 }
 
-static size_t SetupTxBuffer(uint8_t *const pBuffer, TxIDs_t eID, uint8_t Len, void* pData)
+static void TakeQueuedAt(const EventBits_t Flags, uint32_t *const pQueuedAt_us)
 {
-    if ((pBuffer == NULL) || (Len > kSysMgmtConsts_MsgProtoV2Len) || (pData == NULL) || ((unsigned)eID >= kNumTxCmds))
+    for (size_t i = 0; i < kNumFlags; i++)
     {
-        return 0;
+        pQueuedAt_us[i] = 0;
+        if ((Flags & (1 << i)) != 0)
+        {
+            pQueuedAt_us[i] = QueuedAt_us[i];
+            QueuedAt_us[i] = 0;
+        }
     }
+}
 
-    pBuffer[0] = (uint8_t)(FPGA_IsProtoV1() ? kSysMgmtConsts_HeaderV1Marker : kSysMgmtConsts_HeaderV2Marker);
-    pBuffer[1] = (uint8_t)eID;
+static void Batch_Append(TxBatch_t *const pBatch, const TxIDs_t eID, const uint64_t Value, const uint32_t QueuedAt_us)
+{
+    if (((unsigned)eID >= kNumTxCmds) || (FPGA_TxSchema[eID].pName == NULL))
+    {
+        return;
+    }
 
-    size_t MsgSize = 4;
-    size_t PayloadOffset = 2;
-    if (pBuffer[0] == kSysMgmtConsts_HeaderV2Marker)
+    if (Shadow_IsUnchanged(eID, Value))
     {
-        PayloadOffset++;
+        FPGA_Stats_RecordSuppressed((uint8_t)eID);
+        return;
     }
 
-    if ((pData != NULL) && (Len > 0))
+    int Seq = -1;
+    if (IsAckActive && FPGA_TxSchema[eID].IsCacheable)
     {
-        // 16-bit data is sent in big endian
-        if (Len == 2)
+        Seq = FPGA_Ack_Track(&Acks, (uint8_t)eID, Value, (uint32_t)(esp_timer_get_time() / 1000));
+    }
+
+    Batch_Write(pBatch, eID, Value, QueuedAt_us, Seq);
+}
+
+// Seq is negative for frames that are not sequenced
+static void Batch_Write(TxBatch_t *const pBatch, const TxIDs_t eID, const uint64_t Value, const uint32_t QueuedAt_us, const int Seq)
+{
+    if (((pBatch->Length + kSysMgmtConsts_MaxMsgProtoV2Len) > sizeof(pBatch->Buffer)) || (pBatch->NumFrames >= kTxBatch_MaxFrames))
+    {
+        // Only resends can push a wakeup past one frame per flag, never overrun the buffer
+        ESP_LOGW(TAG, "Tx batch full, flushing early");
+        Batch_Flush(pBatch);
+    }
+
+    uint8_t *const pFrame = &pBatch->Buffer[pBatch->Length];
+    const size_t Remaining = sizeof(pBatch->Buffer) - pBatch->Length;
+    const size_t Size = (Seq >= 0) ?
+        FPGA_Ack_EncodeFrame(pFrame, Remaining, (uint8_t)eID, Value, FPGA_TxSchema[eID].Width, (uint8_t)Seq) :
+        FPGA_Schema_EncodeBE(pFrame, Remaining, (uint8_t)eID, Value, FPGA_TxSchema[eID].Width, FPGA_IsProtoV1());
+    if (Size > 0)
+    {
+        pBatch->Length += Size;
+        pBatch->QueuedAt_us[pBatch->NumFrames] = QueuedAt_us;
+        pBatch->EndOffset[pBatch->NumFrames] = (uint16_t)pBatch->Length;
+        pBatch->NumFrames++;
+
+        FPGA_Stats_RecordFrame(kFPGA_Dir_Tx, (uint8_t)eID, Size);
+    }
+}
+
+static void Batch_Flush(TxBatch_t *const pBatch)
+{
+    if (pBatch->Length == 0)
+    {
+        return;
+    }
+
+    (void) uart_write_bytes(UART_NUM_1, pBatch->Buffer, pBatch->Length);
+    const uint32_t Now_us = (uint32_t)esp_timer_get_time();
+    const uint32_t BaudRate = FPGA_Link_GetBaudRate(FPGA_GetLink());
+
+    // The driver copies into its ring buffer and returns, so each frame reaches the wire once every byte ahead of
+    // it in the batch has been shifted out
+    for (uint32_t i = 0; i < pBatch->NumFrames; i++)
+    {
+        if (pBatch->QueuedAt_us[i] != 0)
         {
-            uint16_t *const  pu16Data = (uint16_t *const)pData;
-            *pu16Data = __builtin_bswap16(*pu16Data);
+            const uint32_t OnWire_us = (uint32_t)(((uint64_t)pBatch->EndOffset[i] * kTxBitsPerByte * 1000000u) / BaudRate);
+            FPGA_Stats_RecordTxLatency((Now_us - pBatch->QueuedAt_us[i]) + OnWire_us);
         }
+    }
+
+    FPGA_Stats_RecordTxBatch(pBatch->NumFrames);
 
-        memcpy(&pBuffer[PayloadOffset], pData, Len);
+    memset(pBatch->Buffer, 0x0, pBatch->Length);
+    pBatch->Length = 0;
+    pBatch->NumFrames = 0;
+}
+
+static bool Shadow_IsUnchanged(const TxIDs_t eID, const uint64_t Value)
+{
+    // Requests and pokes must always reach the FPGA
+    if (!FPGA_TxSchema[eID].IsCacheable)
+    {
+        return false;
+    }
+
+    TxShadow_t *const pShadow = &Shadow[eID];
+
+    if (IsAckActive)
+    {
+        // A write still waiting on its ack is resent until it's confirmed or given up on, so repeating it adds
+        // nothing. The shadow itself only moves once Ack_Service() sees the acknowledgement.
+        const FPGA_AckSlot_t *const pSlot = &Acks.Slots[eID];
+        if (pSlot->IsPending)
+        {
+            return (pSlot->Value == Value);
+        }
+
+        return pShadow->IsValid && (pShadow->Value == Value);
     }
 
-    if (pBuffer[0] == kSysMgmtConsts_HeaderV2Marker)
+    // Nothing confirms a plain write, so during the boot repeats every pass sends it again
+    const bool IsUnchanged = !IsShadowHeld && pShadow->IsValid && (pShadow->Value == Value);
+
+    pShadow->Value = Value;
+    pShadow->IsValid = true;
+
+    return IsUnchanged;
+}
+
+static void Link_Service(void)
+{
+    FPGA_Link_t *const pLink = FPGA_GetLink();
+    const FPGA_LinkAction_t eAction = FPGA_Link_Poll(pLink, (uint32_t)(esp_timer_get_time() / 1000));
+
+    switch (eAction)
+    {
+        case kFPGA_LinkAction_KeepAlive:
+            RequestFlags(kTxFlag_RequestFWVer);
+            return;
+
+        case kFPGA_LinkAction_SwitchBaud:
+        case kFPGA_LinkAction_Fallback:
+            // LinkCtl goes out at the old rate and has to be fully shifted out before the UART is reclocked
+            Batch_Append(&Batch, kTxCmd_LinkCtl, FPGA_Link_GetLinkCtl(pLink), 0);
+            Batch_Flush(&Batch);
+            (void) uart_wait_tx_done(UART_NUM_1, pdMS_TO_TICKS(20));
+            break;
+
+        case kFPGA_LinkAction_Revert:
+            break;
+
+        default:
+            return;
+    }
+
+    const uint32_t BaudRate = FPGA_Link_GetBaudRate(pLink);
+    esp_err_t err;
+    if ((err = uart_set_baudrate(UART_NUM_1, BaudRate)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Setting the link to %lu baud failed: %s", BaudRate, esp_err_to_name(err));
+    }
+    FPGA_Rx_SetBaudRate(BaudRate);
+    FPGA_Stats_RecordLinkBaud(BaudRate, (eAction == kFPGA_LinkAction_Fallback));
+    ESP_LOGI(TAG, "Link now at %lu baud", BaudRate);
+
+    // Confirms a switch, or asks for the capabilities again at the default rate
+    RequestFlags(kTxFlag_RequestFWVer);
+}
+
+static void Ack_Service(void)
+{
+    const bool IsActive = !FPGA_IsProtoV1() && FPGA_Link_HasFeature(FPGA_GetLink(), kFPGA_LinkFeature_Ack);
+
+    if (IsActive != IsAckActive)
+    {
+        IsAckActive = IsActive;
+        FPGA_Ack_Init(&Acks);
+
+        if (IsActive)
+        {
+            // Whatever was written before the handshake went out unsequenced, so write it again to have it confirmed
+            ESP_LOGI(TAG, "Acknowledged config writes enabled");
+            memset(Shadow, 0x0, sizeof(Shadow));
+            FPGA_Tx_SendAll();
+        }
+        return;
+    }
+
+    if (!IsAckActive)
+    {
+        return;
+    }
+
+    const FPGA_AckResult_t Result = FPGA_Ack_Poll(&Acks, (uint32_t)(esp_timer_get_time() / 1000));
+    uint32_t NumAcked = 0;
+    uint32_t NumResent = 0;
+    uint32_t NumGivenUp = 0;
+
+    for (size_t i = 0; i < kNumTxCmds; i++)
+    {
+        const uint32_t Bit = (1u << i);
+
+        if ((Result.AckedMask & Bit) != 0)
+        {
+            Shadow[i].Value = Acks.Slots[i].Value;
+            Shadow[i].IsValid = true;
+            NumAcked++;
+        }
+
+        if ((Result.ResendMask & Bit) != 0)
+        {
+            // Resent as is, bypassing the shadow which would suppress it as pending
+            Batch_Write(&Batch, (TxIDs_t)i, Acks.Slots[i].Value, 0, Acks.Slots[i].Seq);
+            NumResent++;
+        }
+
+        if ((Result.GiveUpMask & Bit) != 0)
+        {
+            // The shadow still holds the last confirmed value, so the next write of this one goes out again
+            ESP_LOGW(TAG, "%s was never acknowledged", FPGA_TxSchema[i].pName);
+            NumGivenUp++;
+        }
+    }
+
+    if ((NumAcked | NumResent | NumGivenUp) != 0)
+    {
+        FPGA_Stats_RecordConfigAcks(NumAcked, NumResent, NumGivenUp);
+    }
+}
+
+// Blocks for good while no sequenced write is outstanding and the link has no deadline, e.g. with an FPGA that
+// predates the handshake, so the task only wakes for requests
+static TickType_t GetWaitTicks(void)
+{
+    const uint32_t Now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    const uint32_t AckTimeout_ms = FPGA_Ack_GetTimeout(&Acks, Now_ms);
+    const uint32_t LinkTimeout_ms = FPGA_Link_GetTimeout(FPGA_GetLink(), Now_ms);
+    const uint32_t Timeout_ms = (AckTimeout_ms < LinkTimeout_ms) ? AckTimeout_ms : LinkTimeout_ms;
+    if (Timeout_ms == UINT32_MAX)
     {
-        pBuffer[2] = Len;
-        MsgSize = crc8_sae_j1850_encode(pBuffer, 3 + Len, pBuffer);
+        return portMAX_DELAY;
     }
 
-    return MsgSize;
+    // Never zero, a resend that is due is picked up on the next tick
+    const TickType_t Ticks = pdMS_TO_TICKS(Timeout_ms);
+    return (Ticks > 0) ? Ticks : 1;
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "fpga_decode.h"
+
+#include <stdbool.h>
+
 typedef enum {
     kFPGA_TxConsts_BufferSize = 1024,    // [bytes]
 } FPGA_TxConsts_t;
@@ -11,4 +15,11 @@ void FPGA_Tx_SendAll(void);
 void FPGA_Tx_WriteBrightness(void);
 void FPGA_Tx_SendSysCtl(void);
 void FPGA_Tx_PokeButtons(void);
-void FPGA_Tx_WritePaletteStyle(void);
\ No newline at end of file
+void FPGA_Tx_WritePaletteStyle(void);
+void FPGA_Tx_ForceResync(void);
+void FPGA_Tx_EndBootRepeats(void);
+void FPGA_Tx_RevertLink(void);
+void FPGA_Tx_OnConfigAck(const FPGA_Frame_t *const pFrame);
+void FPGA_Tx_OnLinkEvent(void);
+void FPGA_Tx_OnBGPaletteReadback(void);
+bool FPGA_Tx_IsConfigured(void);
@@ -1,6 +1,25 @@
 #include "gfx.h"
 
+#include "argtable3/argtable3.h"
+#include "asset_store.h"
+#include "band_render.h"
+#include "disp_flush.h"
+#include "disp_stats.h"
+#include "img_spans.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lv_arena.h"
+#include "menu_mgr.h"
 #include "osd.h"
+#include "osd_shared.h"
+#include "text_cache.h"
+
+#include <stdio.h>
+#include <string.h>
 
 static lv_style_t Background;
 static lv_obj_t *pDisplayObj;
@@ -12,16 +31,107 @@ typedef struct
     lv_obj_t *pScreen;
 } TimerCtx_t;
 
-static TimerCtx_t _Ctx;
+enum {
+    kBench_DefaultFrames = 20,
+    kBench_Timeout_ms    = 30000,
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+    kBench_NumModes      = 2,       // One core, then both
+#else
+    kBench_NumModes      = 1,
+#endif
+    kSpans_MaxImages     = 8,
+};
 
-static void anim_timer_cb(lv_timer_t *timer)
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+typedef struct BandBlend
 {
-    TimerCtx_t *timer_ctx = (TimerCtx_t *) timer->user_data;
-    lv_obj_t *pScreen = timer_ctx->pScreen;
+    lv_draw_ctx_t *pDrawCtx;
+    const lv_draw_sw_blend_dsc_t *pDsc;
+} BandBlend_t;
+#endif
 
-    OSD_HandleInputs();
-    OSD_Draw(pScreen);
-}
+static const char* TAG = "Gfx";
+static TimerCtx_t _Ctx;
+static TaskHandle_t hRenderTask;
+static Gfx_RenderStats_t Stats;
+static Gfx_NavStats_t NavStats;
+static BandRender_t Bands;
+
+// Set by osd_bench, run and cleared by the render task which owns LVGL
+static volatile uint32_t BenchFrames;
+static uint32_t BenchAvg_us[kNumTabIDs][kBench_NumModes];
+static SemaphoreHandle_t xBenchDone;
+static StaticSemaphore_t xBenchDoneBuffer;
+
+static const char *const TabNames[kNumTabIDs] = {
+    [kTabID_Status]   = "Status",
+    [kTabID_Display]  = "Display",
+    [kTabID_Controls] = "Controls",
+    [kTabID_Palette]  = "Palette",
+    [kTabID_System]   = "System",
+};
+
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+static SemaphoreHandle_t xBandKick;
+static StaticSemaphore_t xBandKickBuffer;
+static SemaphoreHandle_t xBandDone;
+static StaticSemaphore_t xBandDoneBuffer;
+static void (*fnSoftBlend)(lv_draw_ctx_t *pDrawCtx, const lv_draw_sw_blend_dsc_t *pDsc);
+#endif
+
+#if CONFIG_CHROMATIC_OSD_IMG_SPANS
+static ImgSpans_t SpanImages[kSpans_MaxImages];
+static size_t NumSpanImages;
+static void (*fnSoftImgDecoded)(lv_draw_ctx_t *pDrawCtx, const lv_draw_img_dsc_t *pDsc, const lv_area_t *pCoords,
+                                const uint8_t *pMap, lv_img_cf_t eFormat);
+#endif
+
+#if CONFIG_CHROMATIC_OSD_TEXT_CACHE
+LV_FONT_DECLARE(fingfai);
+LV_FONT_DECLARE(jf_dot_k14);
+
+static void (*fnSoftDrawLetter)(lv_draw_ctx_t *pDrawCtx, const lv_draw_label_dsc_t *pDsc, const lv_point_t *pPos,
+                                uint32_t Letter);
+
+// The label whose string is blitted once LVGL has drawn its background
+static struct {
+    const TextCache_Entry_t *pEntry;
+    lv_area_t Coords;                   // Where the text may go
+    lv_point_t Pos;                     // Top left of the line
+    uint16_t Color;
+} PendingText;
+#endif
+
+static struct {
+    struct arg_lit *reset;
+    struct arg_end *end;
+} osd_nav_args;
+
+static struct {
+    struct arg_int *frames;
+    struct arg_end *end;
+} osd_bench_args;
+
+static void RecordTransition(const uint32_t Transition_us);
+static void RunBenchmark(const uint32_t NumFrames);
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+static void BandBlend(lv_draw_ctx_t *pDrawCtx, const lv_draw_sw_blend_dsc_t *pDsc);
+static void BlendRows(void *pArg, const int32_t y1, const int32_t y2);
+static void KickHelper(void *pCtx);
+static void WaitHelper(void *pCtx);
+#endif
+#if CONFIG_CHROMATIC_OSD_IMG_SPANS
+static void SpanImgDecoded(lv_draw_ctx_t *pDrawCtx, const lv_draw_img_dsc_t *pDsc, const lv_area_t *pCoords,
+                           const uint8_t *pMap, lv_img_cf_t eFormat);
+#endif
+#if CONFIG_CHROMATIC_OSD_TEXT_CACHE
+static void CachedDrawLetter(lv_draw_ctx_t *pDrawCtx, const lv_draw_label_dsc_t *pDsc, const lv_point_t *pPos,
+                             uint32_t Letter);
+static void LabelDrawBegin(lv_event_t *pEvent);
+static void LabelDrawEnd(lv_event_t *pEvent);
+static bool IsPlainText(const lv_draw_label_dsc_t *pDsc, const lv_area_t *pArea);
+static void ToBufferRect(const lv_draw_ctx_t *pDrawCtx, const lv_area_t *pArea, TextCache_Rect_t *pRect);
+#endif
 
 void Gfx_Start(lv_obj_t *const pScreen)
 {
@@ -37,7 +147,630 @@ void Gfx_Start(lv_obj_t *const pScreen)
     lv_style_set_bg_color(&Background, lv_color_hex(BG_COLOR));
 
     _Ctx.pScreen = pScreen;
+    xBenchDone = xSemaphoreCreateBinaryStatic(&xBenchDoneBuffer);
+
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+    xBandKick = xSemaphoreCreateBinaryStatic(&xBandKickBuffer);
+    xBandDone = xSemaphoreCreateBinaryStatic(&xBandDoneBuffer);
+
+    const BandRender_Sync_t Sync = {
+        .fnKick = KickHelper,
+        .fnWait = WaitHelper,
+    };
+    BandRender_Init(&Bands, &Sync);
+
+    // Every fill and image copy LVGL rasterizes ends up in the software blend, so that's where the rows are split
+    lv_draw_sw_ctx_t *const pDrawCtx = (lv_draw_sw_ctx_t*)lv_obj_get_disp(pScreen)->driver->draw_ctx;
+    fnSoftBlend = pDrawCtx->blend;
+    pDrawCtx->blend = BandBlend;
+#else
+    BandRender_Init(&Bands, NULL);
+#endif
+
+#if CONFIG_CHROMATIC_OSD_IMG_SPANS
+    // Images LVGL has decoded end up here, before anything is blended
+    lv_draw_ctx_t *const pImgCtx = lv_obj_get_disp(pScreen)->driver->draw_ctx;
+    fnSoftImgDecoded = pImgCtx->draw_img_decoded;
+    pImgCtx->draw_img_decoded = SpanImgDecoded;
+#endif
+
+#if CONFIG_CHROMATIC_OSD_TEXT_CACHE
+    TextCache_SetBudget(CONFIG_CHROMATIC_OSD_TEXT_CACHE_BUDGET);
+    const lv_font_t *const Fonts[] = { ASSET_FONT(fingfai), ASSET_FONT(jf_dot_k14) };
+    for (size_t i = 0; i < ARRAY_SIZE(Fonts); i++)
+    {
+        if (!TextCache_AddFont(Fonts[i]))
+        {
+            ESP_LOGW(TAG, "No glyph atlas for font %u, LVGL will draw its text", i);
+        }
+    }
+    ESP_LOGI(TAG, "Glyph atlases: %lu bytes", TextCache_GetStats()->AtlasBytes);
+
+    // Every letter LVGL draws comes through here, the labels' whole strings are taken over by their draw events
+    lv_draw_ctx_t *const pTextCtx = lv_obj_get_disp(pScreen)->driver->draw_ctx;
+    fnSoftDrawLetter = pTextCtx->draw_letter;
+    pTextCtx->draw_letter = CachedDrawLetter;
+    Gfx_PrepareLabels(pScreen);
+#endif
+}
+
+// Builds the opaque span table for a chroma keyed image so that it is blitted without checking every pixel against
+// the key. Other formats and anything past kSpans_MaxImages are drawn by LVGL as usual.
+void Gfx_PrepareImage(const lv_img_dsc_t *const pImg)
+{
+#if CONFIG_CHROMATIC_OSD_IMG_SPANS
+    if ((pImg == NULL) || (pImg->header.cf != LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED))
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < NumSpanImages; i++)
+    {
+        if (SpanImages[i].pPixels == (const uint16_t*)pImg->data)
+        {
+            return;
+        }
+    }
+
+    if ((NumSpanImages >= kSpans_MaxImages) ||
+        !ImgSpans_Build(&SpanImages[NumSpanImages], (const uint16_t*)pImg->data, pImg->header.w, pImg->header.h,
+                        LV_COLOR_CHROMA_KEY.full))
+    {
+        ESP_LOGW(TAG, "No span table for %ux%u image, LVGL will key it per pixel", pImg->header.w, pImg->header.h);
+        return;
+    }
+
+    const ImgSpans_t *const pTable = &SpanImages[NumSpanImages++];
+    ESP_LOGI(TAG, "Span table for %ux%u image: %lu spans, %lu%% opaque", pTable->Width, pTable->Height,
+             pTable->NumSpans, (pTable->NumOpaque * 100) / ((uint32_t)pTable->Width * pTable->Height));
+#else
+    (void)pImg;
+#endif
+}
+
+// Has the labels under pRoot draw their text from the text cache. Labels are only hooked once, so this is called again
+// whenever new ones may have been created.
+void Gfx_PrepareLabels(lv_obj_t *const pRoot)
+{
+#if CONFIG_CHROMATIC_OSD_TEXT_CACHE
+    if (lv_obj_check_type(pRoot, &lv_label_class) && !lv_obj_has_flag(pRoot, LV_OBJ_FLAG_USER_1))
+    {
+        lv_obj_add_event_cb(pRoot, LabelDrawBegin, LV_EVENT_DRAW_MAIN_BEGIN, NULL);
+        lv_obj_add_event_cb(pRoot, LabelDrawEnd, LV_EVENT_DRAW_MAIN_END, NULL);
+        lv_obj_add_flag(pRoot, LV_OBJ_FLAG_USER_1);
+    }
+
+    const uint32_t NumChildren = lv_obj_get_child_cnt(pRoot);
+    for (uint32_t i = 0; i < NumChildren; i++)
+    {
+        Gfx_PrepareLabels(lv_obj_get_child(pRoot, (int32_t)i));
+    }
+#else
+    (void)pRoot;
+#endif
+}
+
+// Renders on demand instead of on a fixed period. Nothing is drawn while the OSD is hidden since the FPGA doesn't show
+// it, and while visible the task wakes on button presses, setting and battery changes (see OSD_RequestRedraw()), for
+// LVGL timers that are due, and at least every kGfxConsts_IdleRefresh_ms. All LVGL calls happen on this task.
+void Gfx_RenderTask(void* pArg)
+{
+    (void)pArg;
+
+    hRenderTask = xTaskGetCurrentTaskHandle();
+
+    // Frames are refreshed right after drawing, the display's own refresh timer would only wake the task for nothing
+    lv_timer_pause(_lv_disp_get_refr_timer(lv_disp_get_default()));
+
+    uint32_t Wait_ms = 0;
+    while (1)
+    {
+        const TickType_t Wait_ticks = OSD_IsVisible() ? pdMS_TO_TICKS(Wait_ms) : portMAX_DELAY;
+        (void) ulTaskNotifyTake(pdTRUE, Wait_ticks);
+        Stats.NumWakeups++;
+
+        // Presses are still consumed while hidden, as they were when this ran on a timer
+        const uint32_t Start_us = (uint32_t)esp_timer_get_time();
+        const bool IsInput = OSD_HandleInputs();
+
+        if (!OSD_IsVisible())
+        {
+            continue;
+        }
+
+        if (BenchFrames > 0)
+        {
+            RunBenchmark(BenchFrames);
+            BenchFrames = 0;
+            (void) xSemaphoreGive(xBenchDone);
+        }
+
+        if (Disp_Flush_CheckPalette())
+        {
+            lv_obj_invalidate(_Ctx.pScreen);
+        }
+
+        OSD_Draw(_Ctx.pScreen);
+        if (IsInput)
+        {
+            // Transitions are when widgets create their objects
+            Gfx_PrepareLabels(_Ctx.pScreen);
+        }
+        const uint32_t NextTimer_ms = lv_timer_handler();
+        lv_refr_now(NULL);
+
+        const uint32_t Render_us = (uint32_t)esp_timer_get_time() - Start_us;
+        Stats.NumRenders++;
+        Stats.LastRender_us = Render_us;
+        Stats.MaxRender_us = (Render_us > Stats.MaxRender_us) ? Render_us : Stats.MaxRender_us;
+        Stats.TotalRender_us += Render_us;
+        Disp_Stats_Record(kDisp_Probe_Update, Render_us);
+
+        if (IsInput)
+        {
+            RecordTransition(Render_us);
+        }
+
+        Wait_ms = (NextTimer_ms < kGfxConsts_IdleRefresh_ms) ? NextTimer_ms : kGfxConsts_IdleRefresh_ms;
+    }
+}
+
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+// Pinned to the core the render task doesn't run on, only ever blends the rows BandRender_Run() hands it
+void Gfx_BandTask(void* pArg)
+{
+    (void)pArg;
+
+    while (1)
+    {
+        (void) xSemaphoreTake(xBandKick, portMAX_DELAY);
+        BandRender_RunHelper(&Bands);
+        (void) xSemaphoreGive(xBandDone);
+    }
+}
+#endif
+
+void Gfx_RequestRender(void)
+{
+    if (hRenderTask != NULL)
+    {
+        (void) xTaskNotifyGive(hRenderTask);
+    }
+}
+
+const Gfx_RenderStats_t* Gfx_GetRenderStats(void)
+{
+    return &Stats;
+}
+
+const Gfx_NavStats_t* Gfx_GetNavStats(void)
+{
+    return &NavStats;
+}
+
+// Render task only, the heap is LVGL's and must not be walked while it draws
+static void RecordTransition(const uint32_t Transition_us)
+{
+    const bool IsFirst = (NavStats.NumTransitions == 0);
+
+    NavStats.NumTransitions++;
+    NavStats.LastTransition_us = Transition_us;
+    NavStats.MaxTransition_us = (Transition_us > NavStats.MaxTransition_us) ? Transition_us : NavStats.MaxTransition_us;
+    NavStats.TotalTransition_us += Transition_us;
+
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t Mon;
+    lv_mem_monitor(&Mon);
+
+    NavStats.HeapUsed = Mon.total_size - Mon.free_size;
+    NavStats.HeapMaxUsed = Mon.max_used;
+    NavStats.HeapFreeBiggest = Mon.free_biggest_size;
+    NavStats.HeapFrag_pct = Mon.frag_pct;
+#elif CONFIG_CHROMATIC_OSD_LV_ARENA
+    // Pooled blocks count as used, they can't serve a larger allocation until the pools are flushed
+    const LvArena_Stats_t *const pArena = LvArena_GetStats();
+    LvArena_Frag_t Frag;
+    LvArena_GetFrag(&Frag);
+
+    NavStats.HeapUsed = pArena->Used + pArena->Pooled;
+    NavStats.HeapMaxUsed = pArena->Peak;
+    NavStats.HeapFreeBiggest = Frag.FreeBiggest;
+    NavStats.HeapFrag_pct = Frag.Frag_pct;
+#endif
+
+#if (LV_MEM_CUSTOM == 0) || CONFIG_CHROMATIC_OSD_LV_ARENA
+    if (IsFirst || (NavStats.HeapFreeBiggest < NavStats.HeapMinFreeBiggest))
+    {
+        NavStats.HeapMinFreeBiggest = NavStats.HeapFreeBiggest;
+    }
+
+    if (NavStats.HeapFrag_pct > NavStats.HeapMaxFrag_pct)
+    {
+        NavStats.HeapMaxFrag_pct = NavStats.HeapFrag_pct;
+    }
+#else
+    (void)IsFirst;
+#endif
+}
+
+// Times full-screen refreshes of every tab, on one core and then on both, and goes back to the tab that was shown
+static void RunBenchmark(const uint32_t NumFrames)
+{
+    const TabID_t eStartTab = MenuMgr_GetTab();
+    const bool WasEnabled = Bands.IsEnabled;
+
+    for (size_t t = 0; t < kNumTabIDs; t++)
+    {
+        if (MenuMgr_SelectTab((TabID_t)t) != kOSD_Result_Ok)
+        {
+            continue;
+        }
+
+        // Bring the tab on screen first so that only the refreshes are timed
+        OSD_Draw(_Ctx.pScreen);
+        lv_refr_now(NULL);
+
+        for (size_t m = 0; m < kBench_NumModes; m++)
+        {
+            BandRender_SetEnabled(&Bands, m > 0);
+
+            const int64_t Start_us = esp_timer_get_time();
+            for (uint32_t n = 0; n < NumFrames; n++)
+            {
+                lv_obj_invalidate(_Ctx.pScreen);
+                lv_refr_now(NULL);
+            }
+
+            BenchAvg_us[t][m] = (uint32_t)((esp_timer_get_time() - Start_us) / NumFrames);
+        }
+    }
+
+    BandRender_SetEnabled(&Bands, WasEnabled);
+    (void) MenuMgr_SelectTab(eStartTab);
+    OSD_Draw(_Ctx.pScreen);
+    lv_refr_now(NULL);
+}
+
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+// Everything in LVGL apart from the pixel loop stays on the render task. The blend only reads its inputs and writes
+// the rows it is clipped to, which is what makes it safe to run on the other core at the same time.
+static void BandBlend(lv_draw_ctx_t *pDrawCtx, const lv_draw_sw_blend_dsc_t *pDsc)
+{
+    lv_area_t Area;
+    if (!_lv_area_intersect(&Area, pDsc->blend_area, pDrawCtx->clip_area))
+    {
+        return;
+    }
+
+    BandBlend_t Job = {
+        .pDrawCtx = pDrawCtx,
+        .pDsc = pDsc,
+    };
+    BandRender_Run(&Bands, BlendRows, &Job, Area.y1, Area.y2, lv_area_get_width(&Area));
+}
+
+static void BlendRows(void *pArg, const int32_t y1, const int32_t y2)
+{
+    const BandBlend_t *const pJob = (const BandBlend_t*)pArg;
+
+    // Each core gets its own copy of the context, clipped to its band
+    lv_draw_sw_ctx_t Ctx = *(lv_draw_sw_ctx_t*)pJob->pDrawCtx;
+    lv_area_t Clip = *pJob->pDrawCtx->clip_area;
+    Clip.y1 = (lv_coord_t)y1;
+    Clip.y2 = (lv_coord_t)y2;
+    Ctx.base_draw.clip_area = &Clip;
+
+    fnSoftBlend(&Ctx.base_draw, pJob->pDsc);
+}
+
+static void KickHelper(void *pCtx)
+{
+    (void)pCtx;
+    (void) xSemaphoreGive(xBandKick);
+}
+
+static void WaitHelper(void *pCtx)
+{
+    (void)pCtx;
+    (void) xSemaphoreTake(xBandDone, portMAX_DELAY);
+}
+#endif
+
+#if CONFIG_CHROMATIC_OSD_IMG_SPANS
+// LVGL hands over the image's own pixels for the built-in true color formats, which is how the table is found. Only
+// a plain copy at full opacity onto the frame can use it, anything else is LVGL's to draw.
+static void SpanImgDecoded(lv_draw_ctx_t *pDrawCtx, const lv_draw_img_dsc_t *pDsc, const lv_area_t *pCoords,
+                           const uint8_t *pMap, lv_img_cf_t eFormat)
+{
+    const ImgSpans_t *pTable = NULL;
+    if (eFormat == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED)
+    {
+        for (size_t i = 0; (i < NumSpanImages) && (pTable == NULL); i++)
+        {
+            pTable = (SpanImages[i].pPixels == (const uint16_t*)pMap) ? &SpanImages[i] : NULL;
+        }
+    }
+
+    const bool IsPlainCopy = (pTable != NULL) && (pDsc->angle == 0) && (pDsc->zoom == LV_IMG_ZOOM_NONE) &&
+                             (pDsc->opa >= LV_OPA_MAX) && (pDsc->recolor_opa <= LV_OPA_MIN) &&
+                             (pDsc->blend_mode == LV_BLEND_MODE_NORMAL) && (lv_area_get_width(pCoords) == pTable->Width) &&
+                             (lv_area_get_height(pCoords) == pTable->Height) &&
+                             !_lv_refr_get_disp_refreshing()->driver->screen_transp;
+
+    lv_area_t Clip;
+    if (!IsPlainCopy || !_lv_area_intersect(&Clip, pCoords, pDrawCtx->clip_area) || lv_draw_mask_is_any(&Clip))
+    {
+        fnSoftImgDecoded(pDrawCtx, pDsc, pCoords, pMap, eFormat);
+        return;
+    }
+
+    const ImgSpans_Rect_t Area = {
+        .x1 = Clip.x1 - pCoords->x1,
+        .y1 = Clip.y1 - pCoords->y1,
+        .x2 = Clip.x2 - pCoords->x1,
+        .y2 = Clip.y2 - pCoords->y1,
+    };
+    const lv_coord_t Stride = lv_area_get_width(pDrawCtx->buf_area);
+    lv_color_t *const pDst = (lv_color_t*)pDrawCtx->buf + (Clip.y1 - pDrawCtx->buf_area->y1) * Stride +
+                             (Clip.x1 - pDrawCtx->buf_area->x1);
+
+    ImgSpans_Blit(pTable, &Area, (uint16_t*)pDst, (size_t)Stride);
+}
+#endif
+
+#if CONFIG_CHROMATIC_OSD_TEXT_CACHE
+// Letters of a label whose string is pending are dropped, it is blitted whole at the end of the label's draw. Others
+// come from the glyph atlas if it has them and LVGL would have drawn them as plain pixels.
+static void CachedDrawLetter(lv_draw_ctx_t *pDrawCtx, const lv_draw_label_dsc_t *pDsc, const lv_point_t *pPos,
+                             uint32_t Letter)
+{
+    if (PendingText.pEntry != NULL)
+    {
+        return;
+    }
+
+    TextCache_Rect_t Clip;
+    ToBufferRect(pDrawCtx, pDrawCtx->clip_area, &Clip);
+    if (!IsPlainText(pDsc, pDrawCtx->clip_area) ||
+        !TextCache_DrawGlyph(pDsc->font, Letter, pDsc->color.full, pPos->x - pDrawCtx->buf_area->x1,
+                             pPos->y - pDrawCtx->buf_area->y1, &Clip, (uint16_t*)pDrawCtx->buf,
+                             (size_t)lv_area_get_width(pDrawCtx->buf_area)))
+    {
+        fnSoftDrawLetter(pDrawCtx, pDsc, pPos, Letter);
+    }
+}
+
+// Places the label's string as lv_draw_label() would. Only a single line that fits is taken over, anything LVGL would
+// wrap, scroll, decorate or fade is left to it.
+static void LabelDrawBegin(lv_event_t *pEvent)
+{
+    lv_obj_t *const pLabel = lv_event_get_target(pEvent);
+    const lv_label_long_mode_t eMode = lv_label_get_long_mode(pLabel);
+
+    PendingText.pEntry = NULL;
+    if (((eMode != LV_LABEL_LONG_WRAP) && (eMode != LV_LABEL_LONG_CLIP)) || (lv_obj_get_scroll_top(pLabel) != 0))
+    {
+        return;
+    }
+
+    lv_draw_label_dsc_t Dsc;
+    lv_draw_label_dsc_init(&Dsc);
+    lv_obj_init_draw_label_dsc(pLabel, LV_PART_MAIN, &Dsc);
+
+    lv_area_t Coords;
+    lv_obj_get_content_coords(pLabel, &Coords);
+    if (!IsPlainText(&Dsc, &Coords) || (Dsc.letter_space != 0) || (Dsc.decor != LV_TEXT_DECOR_NONE) ||
+        ((Dsc.flag & LV_TEXT_FLAG_RECOLOR) != 0) || !TextCache_HasFont(Dsc.font) ||
+        (lv_area_get_height(&Coords) < lv_font_get_line_height(Dsc.font)))
+    {
+        return;
+    }
+
+    const TextCache_Entry_t *const pEntry = TextCache_Get(Dsc.font, lv_label_get_text(pLabel));
+    const lv_coord_t Width = lv_area_get_width(&Coords);
+    if ((pEntry == NULL) || (pEntry->Width > Width))
+    {
+        return;
+    }
+
+    PendingText.Pos.x = Coords.x1;
+    PendingText.Pos.y = Coords.y1;
+    if (Dsc.align == LV_TEXT_ALIGN_CENTER)
+    {
+        PendingText.Pos.x += (Width - pEntry->Width) / 2;
+    }
+    else if (Dsc.align == LV_TEXT_ALIGN_RIGHT)
+    {
+        PendingText.Pos.x += Width - pEntry->Width;
+    }
+
+    PendingText.Coords = Coords;
+    PendingText.Color = Dsc.color.full;
+    PendingText.pEntry = pEntry;
+}
+
+static void LabelDrawEnd(lv_event_t *pEvent)
+{
+    const lv_draw_ctx_t *const pDrawCtx = lv_event_get_draw_ctx(pEvent);
+    const TextCache_Entry_t *const pEntry = PendingText.pEntry;
+    PendingText.pEntry = NULL;
+
+    lv_area_t Area;
+    if ((pEntry == NULL) || !_lv_area_intersect(&Area, &PendingText.Coords, pDrawCtx->clip_area))
+    {
+        return;
+    }
+
+    TextCache_Rect_t Clip;
+    ToBufferRect(pDrawCtx, &Area, &Clip);
+    TextCache_Blit(pEntry, PendingText.Color, PendingText.Pos.x - pDrawCtx->buf_area->x1, PendingText.Pos.y - pDrawCtx->buf_area->y1,
+                   &Clip, (uint16_t*)pDrawCtx->buf, (size_t)lv_area_get_width(pDrawCtx->buf_area));
+}
+
+// What LVGL would store as the text's color, without blending it
+static bool IsPlainText(const lv_draw_label_dsc_t *pDsc, const lv_area_t *pArea)
+{
+    return (pDsc->opa >= LV_OPA_MAX) && (pDsc->blend_mode == LV_BLEND_MODE_NORMAL) &&
+           !_lv_refr_get_disp_refreshing()->driver->screen_transp && !lv_draw_mask_is_any(pArea);
+}
+
+static void ToBufferRect(const lv_draw_ctx_t *pDrawCtx, const lv_area_t *pArea, TextCache_Rect_t *pRect)
+{
+    pRect->x1 = pArea->x1 - pDrawCtx->buf_area->x1;
+    pRect->y1 = pArea->y1 - pDrawCtx->buf_area->y1;
+    pRect->x2 = pArea->x2 - pDrawCtx->buf_area->x1;
+    pRect->y2 = pArea->y2 - pDrawCtx->buf_area->y1;
+}
+#endif
+
+static int osd_bench_command(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&osd_bench_args);
+    if (nerrors != 0)
+    {
+        arg_print_errors(stderr, osd_bench_args.end, argv[0]);
+        return 1;
+    }
+
+    const int Frames = (osd_bench_args.frames->count > 0) ? osd_bench_args.frames->ival[0] : kBench_DefaultFrames;
+    if (Frames <= 0)
+    {
+        printf("The number of frames must be positive\n");
+        return 1;
+    }
+
+    if (!OSD_IsVisible())
+    {
+        printf("Open the OSD first, nothing is rendered while it is hidden\n");
+        return 1;
+    }
+
+    // Drop a completion left over from a run that timed out
+    (void) xSemaphoreTake(xBenchDone, 0);
+    const BandRender_Stats_t Before = Bands.Stats;
+
+    BenchFrames = (uint32_t)Frames;
+    Gfx_RequestRender();
+    if (xSemaphoreTake(xBenchDone, pdMS_TO_TICKS(kBench_Timeout_ms)) != pdTRUE)
+    {
+        printf("Timed out, was the OSD closed?\n");
+        return 1;
+    }
+
+    printf("%-10s %10s %10s\n", "Tab", "1 core", "2 cores");
+    for (size_t t = 0; t < kNumTabIDs; t++)
+    {
+        printf("%-10s %7lu us", TabNames[t], BenchAvg_us[t][0]);
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+        const uint32_t Dual_us = BenchAvg_us[t][1];
+        const uint32_t Speedup_pct = (Dual_us > 0) ? (BenchAvg_us[t][0] * 100) / Dual_us : 0;
+        printf(" %7lu us %3lu.%02lux\n", Dual_us, Speedup_pct / 100, Speedup_pct % 100);
+#else
+        printf(" %10s\n", "-");
+#endif
+    }
+
+    const uint32_t NumJobs = Bands.Stats.NumJobs - Before.NumJobs;
+    const uint32_t NumSplit = Bands.Stats.NumSplit - Before.NumSplit;
+    const uint64_t PixelsHelper = Bands.Stats.PixelsHelper - Before.PixelsHelper;
+    const uint64_t Pixels = PixelsHelper + (Bands.Stats.PixelsMain - Before.PixelsMain);
+    printf("Blends: %lu, %lu split across cores, %lu%% of the pixels on the helper\n", NumJobs, NumSplit,
+           (Pixels > 0) ? (uint32_t)((PixelsHelper * 100) / Pixels) : 0);
+
+#if CONFIG_CHROMATIC_OSD_IMG_SPANS
+    const ImgSpans_Stats_t *const pSpans = ImgSpans_GetStats();
+    const uint64_t SpanPixels = pSpans->PixelsCopied + pSpans->PixelsSkipped;
+    printf("Span blits since boot: %lu, %lu%% of their pixels skipped as transparent\n", pSpans->NumBlits,
+           (SpanPixels > 0) ? (uint32_t)((pSpans->PixelsSkipped * 100) / SpanPixels) : 0);
+#endif
+
+#if CONFIG_CHROMATIC_OSD_TEXT_CACHE
+    const TextCache_Stats_t *const pText = TextCache_GetStats();
+    printf("Text cache since boot: %lu%% of %lu lookups hit, %lu strings in %lu of %lu bytes, %lu glyphs drawn singly\n",
+           (pText->Lookups > 0) ? (pText->Hits * 100) / pText->Lookups : 0, pText->Lookups, pText->NumEntries,
+           pText->Bytes, pText->Budget, pText->NumGlyphs);
+#endif
+
+    return 0;
+}
+
+static int osd_nav_command(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&osd_nav_args);
+    if (nerrors != 0)
+    {
+        arg_print_errors(stderr, osd_nav_args.end, argv[0]);
+        return 1;
+    }
+
+    const Gfx_NavStats_t Nav = NavStats;
+    const uint32_t Avg_us = (Nav.NumTransitions > 0) ? (uint32_t)(Nav.TotalTransition_us / Nav.NumTransitions) : 0;
+
+    printf("Mode: %s\n", OSD_IsRetainedMode() ? "retained" : "recreate");
+    printf("Transitions: %lu, latency last %lu avg %lu max %lu us\n", Nav.NumTransitions, Nav.LastTransition_us, Avg_us, Nav.MaxTransition_us);
+    printf("LVGL heap: %lu bytes used (peak %lu), %u%% fragmented, largest free %lu\n", Nav.HeapUsed, Nav.HeapMaxUsed, Nav.HeapFrag_pct, Nav.HeapFreeBiggest);
+    printf("Worst after a transition: %u%% fragmented, largest free %lu\n", Nav.HeapMaxFrag_pct, Nav.HeapMinFreeBiggest);
+
+#if CONFIG_CHROMATIC_OSD_LV_ARENA
+    // Counters only, the free list is walked by the render task after each transition
+    const LvArena_Stats_t Arena = *LvArena_GetStats();
+    printf("Arena: %lu bytes, %lu blocks live in %lu bytes, %lu pooled, peak %lu\n", Arena.Size, Arena.NumLive, Arena.Used,
+           Arena.Pooled, Arena.Peak);
+    printf("Allocs %lu, frees %lu, reallocs %lu, %lu%% of allocs from a pool, %lu flushes, %lu failed\n", Arena.NumAllocs,
+           Arena.NumFrees, Arena.NumReallocs, (Arena.NumAllocs > 0) ? (Arena.NumPoolHits * 100) / Arena.NumAllocs : 0,
+           Arena.NumFlushes, Arena.NumFailed);
+    printf("Pooled blocks:");
+    for (size_t p = 0; p < kLvArenaConsts_NumPools; p++)
+    {
+        if (Arena.PoolBlocks[p] > 0)
+        {
+            printf(" %ux%u", Arena.PoolBlocks[p], (unsigned)(kLvArenaConsts_MinBlock + p * kLvArenaConsts_Align));
+        }
+    }
+    printf("\n");
+#endif
+
+    if (osd_nav_args.reset->count > 0)
+    {
+        memset(&NavStats, 0, sizeof(NavStats));
+#if CONFIG_CHROMATIC_OSD_LV_ARENA
+        LvArena_ResetStats();
+#endif
+    }
+
+    return 0;
+}
+
+void Gfx_RegisterCommands(void)
+{
+    osd_nav_args.reset = arg_lit0("r", "reset", "Clear the statistics after printing");
+    osd_nav_args.end = arg_end(1);
+
+    esp_console_cmd_t command = {
+        .command = "osd_nav",
+        .help = "Shows OSD navigation latency and LVGL heap use and fragmentation",
+        .func = &osd_nav_command,
+        .argtable = &osd_nav_args,
+    };
+
+    esp_err_t err;
+    if ((err = esp_console_cmd_register(&command)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Registering '%s' command failed: %s", command.command, esp_err_to_name(err));
+    }
+
+    osd_bench_args.frames = arg_int0("n", "frames", "<n>", "Full-screen refreshes per tab and mode (default 20)");
+    osd_bench_args.end = arg_end(1);
+
+    const esp_console_cmd_t bench_command = {
+        .command = "osd_bench",
+        .help = "Times full-screen renders of every OSD tab on one core and on both, needs the OSD open",
+        .func = &osd_bench_command,
+        .argtable = &osd_bench_args,
+    };
 
-    // Create timer for animation
-    lv_timer_create(anim_timer_cb, 20, &_Ctx);
+    if ((err = esp_console_cmd_register(&bench_command)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Registering '%s' command failed: %s", bench_command.command, esp_err_to_name(err));
+    }
 }
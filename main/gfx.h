@@ -2,4 +2,42 @@
 
 #include "lvgl.h"
 
+#include <stdint.h>
+
+typedef enum {
+    kGfxConsts_IdleRefresh_ms = 500,    // Longest a visible OSD goes without a redraw, for state that changes silently
+} GfxConsts_t;
+
+typedef struct Gfx_RenderStats {
+    uint32_t NumWakeups;
+    uint32_t NumRenders;                // Wakeups while the OSD was visible
+    uint32_t LastRender_us;             // Inputs, widget draws, LVGL timers and the refresh
+    uint32_t MaxRender_us;
+    uint64_t TotalRender_us;
+} Gfx_RenderStats_t;
+
+// Renders that handled a button press, which is what tab and item navigation costs
+typedef struct Gfx_NavStats {
+    uint32_t NumTransitions;
+    uint32_t LastTransition_us;         // Wakeup until the frame was refreshed
+    uint32_t MaxTransition_us;
+    uint64_t TotalTransition_us;
+
+    // LVGL heap right after the last transition, and the worst seen after any of them
+    uint32_t HeapUsed;                  // [bytes]
+    uint32_t HeapMaxUsed;               // [bytes] LVGL's own peak since boot
+    uint32_t HeapFreeBiggest;           // [bytes] Largest free block, which bounds the next allocation
+    uint32_t HeapMinFreeBiggest;        // [bytes]
+    uint8_t HeapFrag_pct;
+    uint8_t HeapMaxFrag_pct;
+} Gfx_NavStats_t;
+
 void Gfx_Start(lv_obj_t *const pScreen);
+void Gfx_PrepareImage(const lv_img_dsc_t *const pImg);
+void Gfx_PrepareLabels(lv_obj_t *const pRoot);
+void Gfx_RenderTask(void* pArg);
+void Gfx_BandTask(void* pArg);
+void Gfx_RequestRender(void);
+const Gfx_RenderStats_t* Gfx_GetRenderStats(void);
+const Gfx_NavStats_t* Gfx_GetNavStats(void);
+void Gfx_RegisterCommands(void);
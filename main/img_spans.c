@@ -0,0 +1,193 @@
+#include "img_spans.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Lets a pair of pixels be moved as one word without breaking strict aliasing
+typedef uint32_t __attribute__((may_alias)) PixelPair_t;
+
+static ImgSpans_Stats_t Stats;
+
+static uint32_t CountSpans(const uint16_t *const pRow, const uint16_t Width, const uint16_t Key);
+
+bool ImgSpans_Build(ImgSpans_t *const pTable, const uint16_t *const pPixels, const uint16_t Width, const uint16_t Height, const uint16_t Key)
+{
+    // Halfword aligned pixels are assumed throughout, as LVGL does for its own blits
+    if ((pTable == NULL) || (pPixels == NULL) || (((uintptr_t)pPixels & 0x1) != 0) || (Width == 0) ||
+        (Width > kImgSpansConsts_MaxWidth) || (Height == 0))
+    {
+        return false;
+    }
+
+    memset(pTable, 0x0, sizeof(*pTable));
+
+    // Counted first so that both tables are allocated once and exactly
+    uint32_t NumSpans = 0;
+    for (uint16_t y = 0; y < Height; y++)
+    {
+        NumSpans += CountSpans(&pPixels[(size_t)y * Width], Width, Key);
+    }
+
+    if (NumSpans > UINT16_MAX)
+    {
+        return false;
+    }
+
+    pTable->pRowStart = malloc(((size_t)Height + 1) * sizeof(pTable->pRowStart[0]));
+    pTable->pSpans = malloc(((NumSpans > 0) ? NumSpans : 1) * sizeof(pTable->pSpans[0]));
+    if ((pTable->pRowStart == NULL) || (pTable->pSpans == NULL))
+    {
+        ImgSpans_Free(pTable);
+        return false;
+    }
+
+    uint32_t Next = 0;
+    for (uint16_t y = 0; y < Height; y++)
+    {
+        const uint16_t *const pRow = &pPixels[(size_t)y * Width];
+        pTable->pRowStart[y] = (uint16_t)Next;
+
+        uint16_t x = 0;
+        while (x < Width)
+        {
+            while ((x < Width) && (pRow[x] == Key))
+            {
+                x++;
+            }
+
+            const uint16_t Start = x;
+            while ((x < Width) && (pRow[x] != Key))
+            {
+                x++;
+            }
+
+            if (x > Start)
+            {
+                pTable->pSpans[Next].x = (uint8_t)Start;
+                pTable->pSpans[Next].Length = (uint8_t)(x - Start);
+                pTable->NumOpaque += x - Start;
+                Next++;
+            }
+        }
+    }
+    pTable->pRowStart[Height] = (uint16_t)Next;
+
+    pTable->pPixels = pPixels;
+    pTable->Width = Width;
+    pTable->Height = Height;
+    pTable->NumSpans = Next;
+    return true;
+}
+
+void ImgSpans_Free(ImgSpans_t *const pTable)
+{
+    if (pTable == NULL)
+    {
+        return;
+    }
+
+    free(pTable->pRowStart);
+    free(pTable->pSpans);
+    memset(pTable, 0x0, sizeof(*pTable));
+}
+
+// Copies the part of the image in pArea, clipped to the image, to pDst, which is where pArea's top left pixel lands
+void ImgSpans_Blit(const ImgSpans_t *const pTable, const ImgSpans_Rect_t *const pArea, uint16_t *const pDst, const size_t DstStride_px)
+{
+    const int32_t x1 = (pArea->x1 > 0) ? pArea->x1 : 0;
+    const int32_t y1 = (pArea->y1 > 0) ? pArea->y1 : 0;
+    const int32_t x2 = (pArea->x2 < pTable->Width - 1) ? pArea->x2 : (pTable->Width - 1);
+    const int32_t y2 = (pArea->y2 < pTable->Height - 1) ? pArea->y2 : (pTable->Height - 1);
+    if ((x1 > x2) || (y1 > y2))
+    {
+        return;
+    }
+
+    uint32_t Copied = 0;
+    for (int32_t y = y1; y <= y2; y++)
+    {
+        const uint16_t *const pSrcRow = &pTable->pPixels[(size_t)y * pTable->Width];
+        uint16_t *const pDstRow = &pDst[(size_t)(y - pArea->y1) * DstStride_px];
+
+        for (uint32_t s = pTable->pRowStart[y]; s < pTable->pRowStart[y + 1]; s++)
+        {
+            const int32_t Start = pTable->pSpans[s].x;
+            const int32_t End = Start + pTable->pSpans[s].Length - 1;
+            if (End < x1)
+            {
+                continue;
+            }
+            if (Start > x2)
+            {
+                break;
+            }
+
+            const int32_t From = (Start > x1) ? Start : x1;
+            const int32_t To = (End < x2) ? End : x2;
+            ImgSpans_CopyWords(&pDstRow[From - pArea->x1], &pSrcRow[From], (size_t)(To - From + 1));
+            Copied += (uint32_t)(To - From + 1);
+        }
+    }
+
+    Stats.NumBlits++;
+    Stats.PixelsCopied += Copied;
+    Stats.PixelsSkipped += (uint32_t)((x2 - x1 + 1) * (y2 - y1 + 1)) - Copied;
+}
+
+// Little endian, as both the ESP32 and the host are
+void ImgSpans_CopyWords(uint16_t *pDst, const uint16_t *pSrc, size_t Length)
+{
+    if ((Length > 0) && (((uintptr_t)pDst & 0x2) != 0))
+    {
+        *pDst++ = *pSrc++;
+        Length--;
+    }
+
+    PixelPair_t *pDstPair = (PixelPair_t*)pDst;
+    if (((uintptr_t)pSrc & 0x2) == 0)
+    {
+        const PixelPair_t *pSrcPair = (const PixelPair_t*)pSrc;
+        for (; Length >= 2; Length -= 2)
+        {
+            *pDstPair++ = *pSrcPair++;
+        }
+        pSrc = (const uint16_t*)pSrcPair;
+    }
+    else
+    {
+        // The source is off by a pixel, so each word is put together from two halfword loads
+        for (; Length >= 2; Length -= 2)
+        {
+            *pDstPair++ = (uint32_t)pSrc[0] | ((uint32_t)pSrc[1] << 16);
+            pSrc += 2;
+        }
+    }
+
+    if (Length > 0)
+    {
+        *(uint16_t*)pDstPair = *pSrc;
+    }
+}
+
+const ImgSpans_Stats_t* ImgSpans_GetStats(void)
+{
+    return &Stats;
+}
+
+static uint32_t CountSpans(const uint16_t *const pRow, const uint16_t Width, const uint16_t Key)
+{
+    uint32_t NumSpans = 0;
+    bool IsOpaque = false;
+
+    for (uint16_t x = 0; x < Width; x++)
+    {
+        const bool IsKey = (pRow[x] == Key);
+        NumSpans += (!IsKey && !IsOpaque) ? 1 : 0;
+        IsOpaque = !IsKey;
+    }
+
+    return NumSpans;
+}
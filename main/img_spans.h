@@ -0,0 +1,51 @@
+#pragma once
+
+// Opaque span tables for chroma keyed RGB565 images. Each row of the image is scanned once for the runs of pixels that
+// aren't the key, and blits then copy those runs a word at a time and skip the transparent ones entirely, instead of
+// comparing every pixel against the key on every draw. The result is the same as LVGL's chroma keyed blit at full
+// opacity, unscaled and unrotated.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host benchmark.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kImgSpansConsts_MaxWidth = UINT8_MAX,   // [px] Spans are stored as bytes, the OSD is 160 wide
+} ImgSpansConsts_t;
+
+typedef struct ImgSpans_Span {
+    uint8_t x;
+    uint8_t Length;                         // [px] Never zero
+} ImgSpans_Span_t;
+
+// Inclusive, in image coordinates
+typedef struct ImgSpans_Rect {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} ImgSpans_Rect_t;
+
+typedef struct ImgSpans {
+    const uint16_t *pPixels;                // The image the table was built from, which is how blits find it
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t *pRowStart;                    // Height + 1 entries, row y's spans are pSpans[pRowStart[y]..pRowStart[y + 1])
+    ImgSpans_Span_t *pSpans;
+    uint32_t NumSpans;
+    uint32_t NumOpaque;                     // [px]
+} ImgSpans_t;
+
+typedef struct ImgSpans_Stats {
+    uint32_t NumBlits;
+    uint64_t PixelsCopied;
+    uint64_t PixelsSkipped;
+} ImgSpans_Stats_t;
+
+bool ImgSpans_Build(ImgSpans_t *const pTable, const uint16_t *const pPixels, const uint16_t Width, const uint16_t Height, const uint16_t Key);
+void ImgSpans_Free(ImgSpans_t *const pTable);
+void ImgSpans_Blit(const ImgSpans_t *const pTable, const ImgSpans_Rect_t *const pArea, uint16_t *const pDst, const size_t DstStride_px);
+void ImgSpans_CopyWords(uint16_t *pDst, const uint16_t *pSrc, size_t Length);
+const ImgSpans_Stats_t* ImgSpans_GetStats(void);
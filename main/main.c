@@ -14,18 +14,25 @@
 #include "freertos/task.h"
 #include "lvgl.h"
 #include "gfx.h"
+#include "asset_decoder.h"
+#include "asset_store.h"
 #include "board.h"
 #include "brightness.h"
 #include "color_correct_lcd.h"
 #include "color_correct_usb.h"
+#include "disp_flush.h"
+#include "disp_stats.h"
 #include "dpad_ctl.h"
+#include "fpga_common.h"
 #include "fpga_rx.h"
+#include "fpga_stats.h"
 #include "fpga_tx.h"
 #include "frameblend.h"
 #include "fw.h"
 #include "osd.h"
 #include "osd_default.h"
 #include "low_batt_icon_ctl.h"
+#include "lv_arena.h"
 #include "style.h"
 #include "player_num.h"
 #include "cmd_filesystem.h"
@@ -51,6 +58,7 @@ enum {
     kFPGARxTask_StackDepth = 8*1024,   // [bytes]
     kSleepTask_StackDepth  = 4*1024,   // [bytes]
     kTimerTask_StackDepth  = 8*1024,   // [bytes]
+    kBandTask_StackDepth   = 2*1024,   // [bytes]
 
     kFPGATxTask_Priority = configMAX_PRIORITIES - 10,
     kFPGARxTask_Priority = configMAX_PRIORITIES - 10,
@@ -63,91 +71,32 @@ static volatile uint8_t fpga_hsync = 0;
 static void lvgl_tick(void *arg);
 
 static void persist_storage_init(void);
-static void example_lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
-static void lvglTimerTask(void* param);
-static void send_lines(spi_device_handle_t spi, int ypos, uint16_t *linedata);
 
 static spi_device_handle_t spi;
 static lv_disp_draw_buf_t disp_buf; // contains internal graphic buffer(s) called draw buffer(s)
 static lv_disp_drv_t disp_drv;      // contains callback functions
 static lv_disp_t *disp;
 
-// Having some issue with floating point here so scale 9.6 10x
-#define ROWS_PER_XFER_X10 32
-#define NUMTRANS 1440/ROWS_PER_XFER_X10
-#define PIXELSPERXFER 16*ROWS_PER_XFER_X10
-#define BYTESPERXFER PIXELSPERXFER*2
-
-static void notify_lvgl_flush_ready(spi_transaction_t *pTransaction)
-{
-    static int rownum = 0;
-
-    (void)(pTransaction);
-
-    rownum = rownum + ROWS_PER_XFER_X10;
-    if(rownum >= 1440)
-    {
-        rownum = 0;
-        lv_disp_flush_ready(&disp_drv);
-    }
-}
-
-static void example_lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
-{
-    // copy a buffer's content to a specific area of the display
-    send_lines(spi, 0, drv->draw_buf->buf1);
-}
-
 static void lvgl_tick(void *arg)
 {
     /* Tell LVGL how many milliseconds has elapsed */
     lv_tick_inc(kLVGL_TickPeriod_us);
 }
 
-static void lvglTimerTask(void* param)
-{
-    while(1)
-    {
-        // The task running lv_timer_handler should have lower priority than that running `lv_tick_inc`
-        lv_timer_handler();
-        vTaskDelay(pdMS_TO_TICKS(30));
-    }
-}
-
+#if CONFIG_CHROMATIC_OSD_INDEXED
+// LVGL only needs a strip to render into, the frame itself is one byte per pixel and never touched by the DMA
+static lv_color_t buffy[kDisp_FlushConsts_IndexedDrawPixels];
+static WORD_ALIGNED_ATTR uint8_t buffy_indexed[160*144];
+#else
 static DMA_ATTR lv_color_t buffy[160*144];
-
-static void send_lines(spi_device_handle_t spi, int ypos, uint16_t *linedata)
-{
-    esp_err_t ret;
-
-    int x;
-    //Transaction descriptors. Declared static so they're not allocated on the stack; we need this memory even when this
-    //function is finished because the SPI driver needs access to it even while we're already calculating the next line.
-    static spi_transaction_t trans[NUMTRANS];
-
-    //In theory, it's better to initialize trans and data only once and hang on to the initialized
-    //variables. We allocate them on the stack, so we need to re-init them each call.
-    for (x=0; x<NUMTRANS; x++) {
-        memset(&trans[x], 0, sizeof(spi_transaction_t));
-        trans[x].tx_buffer = &buffy[x*PIXELSPERXFER];//finally send the line datai
-        trans[x].length = BYTESPERXFER * 8;  //Data length, in bits
-        trans[x].flags = SPI_TRANS_MODE_QIO; //undo SPI_TRANS_USE_TXDATA flag
-        trans[x].cmd = 0x400 | 1023;//write
-        trans[x].addr = x*BYTESPERXFER;
-    }
-
-    //Queue all transactions.
-    for (x=0; x<NUMTRANS; x++) {
-        ret=spi_device_queue_trans(spi, &trans[x], portMAX_DELAY);
-        assert(ret==ESP_OK);
-    }
-
-    return;
-    //When we are here, the SPI driver is busy (in the background) getting the transactions sent. That happens
-    //mostly using DMA, so the CPU doesn't have much to do here. We're not going to wait for the transaction to
-    //finish because we may as well spend the time calculating the next line. When that is done, we can call
-    //send_line_finish, which will wait for the transfers to be done and check their status.
-}
+#endif
+#if CONFIG_CHROMATIC_OSD_DOUBLE_BUFFER
+static DMA_ATTR lv_color_t buffy2[160*144];
+#endif
+#if CONFIG_CHROMATIC_OSD_LV_ARENA
+// LVGL's heap, kept apart from the one Wi-Fi and the file server allocate from
+static uint64_t LvArenaMem[CONFIG_CHROMATIC_OSD_LV_ARENA_KB * 1024 / sizeof(uint64_t)];
+#endif
 
 static void register_update_callbacks(void)
 {
@@ -162,6 +111,7 @@ static void register_update_callbacks(void)
     LowBattIconCtl_RegisterOnUpdateCb(FPGA_Tx_SendSysCtl);
     Button_RegisterOnButtonPokeCb(FPGA_Tx_PokeButtons);
     Style_RegisterOnUpdateCb(FPGA_Tx_WritePaletteStyle);
+    OSD_RegisterOnRedrawCb(Gfx_RequestRender);
 }
 
 static void persist_storage_init(void)
@@ -171,6 +121,10 @@ static void persist_storage_init(void)
     SerialNum_Initialize();
     WiFiFileServer_Initialize();
     Button_RegisterCommands();
+    FPGA_Stats_RegisterCommands();
+    OSD_RegisterCommands();
+    Gfx_RegisterCommands();
+    Disp_Stats_RegisterCommands();
     register_sd_spi_commands();
     register_sd_test_commands();
     register_filesystem_commands();
@@ -246,7 +200,7 @@ void app_main(void)
     // Set up the system management UART to/from the FPGA
     ESP_LOGI(TAG, "Initialize FPGA UART");
     const uart_config_t uart_config = {
-        .baud_rate = 115200,
+        .baud_rate = kSysMgmtConsts_DefaultBaudRate,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
@@ -254,13 +208,30 @@ void app_main(void)
         .source_clk = UART_SCLK_DEFAULT,
     };
 
+#if CONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN
+    uart_driver_install(UART_NUM_1, kFPGA_TxConsts_BufferSize, kFPGA_RxConsts_BufferSize, kFPGA_RxConsts_EventQueueLen, FPGA_Rx_GetUartEventQueue(), 0);
+#else
     uart_driver_install(UART_NUM_1, kFPGA_TxConsts_BufferSize, kFPGA_RxConsts_BufferSize, 0, NULL, 0);
+#endif
     uart_param_config(UART_NUM_1, &uart_config);
     uart_set_pin(UART_NUM_1, PIN_NUM_UART_TO_FPGA, PIN_NUM_UART_FROM_FPGA, -1, -1);
 
+#if CONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN
+    // Wake the Rx task as soon as a frame is likely complete instead of polling
+    uart_set_rx_full_threshold(UART_NUM_1, kFPGA_RxConsts_FullThreshold);
+    uart_set_rx_timeout(UART_NUM_1, kFPGA_RxConsts_IdleTimeout);
+#endif
+
     gpio_sleep_set_direction(PIN_NUM_UART_FROM_FPGA, GPIO_MODE_INPUT);
     gpio_sleep_set_pull_mode(PIN_NUM_UART_FROM_FPGA, GPIO_PULLUP_ONLY);
 
+    // Both ends start at the default rate, a V3 FPGA is moved to a faster one once it reports its capabilities
+#if CONFIG_CHROMATIC_FPGA_CONFIG_ACK
+    FPGA_Link_Init(FPGA_GetLink(), CONFIG_CHROMATIC_FPGA_LINK_MAX_BAUD, kFPGA_LinkFeature_Ack);
+#else
+    FPGA_Link_Init(FPGA_GetLink(), CONFIG_CHROMATIC_FPGA_LINK_MAX_BAUD, kFPGA_LinkFeature_None);
+#endif
+
     // Task is created earlier than the others to apply the settings ASAP
     xTaskCreate(FPGA_TxTask, "fpga_tx_task", kFPGATxTask_StackDepth, NULL, kFPGATxTask_Priority, FPGA_GetTxTaskHandle());
 
@@ -268,13 +239,16 @@ void app_main(void)
     // These tasks are started in the "paused" state
     xTaskCreate(FPGA_RxTask, "fpga_rx_task", kFPGARxTask_StackDepth, NULL, kFPGARxTask_Priority, FPGA_GetRxTaskHandle());
 
-    // Let the tasks run for a bit to transmit config data to the FPGA core
+    // Let the tasks run for a bit to transmit config data to the FPGA core.
+    // An FPGA that acknowledges writes ends this early once every one is confirmed. For one that doesn't, each pass
+    // sends every setting again, so a frame lost on one pass is made up by the next.
     const size_t kTransmitCfgCounts = 6;
-    for(size_t i = 0; i < kTransmitCfgCounts; i++)
+    for(size_t i = 0; (i < kTransmitCfgCounts) && !FPGA_Tx_IsConfigured(); i++)
     {
         FPGA_Tx_SendAll();
         vTaskDelay( pdMS_TO_TICKS(10) );
     }
+    FPGA_Tx_EndBootRepeats();
 
     ESP_LOGI(TAG, "Initialize SPI Master");
 
@@ -284,14 +258,14 @@ void app_main(void)
         .sclk_io_num=PIN_NUM_QSPI_CLK,
         .quadwp_io_num=PIN_NUM_QSPI_WP,
         .quadhd_io_num=PIN_NUM_QSPI_HD,
-        .max_transfer_sz=(BYTESPERXFER*8)+46,
+        .max_transfer_sz=(kDisp_FlushConsts_BytesPerXfer*8)+46,
         .flags=SPICOMMON_BUSFLAG_QUAD | SPICOMMON_BUSFLAG_MASTER
     };
     spi_device_interface_config_t devcfg={
         .clock_speed_hz=40*1000*1000,           //Clock out at 40 MHz
         .mode=0,                                //SPI mode 0
         .spics_io_num=PIN_NUM_QSPI_CS,
-        .queue_size=NUMTRANS,
+        .queue_size=kDisp_FlushConsts_NumTrans,
         .pre_cb=NULL,
         .flags=SPI_DEVICE_HALFDUPLEX,
         .cs_ena_pretrans=3,
@@ -299,7 +273,7 @@ void app_main(void)
         .command_bits=11,
         .address_bits=32,
         .dummy_bits=3,
-        .post_cb=notify_lvgl_flush_ready
+        .post_cb=Disp_Flush_OnTransDone
     };
 
     //Initialize the SPI bus
@@ -309,20 +283,55 @@ void app_main(void)
     ESP_ERROR_CHECK(ret);
 
     ESP_LOGI(TAG, "Initialize LVGL library");
+#if CONFIG_CHROMATIC_OSD_LV_ARENA
+    // Before lv_init(), which already allocates
+#if CONFIG_CHROMATIC_OSD_LV_ARENA_POOLS
+    const bool UsePools = true;
+#else
+    const bool UsePools = false;
+#endif
+    ESP_ERROR_CHECK(LvArena_Init(LvArenaMem, sizeof(LvArenaMem), UsePools) ? ESP_OK : ESP_ERR_INVALID_SIZE);
+#endif
     lv_init();
+    AssetDecoder_Init();
+#if CONFIG_CHROMATIC_OSD_ASSET_PARTITION
+    // Before any widget looks its images and fonts up
+    if (!AssetStore_Map("assets"))
+    {
+        ESP_LOGE(TAG, "Loading the assets partition failed, the OSD is drawn without its images and fonts");
+    }
+#endif
     // alloc draw buffers used by LVGL
     // it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized
     lv_color_t *buf1 = (lv_color_t*)&buffy;
     assert(buf1);
-    lv_disp_draw_buf_init(&disp_buf, buf1, NULL, kOSD_NumPixels);
+#if CONFIG_CHROMATIC_OSD_DOUBLE_BUFFER
+    lv_color_t *buf2 = (lv_color_t*)&buffy2;
+#else
+    lv_color_t *buf2 = NULL;
+#endif
+#if CONFIG_CHROMATIC_OSD_INDEXED
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, kDisp_FlushConsts_IndexedDrawPixels);
+    Disp_Flush_InitIndexed(spi, buffy_indexed);
+#else
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, kOSD_NumPixels);
+    Disp_Flush_Init(spi, buf1, buf2);
+#endif
 
     ESP_LOGI(TAG, "Register display driver to LVGL");
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = kOSD_Width_px;
     disp_drv.ver_res = kOSD_Height_px;
+    // LVGL redraws only the invalidated areas in place and the flush sends only the rows they cover. An indexed frame
+    // can't be drawn into, so there LVGL renders the areas into its strip and the flush keeps them.
+#if CONFIG_CHROMATIC_OSD_INDEXED
+    disp_drv.direct_mode = 0;
+#else
     disp_drv.direct_mode = 1;
-    disp_drv.full_refresh = 1;
-    disp_drv.flush_cb = example_lvgl_flush_cb;
+#endif
+    disp_drv.full_refresh = 0;
+    disp_drv.flush_cb = Disp_Flush_Cb;
+    disp_drv.render_start_cb = Disp_Flush_OnRenderStart;
     disp_drv.draw_buf = &disp_buf;
     disp = lv_disp_drv_register(&disp_drv);
 
@@ -342,12 +351,19 @@ void app_main(void)
     lv_obj_t *scr = lv_disp_get_scr_act(disp);
 
     OSD_Initialize();
+#if CONFIG_CHROMATIC_OSD_RETAINED
+    OSD_SetRetainedMode(true);
+#endif
     OSD_Default_Init(scr);
     register_update_callbacks();
 
     Gfx_Start(scr);
 
-    xTaskCreatePinnedToCore(lvglTimerTask, "lvgl Timer", kTimerTask_StackDepth, NULL, 4, NULL, 1);
+    // The task running lv_timer_handler should have lower priority than that running `lv_tick_inc`
+    xTaskCreatePinnedToCore(Gfx_RenderTask, "lvgl Timer", kTimerTask_StackDepth, NULL, 4, NULL, 1);
+#if CONFIG_CHROMATIC_OSD_DUAL_CORE
+    xTaskCreatePinnedToCore(Gfx_BandTask, "lvgl Bands", kBandTask_StackDepth, NULL, 4, NULL, 0);
+#endif
 
     // Prompt to be printed before each line.
     ReplConfig.prompt = "mcu> ";
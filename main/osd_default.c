@@ -22,6 +22,8 @@
 #include "system/wifi_file_server_osd.h"
 #include "osd.h"
 #include "osd_shared.h"
+#include "asset_store.h"
+#include "gfx.h"
 #include "esp_log.h"
 
 static const char *TAG = "OSDDef";
@@ -58,12 +60,28 @@ void OSD_Default_Init(lv_obj_t *const pScreen)
     
     OSD_AddWidget(&MenuMgr);
     
+    // The tab backgrounds are chroma keyed, so their span tables are built before they are first drawn
+    const lv_img_dsc_t *const TabImages[] = {
+        ASSET_IMG(menu_status), ASSET_IMG(menu_display), ASSET_IMG(menu_controls), ASSET_IMG(menu_palette),
+        ASSET_IMG(menu_system),
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(TabImages); i++)
+    {
+        Gfx_PrepareImage(TabImages[i]);
+    }
+
     // Create all menu tabs
     CreateMenuStatus(pScreen);
     CreateMenuDisplay(pScreen);
     CreateMenuControls(pScreen);
     CreateMenuPalette(pScreen);
     CreateMenuSystem(pScreen);
+
+    // Retained objects are all created here rather than on first use
+    if ((eResult = MenuMgr_CreateAll(pScreen)) != kOSD_Result_Ok)
+    {
+        ESP_LOGE(TAG, "Menu object creation failed: %d", eResult);
+    }
     
     ESP_LOGI(TAG, "Default OSD init OK");
 }
@@ -83,10 +101,10 @@ static void CreateMenuStatus(lv_obj_t *const pScreen)
             .fnOnButton = Tab_OnButton,
             .fnOnTransition =  TabList_OnTransition,
         },
-        .pImageDesc = &menu_status,
         .Menu = &StatusList
     };
     Tab_Status.Accent = lv_color_make(0xFF, 0, 0);
+    Tab_Status.pImageDesc = ASSET_IMG(menu_status);
 
     if ((eResult = MenuMgr_AddTab(kTabID_Status, &Tab_Status)) != kOSD_Result_Ok)
     {
@@ -140,10 +158,10 @@ static void CreateMenuDisplay(lv_obj_t *const pScreen)
             .fnOnButton = Tab_OnButton,
             .fnOnTransition =  TabList_OnTransition,
         },
-        .pImageDesc = &menu_display,
         .Menu = &DisplayList,
     };
     Tab_Display.Accent = lv_color_make(0xFF, 0xFF, 0);
+    Tab_Display.pImageDesc = ASSET_IMG(menu_display);
 
     if ((eResult = MenuMgr_AddTab(kTabID_Display, &Tab_Display)) != kOSD_Result_Ok)
     {
@@ -243,9 +261,9 @@ static void CreateMenuControls(lv_obj_t *const pScreen)
             .fnOnTransition =  TabDot_OnTransition,
         },
         .Menu = &ControlsList,
-        .pImageDesc = &menu_controls,
     };
     Tab_Controls.Accent = lv_color_make(0, 0xCC, 0xFF);
+    Tab_Controls.pImageDesc = ASSET_IMG(menu_controls);
 
     OSD_Result_t eResult;
 
@@ -301,10 +319,10 @@ static void CreateMenuPalette(lv_obj_t *const pScreen)
             .fnOnButton = Tab_OnButton, 
             .fnOnTransition =  TabList_OnTransition,  // TabTable has same object lifetime behavior as TabList
         },
-        .pImageDesc = &menu_palette,
         .Menu = &PaletteList,
     };
     Tab_Palette.Accent = lv_color_make(0x92, 0x4E, 0xD7);  // Unused in actual selection
+    Tab_Palette.pImageDesc = ASSET_IMG(menu_palette);
 
     static TabItem_t PaletteOpts[kNumPalettes];
     const char *PaletteStyleNames[kNumPalettes] = {
@@ -365,10 +383,10 @@ static void CreateMenuSystem(lv_obj_t *const pScreen)
             .fnOnButton = Tab_OnButton,
             .fnOnTransition = TabList_OnTransition,
         },
-        .pImageDesc = &menu_system,
         .Menu = &SystemList,
     };
     Tab_System.Accent = lv_color_make(0xFF, 0x33, 0x99);
+    Tab_System.pImageDesc = ASSET_IMG(menu_system);
 
     static TabItem_t Firmware = {
         .Widget = {
@@ -83,6 +83,10 @@ void PwrMgr_Task(void *arg)
             esp_sleep_enable_gpio_wakeup();
             vTaskDelay(pdMS_TO_TICKS(10));
 
+            // Both ends must be back at the default rate for the brightness readback to decode on wake. The Tx task
+            // has had the delays above to finish what it was sending.
+            FPGA_Tx_RevertLink();
+
             // Tell the world we are sleeping and wait for the message to go out...
             ESP_LOGD(TAG, "Sleeping");
             uart_wait_tx_done(CONFIG_ESP_CONSOLE_UART_NUM, portMAX_DELAY);
@@ -94,6 +98,7 @@ void PwrMgr_Task(void *arg)
 
             // Update the brightness in the event hot-keys were used to adjust it.
             // The Rx task will resume the Tx task once it receives the brightness level
+            FPGA_Tx_ForceResync();
             FPGA_Rx_UseBrightnessReadback();
             FPGA_Rx_Resume();
         }
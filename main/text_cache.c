@@ -0,0 +1,446 @@
+#include "text_cache.h"
+
+#include "lvgl.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    kMaxGlyphRuns = 255,
+};
+
+// Placed relative to the pen, so x can be left of it
+typedef struct {
+    int8_t x;
+    int8_t y;
+    uint8_t Length;
+} AtlasRun_t;
+
+typedef struct {
+    uint16_t FirstRun;
+    uint8_t NumRuns;
+    uint8_t Advance;                            // [px]
+} Glyph_t;
+
+typedef struct {
+    const lv_font_t *pFont;
+    AtlasRun_t *pRuns;
+    Glyph_t Glyphs[kTextCacheConsts_NumChars];
+} Atlas_t;
+
+static Atlas_t Atlases[kTextCacheConsts_MaxFonts];
+static size_t NumAtlases;
+static TextCache_Entry_t Entries[kTextCacheConsts_MaxEntries];
+static uint32_t Clock;
+static TextCache_Stats_t Stats = {
+    .Budget = kTextCacheConsts_DefaultBudget,
+};
+
+static const Atlas_t* FindAtlas(const lv_font_t *const pFont);
+static uint32_t GetGlyphId(const lv_font_fmt_txt_dsc_t *const pDsc, const uint32_t Letter);
+static size_t RasterizeGlyph(const lv_font_t *const pFont, const uint32_t Id, AtlasRun_t *const pRuns);
+static uint32_t Hash(const char *pText);
+static TextCache_Entry_t* GetFreeEntry(const size_t Size);
+static void FreeEntry(TextCache_Entry_t *const pEntry);
+static void FillRun(uint16_t *const pRow, int32_t x1, int32_t x2, const TextCache_Rect_t *const pClip, const uint16_t Color);
+
+// Only LVGL's plain 1 bpp fonts without kerning qualify, which all the OSD fonts are
+bool TextCache_AddFont(const lv_font_t *const pFont)
+{
+    if ((pFont == NULL) || (FindAtlas(pFont) != NULL))
+    {
+        return pFont != NULL;
+    }
+
+    const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+    if ((NumAtlases >= kTextCacheConsts_MaxFonts) || (pFont->get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt) ||
+        (pDsc == NULL) || (pDsc->bpp != 1) || (pDsc->bitmap_format != 0) || (pDsc->kern_dsc != NULL))
+    {
+        return false;
+    }
+
+    // Rasterized once to count the runs, then again into a table of exactly that size
+    static AtlasRun_t Scratch[kMaxGlyphRuns];
+    size_t NumRuns = 0;
+    for (uint32_t c = kTextCacheConsts_FirstChar; c <= kTextCacheConsts_LastChar; c++)
+    {
+        NumRuns += RasterizeGlyph(pFont, GetGlyphId(pDsc, c), Scratch);
+    }
+
+    Atlas_t *const pAtlas = &Atlases[NumAtlases];
+    pAtlas->pRuns = malloc(((NumRuns > 0) ? NumRuns : 1) * sizeof(pAtlas->pRuns[0]));
+    if ((pAtlas->pRuns == NULL) || (NumRuns > UINT16_MAX))
+    {
+        free(pAtlas->pRuns);
+        pAtlas->pRuns = NULL;
+        return false;
+    }
+
+    size_t Next = 0;
+    for (uint32_t c = kTextCacheConsts_FirstChar; c <= kTextCacheConsts_LastChar; c++)
+    {
+        const uint32_t Id = GetGlyphId(pDsc, c);
+        Glyph_t *const pGlyph = &pAtlas->Glyphs[c - kTextCacheConsts_FirstChar];
+
+        // Glyphs the font doesn't have are drawn by LVGL as nothing, with no width
+        pGlyph->FirstRun = (uint16_t)Next;
+        pGlyph->NumRuns = (uint8_t)RasterizeGlyph(pFont, Id, &pAtlas->pRuns[Next]);
+        pGlyph->Advance = (Id != 0) ? (uint8_t)((pDsc->glyph_dsc[Id].adv_w + (1 << 3)) >> 4) : 0;
+        Next += pGlyph->NumRuns;
+    }
+
+    pAtlas->pFont = pFont;
+    NumAtlases++;
+    Stats.AtlasBytes += (uint32_t)(sizeof(*pAtlas) + NumRuns * sizeof(pAtlas->pRuns[0]));
+    return true;
+}
+
+bool TextCache_HasFont(const lv_font_t *const pFont)
+{
+    return FindAtlas(pFont) != NULL;
+}
+
+// Strings over the new budget go right away
+void TextCache_SetBudget(const size_t Budget)
+{
+    Stats.Budget = (uint32_t)Budget;
+    (void) GetFreeEntry(0);
+}
+
+void TextCache_Clear(void)
+{
+    for (size_t i = 0; i < kTextCacheConsts_MaxEntries; i++)
+    {
+        FreeEntry(&Entries[i]);
+    }
+}
+
+// Returns NULL for anything that can't be cached, which is then left to LVGL
+const TextCache_Entry_t* TextCache_Get(const lv_font_t *const pFont, const char *const pText)
+{
+    Stats.Lookups++;
+
+    const Atlas_t *const pAtlas = FindAtlas(pFont);
+    if ((pAtlas == NULL) || (pText == NULL))
+    {
+        Stats.Uncacheable++;
+        return NULL;
+    }
+
+    const uint32_t TextHash = Hash(pText);
+    for (size_t i = 0; i < kTextCacheConsts_MaxEntries; i++)
+    {
+        TextCache_Entry_t *const pEntry = &Entries[i];
+        if ((pEntry->pText != NULL) && (pEntry->Hash == TextHash) && (pEntry->pFont == pFont) &&
+            (strcmp(pEntry->pText, pText) == 0))
+        {
+            pEntry->LastUse = ++Clock;
+            Stats.Hits++;
+            return pEntry;
+        }
+    }
+
+    // Sized and checked up front so that the entry is allocated once, and nothing is evicted for a string that then
+    // can't be cached
+    size_t Length = 0;
+    size_t NumRuns = 0;
+    size_t Width = 0;
+    for (; pText[Length] != '\0'; Length++)
+    {
+        const uint8_t c = (uint8_t)pText[Length];
+        if ((c < kTextCacheConsts_FirstChar) || (c > kTextCacheConsts_LastChar))
+        {
+            Stats.Uncacheable++;
+            return NULL;
+        }
+
+        const Glyph_t *const pGlyph = &pAtlas->Glyphs[c - kTextCacheConsts_FirstChar];
+        for (size_t r = 0; r < pGlyph->NumRuns; r++)
+        {
+            const AtlasRun_t *const pRun = &pAtlas->pRuns[pGlyph->FirstRun + r];
+            const int32_t x = (int32_t)Width + pRun->x;
+
+            // A glyph hanging left of the string or past its end would need a signed or wider x
+            if ((x < 0) || (x + pRun->Length - 1 > kTextCacheConsts_MaxWidth))
+            {
+                Stats.Uncacheable++;
+                return NULL;
+            }
+        }
+
+        NumRuns += pGlyph->NumRuns;
+        Width += pGlyph->Advance;
+    }
+
+    const size_t Size = NumRuns * sizeof(TextCache_Run_t) + Length + 1;
+    TextCache_Entry_t *const pEntry = ((Width <= kTextCacheConsts_MaxWidth) && (Size <= UINT16_MAX) &&
+                                       (Size <= Stats.Budget)) ? GetFreeEntry(Size) : NULL;
+    if (pEntry == NULL)
+    {
+        Stats.Uncacheable++;
+        return NULL;
+    }
+
+    pEntry->pRuns = malloc((NumRuns > 0) ? (NumRuns * sizeof(pEntry->pRuns[0])) : 1);
+    pEntry->pText = malloc(Length + 1);
+    if ((pEntry->pRuns == NULL) || (pEntry->pText == NULL))
+    {
+        free(pEntry->pRuns);
+        free(pEntry->pText);
+        memset(pEntry, 0x0, sizeof(*pEntry));
+        Stats.Uncacheable++;
+        return NULL;
+    }
+
+    size_t Pen = 0;
+    size_t Next = 0;
+    for (size_t i = 0; i < Length; i++)
+    {
+        const Glyph_t *const pGlyph = &pAtlas->Glyphs[(uint8_t)pText[i] - kTextCacheConsts_FirstChar];
+        for (size_t r = 0; r < pGlyph->NumRuns; r++)
+        {
+            const AtlasRun_t *const pRun = &pAtlas->pRuns[pGlyph->FirstRun + r];
+            const int32_t x = (int32_t)Pen + pRun->x;
+
+            pEntry->pRuns[Next].x = (uint8_t)x;
+            pEntry->pRuns[Next].y = pRun->y;
+            pEntry->pRuns[Next].Length = pRun->Length;
+            Next++;
+        }
+        Pen += pGlyph->Advance;
+    }
+
+    memcpy(pEntry->pText, pText, Length + 1);
+    pEntry->pFont = pFont;
+    pEntry->Hash = TextHash;
+    pEntry->LastUse = ++Clock;
+    pEntry->NumRuns = (uint16_t)NumRuns;
+    pEntry->Width = (uint16_t)Width;
+    pEntry->Size = (uint16_t)Size;
+
+    Stats.NumEntries++;
+    Stats.Bytes += (uint32_t)Size;
+    Stats.Misses++;
+    return pEntry;
+}
+
+// Draws the string with the top left of its line at x, y. Everything is in pixels of pDst, which pClip must lie within.
+void TextCache_Blit(const TextCache_Entry_t *const pEntry, const uint16_t Color, const int32_t x, const int32_t y, const TextCache_Rect_t *const pClip, uint16_t *const pDst, const size_t DstStride_px)
+{
+    for (size_t r = 0; r < pEntry->NumRuns; r++)
+    {
+        const TextCache_Run_t *const pRun = &pEntry->pRuns[r];
+        const int32_t Row = y + pRun->y;
+        if ((Row >= pClip->y1) && (Row <= pClip->y2))
+        {
+            const int32_t x1 = x + pRun->x;
+            FillRun(&pDst[(size_t)Row * DstStride_px], x1, x1 + pRun->Length - 1, pClip, Color);
+        }
+    }
+
+    Stats.NumBlits++;
+}
+
+// One letter straight from the atlas, with the pen at x and the top of the line at y. Returns false if the font or
+// the letter isn't in an atlas, for LVGL to draw it instead.
+bool TextCache_DrawGlyph(const lv_font_t *const pFont, const uint32_t Letter, const uint16_t Color, const int32_t x, const int32_t y, const TextCache_Rect_t *const pClip, uint16_t *const pDst, const size_t DstStride_px)
+{
+    const Atlas_t *const pAtlas = FindAtlas(pFont);
+    if ((pAtlas == NULL) || (Letter < kTextCacheConsts_FirstChar) || (Letter > kTextCacheConsts_LastChar))
+    {
+        return false;
+    }
+
+    const Glyph_t *const pGlyph = &pAtlas->Glyphs[Letter - kTextCacheConsts_FirstChar];
+    for (size_t r = 0; r < pGlyph->NumRuns; r++)
+    {
+        const AtlasRun_t *const pRun = &pAtlas->pRuns[pGlyph->FirstRun + r];
+        const int32_t Row = y + pRun->y;
+        if ((Row >= pClip->y1) && (Row <= pClip->y2))
+        {
+            const int32_t x1 = x + pRun->x;
+            FillRun(&pDst[(size_t)Row * DstStride_px], x1, x1 + pRun->Length - 1, pClip, Color);
+        }
+    }
+
+    Stats.NumGlyphs++;
+    return true;
+}
+
+const TextCache_Stats_t* TextCache_GetStats(void)
+{
+    return &Stats;
+}
+
+static const Atlas_t* FindAtlas(const lv_font_t *const pFont)
+{
+    for (size_t i = 0; i < NumAtlases; i++)
+    {
+        if (Atlases[i].pFont == pFont)
+        {
+            return &Atlases[i];
+        }
+    }
+
+    return NULL;
+}
+
+// The lookup lv_font_get_glyph_dsc_fmt_txt() does, 0 if the font doesn't have the letter
+static uint32_t GetGlyphId(const lv_font_fmt_txt_dsc_t *const pDsc, const uint32_t Letter)
+{
+    for (size_t c = 0; c < pDsc->cmap_num; c++)
+    {
+        const lv_font_fmt_txt_cmap_t *const pCmap = &pDsc->cmaps[c];
+        const uint32_t Rcp = Letter - pCmap->range_start;
+        if ((Letter < pCmap->range_start) || (Rcp >= pCmap->range_length))
+        {
+            continue;
+        }
+
+        switch (pCmap->type)
+        {
+            case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+                return pCmap->glyph_id_start + Rcp;
+
+            case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+                return pCmap->glyph_id_start + ((const uint8_t*)pCmap->glyph_id_ofs_list)[Rcp];
+
+            default:
+                for (uint32_t i = 0; i < pCmap->list_length; i++)
+                {
+                    if (pCmap->unicode_list[i] == Rcp)
+                    {
+                        return (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY)
+                            ? (pCmap->glyph_id_start + i)
+                            : (pCmap->glyph_id_start + ((const uint16_t*)pCmap->glyph_id_ofs_list)[i]);
+                    }
+                }
+                break;
+        }
+    }
+
+    return 0;
+}
+
+// Rows of set bits, placed as lv_draw_sw_letter() places the glyph: its box sits ofs_y above the baseline
+static size_t RasterizeGlyph(const lv_font_t *const pFont, const uint32_t Id, AtlasRun_t *const pRuns)
+{
+    const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+    if (Id == 0)
+    {
+        return 0;
+    }
+
+    const lv_font_fmt_txt_glyph_dsc_t *const pGlyph = &pDsc->glyph_dsc[Id];
+    const uint8_t *const pBitmap = &pDsc->glyph_bitmap[pGlyph->bitmap_index];
+    const int32_t Top = (pFont->line_height - pFont->base_line) - pGlyph->box_h - pGlyph->ofs_y;
+
+    // 1 bpp rows follow each other without padding, most significant bit first
+    size_t NumRuns = 0;
+    for (uint32_t Row = 0; Row < pGlyph->box_h; Row++)
+    {
+        uint32_t Col = 0;
+        while (Col < pGlyph->box_w)
+        {
+            const uint32_t Bit = Row * pGlyph->box_w + Col;
+            if ((pBitmap[Bit >> 3] & (0x80 >> (Bit & 0x7))) == 0)
+            {
+                Col++;
+                continue;
+            }
+
+            const uint32_t Start = Col;
+            for (; Col < pGlyph->box_w; Col++)
+            {
+                const uint32_t Next = Row * pGlyph->box_w + Col;
+                if ((pBitmap[Next >> 3] & (0x80 >> (Next & 0x7))) == 0)
+                {
+                    break;
+                }
+            }
+
+            if (NumRuns < kMaxGlyphRuns)
+            {
+                pRuns[NumRuns].x = (int8_t)(pGlyph->ofs_x + (int32_t)Start);
+                pRuns[NumRuns].y = (int8_t)(Top + (int32_t)Row);
+                pRuns[NumRuns].Length = (uint8_t)(Col - Start);
+                NumRuns++;
+            }
+        }
+    }
+
+    return NumRuns;
+}
+
+static uint32_t Hash(const char *pText)
+{
+    uint32_t Value = 2166136261u;
+    while (*pText != '\0')
+    {
+        Value = (Value ^ (uint8_t)*pText++) * 16777619u;
+    }
+
+    return Value;
+}
+
+// Drops the least recently used strings until Size more bytes fit in the budget and a slot is free
+static TextCache_Entry_t* GetFreeEntry(const size_t Size)
+{
+    while (true)
+    {
+        TextCache_Entry_t *pFree = NULL;
+        TextCache_Entry_t *pOldest = NULL;
+        for (size_t i = 0; i < kTextCacheConsts_MaxEntries; i++)
+        {
+            TextCache_Entry_t *const pEntry = &Entries[i];
+            if (pEntry->pText == NULL)
+            {
+                pFree = (pFree == NULL) ? pEntry : pFree;
+            }
+            else if ((pOldest == NULL) || ((int32_t)(pEntry->LastUse - pOldest->LastUse) < 0))
+            {
+                pOldest = pEntry;
+            }
+        }
+
+        if ((pFree != NULL) && (Stats.Bytes + Size <= Stats.Budget))
+        {
+            return pFree;
+        }
+
+        if (pOldest == NULL)
+        {
+            return NULL;
+        }
+
+        FreeEntry(pOldest);
+        Stats.Evictions++;
+    }
+}
+
+static void FreeEntry(TextCache_Entry_t *const pEntry)
+{
+    if (pEntry->pText == NULL)
+    {
+        return;
+    }
+
+    Stats.NumEntries--;
+    Stats.Bytes -= pEntry->Size;
+    free(pEntry->pRuns);
+    free(pEntry->pText);
+    memset(pEntry, 0x0, sizeof(*pEntry));
+}
+
+static void FillRun(uint16_t *const pRow, int32_t x1, int32_t x2, const TextCache_Rect_t *const pClip, const uint16_t Color)
+{
+    x1 = (x1 > pClip->x1) ? x1 : pClip->x1;
+    x2 = (x2 < pClip->x2) ? x2 : pClip->x2;
+    for (int32_t x = x1; x <= x2; x++)
+    {
+        pRow[x] = Color;
+    }
+}
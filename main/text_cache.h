@@ -0,0 +1,74 @@
+#pragma once
+
+// Pre-rasterized text for the OSD's 1 bpp bitmap fonts. Every font added gets a glyph atlas: each printable ASCII glyph
+// is turned once into runs of set pixels, already placed relative to the pen and the top of the line. Strings are put
+// together from the atlas into a single run list, cached by font and string, and drawn in one pass that stores the
+// color straight into the frame. The cache stays within a byte budget by dropping the least recently used strings.
+//
+// What is drawn matches LVGL's rendering of one line of text at full opacity without letter spacing or kerning.
+//
+// Free of FreeRTOS/IDF headers so that it can be built against the host tools.
+
+#include "lvgl.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    kTextCacheConsts_FirstChar     = 0x20,
+    kTextCacheConsts_LastChar      = 0x7E,
+    kTextCacheConsts_NumChars      = kTextCacheConsts_LastChar - kTextCacheConsts_FirstChar + 1,
+    kTextCacheConsts_MaxFonts      = 4,
+    kTextCacheConsts_MaxEntries    = 96,
+    kTextCacheConsts_MaxWidth      = 255,       // [px] Longest string that is cached, runs store x in a byte
+    kTextCacheConsts_DefaultBudget = 12288,     // [bytes]
+} TextCacheConsts_t;
+
+typedef struct TextCache_Run {
+    uint8_t x;                                  // [px] From the start of the string
+    int8_t y;                                   // [px] From the top of the line
+    uint8_t Length;                             // [px]
+} TextCache_Run_t;
+
+// Inclusive, as LVGL's areas are
+typedef struct TextCache_Rect {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} TextCache_Rect_t;
+
+typedef struct TextCache_Entry {
+    const lv_font_t *pFont;
+    char *pText;
+    TextCache_Run_t *pRuns;
+    uint32_t Hash;
+    uint32_t LastUse;
+    uint16_t NumRuns;
+    uint16_t Width;                             // [px] What LVGL measures the line as
+    uint16_t Size;                              // [bytes] Counted against the budget
+} TextCache_Entry_t;
+
+typedef struct TextCache_Stats {
+    uint32_t Lookups;
+    uint32_t Hits;
+    uint32_t Misses;                            // Rendered into the cache
+    uint32_t Uncacheable;                       // Unknown font or character, too wide or over the budget
+    uint32_t Evictions;
+    uint32_t NumEntries;
+    uint32_t Bytes;                             // [bytes] In use by cached strings
+    uint32_t Budget;                            // [bytes]
+    uint32_t AtlasBytes;                        // [bytes] All glyph atlases together
+    uint32_t NumBlits;
+    uint32_t NumGlyphs;                         // Drawn one at a time from an atlas
+} TextCache_Stats_t;
+
+bool TextCache_AddFont(const lv_font_t *const pFont);
+bool TextCache_HasFont(const lv_font_t *const pFont);
+void TextCache_SetBudget(const size_t Budget);
+void TextCache_Clear(void);
+const TextCache_Entry_t* TextCache_Get(const lv_font_t *const pFont, const char *const pText);
+void TextCache_Blit(const TextCache_Entry_t *const pEntry, const uint16_t Color, const int32_t x, const int32_t y, const TextCache_Rect_t *const pClip, uint16_t *const pDst, const size_t DstStride_px);
+bool TextCache_DrawGlyph(const lv_font_t *const pFont, const uint32_t Letter, const uint16_t Color, const int32_t x, const int32_t y, const TextCache_Rect_t *const pClip, uint16_t *const pDst, const size_t DstStride_px);
+const TextCache_Stats_t* TextCache_GetStats(void);
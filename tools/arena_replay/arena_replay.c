@@ -0,0 +1,780 @@
+// Host-side replay of the OSD's LVGL heap traffic against components/lv_arena.
+//
+// Drives a scripted navigation session through a model of what LVGL 8.4 allocates on a 32-bit target when the OSD
+// creates and deletes its widgets. Each tab is built when it is entered: a container, the tab image, and a row per
+// menu item with its name and dot. Each item's options are built while it is selected. Everything is deleted again on
+// the way out, as the OSD does with CHROMATIC_OSD_RETAINED=n. With CHROMATIC_OSD_RETAINED=y every tab and every
+// item's options are built once at start-up and only hidden and shown after that, which costs LVGL nothing, but the
+// labels whose text is set at run time get new text each time their item is shown. The session is run both ways.
+// An object allocates what LVGL would allocate for it:
+//   - the instance, its parent's child array growing by a pointer, and the theme's style
+//   - local style properties for its position and size, the first inline and the rest in a growing array
+//   - label text set with lv_label_set_text(), and the two draw event callbacks the text cache adds
+//   - a table's row heights, column widths, cell array and cell texts
+// Deleting an object frees all of that, children first, shrinking the parent's child array one entry at a time. The
+// sizes are those of LVGL's structures with its ESP-IDF defaults, so this is a stand-in shaped after the OSD rather
+// than a recording. `osd_nav` on the device measures the real thing.
+//
+// The session runs against the arena with its pools, against the same arena as a plain first fit heap, and against
+// the C library's allocator for the cost. Every block is filled when it is handed out and checked when it is resized
+// or freed, and the arena's books must balance after every transition. For each allocator it reports the time per
+// call, the heap time per transition, the peak footprint, the fragmentation after transitions and the smallest arena
+// the session runs in.
+//
+// Build and run from this directory with:
+//   gcc -O2 -I../../components/lv_arena arena_replay.c ../../components/lv_arena/lv_arena.c -o arena_replay
+//   ./arena_replay --rounds 20 --arena-kb 32
+//
+// The exit code is non-zero if a block was corrupted, the books don't balance or the session doesn't fit the arena.
+
+#include "lv_arena.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// LVGL 8.4 structure sizes on a 32-bit target, with LV_USE_USER_DATA, LV_LABEL_LONG_TXT_HINT and
+// LV_LABEL_TEXT_SELECTION enabled as the ESP-IDF component has them
+enum {
+    kSizeObj       = 36,
+    kSizeLabel     = 76,
+    kSizeImg       = 60,
+    kSizeTable     = 56,
+    kSizeSpecAttr  = 32,
+    kSizeStyleRef  = 8,                 // _lv_obj_style_t
+    kSizeStyle     = 8,                 // lv_style_t
+    kSizeProp      = 6,                 // A value and its property id
+    kSizeEventDsc  = 12,
+    kSizeLlNode    = 8,                 // lv_ll_t's links, after the node
+    kMaxObjs       = 512,
+    kMaxKids       = 32,
+    kMaxExtras     = 48,
+    kMaxDetails    = 6,
+    kMinText       = 4,
+    kMaxText       = 20,
+    kSearchStep    = 256,               // [bytes] Resolution of the smallest arena search
+};
+
+typedef struct Detail {
+    uint8_t Images;
+    uint8_t Labels;                     // Static text
+    uint8_t DynLabels;                  // Text copied by lv_label_set_text()
+    uint8_t TableRows;
+} Detail_t;
+
+// After main/osd_default.c: the items each tab has and the option widgets behind them
+static const struct {
+    const char *pName;
+    size_t NumItems;
+    Detail_t Details[kMaxDetails];
+} Tabs[] = {
+    { "Status",   3, { { 1, 1, 1, 0 }, { 2, 0, 2, 0 }, { 0, 2, 4, 0 } } },
+    { "Display",  5, { { 2, 1, 1, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 3, 0, 3, 0 } } },
+    { "Controls", 2, { { 2, 0, 2, 0 }, { 0, 13, 0, 0 } } },
+    { "Palette",  1, { { 0, 2, 0, 12 } } },
+    { "System",   4, { { 2, 2, 0, 0 }, { 2, 0, 2, 0 }, { 0, 1, 2, 0 }, { 2, 1, 2, 0 } } },
+};
+
+#define NUM_TABS (sizeof(Tabs) / sizeof(Tabs[0]))
+
+typedef struct Allocator {
+    const char *pName;
+    void* (*fnAlloc)(size_t Size);
+    void (*fnFree)(void *pData);
+    void* (*fnRealloc)(void *pData, size_t Size);
+    bool IsArena;
+    bool UsePools;
+} Allocator_t;
+
+static const Allocator_t Allocators[] = {
+    { "arena+pools", LvArena_Alloc, LvArena_Free, LvArena_Realloc, true, true },
+    { "first fit",   LvArena_Alloc, LvArena_Free, LvArena_Realloc, true, false },
+    { "libc",        malloc,        free,         realloc,         false, false },
+};
+
+#define NUM_ALLOCATORS (sizeof(Allocators) / sizeof(Allocators[0]))
+
+// A block as the model holds it, with the byte it was filled with
+typedef struct Mem {
+    uint8_t *p;
+    uint32_t Size;
+    uint8_t Fill;
+} Mem_t;
+
+typedef struct Obj {
+    struct Obj *pParent;
+    struct Obj *Kids[kMaxKids];
+    size_t NumKids;
+    Mem_t Inst;
+    Mem_t Spec;
+    Mem_t Children;
+    Mem_t Styles;
+    size_t NumStyles;
+    Mem_t Local;
+    Mem_t Props;
+    size_t NumProps;
+    Mem_t Events;
+    size_t NumEvents;
+    Mem_t Text;
+    Mem_t Extras[kMaxExtras];
+    size_t NumExtras;
+} Obj_t;
+
+typedef struct Result {
+    uint64_t NumCalls;
+    uint64_t Elapsed_ns;
+    uint32_t NumTransitions;
+    uint64_t Transition_ns;             // All transitions together, building at start-up excluded
+    uint64_t MaxTransition_ns;
+    uint32_t PeakRequested;             // [bytes]
+    uint32_t Peak;                      // [bytes]
+    uint32_t MinBiggest;                // [bytes] Largest free block, at its smallest after a transition
+    uint8_t MaxFrag_pct;
+    uint32_t NumPoolHits;
+    uint32_t NumFlushes;
+} Result_t;
+
+static struct {
+    unsigned Rounds;
+    unsigned Repeat;
+    unsigned ArenaKb;
+    uint32_t Seed;
+} Config = {
+    .Rounds = 20,
+    .Repeat = 10,
+    .ArenaKb = 32,
+    .Seed = 1,
+};
+
+// lv_mem_alloc(0) and lv_mem_realloc(p, 0) hand this out instead of a block
+static uint8_t ZeroMem[4];
+
+static const Allocator_t *pAlloc;
+static bool IsRetained;
+static Obj_t Objs[kMaxObjs];
+static bool IsObjUsed[kMaxObjs];
+static uint8_t *pArenaMem;
+static uint32_t Rng;
+static uint32_t NumCalls;
+static uint32_t Requested;
+static uint32_t PeakRequested;
+static uint8_t NextFill;
+static bool IsFailed;
+static bool IsCorrupt;
+
+static uint32_t Random(void)
+{
+    // xorshift32, the same sequence on every run for a given seed
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+static uint64_t Now_ns(void)
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return (uint64_t)Ts.tv_sec * 1000000000ull + (uint64_t)Ts.tv_nsec;
+}
+
+static bool IsIntact(const Mem_t *const pMem, const uint32_t Length)
+{
+    for (uint32_t i = 0; i < Length; i++)
+    {
+        if (pMem->p[i] != pMem->Fill)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void Track(Mem_t *const pMem, uint8_t *const p, const uint32_t Size)
+{
+    Requested = Requested - pMem->Size + Size;
+    PeakRequested = (Requested > PeakRequested) ? Requested : PeakRequested;
+    pMem->p = p;
+    pMem->Size = Size;
+    pMem->Fill = ++NextFill;
+    memset(p, pMem->Fill, Size);
+}
+
+// lv_mem_alloc()
+static void Alloc(Mem_t *const pMem, const uint32_t Size)
+{
+    uint8_t *const p = pAlloc->fnAlloc(Size);
+    NumCalls++;
+    if (p == NULL)
+    {
+        IsFailed = true;
+        return;
+    }
+
+    Track(pMem, p, Size);
+}
+
+// lv_mem_free()
+static void Free(Mem_t *const pMem)
+{
+    if ((pMem->p == NULL) || (pMem->p == ZeroMem))
+    {
+        memset(pMem, 0x0, sizeof(*pMem));
+        return;
+    }
+
+    IsCorrupt = IsCorrupt || !IsIntact(pMem, pMem->Size);
+    pAlloc->fnFree(pMem->p);
+    NumCalls++;
+    Requested -= pMem->Size;
+    memset(pMem, 0x0, sizeof(*pMem));
+}
+
+// lv_mem_realloc(), which frees for a size of 0 and allocates for a block that was never allocated
+static void Realloc(Mem_t *const pMem, const uint32_t Size)
+{
+    if (Size == 0)
+    {
+        Free(pMem);
+        pMem->p = ZeroMem;
+        return;
+    }
+
+    if ((pMem->p == NULL) || (pMem->p == ZeroMem))
+    {
+        pMem->p = NULL;
+        Alloc(pMem, Size);
+        return;
+    }
+
+    const uint32_t Kept = (Size < pMem->Size) ? Size : pMem->Size;
+    uint8_t *const p = pAlloc->fnRealloc(pMem->p, Size);
+    NumCalls++;
+    if (p == NULL)
+    {
+        IsFailed = true;
+        return;
+    }
+
+    const Mem_t Moved = { .p = p, .Size = Kept, .Fill = pMem->Fill };
+    IsCorrupt = IsCorrupt || !IsIntact(&Moved, Kept);
+    Track(pMem, p, Size);
+}
+
+static void AddStyle(Obj_t *const pObj)
+{
+    Realloc(&pObj->Styles, (uint32_t)(++pObj->NumStyles * kSizeStyleRef));
+}
+
+// lv_obj_set_style_*() on the object's local style, whose first property lives in the style itself
+static void SetLocal(Obj_t *const pObj, const size_t NumProps)
+{
+    if (pObj->Local.p == NULL)
+    {
+        AddStyle(pObj);
+        Alloc(&pObj->Local, kSizeStyle);
+    }
+
+    for (size_t i = 0; i < NumProps; i++)
+    {
+        if (++pObj->NumProps > 1)
+        {
+            Realloc(&pObj->Props, (uint32_t)(pObj->NumProps * kSizeProp));
+        }
+    }
+}
+
+static void AllocSpec(Obj_t *const pObj)
+{
+    if (pObj->Spec.p == NULL)
+    {
+        Alloc(&pObj->Spec, kSizeSpecAttr);
+    }
+}
+
+static void AddEvent(Obj_t *const pObj)
+{
+    AllocSpec(pObj);
+    Realloc(&pObj->Events, (uint32_t)(++pObj->NumEvents * kSizeEventDsc));
+}
+
+static Obj_t* Create(Obj_t *const pParent, const uint32_t InstSize)
+{
+    Obj_t *pObj = NULL;
+    for (size_t i = 0; (i < kMaxObjs) && (pObj == NULL); i++)
+    {
+        if (!IsObjUsed[i])
+        {
+            pObj = &Objs[i];
+            IsObjUsed[i] = true;
+        }
+    }
+
+    if ((pObj == NULL) || ((pParent != NULL) && (pParent->NumKids >= kMaxKids)))
+    {
+        fprintf(stderr, "The model ran out of objects\n");
+        exit(2);
+    }
+
+    memset(pObj, 0x0, sizeof(*pObj));
+    Alloc(&pObj->Inst, InstSize);
+    if (pParent != NULL)
+    {
+        AllocSpec(pParent);
+        pParent->Kids[pParent->NumKids++] = pObj;
+        Realloc(&pParent->Children, (uint32_t)(pParent->NumKids * sizeof(uint32_t)));
+        pObj->pParent = pParent;
+    }
+
+    // The default theme's style
+    AddStyle(pObj);
+    return pObj;
+}
+
+static Obj_t* Container(Obj_t *const pParent)
+{
+    Obj_t *const pObj = Create(pParent, kSizeObj);
+    SetLocal(pObj, 4);
+    return pObj;
+}
+
+static void Image(Obj_t *const pParent)
+{
+    SetLocal(Create(pParent, kSizeImg), 2);
+}
+
+static void Label(Obj_t *const pParent, const bool IsCopied)
+{
+    Obj_t *const pObj = Create(pParent, kSizeLabel);
+    if (IsCopied)
+    {
+        Alloc(&pObj->Text, kMinText + Random() % (kMaxText - kMinText + 1) + 1);
+    }
+
+    AddStyle(pObj);
+    SetLocal(pObj, 2);
+    AddEvent(pObj);
+    AddEvent(pObj);
+}
+
+static void Table(Obj_t *const pParent, const size_t NumRows)
+{
+    Obj_t *const pObj = Create(pParent, kSizeTable);
+    Mem_t *const pRowH = &pObj->Extras[0];
+    Mem_t *const pColW = &pObj->Extras[1];
+    Mem_t *const pCells = &pObj->Extras[2];
+    pObj->NumExtras = 3;
+
+    Alloc(pRowH, sizeof(uint16_t));
+    Alloc(pColW, sizeof(uint16_t));
+    Alloc(pCells, sizeof(uint32_t));
+    SetLocal(pObj, 3);
+
+    // lv_table_set_cell_value() grows the table a row at a time, each cell keeps its text behind a control byte
+    for (size_t r = 0; (r < NumRows) && (pObj->NumExtras < kMaxExtras); r++)
+    {
+        Realloc(pRowH, (uint32_t)((r + 1) * sizeof(uint16_t)));
+        Realloc(pCells, (uint32_t)((r + 1) * sizeof(uint32_t)));
+        Alloc(&pObj->Extras[pObj->NumExtras++], kMinText + Random() % (kMaxText - kMinText + 1) + 2);
+    }
+}
+
+// lv_obj_del(), children first, each taken out of its parent's child array
+static void Delete(Obj_t *const pObj)
+{
+    while (pObj->NumKids > 0)
+    {
+        Delete(pObj->Kids[pObj->NumKids - 1]);
+    }
+
+    Free(&pObj->Events);
+    Free(&pObj->Children);
+    Free(&pObj->Spec);
+    Free(&pObj->Props);
+    Free(&pObj->Local);
+    Free(&pObj->Styles);
+    Free(&pObj->Text);
+    for (size_t i = 0; i < pObj->NumExtras; i++)
+    {
+        Free(&pObj->Extras[i]);
+    }
+    Free(&pObj->Inst);
+
+    Obj_t *const pParent = pObj->pParent;
+    if (pParent != NULL)
+    {
+        size_t i = 0;
+        while (pParent->Kids[i] != pObj)
+        {
+            i++;
+        }
+
+        memmove(&pParent->Kids[i], &pParent->Kids[i + 1], (pParent->NumKids - i - 1) * sizeof(pParent->Kids[0]));
+        pParent->NumKids--;
+        Realloc(&pParent->Children, (uint32_t)(pParent->NumKids * sizeof(uint32_t)));
+    }
+
+    IsObjUsed[pObj - Objs] = false;
+}
+
+// The arena's books: everything is either live, pooled or in the free list
+static void Sample(Result_t *const pResult)
+{
+    if (!pAlloc->IsArena)
+    {
+        return;
+    }
+
+    LvArena_Frag_t Frag;
+    LvArena_GetFrag(&Frag);
+    const LvArena_Stats_t *const pStats = LvArena_GetStats();
+    IsCorrupt = IsCorrupt || (pStats->Used + pStats->Pooled + Frag.FreeBytes != pStats->Size);
+
+    pResult->MinBiggest = (Frag.FreeBiggest < pResult->MinBiggest) ? Frag.FreeBiggest : pResult->MinBiggest;
+    pResult->MaxFrag_pct = (Frag.Frag_pct > pResult->MaxFrag_pct) ? Frag.Frag_pct : pResult->MaxFrag_pct;
+}
+
+// lv_init(), the display, its draw context, the screens and layers, the input device and lv_mem_buf_get()'s buffers,
+// which are all kept for good
+static void Boot(Mem_t *const pBoot, const size_t NumBoot, Obj_t **ppScreen)
+{
+    static const uint32_t Sizes[] = {
+        28 + kSizeLlNode, 28 + kSizeLlNode, 28 + kSizeLlNode, 320 + kSizeLlNode, 104, 80 + kSizeLlNode,
+        160, 320, 640, 160,
+    };
+
+    for (size_t i = 0; (i < NumBoot) && (i < sizeof(Sizes) / sizeof(Sizes[0])); i++)
+    {
+        Alloc(&pBoot[i], Sizes[i]);
+    }
+
+    *ppScreen = Create(NULL, kSizeObj);
+    SetLocal(Create(NULL, kSizeObj), 1);
+    SetLocal(Create(NULL, kSizeObj), 1);
+}
+
+// The tab, with a row per item
+static Obj_t* BuildTab(Obj_t *const pScreen, const size_t t)
+{
+    Obj_t *const pTab = Container(pScreen);
+    Image(pTab);
+    for (size_t i = 0; i < Tabs[t].NumItems; i++)
+    {
+        Obj_t *const pRow = Container(pTab);
+        Label(pRow, false);
+        Image(pRow);
+    }
+
+    return pTab;
+}
+
+// An item's options
+static Obj_t* BuildPane(Obj_t *const pTab, const Detail_t *const pDetail)
+{
+    Obj_t *const pPane = Container(pTab);
+    for (size_t n = 0; n < pDetail->Images; n++)
+    {
+        Image(pPane);
+    }
+    for (size_t n = 0; n < pDetail->Labels; n++)
+    {
+        Label(pPane, false);
+    }
+    for (size_t n = 0; n < pDetail->DynLabels; n++)
+    {
+        Label(pPane, true);
+    }
+    if (pDetail->TableRows > 0)
+    {
+        Table(pPane, pDetail->TableRows);
+    }
+
+    return pPane;
+}
+
+// Selecting an item: its options are built, or a retained one is shown and has its run-time text set again
+static void EnterPane(Obj_t *const pTab, Obj_t **ppPane, const Detail_t *const pDetail)
+{
+    if (!IsRetained)
+    {
+        *ppPane = BuildPane(pTab, pDetail);
+        return;
+    }
+
+    Obj_t *const pPane = *ppPane;
+    for (size_t k = 0; k < pPane->NumKids; k++)
+    {
+        Mem_t *const pText = &pPane->Kids[k]->Text;
+        if (pText->p != NULL)
+        {
+            Realloc(pText, kMinText + Random() % (kMaxText - kMinText + 1) + 1);
+        }
+    }
+}
+
+// The pane may never have been built if the session ran out of arena on the way
+static void LeavePane(Obj_t **ppPane)
+{
+    if (!IsRetained && (*ppPane != NULL))
+    {
+        Delete(*ppPane);
+        *ppPane = NULL;
+    }
+}
+
+// Times the transition that began at Begin_ns, then checks the heap it left behind
+static void EndTransition(Result_t *const pResult, const uint64_t Begin_ns)
+{
+    const uint64_t Elapsed_ns = Now_ns() - Begin_ns;
+    pResult->NumTransitions++;
+    pResult->Transition_ns += Elapsed_ns;
+    pResult->MaxTransition_ns = (Elapsed_ns > pResult->MaxTransition_ns) ? Elapsed_ns : pResult->MaxTransition_ns;
+    Sample(pResult);
+}
+
+static bool RunSession(const Allocator_t *const pAllocator, const size_t ArenaSize, Result_t *const pResult)
+{
+    pAlloc = pAllocator;
+    memset(pResult, 0x0, sizeof(*pResult));
+    memset(IsObjUsed, 0x0, sizeof(IsObjUsed));
+    pResult->MinBiggest = UINT32_MAX;
+    Rng = (Config.Seed == 0) ? 1 : Config.Seed;
+    NumCalls = 0;
+    Requested = 0;
+    PeakRequested = 0;
+    IsFailed = false;
+
+    if (pAllocator->IsArena && !LvArena_Init(pArenaMem, ArenaSize, pAllocator->UsePools))
+    {
+        return false;
+    }
+
+    Mem_t Boots[10] = { 0 };
+    Obj_t *pScreen = NULL;
+    const uint64_t Start_ns = Now_ns();
+
+    Boot(Boots, sizeof(Boots) / sizeof(Boots[0]), &pScreen);
+
+    // Kept for the whole session when retained, otherwise only while they are on screen
+    Obj_t *pTabs[NUM_TABS] = { NULL };
+    Obj_t *pPanes[NUM_TABS][kMaxDetails] = { { NULL } };
+    if (IsRetained)
+    {
+        for (size_t t = 0; t < NUM_TABS; t++)
+        {
+            pTabs[t] = BuildTab(pScreen, t);
+            for (size_t i = 0; i < Tabs[t].NumItems; i++)
+            {
+                pPanes[t][i] = BuildPane(pTabs[t], &Tabs[t].Details[i]);
+            }
+        }
+        Sample(pResult);
+    }
+
+    for (unsigned Round = 0; (Round < Config.Rounds) && !IsFailed; Round++)
+    {
+        for (size_t t = 0; (t < NUM_TABS) && !IsFailed; t++)
+        {
+            // Into the tab, down through the items, each showing its options until the next is selected, and out
+            uint64_t Begin_ns = Now_ns();
+            pTabs[t] = IsRetained ? pTabs[t] : BuildTab(pScreen, t);
+            EndTransition(pResult, Begin_ns);
+
+            for (size_t i = 0; (i < Tabs[t].NumItems) && !IsFailed; i++)
+            {
+                Begin_ns = Now_ns();
+                if (i > 0)
+                {
+                    LeavePane(&pPanes[t][i - 1]);
+                }
+                EnterPane(pTabs[t], &pPanes[t][i], &Tabs[t].Details[i]);
+                EndTransition(pResult, Begin_ns);
+            }
+
+            Begin_ns = Now_ns();
+            if (Tabs[t].NumItems > 0)
+            {
+                LeavePane(&pPanes[t][Tabs[t].NumItems - 1]);
+            }
+            if (!IsRetained)
+            {
+                Delete(pTabs[t]);
+                pTabs[t] = NULL;
+            }
+            EndTransition(pResult, Begin_ns);
+        }
+    }
+
+    pResult->Elapsed_ns = Now_ns() - Start_ns;
+    pResult->NumCalls = NumCalls;
+    pResult->PeakRequested = PeakRequested;
+    if (pAllocator->IsArena)
+    {
+        const LvArena_Stats_t *const pStats = LvArena_GetStats();
+        pResult->Peak = pStats->Peak;
+        pResult->NumPoolHits = pStats->NumPoolHits;
+        pResult->NumFlushes = pStats->NumFlushes;
+    }
+
+    // Everything the session created goes, so that libc's heap is left as it was found
+    for (size_t i = 0; i < kMaxObjs; i++)
+    {
+        if (IsObjUsed[i] && (Objs[i].pParent == NULL))
+        {
+            Delete(&Objs[i]);
+        }
+    }
+    for (size_t i = 0; i < sizeof(Boots) / sizeof(Boots[0]); i++)
+    {
+        Free(&Boots[i]);
+    }
+
+    return !IsFailed;
+}
+
+// The smallest arena, in steps of kSearchStep, that the whole session runs in
+static size_t FindSmallestArena(const Allocator_t *const pAllocator, const size_t Max)
+{
+    Result_t Result;
+    size_t Low = 0;
+    size_t High = Max / kSearchStep;
+    if (!RunSession(pAllocator, High * kSearchStep, &Result))
+    {
+        return 0;
+    }
+
+    while (High - Low > 1)
+    {
+        const size_t Mid = (Low + High) / 2;
+        if (RunSession(pAllocator, Mid * kSearchStep, &Result))
+        {
+            High = Mid;
+        }
+        else
+        {
+            Low = Mid;
+        }
+    }
+
+    return High * kSearchStep;
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --rounds N    Times the session walks every tab and item (default %u)\n"
+            "  --repeat N    Sessions per allocator for the timings (default %u)\n"
+            "  --arena-kb N  Arena size, CHROMATIC_OSD_LV_ARENA_KB on the device (default %u)\n"
+            "  --seed N      Seed for the label text lengths (default %u)\n",
+            pName, Config.Rounds, Config.Repeat, Config.ArenaKb, Config.Seed);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "rounds",   required_argument, NULL, 'r' },
+        { "repeat",   required_argument, NULL, 'n' },
+        { "arena-kb", required_argument, NULL, 'a' },
+        { "seed",     required_argument, NULL, 'S' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'r': Config.Rounds = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'n': Config.Repeat = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'a': Config.ArenaKb = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'S': Config.Seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    Config.Rounds = (Config.Rounds == 0) ? 1 : Config.Rounds;
+    Config.Repeat = (Config.Repeat == 0) ? 1 : Config.Repeat;
+    const size_t ArenaSize = (size_t)Config.ArenaKb * 1024;
+    pArenaMem = malloc(ArenaSize + kLvArenaConsts_Align);
+    if ((pArenaMem == NULL) || (ArenaSize == 0))
+    {
+        fprintf(stderr, "No memory for a %u KB arena\n", Config.ArenaKb);
+        return 1;
+    }
+
+    bool IsOk = true;
+    printf("%u rounds of %zu tabs in a %u KB arena\n", Config.Rounds, NUM_TABS, Config.ArenaKb);
+    for (size_t m = 0; m < 2; m++)
+    {
+        IsRetained = (m == 1);
+        printf("\n%s\n", IsRetained ? "Retained widgets (CHROMATIC_OSD_RETAINED=y)" : "Rebuilt widgets (CHROMATIC_OSD_RETAINED=n)");
+        printf("%-12s %8s %8s %9s %9s %9s %8s %8s %6s %8s %9s %8s\n", "Allocator", "Calls", "ns/call", "us/trans",
+               "max us", "Requested", "Peak", "MinBig", "Frag", "Pooled", "Flushes", "Smallest");
+
+        for (size_t a = 0; a < NUM_ALLOCATORS; a++)
+        {
+            const Allocator_t *const pAllocator = &Allocators[a];
+            Result_t Result;
+            uint64_t Elapsed_ns = 0;
+            uint64_t Transition_ns = 0;
+            uint64_t MaxTransition_ns = 0;
+            bool IsFit = true;
+
+            IsCorrupt = false;
+            for (unsigned n = 0; n < Config.Repeat; n++)
+            {
+                IsFit = RunSession(pAllocator, ArenaSize, &Result) && IsFit;
+                Elapsed_ns += Result.Elapsed_ns;
+                Transition_ns += Result.Transition_ns;
+                MaxTransition_ns = (Result.MaxTransition_ns > MaxTransition_ns) ? Result.MaxTransition_ns : MaxTransition_ns;
+            }
+
+            const double PerCall_ns = (double)Elapsed_ns / ((double)Result.NumCalls * Config.Repeat);
+            const double PerTransition_us = (double)Transition_ns / ((double)Result.NumTransitions * Config.Repeat) / 1000.0;
+            const double MaxTransition_us = (double)MaxTransition_ns / 1000.0;
+            if (!pAllocator->IsArena)
+            {
+                printf("%-12s %8llu %8.1f %9.2f %9.2f %9lu %8s %8s %6s %8s %9s %8s\n", pAllocator->pName,
+                       (unsigned long long)Result.NumCalls, PerCall_ns, PerTransition_us, MaxTransition_us,
+                       (unsigned long)Result.PeakRequested, "-", "-", "-", "-", "-", "-");
+            }
+            else
+            {
+                const size_t Smallest = FindSmallestArena(pAllocator, ArenaSize);
+                printf("%-12s %8llu %8.1f %9.2f %9.2f %9lu %8lu %8lu %5u%% %7.1f%% %9lu %8zu\n", pAllocator->pName,
+                       (unsigned long long)Result.NumCalls, PerCall_ns, PerTransition_us, MaxTransition_us,
+                       (unsigned long)Result.PeakRequested, (unsigned long)Result.Peak, (unsigned long)Result.MinBiggest,
+                       Result.MaxFrag_pct,
+                       (Result.NumCalls > 0) ? (100.0 * Result.NumPoolHits) / (double)Result.NumCalls : 0.0,
+                       (unsigned long)Result.NumFlushes, Smallest);
+            }
+
+            if (!IsFit || IsCorrupt)
+            {
+                printf("%s: %s\n", pAllocator->pName, IsCorrupt ? "a block was corrupted or the books don't balance"
+                                                                : "the session didn't fit");
+                IsOk = false;
+            }
+        }
+    }
+
+    printf("\n");
+    printf("us/trans is the time a transition spends in the model and the allocator, max the slowest one seen.\n"
+           "Requested is the most LVGL asked for at once, Peak what the arena took out of its free list for it.\n"
+           "Frag and MinBig are the worst seen after a transition, Pooled the share of calls a pool served and\n"
+           "Smallest the smallest arena the session runs in.\n");
+
+    free(pArenaMem);
+    printf("%s\n", IsOk ? "PASS" : "FAIL");
+    return IsOk ? 0 : 1;
+}
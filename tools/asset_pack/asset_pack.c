@@ -0,0 +1,782 @@
+// Build step for the packed OSD images and the asset partition.
+//
+// Compiles the images in components/images into an asset pack (see components/assets/asset_pack.h): each image gets
+// its own palette and its rows are stored as run-length coded palette indices, or it is kept as it was if that comes
+// out smaller or it has more than 256 colors. The pixels are taken from the 16-bit variant in the generated .c files,
+// which is what the firmware links and what the PNGs were converted to, so the pack matches them bit for bit.
+//
+// With --out-c it writes the pack as a C source defining the same lv_img_dsc_t symbols as the images component, which
+// components/images generates and builds instead of the individual files when CHROMATIC_OSD_ASSET_PACK is enabled. Every image is
+// decoded back and compared with the original, and the flash each one takes before and after packing is reported
+// along with what decoding it costs on this host, against copying the raw rows.
+//
+// With --out-bin it writes the packed images and the fonts as an asset store (see components/assets/asset_store.h) for
+// the `assets` partition, then maps the file through the firmware's own loader and checks that every asset resolves to
+// what is linked in today.
+//
+// The fonts aren't compressed. They are already 1 bpp and at most a little over a kilobyte each, and run-length coding
+// their glyphs makes the small ones bigger and saves a few dozen bytes on jf_dot_k14, so they are stored as they are.
+//
+// Build and run from this directory with:
+//   gcc -O2 -DLV_LVGL_H_INCLUDE_SIMPLE -I../palette_check -I../../components/assets asset_pack.c ../../components/assets/asset_pack.c ../../components/assets/asset_store.c ../../components/images/*.c ../../components/fonts/*.c -o asset_pack
+//   ./asset_pack --out-c images_packed.c --out-bin assets.bin
+//
+// The firmware build does the same through asset_pack_generate() in components/assets/project_include.cmake, so the
+// outputs aren't kept in the tree and can't go stale.
+//
+// The exit code is non-zero if an asset doesn't come back as it went in or the output can't be written.
+
+#include "asset_pack.h"
+#include "asset_store.h"
+#include "lvgl.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+    kMaxPackSize  = 512 * 1024,
+    kMaxWidth_px  = 256,
+    kWordsPerLine = 8,
+};
+
+#define IMAGES(X)                                                                                                   \
+    X(icon_bat_large_g) X(icon_bat_large_r) X(icon_bat_large_y) X(icon_charging) X(icon_wifi) X(img_a_right)        \
+    X(img_arrow_down) X(img_arrow_up) X(img_b_left) X(img_brightness) X(img_chromatic) X(img_chromatic_eyebrow)     \
+    X(img_dot_grey) X(img_dot_white) X(img_option_dis) X(img_option_en) X(img_toggle_off) X(img_toggle_on)          \
+    X(menu_controls) X(menu_display) X(menu_palette) X(menu_status) X(menu_system)
+
+#define FONTS(X) X(chibit_mr) X(fingfai) X(jf_dot_k14)
+
+#define DECLARE_IMAGE(Name) extern const lv_img_dsc_t Name;
+#define DECLARE_FONT(Name) extern const lv_font_t Name;
+#define IMAGE_ENTRY(Name) { #Name, &Name },
+#define FONT_ENTRY(Name) { #Name, &Name },
+
+IMAGES(DECLARE_IMAGE)
+FONTS(DECLARE_FONT)
+
+static const struct {
+    const char *pName;
+    const lv_img_dsc_t *pImg;
+} Images[] = { IMAGES(IMAGE_ENTRY) };
+
+static const struct {
+    const char *pName;
+    const lv_font_t *pFont;
+} Fonts[] = { FONTS(FONT_ENTRY) };
+
+#define NUM_IMAGES (sizeof(Images) / sizeof(Images[0]))
+
+static struct {
+    const char *pOutC;
+    const char *pOutBin;
+    unsigned Iterations;
+} Config = {
+    .pOutC = NULL,
+    .pOutBin = NULL,
+    .Iterations = 1000,
+};
+
+// Word aligned so that entries can be checked and decoded in place, as the firmware does
+static uint32_t PackWords[kMaxPackSize / sizeof(uint32_t)];
+static uint8_t *const pPack = (uint8_t*)PackWords;
+static size_t PackSize;
+static size_t EntryOffsets[NUM_IMAGES];
+static size_t EntrySizes[NUM_IMAGES];
+
+static uint32_t StoreWords[kMaxPackSize / sizeof(uint32_t)];
+static uint8_t *const pStore = (uint8_t*)StoreWords;
+
+// The font descriptors point at these, the tool never calls them
+bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, void *dsc_out, uint32_t unicode_letter, uint32_t unicode_letter_next)
+{
+    (void) font;
+    (void) dsc_out;
+    (void) unicode_letter;
+    (void) unicode_letter_next;
+    return false;
+}
+
+const uint8_t *lv_font_get_bitmap_fmt_txt(const lv_font_t *font, uint32_t letter)
+{
+    (void) font;
+    (void) letter;
+    return NULL;
+}
+
+static uint64_t Now_ns(void)
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return (uint64_t)Ts.tv_sec * 1000000000ull + (uint64_t)Ts.tv_nsec;
+}
+
+static size_t AlignUp(const size_t Size)
+{
+    return (Size + kAssetPackConsts_Align - 1) & ~(size_t)(kAssetPackConsts_Align - 1);
+}
+
+static AssetPack_Color_t GetPixel(const lv_img_dsc_t *const pImg, const size_t i)
+{
+    const uint8_t *const pPx = &pImg->data[i * AssetPack_BytesPerPixel((uint8_t)pImg->header.cf)];
+    const AssetPack_Color_t Color = (AssetPack_Color_t)(pPx[0] | (pPx[1] << 8));
+    return (pImg->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA) ? (Color | ((AssetPack_Color_t)pPx[2] << 16)) : Color;
+}
+
+// Runs of two or more become a run code, anything else is gathered into literals
+static size_t EncodeRow(const uint8_t *const pIndices, const size_t Width, uint8_t *const pOut)
+{
+    size_t Size = 0;
+    size_t x = 0;
+    while (x < Width)
+    {
+        size_t Run = 1;
+        while ((x + Run < Width) && (pIndices[x + Run] == pIndices[x]) && (Run < kAssetPackConsts_MaxRun))
+        {
+            Run++;
+        }
+
+        if (Run >= 2)
+        {
+            pOut[Size++] = (uint8_t)(kAssetPackConsts_RunFlag | (Run - 1));
+            pOut[Size++] = pIndices[x];
+            x += Run;
+            continue;
+        }
+
+        size_t Literal = 0;
+        while ((x + Literal < Width) && (Literal < kAssetPackConsts_MaxRun) &&
+               !((x + Literal + 1 < Width) && (pIndices[x + Literal + 1] == pIndices[x + Literal])))
+        {
+            Literal++;
+        }
+        Literal = (Literal == 0) ? 1 : Literal;
+
+        pOut[Size++] = (uint8_t)(Literal - 1);
+        memcpy(&pOut[Size], &pIndices[x], Literal);
+        Size += Literal;
+        x += Literal;
+    }
+
+    return Size;
+}
+
+// Returns the entry's size, or 0 if the pack is full
+static size_t AddImage(const lv_img_dsc_t *const pImg, uint8_t *const pEntry, const size_t Space)
+{
+    const size_t Width = pImg->header.w;
+    const size_t Height = pImg->header.h;
+    const size_t NumPixels = Width * Height;
+    const size_t BytesPerPixel = AssetPack_BytesPerPixel((uint8_t)pImg->header.cf);
+    const size_t RawSize = sizeof(AssetPack_Image_t) + NumPixels * BytesPerPixel;
+
+    AssetPack_Image_t Header = {
+        .Width = (uint16_t)Width,
+        .Height = (uint16_t)Height,
+        .Format = (uint8_t)pImg->header.cf,
+        .Encoding = kAssetPack_Encoding_Raw,
+        .NumColors = 0,
+        .DataSize = (uint32_t)(NumPixels * BytesPerPixel),
+    };
+
+    // Palette in order of first use, which keeps the output stable from run to run
+    static AssetPack_Color_t Palette[kAssetPackConsts_MaxColors];
+    static uint8_t Indices[kMaxWidth_px];
+    static uint8_t Code[kMaxPackSize];
+    static uint32_t RowOffsets[kMaxWidth_px];
+    size_t NumColors = 0;
+    size_t CodeSize = 0;
+    bool IsPaletted = (Width <= kMaxWidth_px) && (Height <= kMaxWidth_px);
+
+    for (size_t y = 0; (y < Height) && IsPaletted; y++)
+    {
+        for (size_t x = 0; (x < Width) && IsPaletted; x++)
+        {
+            const AssetPack_Color_t Color = GetPixel(pImg, y * Width + x);
+            size_t i = 0;
+            while ((i < NumColors) && (Palette[i] != Color))
+            {
+                i++;
+            }
+
+            if (i == NumColors)
+            {
+                IsPaletted = (NumColors < kAssetPackConsts_MaxColors);
+                Palette[NumColors++] = Color;
+            }
+            Indices[x] = (uint8_t)i;
+        }
+
+        if (IsPaletted)
+        {
+            RowOffsets[y] = (uint32_t)CodeSize;
+            CodeSize += EncodeRow(Indices, Width, &Code[CodeSize]);
+        }
+    }
+
+    const size_t PackedSize = sizeof(AssetPack_Image_t) + NumColors * sizeof(AssetPack_Color_t) + Height * sizeof(uint32_t) + CodeSize;
+    const bool IsRLE = IsPaletted && (PackedSize < RawSize);
+    const size_t Size = IsRLE ? PackedSize : RawSize;
+    if (AlignUp(Size) > Space)
+    {
+        return 0;
+    }
+
+    memset(pEntry, 0, AlignUp(Size));
+    if (!IsRLE)
+    {
+        memcpy(&pEntry[sizeof(Header)], pImg->data, Header.DataSize);
+    }
+    else
+    {
+        Header.Encoding = kAssetPack_Encoding_PaletteRLE;
+        Header.NumColors = (uint16_t)NumColors;
+        Header.DataSize = (uint32_t)(PackedSize - sizeof(Header));
+
+        uint8_t *p = &pEntry[sizeof(Header)];
+        memcpy(p, Palette, NumColors * sizeof(Palette[0]));
+        p += NumColors * sizeof(Palette[0]);
+        memcpy(p, RowOffsets, Height * sizeof(RowOffsets[0]));
+        p += Height * sizeof(RowOffsets[0]);
+        memcpy(p, Code, CodeSize);
+    }
+
+    memcpy(pEntry, &Header, sizeof(Header));
+    return AlignUp(Size);
+}
+
+// Whole rows and a spread of partial ones, since LVGL asks for both
+static bool Verify(const lv_img_dsc_t *const pImg, const AssetPack_Image_t *const pPacked, const size_t EntrySize)
+{
+    if (!AssetPack_IsValidImage(pPacked, EntrySize))
+    {
+        return false;
+    }
+
+    const size_t Width = pImg->header.w;
+    const size_t BytesPerPixel = AssetPack_BytesPerPixel(pPacked->Format);
+    static uint16_t Line[kMaxWidth_px * 2];
+
+    for (size_t y = 0; y < pImg->header.h; y++)
+    {
+        const uint8_t *const pRow = &pImg->data[y * Width * BytesPerPixel];
+        for (size_t x = 0; x < Width; x += (x < 3) ? 1 : 7)
+        {
+            const size_t Length = (x == 0) ? Width : (Width - x + 1) / 2;
+            AssetPack_DecodeRow(pPacked, (uint32_t)y, (uint32_t)x, (uint32_t)Length, (uint8_t*)Line);
+            if (memcmp(Line, &pRow[x * BytesPerPixel], Length * BytesPerPixel) != 0)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static uint64_t TimeDecode(const AssetPack_Image_t *const pPacked)
+{
+    static uint16_t Line[kMaxWidth_px * 2];
+
+    const uint64_t Start_ns = Now_ns();
+    for (unsigned n = 0; n < Config.Iterations; n++)
+    {
+        for (uint32_t y = 0; y < pPacked->Height; y++)
+        {
+            AssetPack_DecodeRow(pPacked, y, 0, pPacked->Width, (uint8_t*)Line);
+        }
+        __asm__ volatile("" : : "r"(Line) : "memory");
+    }
+
+    return (Now_ns() - Start_ns) / Config.Iterations;
+}
+
+static uint64_t TimeCopy(const lv_img_dsc_t *const pImg)
+{
+    static uint16_t Line[kMaxWidth_px * 2];
+    const size_t RowSize = pImg->header.w * AssetPack_BytesPerPixel((uint8_t)pImg->header.cf);
+
+    const uint64_t Start_ns = Now_ns();
+    for (unsigned n = 0; n < Config.Iterations; n++)
+    {
+        for (size_t y = 0; y < pImg->header.h; y++)
+        {
+            memcpy(Line, &pImg->data[y * RowSize], RowSize);
+            __asm__ volatile("" : : "r"(Line) : "memory");
+        }
+    }
+
+    return (Now_ns() - Start_ns) / Config.Iterations;
+}
+
+static const char* CfName(const uint8_t Format)
+{
+    switch (Format)
+    {
+        case kAssetPack_Format_TrueColorAlpha:       return "LV_IMG_CF_TRUE_COLOR_ALPHA";
+        case kAssetPack_Format_TrueColorChromaKeyed: return "LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED";
+        default:                                     return "LV_IMG_CF_TRUE_COLOR";
+    }
+}
+
+static bool WriteC(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "w");
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    fprintf(pFile,
+            "// Generated by tools/asset_pack from the images in this component, do not edit. Built instead of the\n"
+            "// individual image files when CHROMATIC_OSD_ASSET_PACK is enabled.\n"
+            "\n"
+            "#ifdef __has_include\n"
+            "    #if __has_include(\"lvgl.h\")\n"
+            "        #ifndef LV_LVGL_H_INCLUDE_SIMPLE\n"
+            "            #define LV_LVGL_H_INCLUDE_SIMPLE\n"
+            "        #endif\n"
+            "    #endif\n"
+            "#endif\n"
+            "\n"
+            "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)\n"
+            "    #include \"lvgl.h\"\n"
+            "#else\n"
+            "    #include \"lvgl/lvgl.h\"\n"
+            "#endif\n"
+            "\n"
+            "#if LV_COLOR_DEPTH != 16 || LV_COLOR_16_SWAP != 0\n"
+            "#error \"The asset pack holds RGB565 pixels, rebuild it for this color format\"\n"
+            "#endif\n"
+            "\n"
+            "// Words so that every entry is 4-byte aligned\n"
+            "static const LV_ATTRIBUTE_LARGE_CONST uint32_t AssetPack[] = {\n");
+
+    for (size_t w = 0; w < PackSize / sizeof(uint32_t); w++)
+    {
+        fprintf(pFile, "%s0x%08X,%s", (w % kWordsPerLine == 0) ? "  " : " ", PackWords[w],
+                ((w + 1) % kWordsPerLine == 0) ? "\n" : "");
+    }
+    fprintf(pFile, "%s};\n", ((PackSize / sizeof(uint32_t)) % kWordsPerLine != 0) ? "\n" : "");
+
+    for (size_t i = 0; i < NUM_IMAGES; i++)
+    {
+        const AssetPack_Image_t *const pPacked = (const AssetPack_Image_t*)&pPack[EntryOffsets[i]];
+        const bool IsRLE = (pPacked->Encoding == kAssetPack_Encoding_PaletteRLE);
+
+        // Images that didn't shrink point LVGL straight at their pixels
+        const size_t Offset = EntryOffsets[i] + (IsRLE ? 0 : sizeof(*pPacked));
+        const size_t Size = IsRLE ? (sizeof(*pPacked) + pPacked->DataSize) : pPacked->DataSize;
+
+        fprintf(pFile,
+                "\n"
+                "const lv_img_dsc_t %s = {\n"
+                "  .header.cf = %s,\n"
+                "  .header.always_zero = 0,\n"
+                "  .header.reserved = 0,\n"
+                "  .header.w = %u,\n"
+                "  .header.h = %u,\n"
+                "  .data_size = %zu,\n"
+                "  .data = (const uint8_t*)&AssetPack[%zu],\n"
+                "};\n",
+                Images[i].pName, IsRLE ? "LV_IMG_CF_USER_ENCODED_0" : CfName(pPacked->Format), pPacked->Width,
+                pPacked->Height, Size, Offset / sizeof(uint32_t));
+    }
+
+    return fclose(pFile) == 0;
+}
+
+static size_t FontRLESize(const lv_font_fmt_txt_dsc_t *const pDsc, const size_t NumGlyphs, size_t *const pBitmapSize)
+{
+    static uint8_t Code[4096];
+    size_t Size = 0;
+    *pBitmapSize = 0;
+
+    // Glyph 0 is reserved, the glyphs are coded one by one since they are drawn one by one
+    for (size_t g = 1; g < NumGlyphs; g++)
+    {
+        const lv_font_fmt_txt_glyph_dsc_t *const pGlyph = &pDsc->glyph_dsc[g];
+        const size_t GlyphSize = ((size_t)pGlyph->box_w * pGlyph->box_h * pDsc->bpp + 7) / 8;
+        if (GlyphSize <= sizeof(Code) / 2)
+        {
+            Size += EncodeRow(&pDsc->glyph_bitmap[pGlyph->bitmap_index], GlyphSize, Code);
+        }
+        *pBitmapSize += GlyphSize;
+    }
+
+    return Size;
+}
+
+static size_t CountGlyphs(const lv_font_fmt_txt_dsc_t *const pDsc)
+{
+    size_t NumGlyphs = 1;
+    for (size_t c = 0; c < pDsc->cmap_num; c++)
+    {
+        const lv_font_fmt_txt_cmap_t *const pCmap = &pDsc->cmaps[c];
+        const bool IsSparse = (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) || (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL);
+        const size_t NumCodes = IsSparse ? pCmap->list_length : pCmap->range_length;
+
+        for (size_t i = 0; i < NumCodes; i++)
+        {
+            size_t Id = pCmap->glyph_id_start + i;
+            if (pCmap->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL)
+            {
+                Id = pCmap->glyph_id_start + ((const uint8_t*)pCmap->glyph_id_ofs_list)[i];
+            }
+            else if (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL)
+            {
+                Id = pCmap->glyph_id_start + ((const uint16_t*)pCmap->glyph_id_ofs_list)[i];
+            }
+            NumGlyphs = (Id + 1 > NumGlyphs) ? (Id + 1) : NumGlyphs;
+        }
+    }
+
+    return NumGlyphs;
+}
+
+static size_t CmapListSize(const lv_font_fmt_txt_cmap_t *const pCmap, const void *const pList, const size_t ItemSize)
+{
+    const bool IsSparse = (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) || (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL);
+    return (pList != NULL) ? ((IsSparse ? pCmap->list_length : pCmap->range_length) * ItemSize) : 0;
+}
+
+// Returns the entry's size, or 0 if the font can't be stored or doesn't fit
+static size_t AddFont(const lv_font_t *const pFont, uint8_t *const pEntry, const size_t Space)
+{
+    const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+    if ((pDsc->kern_dsc != NULL) || (pDsc->bitmap_format != 0))
+    {
+        return 0;
+    }
+
+    const size_t NumGlyphs = CountGlyphs(pDsc);
+    size_t BitmapSize = 0;
+    for (size_t g = 1; g < NumGlyphs; g++)
+    {
+        const lv_font_fmt_txt_glyph_dsc_t *const pGlyph = &pDsc->glyph_dsc[g];
+        const size_t End = pGlyph->bitmap_index + ((size_t)pGlyph->box_w * pGlyph->box_h * pDsc->bpp + 7) / 8;
+        BitmapSize = (End > BitmapSize) ? End : BitmapSize;
+    }
+
+    // The cmaps' lists go after the bitmaps, each on its own 4-byte boundary
+    const size_t GlyphsOffset = sizeof(AssetStore_Font_t) + pDsc->cmap_num * sizeof(AssetStore_Cmap_t);
+    const size_t BitmapOffset = GlyphsOffset + NumGlyphs * 8;
+    size_t Size = AlignUp(BitmapOffset + BitmapSize);
+    for (size_t c = 0; c < pDsc->cmap_num; c++)
+    {
+        Size += AlignUp(CmapListSize(&pDsc->cmaps[c], pDsc->cmaps[c].unicode_list, sizeof(uint16_t)));
+        Size += AlignUp(CmapListSize(&pDsc->cmaps[c], pDsc->cmaps[c].glyph_id_ofs_list,
+                                     (pDsc->cmaps[c].type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) ? sizeof(uint16_t) : sizeof(uint8_t)));
+    }
+
+    if (Size > Space)
+    {
+        return 0;
+    }
+
+    const AssetStore_Font_t Header = {
+        .LineHeight = pFont->line_height,
+        .BaseLine = pFont->base_line,
+        .UnderlinePosition = pFont->underline_position,
+        .UnderlineThickness = pFont->underline_thickness,
+        .Subpx = pFont->subpx,
+        .Bpp = (uint8_t)pDsc->bpp,
+        .NumGlyphs = (uint16_t)NumGlyphs,
+        .NumCmaps = (uint16_t)pDsc->cmap_num,
+        .BitmapSize = (uint32_t)BitmapSize,
+    };
+    memcpy(pEntry, &Header, sizeof(Header));
+
+    size_t ListOffset = AlignUp(BitmapOffset + BitmapSize);
+    for (size_t c = 0; c < pDsc->cmap_num; c++)
+    {
+        const lv_font_fmt_txt_cmap_t *const pCmap = &pDsc->cmaps[c];
+        const size_t UnicodeSize = CmapListSize(pCmap, pCmap->unicode_list, sizeof(uint16_t));
+        const size_t OfsSize = CmapListSize(pCmap, pCmap->glyph_id_ofs_list,
+                                            (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) ? sizeof(uint16_t) : sizeof(uint8_t));
+
+        const AssetStore_Cmap_t Cmap = {
+            .RangeStart = pCmap->range_start,
+            .RangeLength = pCmap->range_length,
+            .GlyphIdStart = pCmap->glyph_id_start,
+            .UnicodeListOffset = (UnicodeSize > 0) ? (uint32_t)ListOffset : 0,
+            .GlyphIdOfsListOffset = (OfsSize > 0) ? (uint32_t)(ListOffset + AlignUp(UnicodeSize)) : 0,
+            .ListLength = pCmap->list_length,
+            .Type = (uint8_t)pCmap->type,
+        };
+        memcpy(&pEntry[sizeof(Header) + c * sizeof(Cmap)], &Cmap, sizeof(Cmap));
+
+        memcpy(&pEntry[ListOffset], pCmap->unicode_list, UnicodeSize);
+        ListOffset += AlignUp(UnicodeSize);
+        memcpy(&pEntry[ListOffset], pCmap->glyph_id_ofs_list, OfsSize);
+        ListOffset += AlignUp(OfsSize);
+    }
+
+    // Laid out as LVGL's glyph descriptor is on a little endian target, bitmap_index in the low 20 bits
+    for (size_t g = 0; g < NumGlyphs; g++)
+    {
+        const lv_font_fmt_txt_glyph_dsc_t *const pGlyph = &pDsc->glyph_dsc[g];
+        const uint32_t Packed = (uint32_t)pGlyph->bitmap_index | ((uint32_t)pGlyph->adv_w << 20);
+        uint8_t *const p = &pEntry[GlyphsOffset + g * 8];
+        memcpy(p, &Packed, sizeof(Packed));
+        p[4] = pGlyph->box_w;
+        p[5] = pGlyph->box_h;
+        p[6] = (uint8_t)pGlyph->ofs_x;
+        p[7] = (uint8_t)pGlyph->ofs_y;
+    }
+
+    memcpy(&pEntry[BitmapOffset], pDsc->glyph_bitmap, BitmapSize);
+    return Size;
+}
+
+// Images first and then fonts, each under the name of the symbol it replaces
+static size_t BuildStore(void)
+{
+    const size_t NumEntries = NUM_IMAGES + sizeof(Fonts) / sizeof(Fonts[0]);
+    AssetStore_Header_t *const pHeader = (AssetStore_Header_t*)pStore;
+    AssetStore_Entry_t *const pDir = (AssetStore_Entry_t*)(pHeader + 1);
+    size_t Size = AlignUp(sizeof(*pHeader) + NumEntries * sizeof(*pDir));
+
+    memset(pStore, 0, sizeof(StoreWords));
+    for (size_t e = 0; e < NumEntries; e++)
+    {
+        const bool IsImage = (e < NUM_IMAGES);
+        const char *const pName = IsImage ? Images[e].pName : Fonts[e - NUM_IMAGES].pName;
+        size_t EntrySize = 0;
+
+        if (IsImage && (Size + EntrySizes[e] <= sizeof(StoreWords)))
+        {
+            memcpy(&pStore[Size], &pPack[EntryOffsets[e]], EntrySizes[e]);
+            EntrySize = EntrySizes[e];
+        }
+        else if (!IsImage)
+        {
+            EntrySize = AddFont(Fonts[e - NUM_IMAGES].pFont, &pStore[Size], sizeof(StoreWords) - Size);
+        }
+
+        if ((EntrySize == 0) || (strlen(pName) >= sizeof(pDir[e].Name)))
+        {
+            fprintf(stderr, "%s can't be added to the asset store\n", pName);
+            return 0;
+        }
+
+        strcpy(pDir[e].Name, pName);
+        pDir[e].Type = IsImage ? kAssetStore_Type_Image : kAssetStore_Type_Font;
+        pDir[e].Offset = (uint32_t)Size;
+        pDir[e].Size = (uint32_t)EntrySize;
+        Size += EntrySize;
+    }
+
+    pHeader->Magic = kAssetStoreConsts_Magic;
+    pHeader->Version = kAssetStoreConsts_Version;
+    pHeader->NumEntries = (uint16_t)NumEntries;
+    pHeader->Size = (uint32_t)Size;
+    pHeader->Checksum = AssetStore_Checksum(pHeader + 1, Size - sizeof(*pHeader));
+    return Size;
+}
+
+// Maps the written file through the firmware's loader and compares what it resolves with the linked assets
+static unsigned CheckStore(const char *const pPath)
+{
+    const uint64_t Start_ns = Now_ns();
+    if (!AssetStore_Map(pPath))
+    {
+        printf("%s: the asset store doesn't load\n", pPath);
+        return 1;
+    }
+    const uint64_t Open_ns = Now_ns() - Start_ns;
+
+    unsigned NumFailures = 0;
+    for (size_t i = 0; i < NUM_IMAGES; i++)
+    {
+        const lv_img_dsc_t *const pImg = Images[i].pImg;
+        const lv_img_dsc_t *const pLoaded = AssetStore_GetImage(Images[i].pName);
+        const bool IsPacked = (pLoaded->header.cf == LV_IMG_CF_USER_ENCODED_0);
+        const bool IsSame = (pLoaded->header.w == pImg->header.w) && (pLoaded->header.h == pImg->header.h) &&
+            (IsPacked ? Verify(pImg, (const AssetPack_Image_t*)pLoaded->data, pLoaded->data_size)
+                      : ((pLoaded->header.cf == pImg->header.cf) && (pLoaded->data_size == pImg->data_size) &&
+                         (memcmp(pLoaded->data, pImg->data, pImg->data_size) == 0)));
+        if (!IsSame)
+        {
+            printf("%s: differs in the asset store\n", Images[i].pName);
+            NumFailures++;
+        }
+    }
+
+    for (size_t f = 0; f < sizeof(Fonts) / sizeof(Fonts[0]); f++)
+    {
+        const lv_font_t *const pFont = Fonts[f].pFont;
+        const lv_font_t *const pLoaded = AssetStore_GetFont(Fonts[f].pName);
+        const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+        const lv_font_fmt_txt_dsc_t *const pLoadedDsc = (pLoaded != NULL) ? (const lv_font_fmt_txt_dsc_t*)pLoaded->dsc : NULL;
+
+        bool IsSame = (pLoadedDsc != NULL) && (pLoaded->line_height == pFont->line_height) &&
+                      (pLoaded->base_line == pFont->base_line) && (pLoadedDsc->bpp == pDsc->bpp) &&
+                      (pLoadedDsc->cmap_num == pDsc->cmap_num);
+        for (size_t c = 0; IsSame && (c < pDsc->cmap_num); c++)
+        {
+            IsSame = (pLoadedDsc->cmaps[c].range_start == pDsc->cmaps[c].range_start) &&
+                     (pLoadedDsc->cmaps[c].range_length == pDsc->cmaps[c].range_length) &&
+                     (pLoadedDsc->cmaps[c].glyph_id_start == pDsc->cmaps[c].glyph_id_start) &&
+                     (pLoadedDsc->cmaps[c].type == pDsc->cmaps[c].type);
+        }
+
+        const size_t NumGlyphs = CountGlyphs(pDsc);
+        for (size_t g = 1; IsSame && (g < NumGlyphs); g++)
+        {
+            const lv_font_fmt_txt_glyph_dsc_t *const pGlyph = &pDsc->glyph_dsc[g];
+            const lv_font_fmt_txt_glyph_dsc_t *const pLoadedGlyph = &pLoadedDsc->glyph_dsc[g];
+            const size_t GlyphSize = ((size_t)pGlyph->box_w * pGlyph->box_h * pDsc->bpp + 7) / 8;
+            IsSame = (pLoadedGlyph->bitmap_index == pGlyph->bitmap_index) && (pLoadedGlyph->adv_w == pGlyph->adv_w) &&
+                     (pLoadedGlyph->box_w == pGlyph->box_w) && (pLoadedGlyph->box_h == pGlyph->box_h) &&
+                     (pLoadedGlyph->ofs_x == pGlyph->ofs_x) && (pLoadedGlyph->ofs_y == pGlyph->ofs_y) &&
+                     (memcmp(&pLoadedDsc->glyph_bitmap[pGlyph->bitmap_index], &pDsc->glyph_bitmap[pGlyph->bitmap_index], GlyphSize) == 0);
+        }
+
+        if (!IsSame)
+        {
+            printf("%s: differs in the asset store\n", Fonts[f].pName);
+            NumFailures++;
+        }
+    }
+
+    printf("Asset store: %zu entries mapped, checked and resolved in %lu us\n", AssetStore_GetNumEntries(),
+           (unsigned long)(Open_ns / 1000));
+    AssetStore_Close();
+    return NumFailures;
+}
+
+static bool WriteBin(const char *pPath, const size_t Size)
+{
+    FILE *pFile = fopen(pPath, "wb");
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    const bool IsWritten = (fwrite(pStore, 1, Size, pFile) == Size);
+    return (fclose(pFile) == 0) && IsWritten;
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --out-c FILE    Write the pack as C source for components/images\n"
+            "  --out-bin FILE  Write the images and fonts as an asset store for the assets partition\n"
+            "  --iterations N  Decodes per image for the timings (default %u)\n",
+            pName, Config.Iterations);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "out-c",      required_argument, NULL, 'c' },
+        { "out-bin",    required_argument, NULL, 'b' },
+        { "iterations", required_argument, NULL, 'i' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'c': Config.pOutC = optarg; break;
+            case 'b': Config.pOutBin = optarg; break;
+            case 'i': Config.Iterations = (unsigned)strtoul(optarg, NULL, 10); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    Config.Iterations = (Config.Iterations == 0) ? 1 : Config.Iterations;
+
+    unsigned NumFailures = 0;
+    size_t TotalRaw = 0;
+    size_t TotalPacked = 0;
+
+    printf("%-22s %-6s %7s %6s %7s %7s %9s %9s %7s\n", "Image", "Coding", "Size", "Colors", "Flash", "Packed", "Decode",
+           "Copy", "ns/px");
+    for (size_t i = 0; i < NUM_IMAGES; i++)
+    {
+        const lv_img_dsc_t *const pImg = Images[i].pImg;
+        EntryOffsets[i] = PackSize;
+
+        const size_t EntrySize = AddImage(pImg, &pPack[PackSize], sizeof(PackWords) - PackSize);
+        if (EntrySize == 0)
+        {
+            fprintf(stderr, "The pack is full at %s\n", Images[i].pName);
+            return 1;
+        }
+        EntrySizes[i] = EntrySize;
+        PackSize += EntrySize;
+
+        const AssetPack_Image_t *const pPacked = (const AssetPack_Image_t*)&pPack[EntryOffsets[i]];
+        if (!Verify(pImg, pPacked, EntrySize))
+        {
+            printf("%s: decodes to different pixels\n", Images[i].pName);
+            NumFailures++;
+        }
+
+        const bool IsRLE = (pPacked->Encoding == kAssetPack_Encoding_PaletteRLE);
+        const uint64_t Decode_ns = TimeDecode(pPacked);
+        const uint64_t Copy_ns = TimeCopy(pImg);
+        const size_t NumPixels = (size_t)pImg->header.w * pImg->header.h;
+        TotalRaw += pImg->data_size;
+        TotalPacked += EntrySize;
+
+        char Size[16];
+        snprintf(Size, sizeof(Size), "%ux%u", pImg->header.w, pImg->header.h);
+        printf("%-22s %-6s %7s %6u %7lu %7zu %6lu ns %6lu ns %7.2f\n", Images[i].pName, IsRLE ? "RLE" : "raw", Size,
+               pPacked->NumColors, (unsigned long)pImg->data_size, EntrySize, (unsigned long)Decode_ns,
+               (unsigned long)Copy_ns, (double)Decode_ns / (double)NumPixels);
+    }
+
+    printf("Images: %zu bytes as linked, %zu packed, %zu saved (%zu%%)\n", TotalRaw, TotalPacked, TotalRaw - TotalPacked,
+           (TotalRaw > 0) ? ((TotalRaw - TotalPacked) * 100) / TotalRaw : 0);
+
+    for (size_t f = 0; f < sizeof(Fonts) / sizeof(Fonts[0]); f++)
+    {
+        const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)Fonts[f].pFont->dsc;
+        const size_t NumGlyphs = CountGlyphs(pDsc);
+
+        size_t BitmapSize;
+        const size_t RLESize = FontRLESize(pDsc, NumGlyphs, &BitmapSize);
+        printf("Font %-12s %u bpp, %zu glyphs, %zu bitmap bytes, %zu run-length coded (%+ld)\n", Fonts[f].pName,
+               pDsc->bpp, NumGlyphs - 1, BitmapSize, RLESize, (long)RLESize - (long)BitmapSize);
+    }
+
+    if ((Config.pOutC != NULL) && (NumFailures == 0))
+    {
+        if (!WriteC(Config.pOutC))
+        {
+            fprintf(stderr, "Writing %s failed\n", Config.pOutC);
+            return 1;
+        }
+        printf("Wrote %zu bytes of pack to %s\n", PackSize, Config.pOutC);
+    }
+
+    if ((Config.pOutBin != NULL) && (NumFailures == 0))
+    {
+        const size_t StoreSize = BuildStore();
+        if ((StoreSize == 0) || !WriteBin(Config.pOutBin, StoreSize))
+        {
+            fprintf(stderr, "Writing %s failed\n", Config.pOutBin);
+            return 1;
+        }
+        printf("Wrote %zu bytes of asset store to %s\n", StoreSize, Config.pOutBin);
+        NumFailures += CheckStore(Config.pOutBin);
+    }
+
+    printf("%s\n", (NumFailures == 0) ? "PASS" : "FAIL");
+    return (NumFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,447 @@
+// Host-side check and benchmark for the dual-core OSD band rendering.
+//
+// Runs main/band_render.c with a thread standing in for the helper task on core 0 and a blend kernel standing in for
+// LVGL's: solid fills, masked fills the way text and rounded corners are drawn, and image copies, all with opacity,
+// into a 160x144 RGB565 buffer. Every tab's scene is rendered once on one thread and once split across two, and the
+// two frames must match bit for bit. A randomized pass then throws blends of every size at the splitter, down to
+// single rows, and compares again.
+//
+// The scenes are stand-ins shaped after the OSD tabs (a full-screen background, the tab header, rows of icons and
+// text, a selection highlight, the palette swatches), so the timings show how the split scales rather than what the
+// device does. `osd_bench` on the device times the real tabs. Thread wake-ups cost more on a desktop OS than between
+// the ESP32 cores, so --min-pixels may need raising to see a speedup here.
+//
+// Build and run from this directory with:
+//   gcc -O2 -pthread -I../../main band_bench.c ../../main/band_render.c -o band_bench
+//   ./band_bench --frames 200 --random 20000
+//
+// The exit code is non-zero if any frame rendered on two threads differs from the one rendered on one.
+
+#include "band_render.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    kWidth_px  = 160,
+    kHeight_px = 144,
+    kNumPixels = kWidth_px * kHeight_px,
+    kMaxOps    = 512,
+    kNumTabs   = 5,
+    kChromaKey = 0xF81F,    // 0xFF00FF in RGB565
+};
+
+typedef enum {
+    kOp_Fill,
+    kOp_MaskFill,
+    kOp_Copy,
+} OpType_t;
+
+typedef struct Op {
+    OpType_t eType;
+    int32_t x1, y1, x2, y2;
+    uint16_t Color;
+    uint8_t Opa;
+    const uint8_t *pMask;       // One byte per pixel of the area, for kOp_MaskFill
+    const uint16_t *pSrc;       // One pixel per pixel of the area, for kOp_Copy
+} Op_t;
+
+typedef struct Scene {
+    const char *pName;
+    Op_t Ops[kMaxOps];
+    size_t NumOps;
+} Scene_t;
+
+typedef struct Job {
+    uint16_t *pBuf;
+    const Op_t *pOp;
+} Job_t;
+
+typedef struct Helper {
+    sem_t Kick;
+    sem_t Done;
+    pthread_t Thread;
+    BandRender_t *pBands;
+    volatile bool IsQuit;
+} Helper_t;
+
+static struct {
+    unsigned Frames;
+    unsigned Random;
+    uint32_t MinPixels;
+    uint32_t Seed;
+} Config = {
+    .Frames = 200,
+    .Random = 20000,
+    .MinPixels = kBandRenderConsts_MinPixels,
+    .Seed = 1,
+};
+
+// Images and masks the ops point into, filled from the seed
+static uint16_t Pixels[kNumPixels];
+static uint8_t Masks[kNumPixels];
+static uint32_t Rng;
+
+static uint32_t Random(void)
+{
+    // xorshift32, the same sequence on every run for a given seed
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+static int32_t RandomIn(const int32_t Min, const int32_t Max)
+{
+    return Min + (int32_t)(Random() % (uint32_t)(Max - Min + 1));
+}
+
+static uint64_t Now_ns(void)
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return (uint64_t)Ts.tv_sec * 1000000000ull + (uint64_t)Ts.tv_nsec;
+}
+
+// RGB565 per channel, rounded the way LVGL's LV_UDIV255 does
+static uint16_t Mix(const uint16_t Fg, const uint16_t Bg, const uint8_t Opa)
+{
+    if (Opa == 255)
+    {
+        return Fg;
+    }
+
+    const uint32_t R = (((Fg >> 11) & 0x1F) * Opa + ((Bg >> 11) & 0x1F) * (255 - Opa)) * 0x8081u >> 23;
+    const uint32_t G = (((Fg >> 5) & 0x3F) * Opa + ((Bg >> 5) & 0x3F) * (255 - Opa)) * 0x8081u >> 23;
+    const uint32_t B = ((Fg & 0x1F) * Opa + (Bg & 0x1F) * (255 - Opa)) * 0x8081u >> 23;
+    return (uint16_t)((R << 11) | (G << 5) | B);
+}
+
+// Stands in for the blend LVGL runs on either core, writes the rows of the op's area that fall in y1..y2 and nothing
+// else
+static void BlendRows(void *pArg, const int32_t y1, const int32_t y2)
+{
+    const Job_t *const pJob = (const Job_t*)pArg;
+    const Op_t *const pOp = pJob->pOp;
+    const int32_t Width = pOp->x2 - pOp->x1 + 1;
+    const int32_t First = (y1 > pOp->y1) ? y1 : pOp->y1;
+    const int32_t Last = (y2 < pOp->y2) ? y2 : pOp->y2;
+
+    for (int32_t y = First; y <= Last; y++)
+    {
+        uint16_t *const pRow = &pJob->pBuf[y * kWidth_px + pOp->x1];
+        const size_t Offset = (size_t)(y - pOp->y1) * (size_t)Width;
+
+        for (int32_t x = 0; x < Width; x++)
+        {
+            switch (pOp->eType)
+            {
+                case kOp_Fill:
+                    pRow[x] = Mix(pOp->Color, pRow[x], pOp->Opa);
+                    break;
+
+                case kOp_MaskFill:
+                    pRow[x] = Mix(pOp->Color, pRow[x], (uint8_t)((pOp->pMask[Offset + x] * pOp->Opa) >> 8));
+                    break;
+
+                case kOp_Copy:
+                    pRow[x] = Mix(pOp->pSrc[Offset + x], pRow[x], pOp->Opa);
+                    break;
+            }
+        }
+    }
+}
+
+static void Render(BandRender_t *const pBands, uint16_t *const pBuf, const Scene_t *const pScene)
+{
+    for (size_t i = 0; i < pScene->NumOps; i++)
+    {
+        Job_t Job = {
+            .pBuf = pBuf,
+            .pOp = &pScene->Ops[i],
+        };
+        BandRender_Run(pBands, BlendRows, &Job, Job.pOp->y1, Job.pOp->y2, Job.pOp->x2 - Job.pOp->x1 + 1);
+    }
+}
+
+static void KickHelper(void *pCtx)
+{
+    (void) sem_post(&((Helper_t*)pCtx)->Kick);
+}
+
+static void WaitHelper(void *pCtx)
+{
+    while (sem_wait(&((Helper_t*)pCtx)->Done) != 0)
+    {
+    }
+}
+
+static void *HelperThread(void *pArg)
+{
+    Helper_t *const pHelper = (Helper_t*)pArg;
+
+    while (1)
+    {
+        while (sem_wait(&pHelper->Kick) != 0)
+        {
+        }
+
+        if (pHelper->IsQuit)
+        {
+            return NULL;
+        }
+
+        BandRender_RunHelper(pHelper->pBands);
+        (void) sem_post(&pHelper->Done);
+    }
+}
+
+static void AddOp(Scene_t *const pScene, const OpType_t eType, const int32_t x, const int32_t y, const int32_t w, const int32_t h,
+                  const uint16_t Color, const uint8_t Opa)
+{
+    if (pScene->NumOps >= kMaxOps)
+    {
+        return;
+    }
+
+    // Clipped to the screen like LVGL's clip area would
+    Op_t *const pOp = &pScene->Ops[pScene->NumOps];
+    pOp->eType = eType;
+    pOp->x1 = (x < 0) ? 0 : x;
+    pOp->y1 = (y < 0) ? 0 : y;
+    pOp->x2 = (x + w - 1 >= kWidth_px) ? (kWidth_px - 1) : (x + w - 1);
+    pOp->y2 = (y + h - 1 >= kHeight_px) ? (kHeight_px - 1) : (y + h - 1);
+    pOp->Color = Color;
+    pOp->Opa = Opa;
+
+    if ((pOp->x1 > pOp->x2) || (pOp->y1 > pOp->y2))
+    {
+        return;
+    }
+
+    // Any window into the shared images will do as long as it's big enough
+    const size_t Size = (size_t)(pOp->x2 - pOp->x1 + 1) * (size_t)(pOp->y2 - pOp->y1 + 1);
+    const size_t Start = (Size < kNumPixels) ? (Random() % (kNumPixels - Size + 1)) : 0;
+    pOp->pMask = &Masks[Start];
+    pOp->pSrc = &Pixels[Start];
+    pScene->NumOps++;
+}
+
+// A line of text, one masked fill per glyph
+static void AddText(Scene_t *const pScene, const int32_t x, const int32_t y, const int32_t NumGlyphs)
+{
+    for (int32_t g = 0; g < NumGlyphs; g++)
+    {
+        AddOp(pScene, kOp_MaskFill, x + g * 7, y, 7, 11, 0xFFFF, 255);
+    }
+}
+
+static void BuildTab(Scene_t *const pScene, const char *pName, const int32_t NumItems, const bool HasIcons, const int32_t NumSwatches)
+{
+    pScene->pName = pName;
+    pScene->NumOps = 0;
+
+    AddOp(pScene, kOp_Fill, 0, 0, kWidth_px, kHeight_px, kChromaKey, 255);  // Background
+    AddOp(pScene, kOp_Copy, 8, 7, 144, 22, 0, 255);                         // Tab header
+    AddOp(pScene, kOp_Fill, 8, 30, 144, 106, 0x0000, 200);                  // Translucent menu body
+
+    for (int32_t i = 0; i < NumItems; i++)
+    {
+        const int32_t y = 34 + i * 16;
+        if (HasIcons)
+        {
+            AddOp(pScene, kOp_Copy, 12, y, 16, 14, 0, 255);
+        }
+
+        AddText(pScene, HasIcons ? 32 : 14, y + 2, 10 + (int32_t)(Random() % 6));
+        AddOp(pScene, kOp_Copy, 128, y + 2, 20, 10, 0, 255);                // Toggle or value
+    }
+
+    AddOp(pScene, kOp_MaskFill, 10, 33, 140, 16, 0x07E0, 128);              // Selection with rounded corners
+
+    for (int32_t s = 0; s < NumSwatches; s++)
+    {
+        AddOp(pScene, kOp_Fill, 14 + (s % 4) * 34, 80 + (s / 4) * 14, 30, 12, (uint16_t)Random(), 255);
+    }
+}
+
+static void BuildRandom(Scene_t *const pScene, const size_t NumOps)
+{
+    pScene->pName = "Random";
+    pScene->NumOps = 0;
+
+    while (pScene->NumOps < NumOps)
+    {
+        const int32_t x = RandomIn(0, kWidth_px - 1);
+        const int32_t y = RandomIn(0, kHeight_px - 1);
+        const int32_t w = RandomIn(1, kWidth_px - x);
+        const int32_t h = ((Random() % 4) == 0) ? 1 : RandomIn(1, kHeight_px - y);
+        AddOp(pScene, (OpType_t)(Random() % 3), x, y, w, h, (uint16_t)Random(), (uint8_t)RandomIn(1, 255));
+    }
+}
+
+static double TimeScene(BandRender_t *const pBands, uint16_t *const pBuf, const Scene_t *const pScene)
+{
+    const uint64_t Start_ns = Now_ns();
+    for (unsigned f = 0; f < Config.Frames; f++)
+    {
+        Render(pBands, pBuf, pScene);
+    }
+
+    return (double)(Now_ns() - Start_ns) / 1000.0 / (double)Config.Frames;
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --frames N      Renders per tab and mode for the timings (default %u)\n"
+            "  --random N      Random blends to check the split on (default %u)\n"
+            "  --min-pixels N  Smallest blend that gets split (default %u)\n"
+            "  --seed N        Seed for the images, masks and random blends (default %u)\n",
+            pName, Config.Frames, Config.Random, Config.MinPixels, Config.Seed);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "frames",     required_argument, NULL, 'f' },
+        { "random",     required_argument, NULL, 'r' },
+        { "min-pixels", required_argument, NULL, 'm' },
+        { "seed",       required_argument, NULL, 'S' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'f': Config.Frames = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'r': Config.Random = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'm': Config.MinPixels = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'S': Config.Seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    Config.Frames = (Config.Frames == 0) ? 1 : Config.Frames;
+    Rng = (Config.Seed == 0) ? 1 : Config.Seed;
+
+    for (size_t i = 0; i < kNumPixels; i++)
+    {
+        Pixels[i] = (uint16_t)Random();
+        Masks[i] = (uint8_t)Random();
+    }
+
+    static BandRender_t Single;
+    static BandRender_t Dual;
+    static Helper_t Helper;
+
+    BandRender_Init(&Single, NULL);
+    Single.MinPixels = Config.MinPixels;
+
+    const BandRender_Sync_t Sync = {
+        .fnKick = KickHelper,
+        .fnWait = WaitHelper,
+        .pCtx = &Helper,
+    };
+    BandRender_Init(&Dual, &Sync);
+    Dual.MinPixels = Config.MinPixels;
+
+    Helper.pBands = &Dual;
+    if ((sem_init(&Helper.Kick, 0, 0) != 0) || (sem_init(&Helper.Done, 0, 0) != 0) ||
+        (pthread_create(&Helper.Thread, NULL, HelperThread, &Helper) != 0))
+    {
+        fprintf(stderr, "Starting the helper thread failed\n");
+        return 1;
+    }
+
+    static Scene_t Scenes[kNumTabs];
+    BuildTab(&Scenes[0], "Status", 4, true, 0);
+    BuildTab(&Scenes[1], "Display", 6, true, 0);
+    BuildTab(&Scenes[2], "Controls", 6, false, 0);
+    BuildTab(&Scenes[3], "Palette", 2, false, 12);
+    BuildTab(&Scenes[4], "System", 5, true, 0);
+
+    static uint16_t FrameSingle[kNumPixels];
+    static uint16_t FrameDual[kNumPixels];
+    unsigned NumMismatches = 0;
+
+    printf("%-10s %6s %10s %10s %8s %7s\n", "Tab", "Blends", "1 thread", "2 threads", "Speedup", "Split");
+    for (size_t t = 0; t < kNumTabs; t++)
+    {
+        const Scene_t *const pScene = &Scenes[t];
+        const uint32_t SplitBefore = Dual.Stats.NumSplit;
+        const uint32_t JobsBefore = Dual.Stats.NumJobs;
+
+        memset(FrameSingle, 0, sizeof(FrameSingle));
+        memset(FrameDual, 0, sizeof(FrameDual));
+        Render(&Single, FrameSingle, pScene);
+        Render(&Dual, FrameDual, pScene);
+        if (memcmp(FrameSingle, FrameDual, sizeof(FrameSingle)) != 0)
+        {
+            printf("%s: two threads rendered a different frame\n", pScene->pName);
+            NumMismatches++;
+        }
+
+        const uint32_t NumSplit = Dual.Stats.NumSplit - SplitBefore;
+        const uint32_t NumJobs = Dual.Stats.NumJobs - JobsBefore;
+        const double Single_us = TimeScene(&Single, FrameSingle, pScene);
+        const double Dual_us = TimeScene(&Dual, FrameDual, pScene);
+
+        printf("%-10s %6zu %7.1f us %7.1f us %7.2fx %3u/%-3u\n", pScene->pName, pScene->NumOps, Single_us, Dual_us,
+               Single_us / Dual_us, NumSplit, NumJobs);
+    }
+
+    // Random blends in batches the size of a scene, each batch on top of the last one's frame
+    static Scene_t Random;
+    unsigned NumRandom = 0;
+    memset(FrameSingle, 0, sizeof(FrameSingle));
+    memset(FrameDual, 0, sizeof(FrameDual));
+
+    while (NumRandom < Config.Random)
+    {
+        const size_t NumOps = ((Config.Random - NumRandom) < kMaxOps) ? (Config.Random - NumRandom) : kMaxOps;
+        BuildRandom(&Random, NumOps);
+        Render(&Single, FrameSingle, &Random);
+        Render(&Dual, FrameDual, &Random);
+        NumRandom += (unsigned)NumOps;
+
+        if (memcmp(FrameSingle, FrameDual, sizeof(FrameSingle)) != 0)
+        {
+            printf("Random blends: two threads rendered a different frame after %u\n", NumRandom);
+            NumMismatches++;
+            break;
+        }
+    }
+
+    printf("%u random blends checked, %lu of %lu blends split overall, %.1f%% of the pixels on the helper\n", NumRandom,
+           (unsigned long)Dual.Stats.NumSplit, (unsigned long)Dual.Stats.NumJobs,
+           100.0 * (double)Dual.Stats.PixelsHelper / (double)(Dual.Stats.PixelsHelper + Dual.Stats.PixelsMain));
+
+    // With one CPU the helper only runs when the render thread blocks, so the split can only ever cost time
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+    {
+        printf("Only one CPU online, the timings show the hand-over cost and not the speedup\n");
+    }
+
+    Helper.IsQuit = true;
+    (void) sem_post(&Helper.Kick);
+    (void) pthread_join(Helper.Thread, NULL);
+
+    printf("%s\n", (NumMismatches == 0) ? "PASS" : "FAIL");
+    return (NumMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+// Host-side check and micro-benchmark for the chroma keyed span blits.
+//
+// Draws every image in components/images into a 160x144 RGB565 frame twice: once the way LVGL 8's software renderer
+// does, and once through main/img_spans.c. The stock path follows lv_draw_sw_img_decoded() and the software blend:
+// each row is converted into a scratch line with a mask byte per pixel (0 where the pixel is the chroma key), then
+// blended through the mask, copying where it is opaque. Opaque images are copied a row at a time as LVGL does, and
+// get a span table too, one span per row. A library memcpy() beats the span copy there, which is why the firmware
+// only builds tables for chroma keyed images. Images with an alpha channel can't use spans and are only timed on the
+// stock path.
+//
+// Each image is drawn at a spread of positions, including partly off screen and at odd pixel offsets so that both of
+// the word copy's alignment cases run, and the two frames must match bit for bit. The frame is reset from the same
+// random background before every draw.
+//
+// Build and run from this directory with:
+//   gcc -O2 -DLV_LVGL_H_INCLUDE_SIMPLE -I../palette_check -I../../main blit_bench.c ../../main/img_spans.c ../../components/images/*.c -o blit_bench
+//   ./blit_bench --iterations 2000
+//
+// The exit code is non-zero if a span blit differs from the stock one.
+
+#include "img_spans.h"
+#include "lvgl.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+    kWidth_px     = 160,
+    kHeight_px    = 144,
+    kNumPixels    = kWidth_px * kHeight_px,
+    kChromaKey    = 0xF81F,         // 0xFF00FF in RGB565
+    kMaskOpaque   = 0xFF,
+    kNumPositions = 9,
+};
+
+#define IMAGES(X)                                                                                                   \
+    X(icon_bat_large_g) X(icon_bat_large_r) X(icon_bat_large_y) X(icon_charging) X(icon_wifi) X(img_a_right)        \
+    X(img_arrow_down) X(img_arrow_up) X(img_b_left) X(img_brightness) X(img_chromatic) X(img_chromatic_eyebrow)     \
+    X(img_dot_grey) X(img_dot_white) X(img_option_dis) X(img_option_en) X(img_toggle_off) X(img_toggle_on)          \
+    X(menu_controls) X(menu_display) X(menu_palette) X(menu_status) X(menu_system)
+
+#define DECLARE_IMAGE(Name) extern const lv_img_dsc_t Name;
+#define IMAGE_ENTRY(Name) { #Name, &Name },
+
+IMAGES(DECLARE_IMAGE)
+
+static const struct {
+    const char *pName;
+    const lv_img_dsc_t *pImg;
+} Images[] = { IMAGES(IMAGE_ENTRY) };
+
+static struct {
+    unsigned Iterations;
+    uint32_t Seed;
+} Config = {
+    .Iterations = 2000,
+    .Seed = 1,
+};
+
+static uint16_t Background[kNumPixels];
+static uint16_t FrameStock[kNumPixels];
+static uint16_t FrameSpans[kNumPixels];
+static uint32_t Rng;
+
+static uint32_t Random(void)
+{
+    // xorshift32, the same sequence on every run for a given seed
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+static uint64_t Now_ns(void)
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return (uint64_t)Ts.tv_sec * 1000000000ull + (uint64_t)Ts.tv_nsec;
+}
+
+// RGB565 per channel, rounded the way LVGL's LV_UDIV255 does
+static uint16_t Mix(const uint16_t Fg, const uint16_t Bg, const uint8_t Opa)
+{
+    const uint32_t R = (((Fg >> 11) & 0x1F) * Opa + ((Bg >> 11) & 0x1F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    const uint32_t G = (((Fg >> 5) & 0x3F) * Opa + ((Bg >> 5) & 0x3F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    const uint32_t B = ((Fg & 0x1F) * Opa + (Bg & 0x1F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    return (uint16_t)((R << 11) | (G << 5) | B);
+}
+
+// Opaque images get a key none of their pixels have, so each row becomes a single span
+static uint16_t UnusedColor(const lv_img_dsc_t *const pImg)
+{
+    static bool IsUsed[1 << 16];
+    const uint16_t *const pPixels = (const uint16_t*)pImg->data;
+    const size_t NumPixels = (size_t)pImg->header.w * pImg->header.h;
+
+    memset(IsUsed, 0, sizeof(IsUsed));
+    for (size_t i = 0; i < NumPixels; i++)
+    {
+        IsUsed[pPixels[i]] = true;
+    }
+
+    uint16_t Color = kChromaKey;
+    while (IsUsed[Color])
+    {
+        Color++;
+    }
+
+    return Color;
+}
+
+// Where the image lands and which part of the frame may be drawn, like LVGL's coords and clip area
+typedef struct Placement {
+    int32_t x;
+    int32_t y;
+    int32_t ClipX1, ClipY1, ClipX2, ClipY2;
+} Placement_t;
+
+static bool Clip(const lv_img_dsc_t *const pImg, const Placement_t *const pPlace, ImgSpans_Rect_t *const pArea)
+{
+    const int32_t x1 = (pPlace->x > pPlace->ClipX1) ? pPlace->x : pPlace->ClipX1;
+    const int32_t y1 = (pPlace->y > pPlace->ClipY1) ? pPlace->y : pPlace->ClipY1;
+    const int32_t x2 = (pPlace->x + (int32_t)pImg->header.w - 1 < pPlace->ClipX2) ? (pPlace->x + (int32_t)pImg->header.w - 1) : pPlace->ClipX2;
+    const int32_t y2 = (pPlace->y + (int32_t)pImg->header.h - 1 < pPlace->ClipY2) ? (pPlace->y + (int32_t)pImg->header.h - 1) : pPlace->ClipY2;
+
+    pArea->x1 = x1 - pPlace->x;
+    pArea->y1 = y1 - pPlace->y;
+    pArea->x2 = x2 - pPlace->x;
+    pArea->y2 = y2 - pPlace->y;
+    return (x1 <= x2) && (y1 <= y2);
+}
+
+// lv_draw_sw_img_decoded() for the true color formats: the row is converted into a line buffer with a mask, then
+// blended through the mask
+static void StockBlit(const lv_img_dsc_t *const pImg, const Placement_t *const pPlace, uint16_t *const pFrame)
+{
+    ImgSpans_Rect_t Area;
+    if (!Clip(pImg, pPlace, &Area))
+    {
+        return;
+    }
+
+    const int32_t Width = Area.x2 - Area.x1 + 1;
+    uint16_t Line[kWidth_px];
+    uint8_t Mask[kWidth_px];
+
+    for (int32_t y = Area.y1; y <= Area.y2; y++)
+    {
+        uint16_t *const pDst = &pFrame[(pPlace->y + y) * kWidth_px + pPlace->x + Area.x1];
+        const size_t Row = (size_t)y * pImg->header.w + (size_t)Area.x1;
+
+        switch (pImg->header.cf)
+        {
+            case LV_IMG_CF_TRUE_COLOR:
+                memcpy(pDst, &((const uint16_t*)pImg->data)[Row], (size_t)Width * sizeof(uint16_t));
+                continue;
+
+            case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+            {
+                const uint16_t *const pSrc = &((const uint16_t*)pImg->data)[Row];
+                for (int32_t x = 0; x < Width; x++)
+                {
+                    Line[x] = pSrc[x];
+                    Mask[x] = (pSrc[x] == kChromaKey) ? 0 : kMaskOpaque;
+                }
+                break;
+            }
+
+            case LV_IMG_CF_TRUE_COLOR_ALPHA:
+            {
+                const uint8_t *const pSrc = &pImg->data[Row * LV_IMG_PX_SIZE_ALPHA_BYTE];
+                for (int32_t x = 0; x < Width; x++)
+                {
+                    Line[x] = (uint16_t)(pSrc[x * 3] | (pSrc[x * 3 + 1] << 8));
+                    Mask[x] = pSrc[x * 3 + 2];
+                }
+                break;
+            }
+
+            default:
+                return;
+        }
+
+        for (int32_t x = 0; x < Width; x++)
+        {
+            if (Mask[x] >= 253)
+            {
+                pDst[x] = Line[x];
+            }
+            else if (Mask[x] > 2)
+            {
+                pDst[x] = Mix(Line[x], pDst[x], Mask[x]);
+            }
+        }
+    }
+}
+
+static void SpanBlit(const ImgSpans_t *const pTable, const lv_img_dsc_t *const pImg, const Placement_t *const pPlace, uint16_t *const pFrame)
+{
+    ImgSpans_Rect_t Area;
+    if (!Clip(pImg, pPlace, &Area))
+    {
+        return;
+    }
+
+    uint16_t *const pDst = &pFrame[(pPlace->y + Area.y1) * kWidth_px + pPlace->x + Area.x1];
+    ImgSpans_Blit(pTable, &Area, pDst, kWidth_px);
+}
+
+// Centred, in the corners, hanging off every edge, at odd and even x, and with a clip area cutting through the middle
+static void BuildPlacements(const lv_img_dsc_t *const pImg, Placement_t *const pPlaces)
+{
+    const int32_t w = (int32_t)pImg->header.w;
+    const int32_t h = (int32_t)pImg->header.h;
+    const int32_t Xs[kNumPositions] = { (kWidth_px - w) / 2, 0, 1, kWidth_px - w, -w / 2, kWidth_px - w / 2 - 1, 8, 7, 3 };
+    const int32_t Ys[kNumPositions] = { (kHeight_px - h) / 2, 0, 1, kHeight_px - h, -h / 3, kHeight_px - h / 2, 7, 30, 5 };
+
+    for (size_t p = 0; p < kNumPositions; p++)
+    {
+        pPlaces[p] = (Placement_t) {
+            .x = Xs[p],
+            .y = Ys[p],
+            .ClipX1 = 0,
+            .ClipY1 = 0,
+            .ClipX2 = kWidth_px - 1,
+            .ClipY2 = kHeight_px - 1,
+        };
+    }
+
+    // LVGL redraws invalidated areas, which clip images anywhere
+    pPlaces[kNumPositions - 1].ClipX1 = 3 + w / 3;
+    pPlaces[kNumPositions - 1].ClipY1 = 5 + h / 4;
+    pPlaces[kNumPositions - 1].ClipX2 = 3 + (2 * w) / 3;
+    pPlaces[kNumPositions - 1].ClipY2 = 5 + (3 * h) / 4;
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --iterations N  Draws per image, position and path for the timings (default %u)\n"
+            "  --seed N        Seed for the background (default %u)\n",
+            pName, Config.Iterations, Config.Seed);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "iterations", required_argument, NULL, 'i' },
+        { "seed",       required_argument, NULL, 'S' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'i': Config.Iterations = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'S': Config.Seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    Config.Iterations = (Config.Iterations == 0) ? 1 : Config.Iterations;
+    Rng = (Config.Seed == 0) ? 1 : Config.Seed;
+
+    for (size_t i = 0; i < kNumPixels; i++)
+    {
+        Background[i] = (uint16_t)Random();
+    }
+
+    unsigned NumMismatches = 0;
+    uint64_t TotalStock_ns = 0;
+    uint64_t TotalSpans_ns = 0;
+
+    printf("%-22s %-7s %7s %6s %6s %9s %9s %8s\n", "Image", "Format", "Size", "Spans", "Opaque", "Stock", "Spans", "Speedup");
+    for (size_t i = 0; i < sizeof(Images) / sizeof(Images[0]); i++)
+    {
+        const lv_img_dsc_t *const pImg = Images[i].pImg;
+        const bool IsAlpha = (pImg->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA);
+        const char *pFormat = IsAlpha ? "alpha" : ((pImg->header.cf == LV_IMG_CF_TRUE_COLOR) ? "opaque" : "keyed");
+
+        ImgSpans_t Table;
+        const bool HasTable = !IsAlpha &&
+            ImgSpans_Build(&Table, (const uint16_t*)pImg->data, (uint16_t)pImg->header.w, (uint16_t)pImg->header.h,
+                           (pImg->header.cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED) ? kChromaKey : UnusedColor(pImg));
+
+        Placement_t Places[kNumPositions];
+        BuildPlacements(pImg, Places);
+
+        bool IsMatch = true;
+        for (size_t p = 0; (p < kNumPositions) && HasTable; p++)
+        {
+            memcpy(FrameStock, Background, sizeof(FrameStock));
+            memcpy(FrameSpans, Background, sizeof(FrameSpans));
+            StockBlit(pImg, &Places[p], FrameStock);
+            SpanBlit(&Table, pImg, &Places[p], FrameSpans);
+            IsMatch = IsMatch && (memcmp(FrameStock, FrameSpans, sizeof(FrameStock)) == 0);
+        }
+
+        if (!IsMatch)
+        {
+            printf("%s: the span blit drew a different frame\n", Images[i].pName);
+            NumMismatches++;
+        }
+
+        uint64_t Start_ns = Now_ns();
+        for (unsigned n = 0; n < Config.Iterations; n++)
+        {
+            StockBlit(pImg, &Places[n % kNumPositions], FrameStock);
+        }
+        const uint64_t Stock_ns = (Now_ns() - Start_ns) / Config.Iterations;
+
+        uint64_t Spans_ns = 0;
+        if (HasTable)
+        {
+            Start_ns = Now_ns();
+            for (unsigned n = 0; n < Config.Iterations; n++)
+            {
+                SpanBlit(&Table, pImg, &Places[n % kNumPositions], FrameSpans);
+            }
+            Spans_ns = (Now_ns() - Start_ns) / Config.Iterations;
+
+            TotalStock_ns += Stock_ns;
+            TotalSpans_ns += Spans_ns;
+        }
+
+        char Size[16];
+        snprintf(Size, sizeof(Size), "%ux%u", pImg->header.w, pImg->header.h);
+        if (HasTable)
+        {
+            const uint32_t Opaque_pct = (Table.NumOpaque * 100) / ((uint32_t)Table.Width * Table.Height);
+            printf("%-22s %-7s %7s %6lu %5lu%% %6lu ns %6lu ns %7.2fx\n", Images[i].pName, pFormat, Size,
+                   (unsigned long)Table.NumSpans, (unsigned long)Opaque_pct, (unsigned long)Stock_ns,
+                   (unsigned long)Spans_ns, (Spans_ns > 0) ? (double)Stock_ns / (double)Spans_ns : 0.0);
+            ImgSpans_Free(&Table);
+        }
+        else
+        {
+            printf("%-22s %-7s %7s %6s %6s %6lu ns %9s %8s\n", Images[i].pName, pFormat, Size, "-", "-",
+                   (unsigned long)Stock_ns, "-", "-");
+        }
+    }
+
+    printf("All images with spans, one draw of each: %lu ns stock, %lu ns spans, %.2fx\n",
+           (unsigned long)TotalStock_ns, (unsigned long)TotalSpans_ns,
+           (TotalSpans_ns > 0) ? (double)TotalStock_ns / (double)TotalSpans_ns : 0.0);
+    printf("%s\n", (NumMismatches == 0) ? "PASS" : "FAIL");
+    return (NumMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,592 @@
+// Host-side check for the OSD flush.
+//
+// Drives main/disp_plan.c the way main/disp_flush.c does, with a mock spi_device_queue_trans in place of the SPI
+// driver. Queued transactions wait in a FIFO as deep as the device queue main.c sets up, and a mock DMA drains it in
+// order, copying each one into a model of the FPGA's frame at the offset from its address phase and then running the
+// post callback, as the driver's ISR does after every transaction. Frames are random redraws of row ranges, some of
+// them identical to what is already there, rendered into one buffer or alternately into two with the sent bands
+// synced across. With two buffers the DMA is only part way through a frame when the next one is rendered.
+//
+// Every frame is checked for:
+//   - exactly one completion, coming after all of its transactions, and none for a frame with nothing to send,
+//   - every transaction carrying a full chunk, from the place in the buffer its address says,
+//   - no unchanged transaction going out and no changed one being held back,
+//   - the FPGA's frame matching the rendered one once the frame completes, and the second buffer matching it before
+//     the next render.
+//
+// Both runs see the same frames, and each is also put through a timing model to compare the frame time the two
+// builds report in `disp_stats`: from LVGL starting to render until it may render again. The wire time comes from the
+// SPI setup in main.c (40 MHz, 46 clocks of command, address and dummy bits on one line, 6 of chip select, the data on
+// four lines). Render, hash, queue and copy costs, and the driver's time between transactions, are options, since the
+// host can't measure them. Frames follow each other straight away by default, as during a tab transition, or on a
+// fixed period with --period-us.
+//
+// Build and run from this directory with:
+//   gcc -O2 -Wall -Wextra -I../../main -I../../components/osd flush_check.c ../../main/disp_plan.c -o flush_check
+//   ./flush_check --frames 20000
+//   ./flush_check --full-redraws --render-ns-px 60
+//
+// The exit code is non-zero if any check fails.
+
+#include "disp_plan.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    kNumBufs      = 2,
+    kMaxAreas     = 4,
+    kMaxFailures  = 10,             // Printed, the rest are only counted
+    kWordsPerXfer = kDisp_FlushConsts_BytesPerXfer / sizeof(uint32_t),
+};
+
+// The parts of the IDF SPI driver the flush touches
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef struct spi_transaction {
+    uint32_t addr;
+    size_t length;                  // [bits]
+    const void *tx_buffer;
+    void *user;
+} spi_transaction_t;
+
+typedef struct Device {
+    spi_transaction_t *pQueue[kDisp_FlushConsts_NumTrans];  // queue_size in main.c
+    size_t Head;
+    size_t Count;
+} Device_t;
+
+// Stands in for lv_disp_drv_t, only its address is used
+typedef struct Driver {
+    bool IsFlushReady;
+} Driver_t;
+
+typedef struct InFlight {
+    bool IsActive;
+    uint32_t NumTrans;
+    uint32_t NumDone;
+    uint16_t Expected[kOSD_NumPixels];
+} InFlight_t;
+
+typedef struct QueueCtx {
+    Device_t *pDevice;
+    Driver_t *pDrv;
+    size_t Buf;
+} QueueCtx_t;
+
+typedef struct Timing {
+    double Now_us;                  // When LVGL may start the next render
+    double DmaDone_us;              // When the last transaction queued is off the wire
+    double Total_us;
+    double Max_us;
+    uint32_t NumFrames;
+} Timing_t;
+
+static struct {
+    unsigned Frames;
+    unsigned Buffers;               // 0 runs both
+    uint32_t Seed;
+    bool IsFullRedraw;
+    double SpiMHz;
+    double Gap_us;
+    double RenderBase_us;
+    double RenderNsPerPx;
+    double HashNsPerWord;
+    double Queue_us;
+    double CopyMBps;
+    double Period_us;               // 0 renders back to back
+} Config = {
+    .Frames = 20000,
+    .Buffers = 0,
+    .Seed = 1,
+    .SpiMHz = 40.0,
+    .Gap_us = 15.0,
+    .RenderBase_us = 200.0,
+    .RenderNsPerPx = 40.0,
+    .HashNsPerWord = 50.0,
+    .Queue_us = 5.0,
+    .CopyMBps = 200.0,
+    .Period_us = 0.0,
+};
+
+static uint32_t Rng;
+static uint32_t DmaRng;             // Apart from Rng so that both runs render the same frames
+static unsigned NumFailures;
+
+// Everything below is reset for each run
+static uint16_t Bufs[kNumBufs][kOSD_NumPixels];
+static spi_transaction_t Trans[kNumBufs][kDisp_FlushConsts_NumTrans];
+static uint16_t Fpga[kOSD_NumPixels];
+static uint16_t Queued[kOSD_NumPixels];     // What the FPGA has once everything queued is done
+static uint16_t Screen[kOSD_NumPixels];     // What LVGL believes is on screen
+static Disp_Plan_t Plan;
+static Disp_PlanDone_t Done;
+static InFlight_t Pending;
+static bool IsTransferDone;                 // The semaphore the double buffered flush waits on
+static bool IsDoubleBuffered;
+static uint32_t Frame;
+
+static uint32_t Xorshift(uint32_t *const pState)
+{
+    // xorshift32, the same sequence on every run for a given seed
+    *pState ^= *pState << 13;
+    *pState ^= *pState >> 17;
+    *pState ^= *pState << 5;
+    return *pState;
+}
+
+static uint32_t Random(void)
+{
+    return Xorshift(&Rng);
+}
+
+static int32_t RandomIn(const int32_t Min, const int32_t Max)
+{
+    return Min + (int32_t)(Random() % (uint32_t)(Max - Min + 1));
+}
+
+static void Fail(const char *pWhat, const size_t Index)
+{
+    if (NumFailures < kMaxFailures)
+    {
+        printf("  frame %u, transaction %zu: %s\n", Frame, Index, pWhat);
+    }
+    NumFailures++;
+}
+
+// Disp_Flush_OnTransDone, which the driver calls from its ISR after every transaction
+static void OnTransDone(spi_transaction_t *pTransaction)
+{
+    Pending.NumDone++;
+    if (!Disp_Plan_OnTransDone(&Done, pTransaction->user != NULL))
+    {
+        return;
+    }
+
+    if (!Pending.IsActive || (Pending.NumDone != Pending.NumTrans))
+    {
+        Fail("completion before the last transaction of the frame", 0);
+    }
+    else if (memcmp(Fpga, Pending.Expected, sizeof(Fpga)) != 0)
+    {
+        Fail("FPGA frame differs from the rendered one", 0);
+    }
+
+    Pending.IsActive = false;
+    if (IsDoubleBuffered)
+    {
+        IsTransferDone = true;
+        return;
+    }
+
+    ((Driver_t*)pTransaction->user)->IsFlushReady = true;
+}
+
+// One transaction off the wire: the FPGA writes the chunk at the offset from the address phase
+static bool CompleteOne(Device_t *const pDevice)
+{
+    if (pDevice->Count == 0)
+    {
+        return false;
+    }
+
+    spi_transaction_t *const pTrans = pDevice->pQueue[pDevice->Head];
+    pDevice->Head = (pDevice->Head + 1) % kDisp_FlushConsts_NumTrans;
+    pDevice->Count--;
+
+    const size_t Bytes = pTrans->length / 8;
+    const size_t Index = pTrans->addr / kDisp_FlushConsts_BytesPerXfer;
+    if ((Bytes != kDisp_FlushConsts_BytesPerXfer) || ((pTrans->addr % kDisp_FlushConsts_BytesPerXfer) != 0) ||
+        ((pTrans->addr + Bytes) > kDisp_FlushConsts_BytesPerFrame))
+    {
+        Fail("bad length or address", Index);
+        return true;
+    }
+
+    const size_t Offset_px = pTrans->addr / 2;
+    const uint16_t *const pSrc = (const uint16_t*)pTrans->tx_buffer;
+    if ((pSrc != &Bufs[0][Offset_px]) && (pSrc != &Bufs[1][Offset_px]))
+    {
+        Fail("address does not match the buffer it is sent from", Index);
+    }
+
+    memcpy(&Fpga[Offset_px], pSrc, Bytes);
+    OnTransDone(pTrans);
+    return true;
+}
+
+// Blocks on a full queue until the DMA frees a slot, as spi_device_queue_trans does with portMAX_DELAY
+static esp_err_t spi_device_queue_trans(Device_t *const pDevice, spi_transaction_t *pTrans, const uint32_t TicksToWait)
+{
+    (void)TicksToWait;
+
+    if (pDevice->Count == kDisp_FlushConsts_NumTrans)
+    {
+        (void) CompleteOne(pDevice);
+    }
+
+    pDevice->pQueue[(pDevice->Head + pDevice->Count) % kDisp_FlushConsts_NumTrans] = pTrans;
+    pDevice->Count++;
+    return ESP_OK;
+}
+
+// Disp_Flush's queue callback
+static void Queue(void *pCtx, const Disp_PlanXfer_t *const pXfer)
+{
+    const QueueCtx_t *const pQueue = (const QueueCtx_t*)pCtx;
+    spi_transaction_t *const pTrans = &Trans[pQueue->Buf][pXfer->Index];
+
+    if (pTrans->addr != pXfer->Addr)
+    {
+        Fail("planned address differs from the descriptor's", pXfer->Index);
+    }
+
+    pTrans->user = pXfer->IsLast ? pQueue->pDrv : NULL;
+    const esp_err_t ret = spi_device_queue_trans(pQueue->pDevice, pTrans, UINT32_MAX);
+    (void)ret;
+}
+
+// Mostly small widgets, now and then a full redraw. Some redraws leave the pixels as they were.
+static uint64_t Render(uint16_t *const pBuf, uint32_t *const pNumPixels)
+{
+    uint64_t DirtyMask = 0;
+    const int32_t NumAreas = Config.IsFullRedraw ? 1 : RandomIn(1, kMaxAreas);
+    *pNumPixels = 0;
+
+    for (int32_t a = 0; a < NumAreas; a++)
+    {
+        const bool IsFull = Config.IsFullRedraw || ((Random() % 50) == 0);
+        const int32_t y1 = IsFull ? 0 : RandomIn(0, kOSD_Height_px - 1);
+        const int32_t y2 = IsFull ? (kOSD_Height_px - 1) : RandomIn(y1, (y1 + 24 < kOSD_Height_px) ? (y1 + 24) : (kOSD_Height_px - 1));
+        const int32_t x1 = IsFull ? 0 : RandomIn(0, kOSD_Width_px - 1);
+        const int32_t x2 = IsFull ? (kOSD_Width_px - 1) : RandomIn(x1, kOSD_Width_px - 1);
+        const bool IsSame = !Config.IsFullRedraw && ((Random() % 3) == 0);
+        const uint16_t Color = (uint16_t)Random();
+
+        for (int32_t y = y1; y <= y2; y++)
+        {
+            for (int32_t x = x1; x <= x2; x++)
+            {
+                const size_t i = (size_t)y * kOSD_Width_px + (size_t)x;
+                Screen[i] = IsSame ? Screen[i] : (uint16_t)(Color + (uint16_t)(x * 7 + y));
+                pBuf[i] = Screen[i];
+            }
+        }
+        *pNumPixels += (uint32_t)((y2 - y1 + 1) * (x2 - x1 + 1));
+
+        // LVGL may invalidate a little more than it draws, which must not matter either
+        DirtyMask |= Disp_Plan_RowsToMask(y1 - RandomIn(0, 1), y2 + RandomIn(0, 1));
+    }
+
+    return DirtyMask;
+}
+
+// Disp_Flush_Cb for the last area of a refresh, returns what was queued
+static uint64_t Flush(Device_t *const pDevice, Driver_t *const pDrv, const size_t Buf, const uint64_t Invalidated)
+{
+    const uint16_t *const pFrame = Bufs[Buf];
+    const uint64_t KnownMask = Plan.SentMask;
+    const uint64_t DirtyMask = Disp_Plan_DropUnchanged(&Plan, (const uint32_t*)pFrame, kWordsPerXfer, Invalidated);
+
+    for (size_t x = 0; x < kDisp_FlushConsts_NumTrans; x++)
+    {
+        const size_t Offset = x * kDisp_FlushConsts_PixelsPerXfer;
+        const bool IsChanged = memcmp(&pFrame[Offset], &Queued[Offset], kDisp_FlushConsts_BytesPerXfer) != 0;
+        const bool IsSent = ((DirtyMask >> x) & 1) != 0;
+
+        // Until a transaction was sent once there is no telling what the FPGA holds there
+        if (IsSent && !IsChanged && (((KnownMask >> x) & 1) != 0))
+        {
+            Fail("unchanged transaction sent", x);
+        }
+        else if (!IsSent && IsChanged)
+        {
+            Fail("changed transaction held back", x);
+        }
+    }
+
+    if (IsDoubleBuffered)
+    {
+        // The other buffer is still being read by the previous frame's DMA, and LVGL moves on to it once released
+        while (!IsTransferDone && CompleteOne(pDevice))
+        {
+        }
+
+        if (!IsTransferDone)
+        {
+            Fail("previous frame never completed", 0);
+        }
+        IsTransferDone = false;
+    }
+
+    if (DirtyMask == 0)
+    {
+        // Nothing was queued, so the semaphore goes straight back
+        IsTransferDone = IsDoubleBuffered;
+        pDrv->IsFlushReady = true;
+        return 0;
+    }
+
+    if (Pending.IsActive)
+    {
+        Fail("frame queued while the previous one is in flight", 0);
+    }
+
+    memcpy(Queued, pFrame, sizeof(Queued));
+    memcpy(Pending.Expected, pFrame, sizeof(Pending.Expected));
+    Pending.IsActive = true;
+    Pending.NumTrans = (uint32_t)__builtin_popcountll(DirtyMask);
+    Pending.NumDone = 0;
+
+    QueueCtx_t Ctx = {
+        .pDevice = pDevice,
+        .pDrv = pDrv,
+        .Buf = Buf,
+    };
+    const uint32_t NumQueued = Disp_Plan_Queue(DirtyMask, Queue, &Ctx);
+    if (NumQueued != Pending.NumTrans)
+    {
+        Fail("queued a different number of transactions than were dirty", 0);
+    }
+
+    if (IsDoubleBuffered)
+    {
+        Disp_Plan_SyncBands(Bufs[Buf], Bufs[Buf ^ 1], DirtyMask);
+        pDrv->IsFlushReady = true;
+    }
+
+    return DirtyMask;
+}
+
+static void InitTrans(const unsigned NumBufs)
+{
+    for (size_t b = 0; b < NumBufs; b++)
+    {
+        for (size_t x = 0; x < kDisp_FlushConsts_NumTrans; x++)
+        {
+            spi_transaction_t *const pTrans = &Trans[b][x];
+            memset(pTrans, 0, sizeof(spi_transaction_t));
+            pTrans->tx_buffer = &Bufs[b][x * kDisp_FlushConsts_PixelsPerXfer];
+            pTrans->length = kDisp_FlushConsts_BytesPerXfer * 8;
+            pTrans->addr = x * kDisp_FlushConsts_BytesPerXfer;
+        }
+    }
+}
+
+// One transaction on the wire plus the driver's time before the next one starts
+static double GetXfer_us(void)
+{
+    const double Clocks = 46.0 + 6.0 + (kDisp_FlushConsts_BytesPerXfer * 8.0) / 4.0;
+    return Clocks / Config.SpiMHz + Config.Gap_us;
+}
+
+// Follows Disp_Flush_Cb: hash what was invalidated, wait for the previous transfer when double buffered, queue, then
+// either sync the other buffer and release or wait for the last transaction
+static void ModelFrame(Timing_t *const pTiming, const uint32_t NumPixels, const uint32_t NumHashed, const uint32_t NumSent)
+{
+    const double Tick_us = (Config.Period_us > 0.0) ? (double)pTiming->NumFrames * Config.Period_us : 0.0;
+    const double Start_us = (Tick_us > pTiming->Now_us) ? Tick_us : pTiming->Now_us;
+
+    double t = Start_us + Config.RenderBase_us + (NumPixels * Config.RenderNsPerPx) / 1000.0 +
+               (NumHashed * kWordsPerXfer * Config.HashNsPerWord) / 1000.0;
+
+    if (IsDoubleBuffered)
+    {
+        t = (pTiming->DmaDone_us > t) ? pTiming->DmaDone_us : t;
+    }
+
+    if (NumSent > 0)
+    {
+        pTiming->DmaDone_us = ((pTiming->DmaDone_us > t) ? pTiming->DmaDone_us : t) + NumSent * GetXfer_us();
+        t += NumSent * Config.Queue_us;
+        t = IsDoubleBuffered ? (t + (NumSent * kDisp_FlushConsts_BytesPerXfer) / Config.CopyMBps) : pTiming->DmaDone_us;
+    }
+
+    const double Frame_us = t - Start_us;
+    pTiming->Now_us = t;
+    pTiming->Total_us += Frame_us;
+    pTiming->Max_us = (Frame_us > pTiming->Max_us) ? Frame_us : pTiming->Max_us;
+    pTiming->NumFrames++;
+}
+
+static bool Run(const unsigned NumBufs)
+{
+    static Device_t Device;
+    static Driver_t Drv;
+
+    memset(&Device, 0, sizeof(Device));
+    memset(Bufs, 0, sizeof(Bufs));
+    memset(Fpga, 0, sizeof(Fpga));
+    memset(Queued, 0, sizeof(Queued));
+    memset(Screen, 0, sizeof(Screen));
+    memset(&Pending, 0, sizeof(Pending));
+    memset(&Done, 0, sizeof(Done));
+    Disp_Plan_Init(&Plan);
+    InitTrans(NumBufs);
+
+    IsDoubleBuffered = (NumBufs == 2);
+    IsTransferDone = true;
+    Drv.IsFlushReady = true;
+    Rng = (Config.Seed == 0) ? 1 : Config.Seed;
+    DmaRng = Rng;
+
+    Timing_t Timing;
+    memset(&Timing, 0, sizeof(Timing));
+
+    const unsigned FailuresBefore = NumFailures;
+    uint32_t NumQueued = 0;
+    uint32_t NumBands = 0;
+
+    printf("%s buffered:\n", IsDoubleBuffered ? "Double" : "Single");
+
+    for (Frame = 0; Frame < Config.Frames; Frame++)
+    {
+        // LVGL only renders once the last flush was released
+        if (!IsDoubleBuffered)
+        {
+            while (!Drv.IsFlushReady && CompleteOne(&Device))
+            {
+            }
+        }
+
+        if (!Drv.IsFlushReady)
+        {
+            Fail("flush never released", 0);
+        }
+        Drv.IsFlushReady = false;
+
+        // LVGL alternates buffers and draws on top of what it holds, which has to be the screen as it last was
+        const size_t Buf = IsDoubleBuffered ? (Frame & 1) : 0;
+        if (memcmp(Bufs[Buf], Screen, sizeof(Screen)) != 0)
+        {
+            Fail("buffer out of sync before rendering", 0);
+        }
+
+        uint32_t NumPixels;
+        const uint64_t Invalidated = Render(Bufs[Buf], &NumPixels);
+        const uint64_t DirtyMask = Flush(&Device, &Drv, Buf, Invalidated);
+        ModelFrame(&Timing, NumPixels, (uint32_t)__builtin_popcountll(Invalidated), (uint32_t)__builtin_popcountll(DirtyMask));
+        NumQueued += (DirtyMask != 0) ? 1 : 0;
+        NumBands += Disp_Plan_CountBands(DirtyMask);
+
+        // With two buffers the DMA gets a random way through the frame before the next one is rendered
+        if (IsDoubleBuffered)
+        {
+            for (uint32_t n = Xorshift(&DmaRng) % (Device.Count + 1); n > 0; n--)
+            {
+                (void) CompleteOne(&Device);
+            }
+        }
+    }
+
+    while (CompleteOne(&Device))
+    {
+    }
+
+    if (Pending.IsActive)
+    {
+        Fail("last frame never completed", 0);
+    }
+
+    if (Done.NumFrames != NumQueued)
+    {
+        Fail("completions don't match the frames sent", 0);
+    }
+
+    // Every transaction still costs a trip through the ISR, the completion only happens on the last one
+    printf("  %u frames, %lu sent in %lu bands, %lu transactions, %lu unchanged ones skipped\n", Config.Frames,
+           (unsigned long)NumQueued, (unsigned long)NumBands, (unsigned long)Done.NumCallbacks, (unsigned long)Plan.NumHits);
+    printf("  %lu completions, %.1f post callbacks per completion\n", (unsigned long)Done.NumFrames,
+           (Done.NumFrames == 0) ? 0.0 : (double)Done.NumCallbacks / (double)Done.NumFrames);
+    printf("  Modelled frame time: %.0f us average, %.0f us max, %.1f frames/s\n", Timing.Total_us / Timing.NumFrames,
+           Timing.Max_us, 1e6 * Timing.NumFrames / Timing.Now_us);
+
+    return NumFailures == FailuresBefore;
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --frames N           Frames to render and flush per run (default %u)\n"
+            "  --buffers N          Only run with 1 or 2 frame buffers (default both)\n"
+            "  --seed N             Seed for the redraws and the DMA's progress (default %u)\n"
+            "  --full-redraws       Redraw the whole screen every frame, as a tab transition does\n"
+            "  --spi-mhz N          SPI clock (default %.0f)\n"
+            "  --gap-us N           Driver time between queued transactions (default %.0f)\n"
+            "  --render-base-us N   Render time per frame on top of the pixels (default %.0f)\n"
+            "  --render-ns-px N     Render time per pixel drawn (default %.0f)\n"
+            "  --hash-ns-word N     Hash time per word of an invalidated transaction (default %.0f)\n"
+            "  --queue-us N         Time to queue one transaction (default %.0f)\n"
+            "  --copy-mbps N        Rate the sent bands are copied to the other buffer at (default %.0f)\n"
+            "  --period-us N        Start renders on this period rather than back to back (default off)\n",
+            pName, Config.Frames, Config.Seed, Config.SpiMHz, Config.Gap_us, Config.RenderBase_us,
+            Config.RenderNsPerPx, Config.HashNsPerWord, Config.Queue_us, Config.CopyMBps);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "frames",         required_argument, NULL, 'f' },
+        { "buffers",        required_argument, NULL, 'b' },
+        { "seed",           required_argument, NULL, 'S' },
+        { "full-redraws",   no_argument,       NULL, 'F' },
+        { "spi-mhz",        required_argument, NULL, 'm' },
+        { "gap-us",         required_argument, NULL, 'g' },
+        { "render-base-us", required_argument, NULL, 'r' },
+        { "render-ns-px",   required_argument, NULL, 'p' },
+        { "hash-ns-word",   required_argument, NULL, 'H' },
+        { "queue-us",       required_argument, NULL, 'q' },
+        { "copy-mbps",      required_argument, NULL, 'c' },
+        { "period-us",      required_argument, NULL, 'P' },
+        { "help",           no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'f': Config.Frames = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'b': Config.Buffers = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'S': Config.Seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'F': Config.IsFullRedraw = true; break;
+            case 'm': Config.SpiMHz = strtod(optarg, NULL); break;
+            case 'g': Config.Gap_us = strtod(optarg, NULL); break;
+            case 'r': Config.RenderBase_us = strtod(optarg, NULL); break;
+            case 'p': Config.RenderNsPerPx = strtod(optarg, NULL); break;
+            case 'H': Config.HashNsPerWord = strtod(optarg, NULL); break;
+            case 'q': Config.Queue_us = strtod(optarg, NULL); break;
+            case 'c': Config.CopyMBps = strtod(optarg, NULL); break;
+            case 'P': Config.Period_us = strtod(optarg, NULL); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    if ((Config.Buffers > kNumBufs) || (Config.SpiMHz <= 0.0) || (Config.CopyMBps <= 0.0))
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    bool IsPass = true;
+    for (unsigned NumBufs = 1; NumBufs <= kNumBufs; NumBufs++)
+    {
+        if ((Config.Buffers == 0) || (Config.Buffers == NumBufs))
+        {
+            IsPass = Run(NumBufs) && IsPass;
+        }
+    }
+
+    printf("%s\n", IsPass ? "PASS" : "FAIL");
+    return IsPass ? 0 : 1;
+}
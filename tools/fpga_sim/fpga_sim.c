@@ -0,0 +1,1323 @@
+// Host-side stand-in for the FPGA end of the system management link.
+//
+// The MCU end is the firmware's own FPGA_RxTask and FPGA_TxTask, built from main/fpga_rx.c, main/fpga_tx.c and
+// main/fpga_common.c against the FreeRTOS and UART shim in shim/, with the OSD modules they read settings from and
+// report to replaced by the stand-ins below. The UART is one end of a socketpair. A thread on the other end plays the
+// FPGA: it emits button, voltage, PMIC, palette and StatusExtended traffic at configurable rates, paced at the
+// configured baud rate, optionally corrupts it, and answers firmware version and BG palette requests. The main thread
+// does what app_main() and the OSD do: it repeats FPGA_Tx_SendAll() at boot, then pokes buttons, changes the player
+// number and asks for everything again on timers. Both ends check that every frame they decode matches one that was
+// sent, in order, and within the latency budget.
+//
+// With --v3 the stand-in also answers the capability handshake and follows LinkCtl, so baud rate negotiation can be
+// exercised. Bytes written while the two ends disagree on the rate arrive as garbage, and --unstable-baud makes every
+// rate from the given one up lose frames, which must drive the MCU back down to a rate that holds. Adding --ack
+// offers acknowledged configuration writes in the handshake, so the MCU sequences its writes and resends the ones
+// whose ConfigAck went missing. --ack-drop N withholds every Nth ack, and each one has to be made up by a resend.
+//
+// --lose-first-sysctl drops the first SysCtl write on the wire. Without acks only the boot repeats can make up for
+// it, so run it with --sysctl 0: the FPGA has to end up holding the MCU's setting anyway.
+//
+// --sleep-every puts the MCU into light sleep the way PwrMgr_Task does: it pauses both tasks, reverts the link to the
+// default rate, stops receiving for --sleep-ms, and on wake leaves the Tx task paused until the Rx task decodes an
+// AudioBrightness frame. Every sleep has to end with the Tx task sending again. --sleep-keep-baud skips the revert,
+// which leaves the two ends at different rates after a sleep longer than kFPGA_LinkConsts_LinkLoss, so the link has
+// to find its way back through the fallback instead.
+//
+// Build and run from this directory with:
+//   gcc -O2 -Wall -Wextra -pthread -Ishim -I../../main -I../../components/common -I../../components/button
+//       -I../../components/dlist -I../../components/settings -I../../components/battery -I../../components/osd
+//       -I../../components/osd/status -I../../components/osd/display -I../../components/osd/controls
+//       -I../../components/osd/palette -I../../components/osd/system -I../../components/crc
+//       fpga_sim.c shim/shim.c ../../main/fpga_rx.c ../../main/fpga_tx.c ../../main/fpga_common.c
+//       ../../main/fpga_decode.c ../../main/fpga_schema.c ../../main/fpga_rx_latency.c ../../main/fpga_stats.c
+//       ../../main/fpga_link.c ../../main/fpga_ack.c ../../components/crc/crc8_sae_j1850.c -o fpga_sim
+//   ./fpga_sim --duration 10 --buttons 1000 --corrupt 1 --noise 1
+//   ./fpga_sim --v3 --unstable-baud 921600
+//   ./fpga_sim --v3 --ack --ack-drop 10
+//   ./fpga_sim --lose-first-sysctl --sysctl 0
+//   ./fpga_sim --v3 --duration 10 --sleep-every 3 --sleep-ms 1500
+//
+// Add -DCONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN=1 to run the Rx task off UART events instead of timed reads.
+//
+// The exit code is non-zero if any check failed, so it can be used as a repeatable stress run without hardware.
+
+#include "battery.h"
+#include "brightness.h"
+#include "button.h"
+#include "color_correct_lcd.h"
+#include "color_correct_usb.h"
+#include "dpad_ctl.h"
+#include "driver/uart.h"
+#include "fpga_ack.h"
+#include "fpga_common.h"
+#include "fpga_decode.h"
+#include "fpga_link.h"
+#include "fpga_proto.h"
+#include "fpga_rx.h"
+#include "fpga_rx_latency.h"
+#include "fpga_schema.h"
+#include "fpga_stats.h"
+#include "fpga_tx.h"
+#include "frameblend.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "fw.h"
+#include "low_batt_icon_ctl.h"
+#include "osd.h"
+#include "player_num.h"
+#include "pwrmgr.h"
+#include "screen_transit_ctl.h"
+#include "shim.h"
+#include "silent.h"
+#include "style.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    kMaxPending = 4096,         // Frames in flight per address
+    kBitsPerSymbol = 10,        // 8N1
+    kMaxTxWrite = 1024,         // [bytes] Largest single uart_write_bytes(), the firmware's batches are far smaller
+};
+
+typedef enum {
+    kStream_Buttons,
+    kStream_VoltageAA,
+    kStream_VoltageLiPo,
+    kStream_PMIC,
+    kStream_BGPalette,
+    kStream_StatusExtended,
+    kStream_AudioBrightness,
+
+    kNumStreams,
+} Stream_t;
+
+typedef struct Pending {
+    uint64_t Value;
+    int64_t Sent_us;
+} Pending_t;
+
+// Frames sent but not yet decoded by the other end, per address
+typedef struct PendingQueue {
+    Pending_t Entries[kMaxPending];
+    uint32_t Head;
+    uint32_t Tail;
+} PendingQueue_t;
+
+typedef struct LinkCheck {
+    pthread_mutex_t Lock;
+    PendingQueue_t Queues[kFPGA_StatsConsts_NumAddrs];
+    uint32_t NumSent;
+    uint32_t NumCorrupted;
+    uint32_t NumMatched;
+    uint32_t NumLost;           // Good frames swallowed by a neighbouring corrupted one
+    uint32_t NumPhantom;        // Decoded frames that were never sent
+    uint32_t NumLate;
+    uint32_t MaxLatency_us;
+    uint64_t TotalLatency_us;
+} LinkCheck_t;
+
+typedef struct Config {
+    double Duration_s;
+    double Rate_Hz[kNumStreams];
+    double PokeRate_Hz;
+    double SysCtlRate_Hz;
+    double FWVerRate_Hz;
+    double CorruptPct;
+    double DropPct;
+    double NoisePct;
+    uint32_t BaudRate;
+    uint32_t MaxLatency_us;
+    bool V1;
+    bool V3;
+    uint32_t FPGAMaxBaud;
+    uint32_t MCUMaxBaud;
+    uint32_t UnstableBaud;      // 0 if every rate is reliable
+    double UnstablePct;
+    bool Ack;
+    uint32_t AckDropEvery;      // 0 if every write is acknowledged
+    bool LoseFirstSysCtl;
+    double SleepEvery_s;        // 0 if the MCU never sleeps
+    uint32_t Sleep_ms;
+    bool SleepKeepBaud;
+    unsigned Seed;
+} Config_t;
+
+// State of the FPGA end, only touched by its thread
+typedef struct FPGASim {
+    int64_t WireFree_us;
+    int64_t LastValid_us;
+    uint32_t NumSequenced;
+    unsigned Seed;
+} FPGASim_t;
+
+// What the OSD modules would report to the FPGA tasks, and what they were told
+typedef struct OSDState {
+    _Atomic uint16_t PokedButtons;
+    _Atomic uint8_t PlayerNum;
+    _Atomic bool IsVisible;
+    _Atomic bool IsLPMActive;
+    _Atomic bool IsStyleInitialized;
+} OSDState_t;
+
+static Config_t Config = {
+    .Duration_s = 5.0,
+    .Rate_Hz = {
+        [kStream_Buttons]        = 60.0,
+        [kStream_VoltageAA]      = 2.0,
+        [kStream_VoltageLiPo]    = 2.0,
+        [kStream_PMIC]           = 1.0,
+        [kStream_BGPalette]      = 0.5,
+        [kStream_StatusExtended] = 4.0,
+        [kStream_AudioBrightness] = 2.0,
+    },
+    .PokeRate_Hz = 20.0,
+    .SysCtlRate_Hz = 2.0,
+    .FWVerRate_Hz = 1.0,
+    .BaudRate = kSysMgmtConsts_DefaultBaudRate,
+    .MaxLatency_us = 50000,     // Generous, the host scheduler adds jitter the firmware does not see
+    .FPGAMaxBaud = 2000000,
+    .MCUMaxBaud = 2000000,
+    .UnstablePct = 20.0,
+    .Sleep_ms = 1500,
+    .Seed = 1,
+};
+
+static const RxIDs_t StreamAddr[kNumStreams] = {
+    [kStream_Buttons]        = kRxCmd_Buttons,
+    [kStream_VoltageAA]      = kRxCmd_VoltageAA,
+    [kStream_VoltageLiPo]    = kRxCmd_VoltageLiPo,
+    [kStream_PMIC]           = kRxCmd_PMIC,
+    [kStream_BGPalette]      = kRxCmd_BGPalette,
+    [kStream_StatusExtended] = kRxCmd_StatusExtended,
+    [kStream_AudioBrightness] = kRxCmd_AudioBrightness,
+};
+
+static int Sockets[2];          // [0] MCU end, [1] FPGA end
+static int64_t Start_us;
+static volatile bool Running = true;
+static LinkCheck_t ToMCU = { .Lock = PTHREAD_MUTEX_INITIALIZER };
+static LinkCheck_t ToFPGA = { .Lock = PTHREAD_MUTEX_INITIALIZER };
+static _Atomic uint32_t FPGABaud;
+static OSDState_t OSD;
+
+// MCU Tx side, written under the shim's Tx lock
+static int64_t MCUWireFree_us;
+static unsigned MCUSeed;
+static bool IsSysCtlLost;
+static _Atomic uint64_t WantedSysCtl;       // Last SysCtl value the MCU put on the wire
+static _Atomic uint64_t NumBytesToFPGA;
+static _Atomic uint64_t NumBytesFedToFPGA;
+
+// Seen by the FPGA end
+static _Atomic uint64_t HeldSysCtl;         // Last SysCtl value the FPGA decoded
+static _Atomic bool IsSysCtlHeld;
+static uint32_t NumAcksDropped;
+
+static _Atomic int64_t FWVerRequested_us = -1;
+static uint32_t NumFWVerReplies;
+static uint32_t MaxFWVerRoundTrip_us;
+
+static _Atomic bool IsMCUAsleep;
+static _Atomic bool IsAwaitingResume;       // From the wake until the FPGA decodes the next frame from the Tx task
+static _Atomic uint32_t NumSleptThrough;    // FPGA frames nobody was awake to receive
+static _Atomic int64_t Woke_us;
+static uint32_t NumSleeps;
+static _Atomic uint32_t NumResumed;
+static _Atomic uint32_t MaxResume_us;
+
+static int64_t Now_us(void)
+{
+    struct timespec Now;
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (int64_t)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+}
+
+static void Sleep_us(const int64_t Delay_us)
+{
+    const struct timespec Delay = { .tv_sec = Delay_us / 1000000, .tv_nsec = (Delay_us % 1000000) * 1000 };
+    nanosleep(&Delay, NULL);
+}
+
+static uint32_t ByteTime_us(const uint32_t BaudRate)
+{
+    return (kBitsPerSymbol * 1000000u + BaudRate - 1) / BaudRate;
+}
+
+static bool Chance(const double Pct, unsigned *const pSeed)
+{
+    return (Pct > 0.0) && (((double)rand_r(pSeed) / RAND_MAX) * 100.0 < Pct);
+}
+
+static void Expect(LinkCheck_t *const pCheck, const uint8_t Addr, const uint64_t Value, const int64_t Sent_us)
+{
+    pthread_mutex_lock(&pCheck->Lock);
+
+    PendingQueue_t *const pQueue = &pCheck->Queues[Addr];
+    if ((pQueue->Tail - pQueue->Head) < kMaxPending)
+    {
+        pQueue->Entries[pQueue->Tail++ % kMaxPending] = (Pending_t){ .Value = Value, .Sent_us = Sent_us };
+    }
+    pCheck->NumSent++;
+
+    pthread_mutex_unlock(&pCheck->Lock);
+}
+
+// Frames on one address arrive in order, so anything ahead of the match was lost to a corrupted neighbour
+static void Match(LinkCheck_t *const pCheck, const uint8_t Addr, const uint64_t Value)
+{
+    const int64_t Received_us = Now_us();
+
+    pthread_mutex_lock(&pCheck->Lock);
+
+    if (Addr >= kFPGA_StatsConsts_NumAddrs)
+    {
+        // Only noise decodes to an address nothing is sent on
+        pCheck->NumPhantom++;
+        pthread_mutex_unlock(&pCheck->Lock);
+        return;
+    }
+
+    PendingQueue_t *const pQueue = &pCheck->Queues[Addr];
+    uint32_t Index = pQueue->Head;
+    while ((Index != pQueue->Tail) && (pQueue->Entries[Index % kMaxPending].Value != Value))
+    {
+        Index++;
+    }
+
+    // Requests and replies repeat the same payload, so a lost one would otherwise pair every later copy with the
+    // one sent before it. Prefer the oldest copy still within the latency budget.
+    for (uint32_t Later = Index; Later != pQueue->Tail; Later++)
+    {
+        const Pending_t *const pEntry = &pQueue->Entries[Later % kMaxPending];
+        if ((pEntry->Value == Value) && ((Received_us - pEntry->Sent_us) <= Config.MaxLatency_us))
+        {
+            Index = Later;
+            break;
+        }
+    }
+
+    if (Index == pQueue->Tail)
+    {
+        pCheck->NumPhantom++;
+        fprintf(stderr, "Phantom frame addr=%u value=%llx\n", Addr, (unsigned long long)Value);
+    }
+    else
+    {
+        const uint32_t Latency_us = (uint32_t)(Received_us - pQueue->Entries[Index % kMaxPending].Sent_us);
+
+        pCheck->NumLost += Index - pQueue->Head;
+        pCheck->NumMatched++;
+        pCheck->TotalLatency_us += Latency_us;
+        pCheck->MaxLatency_us = (Latency_us > pCheck->MaxLatency_us) ? Latency_us : pCheck->MaxLatency_us;
+        pCheck->NumLate += (Latency_us > Config.MaxLatency_us) ? 1 : 0;
+
+        pQueue->Head = Index + 1;
+    }
+
+    pthread_mutex_unlock(&pCheck->Lock);
+}
+
+// Encodes an FPGA to MCU frame following the codec implied by the schema width
+static size_t EncodeRx(uint8_t *const pBuffer, const size_t Size, const RxIDs_t eID, const uint64_t Value)
+{
+    const uint8_t Width = FPGA_RxSchema[eID].Width;
+    uint8_t Payload[sizeof(uint64_t)];
+
+    if (Config.V1)
+    {
+        // V1 packs 14 bits into two 7-bit bytes so the header marker stays unique
+        Payload[0] = (uint8_t)((Value >> 7) & 0x7F);
+        Payload[1] = (uint8_t)(Value & 0x7F);
+        return FPGA_Schema_EncodeFrame(pBuffer, Size, (uint8_t)eID, Payload, 2, true);
+    }
+
+    if (Width == 4)
+    {
+        // StatusExtended is little endian on the wire
+        for (uint8_t i = 0; i < Width; i++)
+        {
+            Payload[i] = (uint8_t)(Value >> (8 * i));
+        }
+        return FPGA_Schema_EncodeFrame(pBuffer, Size, (uint8_t)eID, Payload, Width, false);
+    }
+
+    return FPGA_Schema_EncodeBE(pBuffer, Size, (uint8_t)eID, Value, Width, false);
+}
+
+static uint64_t DecodeValue(const FPGA_Frame_t *const pFrame, const uint8_t Width)
+{
+    switch (Width)
+    {
+        case 4:
+            return FPGA_Frame_GetU32(pFrame);
+        case 8:
+            return FPGA_Frame_GetU64(pFrame);
+        default:
+            return FPGA_Frame_GetU16(pFrame);
+    }
+}
+
+static uint64_t MaskValue(const uint64_t Value, const uint8_t Width)
+{
+    if (Config.V1)
+    {
+        return Value & 0x3FFF;
+    }
+
+    return (Width >= sizeof(uint64_t)) ? Value : (Value & ((1ull << (8 * Width)) - 1));
+}
+
+// Value of an MCU to FPGA frame as the FPGA end sees it. A sequenced write carries its sequence number after the value.
+static uint64_t TxValue(const uint8_t Header, const uint8_t Addr, const uint8_t *const pPayload, const uint8_t Len)
+{
+    const uint8_t Width = FPGA_TxSchema[Addr].Width;
+    uint64_t Value = 0;
+
+    if (Header == kSysMgmtConsts_HeaderV1Marker)
+    {
+        Value = ((uint64_t)pPayload[0] << 8) | pPayload[1];
+    }
+    else
+    {
+        for (uint8_t i = 0; (i < Len) && (i < Width); i++)
+        {
+            Value = (Value << 8) | pPayload[i];
+        }
+    }
+
+    return MaskValue(Value, Config.V1 ? 2 : Width);
+}
+
+static void WriteAll(const int Fd, const uint8_t* pData, size_t Length)
+{
+    while (Length > 0)
+    {
+        const ssize_t Written = write(Fd, pData, Length);
+        if (Written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        pData += Written;
+        Length -= (size_t)Written;
+    }
+}
+
+// Holds the caller until the previous bytes would have been shifted out at the writer's baud rate
+static void PaceWire(int64_t *const pWireFree_us, const size_t NumBytes, const uint32_t BaudRate)
+{
+    const int64_t Now = Now_us();
+    if (*pWireFree_us > Now)
+    {
+        Sleep_us(*pWireFree_us - Now);
+    }
+
+    const int64_t Begin = (*pWireFree_us > Now) ? *pWireFree_us : Now;
+    *pWireFree_us = Begin + (int64_t)NumBytes * ByteTime_us(BaudRate);
+}
+
+// Models what the receiver sees: garbage while the two ends disagree on the rate, and occasional bit errors at
+// rates the board cannot sustain
+static bool Mangle(uint8_t *const pData, const size_t Length, const uint32_t BaudRate, const uint32_t PeerBaudRate, unsigned *const pSeed)
+{
+    if (BaudRate != PeerBaudRate)
+    {
+        for (size_t i = 0; i < Length; i++)
+        {
+            pData[i] ^= 0xA5;
+        }
+        return true;
+    }
+
+    if ((Config.UnstableBaud != 0) && (BaudRate >= Config.UnstableBaud) && Chance(Config.UnstablePct, pSeed))
+    {
+        pData[rand_r(pSeed) % Length] ^= (uint8_t)(1u << (rand_r(pSeed) % 8));
+        return true;
+    }
+
+    return false;
+}
+
+static void MarkCorrupted(LinkCheck_t *const pCheck, const uint32_t NumFrames)
+{
+    pthread_mutex_lock(&pCheck->Lock);
+    pCheck->NumCorrupted += NumFrames;
+    pthread_mutex_unlock(&pCheck->Lock);
+}
+
+static void AtomicMax(_Atomic uint32_t *const pMax, const uint32_t Value)
+{
+    uint32_t Current = atomic_load(pMax);
+    while ((Value > Current) && !atomic_compare_exchange_weak(pMax, &Current, Value))
+    {
+    }
+}
+
+static void FPGA_Send(FPGASim_t *const pSim, uint8_t *const pFrame, const size_t Size, const uint8_t Addr, const uint64_t Value, const bool IsCorrupted)
+{
+    const uint32_t BaudRate = atomic_load(&FPGABaud);
+
+    PaceWire(&pSim->WireFree_us, Size, BaudRate);
+    if (atomic_load(&IsMCUAsleep))
+    {
+        // The MCU only wakes on the line going low, and flushes what it received on the way down
+        atomic_fetch_add(&NumSleptThrough, 1);
+        return;
+    }
+
+    if (Mangle(pFrame, Size, BaudRate, Shim_Uart_GetBaudRate(), &pSim->Seed) || IsCorrupted)
+    {
+        MarkCorrupted(&ToMCU, 1);
+    }
+    else
+    {
+        Expect(&ToMCU, Addr, Value, Now_us());
+    }
+    WriteAll(Sockets[1], pFrame, Size);
+}
+
+static void FPGA_OnFrame(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    FPGASim_t *const pSim = (FPGASim_t*)pArg;
+    pSim->LastValid_us = Now_us();
+
+    if ((pFrame->Addr >= kNumTxCmds) || (FPGA_TxSchema[pFrame->Addr].pName == NULL))
+    {
+        Match(&ToFPGA, pFrame->Addr, UINT64_MAX);
+        return;
+    }
+
+    const uint8_t Width = FPGA_TxSchema[pFrame->Addr].Width;
+    const bool IsSequenced = FPGA_TxSchema[pFrame->Addr].IsCacheable && (pFrame->Header == kSysMgmtConsts_HeaderV2Marker) &&
+        (pFrame->Len == Width + 1);
+    const uint64_t Value = TxValue(pFrame->Header, pFrame->Addr, pFrame->pPayload, pFrame->Len);
+    Match(&ToFPGA, pFrame->Addr, Value);
+
+    // Anything from the Tx task after a wake means the brightness readback resumed it
+    if (atomic_exchange(&IsAwaitingResume, false))
+    {
+        AtomicMax(&MaxResume_us, (uint32_t)(Now_us() - atomic_load(&Woke_us)));
+        atomic_fetch_add(&NumResumed, 1);
+    }
+
+    if (pFrame->Addr == kTxCmd_SysCtrl)
+    {
+        atomic_store(&HeldSysCtl, Value);
+        atomic_store(&IsSysCtlHeld, true);
+    }
+
+    if (IsSequenced && Config.Ack)
+    {
+        pSim->NumSequenced++;
+        if ((Config.AckDropEvery != 0) && ((pSim->NumSequenced % Config.AckDropEvery) == 0))
+        {
+            NumAcksDropped++;
+        }
+        else
+        {
+            const uint16_t Ack = (uint16_t)((pFrame->Addr << 8) | pFrame->pPayload[Width]);
+            uint8_t Frame[kSysMgmtConsts_MaxMsgProtoV2Len];
+            const size_t Size = EncodeRx(Frame, sizeof(Frame), kRxCmd_ConfigAck, Ack);
+            FPGA_Send(pSim, Frame, Size, kRxCmd_ConfigAck, Ack, false);
+        }
+    }
+
+    if (Config.V3 && (pFrame->Addr == kTxCmd_LinkCtl) && ((Value >> 8) == kFPGA_LinkConsts_SetBaud))
+    {
+        const size_t Index = (size_t)(Value & 0xFF);
+        if ((Index < kNumFPGA_Bauds) && (FPGA_BaudRates[Index] <= Config.FPGAMaxBaud))
+        {
+            atomic_store(&FPGABaud, FPGA_BaudRates[Index]);
+        }
+    }
+
+    if ((pFrame->Addr == kTxCmd_ReqBGPD) && !Config.V1)
+    {
+        // The hotkey palette the MCU holds its palette writes back for
+        const uint64_t Palette = ((uint64_t)rand_r(&pSim->Seed) << 32) ^ (uint64_t)rand_r(&pSim->Seed);
+        uint8_t Frame[kSysMgmtConsts_MaxMsgProtoV2Len];
+        const size_t Size = EncodeRx(Frame, sizeof(Frame), kRxCmd_BGPalette, Palette);
+        FPGA_Send(pSim, Frame, Size, kRxCmd_BGPalette, Palette, false);
+    }
+
+    if (pFrame->Addr == kTxCmd_ReqFWVer)
+    {
+        // Reply like the real FPGA: debug bit clear, minor in [11:6], major in [5:0]
+        const uint64_t Version = (2u << 6) | 7u;
+        uint8_t Frame[kSysMgmtConsts_MaxMsgProtoV2Len];
+        size_t Size = 0;
+
+        if (Config.V3 && !Config.V1 && ((Value & kFPGA_LinkConsts_CapsRequest) != 0))
+        {
+            uint8_t BaudMask = 0;
+            for (size_t i = 0; i < kNumFPGA_Bauds; i++)
+            {
+                BaudMask |= (FPGA_BaudRates[i] <= Config.FPGAMaxBaud) ? (uint8_t)(1 << i) : 0;
+            }
+
+            const uint8_t Caps[kFPGA_LinkConsts_CapsLen] = {
+                (uint8_t)(Version >> 8), (uint8_t)Version, kFPGA_LinkConsts_ProtoVersion, BaudMask,
+                Config.Ack ? kFPGA_LinkFeature_Ack : kFPGA_LinkFeature_None
+            };
+            Size = FPGA_Schema_EncodeFrame(Frame, sizeof(Frame), kRxCmd_FWVer, Caps, sizeof(Caps), false);
+        }
+        else
+        {
+            Size = EncodeRx(Frame, sizeof(Frame), kRxCmd_FWVer, Version);
+        }
+
+        FPGA_Send(pSim, Frame, Size, kRxCmd_FWVer, Version, false);
+    }
+}
+
+static void* FPGA_Thread(void* pArg)
+{
+    (void)pArg;
+
+    FPGASim_t Sim = { .Seed = Config.Seed, .LastValid_us = Start_us };
+    unsigned *const pSeed = &Sim.Seed;
+    int64_t NextDue_us[kNumStreams];
+    static FPGA_Decoder_t Decoder;
+    uint8_t RxBuffer[kSysMgmtConsts_RxBufferSize];
+
+    FPGA_Decoder_Init(&Decoder, FPGA_OnFrame, &Sim);
+
+    for (size_t s = 0; s < kNumStreams; s++)
+    {
+        NextDue_us[s] = (Config.Rate_Hz[s] > 0.0) ? Start_us : INT64_MAX;
+        if (Config.V1 && (FPGA_RxSchema[StreamAddr[s]].Width != 2))
+        {
+            // Wider payloads do not exist on V1 FPGAs
+            NextDue_us[s] = INT64_MAX;
+        }
+    }
+
+    while (Running)
+    {
+        int64_t Earliest_us = INT64_MAX;
+        size_t Next = 0;
+        for (size_t s = 0; s < kNumStreams; s++)
+        {
+            if (NextDue_us[s] < Earliest_us)
+            {
+                Earliest_us = NextDue_us[s];
+                Next = s;
+            }
+        }
+
+        // A V3 FPGA falls back on its own when nothing decodes at a negotiated rate
+        const int64_t Now = Now_us();
+        if (Config.V3 && (atomic_load(&FPGABaud) != kSysMgmtConsts_DefaultBaudRate) &&
+            ((Now - Sim.LastValid_us) >= (int64_t)kFPGA_LinkConsts_LinkLoss * 1000))
+        {
+            atomic_store(&FPGABaud, kSysMgmtConsts_DefaultBaudRate);
+        }
+
+        // Service the MCU until the next frame is due
+        const int Timeout_ms = (Earliest_us == INT64_MAX) ? 10 : (int)((Earliest_us > Now) ? ((Earliest_us - Now + 999) / 1000) : 0);
+        struct pollfd Fd = { .fd = Sockets[1], .events = POLLIN };
+        if (poll(&Fd, 1, Timeout_ms) > 0)
+        {
+            const ssize_t ByteCount = read(Sockets[1], RxBuffer, sizeof(RxBuffer));
+            if (ByteCount > 0)
+            {
+                (void) FPGA_Decoder_Feed(&Decoder, RxBuffer, (size_t)ByteCount);
+                atomic_fetch_add(&NumBytesFedToFPGA, (uint64_t)ByteCount);
+            }
+            continue;
+        }
+
+        if ((Earliest_us == INT64_MAX) || (Now_us() < Earliest_us))
+        {
+            continue;
+        }
+
+        NextDue_us[Next] += (int64_t)(1000000.0 / Config.Rate_Hz[Next]);
+
+        const RxIDs_t eID = StreamAddr[Next];
+        const uint8_t Width = FPGA_RxSchema[eID].Width;
+        const uint64_t Value = MaskValue(((uint64_t)rand_r(pSeed) << 32) ^ (uint64_t)rand_r(pSeed), Width);
+
+        uint8_t Frame[kSysMgmtConsts_MaxMsgProtoV2Len + 8];
+        size_t Size = EncodeRx(Frame, sizeof(Frame), eID, Value);
+        bool IsCorrupted = false;
+
+        if (Chance(Config.CorruptPct, pSeed))
+        {
+            Frame[rand_r(pSeed) % Size] ^= (uint8_t)(1u << (rand_r(pSeed) % 8));
+            IsCorrupted = true;
+        }
+
+        if (Chance(Config.DropPct, pSeed))
+        {
+            const size_t Drop = (size_t)rand_r(pSeed) % Size;
+            memmove(&Frame[Drop], &Frame[Drop + 1], Size - Drop - 1);
+            Size--;
+            IsCorrupted = true;
+        }
+
+        if (Chance(Config.NoisePct, pSeed))
+        {
+            uint8_t Noise[8];
+            const size_t NumNoise = 1 + ((size_t)rand_r(pSeed) % sizeof(Noise));
+            for (size_t i = 0; i < NumNoise; i++)
+            {
+                Noise[i] = (uint8_t)rand_r(pSeed);
+            }
+            PaceWire(&Sim.WireFree_us, NumNoise, atomic_load(&FPGABaud));
+            WriteAll(Sockets[1], Noise, NumNoise);
+        }
+
+        FPGA_Send(&Sim, Frame, Size, (uint8_t)eID, Value, IsCorrupted);
+    }
+
+    return NULL;
+}
+
+// Length of the MCU to FPGA frame at pData, 0 if it isn't one
+static size_t TxFrameSize(const uint8_t *const pData, const size_t Length)
+{
+    if ((Length >= kSysMgmtConsts_MaxMsgProtoV1Len) && (pData[0] == kSysMgmtConsts_HeaderV1Marker))
+    {
+        return kSysMgmtConsts_MaxMsgProtoV1Len;
+    }
+
+    if ((Length >= 3) && (pData[0] == kSysMgmtConsts_HeaderV2Marker) && (pData[1] < kNumTxCmds))
+    {
+        const size_t Size = 3 + (size_t)pData[2] + 1;
+        return (Size <= Length) ? Size : 0;
+    }
+
+    return 0;
+}
+
+// uart_write_bytes() for the Tx task: the bytes go out at the MCU's rate, one frame at a time so that each can be
+// garbled or lost on its own
+static void MCU_UartWrite(const uint8_t *pData, const size_t Length, const uint32_t BaudRate)
+{
+    uint8_t Wire[kMaxTxWrite];
+    size_t WireLength = 0;
+
+    PaceWire(&MCUWireFree_us, Length, BaudRate);
+    const uint32_t PeerBaudRate = atomic_load(&FPGABaud);
+
+    size_t Offset = 0;
+    while ((Offset < Length) && (WireLength < sizeof(Wire)))
+    {
+        const uint8_t *const pFrame = &pData[Offset];
+        size_t Size = TxFrameSize(pFrame, Length - Offset);
+        if (Size == 0)
+        {
+            // Not something the firmware writes, pass it through unchecked
+            Size = Length - Offset;
+        }
+        Size = (Size < (sizeof(Wire) - WireLength)) ? Size : (sizeof(Wire) - WireLength);
+        Offset += Size;
+
+        const bool IsFrame = (TxFrameSize(pFrame, Size) == Size);
+        const bool IsV1 = IsFrame && (pFrame[0] == kSysMgmtConsts_HeaderV1Marker);
+        const uint8_t Addr = IsFrame ? pFrame[1] : 0;
+        const uint64_t Value = IsFrame ? TxValue(pFrame[0], Addr, &pFrame[IsV1 ? 2 : 3], IsV1 ? 2 : pFrame[2]) : 0;
+
+        if (IsFrame && (Addr == kTxCmd_SysCtrl))
+        {
+            if (Config.LoseFirstSysCtl && !IsSysCtlLost)
+            {
+                IsSysCtlLost = true;
+                continue;
+            }
+            atomic_store(&WantedSysCtl, Value);
+        }
+
+        memcpy(&Wire[WireLength], pFrame, Size);
+        if (Mangle(&Wire[WireLength], Size, BaudRate, PeerBaudRate, &MCUSeed) || !IsFrame)
+        {
+            MarkCorrupted(&ToFPGA, 1);
+        }
+        else
+        {
+            Expect(&ToFPGA, Addr, Value, Now_us());
+        }
+        WireLength += Size;
+    }
+
+    atomic_fetch_add(&NumBytesToFPGA, WireLength);
+    WriteAll(Sockets[0], Wire, WireLength);
+}
+
+// uart_wait_tx_done(). The real FPGA acts on a frame as its last bit arrives, here the other thread has to be given
+// the chance to decode it before anything is sent at a new rate.
+static bool MCU_UartWaitTxDone(const uint32_t BaudRate, const uint32_t Timeout_ms)
+{
+    PaceWire(&MCUWireFree_us, 0, BaudRate);
+
+    const int64_t GiveUp_us = Now_us() + ((Timeout_ms == UINT32_MAX) ? INT64_MAX / 2 : (int64_t)Timeout_ms * 1000);
+    while (atomic_load(&NumBytesFedToFPGA) < atomic_load(&NumBytesToFPGA))
+    {
+        if (Now_us() >= GiveUp_us)
+        {
+            return false;
+        }
+        sched_yield();
+    }
+
+    return true;
+}
+
+// Every frame the Rx task decodes, on top of the firmware's own handlers
+static void MCU_OnFrame(const FPGA_Frame_t *const pFrame, void* pArg)
+{
+    (void)pArg;
+
+    Match(&ToMCU, pFrame->Addr, DecodeValue(pFrame, FPGA_RxSchema[pFrame->Addr].Width));
+}
+
+// Mirrors PwrMgr_Task: pause both tasks, bring the link back to the default rate, sleep, and on wake leave the Tx task
+// to the brightness readback
+static void MCU_Sleep(void)
+{
+    FPGA_Tx_Pause();
+    FPGA_Rx_Pause();
+    (void) uart_flush(UART_NUM_1);
+    Button_ResetAll();
+    OSD_SetVisiblityState(false);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    if (!Config.SleepKeepBaud)
+    {
+        FPGA_Tx_RevertLink();
+    }
+
+    atomic_store(&IsMCUAsleep, true);
+    NumSleeps++;
+    Sleep_us((int64_t)Config.Sleep_ms * 1000);
+
+    // Whatever was on its way in when the MCU went down is dropped, and no longer expected
+    (void) uart_flush(UART_NUM_1);
+    pthread_mutex_lock(&ToMCU.Lock);
+    for (size_t a = 0; a < kFPGA_StatsConsts_NumAddrs; a++)
+    {
+        PendingQueue_t *const pQueue = &ToMCU.Queues[a];
+        atomic_fetch_add(&NumSleptThrough, pQueue->Tail - pQueue->Head);
+        pQueue->Head = pQueue->Tail;
+    }
+    pthread_mutex_unlock(&ToMCU.Lock);
+    atomic_store(&IsMCUAsleep, false);
+
+    atomic_store(&Woke_us, Now_us());
+    atomic_store(&IsAwaitingResume, true);
+    FPGA_Tx_ForceResync();
+    FPGA_Rx_UseBrightnessReadback();
+    FPGA_Rx_Resume();
+}
+
+// What the OSD does to the link while the menu is in use: button pokes, a setting that changes, and requests for
+// everything again
+static void MCU_Run(const int64_t End_us)
+{
+    const double Rates_Hz[] = { Config.PokeRate_Hz, Config.SysCtlRate_Hz, Config.FWVerRate_Hz };
+    int64_t NextDue_us[] = { Now_us(), Now_us(), Now_us() };
+    int64_t NextSleep_us = (Config.SleepEvery_s > 0.0) ? (Start_us + (int64_t)(Config.SleepEvery_s * 1e6)) : INT64_MAX;
+    unsigned Seed = Config.Seed * 7919u;
+
+    while (Now_us() < End_us)
+    {
+        Sleep_us(1000);
+        const int64_t Now = Now_us();
+
+        // Leave the link time to renegotiate after the last sleep before the run ends
+        if ((Now >= NextSleep_us) && !atomic_load(&IsAwaitingResume))
+        {
+            NextSleep_us += (int64_t)(Config.SleepEvery_s * 1e6);
+            if ((Now + (int64_t)Config.Sleep_ms * 1000 + 2 * (int64_t)kFPGA_LinkConsts_LinkLoss * 1000) < End_us)
+            {
+                MCU_Sleep();
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < sizeof(Rates_Hz) / sizeof(Rates_Hz[0]); i++)
+        {
+            if ((Rates_Hz[i] <= 0.0) || (Now < NextDue_us[i]))
+            {
+                continue;
+            }
+            NextDue_us[i] += (int64_t)(1000000.0 / Rates_Hz[i]);
+
+            switch (i)
+            {
+                case 0:
+                    atomic_store(&OSD.PokedButtons, (uint16_t)(1u << (rand_r(&Seed) % 12)));
+                    FPGA_Tx_PokeButtons();
+                    break;
+                case 1:
+                    // Keeps the payload clear of the V1 header markers
+                    atomic_store(&OSD.PlayerNum, (uint8_t)((atomic_load(&OSD.PlayerNum) + 1) % 8));
+                    FPGA_Tx_SendSysCtl();
+                    break;
+                default:
+                {
+                    int64_t Idle = -1;
+                    (void) atomic_compare_exchange_strong(&FWVerRequested_us, &Idle, Now);
+                    FPGA_Tx_SendAll();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Stand-ins for the OSD modules the FPGA tasks read settings from and report to
+
+void Battery_UpdateVoltage(const float batt_V, const BatteryKind_t eKind)
+{
+    (void)batt_V;
+    (void)eKind;
+}
+
+void Battery_SetChargingStatus(const bool IsCharging)
+{
+    (void)IsCharging;
+}
+
+uint8_t Brightness_GetLevel(void)
+{
+    return 8;
+}
+
+void Brightness_Update(const uint8_t Brightness)
+{
+    (void)Brightness;
+}
+
+void Brightness_SetLowPowerOverride(const bool Enable)
+{
+    (void)Enable;
+}
+
+void Button_Update(const uint16_t NewButtons)
+{
+    (void)NewButtons;
+}
+
+void Button_ResetAll(void)
+{
+}
+
+uint16_t Button_GetPokedInputs(void)
+{
+    return atomic_load(&OSD.PokedButtons);
+}
+
+ColorCorrectLCDState_t ColorCorrectLCD_GetState(void)
+{
+    return kColorCorrectLCDState_Off;
+}
+
+ColorCorrectUSBState_t ColorCorrectUSB_GetState(void)
+{
+    return kColorCorrectUSBState_Off;
+}
+
+DPadCtlState_t DPadCtl_GetState(void)
+{
+    return kDPadCtlState_AcceptDiag;
+}
+
+FrameBlendState_t FrameBlend_GetState(void)
+{
+    return kFrameBlendState_Off;
+}
+
+LowBattIconCtlState_t LowBattIconCtl_GetState(void)
+{
+    return kLowBattIconCtlState_AlwaysShow;
+}
+
+ScreenTransitCtlState_t ScreenTransitCtl_GetState(void)
+{
+    return kScreenTransitCtlState_Off;
+}
+
+SilentModeState_t SilentMode_GetState(void)
+{
+    return kSilentModeState_Off;
+}
+
+uint8_t PlayerNum_GetNum(void)
+{
+    return atomic_load(&OSD.PlayerNum);
+}
+
+void Firmware_SetFPGAVersion(uint8_t VersionMajor, uint8_t VersionMinor, uint8_t IsDebug)
+{
+    (void)VersionMajor;
+    (void)VersionMinor;
+    (void)IsDebug;
+
+    const int64_t Requested_us = atomic_exchange(&FWVerRequested_us, -1);
+    if (Requested_us >= 0)
+    {
+        const uint32_t RoundTrip_us = (uint32_t)(Now_us() - Requested_us);
+        MaxFWVerRoundTrip_us = (RoundTrip_us > MaxFWVerRoundTrip_us) ? RoundTrip_us : MaxFWVerRoundTrip_us;
+        NumFWVerReplies++;
+    }
+}
+
+bool OSD_IsVisible(void)
+{
+    return atomic_load(&OSD.IsVisible);
+}
+
+void OSD_SetVisiblityState(const bool IsVisible)
+{
+    atomic_store(&OSD.IsVisible, IsVisible);
+}
+
+void PwrMgr_IdleTimerPet(void)
+{
+}
+
+bool PwrMgr_IsLPMActive(void)
+{
+    return atomic_load(&OSD.IsLPMActive);
+}
+
+void PwrMgr_SetLPM(const bool Active)
+{
+    atomic_store(&OSD.IsLPMActive, Active);
+}
+
+bool Style_IsInitialized(void)
+{
+    return atomic_load(&OSD.IsStyleInitialized);
+}
+
+void Style_Initialize(void)
+{
+    atomic_store(&OSD.IsStyleInitialized, true);
+}
+
+StyleID_t Style_GetCurrID(void)
+{
+    return kPalette_Default;
+}
+
+uint64_t Style_GetPaletteBG(const StyleID_t ID)
+{
+    return 0x0123456789ABCDEFull ^ (uint64_t)ID;
+}
+
+void Style_SetGBCMode(const bool GBCMode)
+{
+    (void)GBCMode;
+}
+
+void Style_SetHKPaletteBG(const uint64_t paletteBG)
+{
+    (void)paletteBG;
+}
+
+static bool Report(const char* pName, LinkCheck_t *const pCheck, const bool AllowPhantoms)
+{
+    const uint32_t Avg_us = (pCheck->NumMatched > 0) ? (uint32_t)(pCheck->TotalLatency_us / pCheck->NumMatched) : 0;
+
+    uint32_t NumOutstanding = 0;
+    for (size_t a = 0; a < sizeof(pCheck->Queues) / sizeof(pCheck->Queues[0]); a++)
+    {
+        NumOutstanding += pCheck->Queues[a].Tail - pCheck->Queues[a].Head;
+    }
+
+    printf("%-10s sent %7u corrupted %6u matched %7u lost %5u phantom %3u late %4u outstanding %3u latency avg %6u max %6u us\n",
+        pName, pCheck->NumSent, pCheck->NumCorrupted, pCheck->NumMatched, pCheck->NumLost, pCheck->NumPhantom,
+        pCheck->NumLate, NumOutstanding, Avg_us, pCheck->MaxLatency_us);
+
+    const bool IsClean = (pCheck->NumCorrupted == 0);
+    bool Pass = (pCheck->NumLate == 0);
+    Pass = Pass && (AllowPhantoms || !IsClean || (pCheck->NumPhantom == 0));
+    Pass = Pass && (!IsClean || (pCheck->NumLost == 0));
+    // A handful of frames can still be on the wire when the run stops
+    Pass = Pass && (NumOutstanding <= 4);
+
+    return Pass;
+}
+
+static void PrintHistogram(const char* pName, const FPGA_Histogram_t *const pHistogram)
+{
+    printf("%s (us):", pName);
+    for (size_t i = 0; i < kFPGA_StatsConsts_NumHistBins; i++)
+    {
+        if (pHistogram->Bins[i] != 0)
+        {
+            printf(" >=%u:%u", (i == 0) ? 0u : (1u << (i - 1)), pHistogram->Bins[i]);
+        }
+    }
+    printf("\n");
+}
+
+static void Usage(const char* pArgv0)
+{
+    printf("Usage: %s [options]\n"
+           "  --duration S      run time in seconds (%.1f)\n"
+           "  --buttons HZ      button frame rate (%.1f)\n"
+           "  --voltage HZ      AA and LiPo voltage frame rate (%.1f)\n"
+           "  --pmic HZ         PMIC frame rate (%.1f)\n"
+           "  --palette HZ      BG palette readback rate (%.1f)\n"
+           "  --status HZ       StatusExtended frame rate (%.1f)\n"
+           "  --poke HZ         MCU button poke rate (%.1f)\n"
+           "  --sysctl HZ       rate the MCU changes its SysCtl setting (%.1f)\n"
+           "  --fwver HZ        rate the MCU sends everything again, FW version request included (%.1f)\n"
+           "  --corrupt PCT     chance of flipping a bit in an FPGA frame\n"
+           "  --drop PCT        chance of dropping a byte from an FPGA frame\n"
+           "  --noise PCT       chance of random bytes between FPGA frames\n"
+           "  --baud N          wire pacing (%u)\n"
+           "  --max-latency US  latency budget per frame (%u)\n"
+           "  --v1              use the V1 protocol\n"
+           "  --v3              answer the capability handshake and follow LinkCtl\n"
+           "  --fpga-max-baud N fastest rate the stand-in offers (%u)\n"
+           "  --mcu-max-baud N  fastest rate the MCU offers (%u)\n"
+           "  --unstable-baud N rates from N up lose frames\n"
+           "  --unstable-pct P  chance of a frame being hit at those rates (%.1f)\n"
+           "  --ack             offer acknowledged configuration writes in the handshake\n"
+           "  --ack-drop N      withhold every Nth acknowledgement\n"
+           "  --lose-first-sysctl drop the MCU's first SysCtl write on the wire\n"
+           "  --brightness HZ   AudioBrightness frame rate, which resumes the MCU after a sleep (%.1f)\n"
+           "  --sleep-every S   put the MCU into light sleep every S seconds\n"
+           "  --sleep-ms MS     length of each sleep (%u)\n"
+           "  --sleep-keep-baud sleep without reverting the link to the default rate first\n"
+           "  --seed N          random seed (%u)\n",
+           pArgv0, Config.Duration_s, Config.Rate_Hz[kStream_Buttons], Config.Rate_Hz[kStream_VoltageAA],
+           Config.Rate_Hz[kStream_PMIC], Config.Rate_Hz[kStream_BGPalette], Config.Rate_Hz[kStream_StatusExtended],
+           Config.PokeRate_Hz, Config.SysCtlRate_Hz, Config.FWVerRate_Hz, Config.BaudRate, Config.MaxLatency_us,
+           Config.FPGAMaxBaud, Config.MCUMaxBaud, Config.UnstablePct, Config.Rate_Hz[kStream_AudioBrightness],
+           Config.Sleep_ms, Config.Seed);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "duration",    required_argument, NULL, 'd' },
+        { "buttons",     required_argument, NULL, 'b' },
+        { "voltage",     required_argument, NULL, 'v' },
+        { "pmic",        required_argument, NULL, 'p' },
+        { "palette",     required_argument, NULL, 'P' },
+        { "status",      required_argument, NULL, 's' },
+        { "poke",        required_argument, NULL, 'k' },
+        { "sysctl",      required_argument, NULL, 'c' },
+        { "fwver",       required_argument, NULL, 'f' },
+        { "corrupt",     required_argument, NULL, 'x' },
+        { "drop",        required_argument, NULL, 'r' },
+        { "noise",       required_argument, NULL, 'n' },
+        { "baud",        required_argument, NULL, 'B' },
+        { "max-latency", required_argument, NULL, 'L' },
+        { "v1",          no_argument,       NULL, '1' },
+        { "v3",            no_argument,       NULL, '3' },
+        { "fpga-max-baud", required_argument, NULL, 'F' },
+        { "mcu-max-baud",  required_argument, NULL, 'M' },
+        { "unstable-baud", required_argument, NULL, 'U' },
+        { "unstable-pct",  required_argument, NULL, 'u' },
+        { "ack",           no_argument,       NULL, 'A' },
+        { "ack-drop",      required_argument, NULL, 'a' },
+        { "lose-first-sysctl", no_argument,   NULL, 'o' },
+        { "brightness",      required_argument, NULL, 'l' },
+        { "sleep-every",     required_argument, NULL, 'e' },
+        { "sleep-ms",        required_argument, NULL, 'm' },
+        { "sleep-keep-baud", no_argument,       NULL, 'K' },
+        { "seed",        required_argument, NULL, 'S' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'd': Config.Duration_s = atof(optarg); break;
+            case 'b': Config.Rate_Hz[kStream_Buttons] = atof(optarg); break;
+            case 'v': Config.Rate_Hz[kStream_VoltageAA] = Config.Rate_Hz[kStream_VoltageLiPo] = atof(optarg); break;
+            case 'p': Config.Rate_Hz[kStream_PMIC] = atof(optarg); break;
+            case 'P': Config.Rate_Hz[kStream_BGPalette] = atof(optarg); break;
+            case 's': Config.Rate_Hz[kStream_StatusExtended] = atof(optarg); break;
+            case 'k': Config.PokeRate_Hz = atof(optarg); break;
+            case 'c': Config.SysCtlRate_Hz = atof(optarg); break;
+            case 'f': Config.FWVerRate_Hz = atof(optarg); break;
+            case 'x': Config.CorruptPct = atof(optarg); break;
+            case 'r': Config.DropPct = atof(optarg); break;
+            case 'n': Config.NoisePct = atof(optarg); break;
+            case 'B': Config.BaudRate = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'L': Config.MaxLatency_us = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case '1': Config.V1 = true; break;
+            case '3': Config.V3 = true; break;
+            case 'F': Config.FPGAMaxBaud = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'M': Config.MCUMaxBaud = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'U': Config.UnstableBaud = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'u': Config.UnstablePct = atof(optarg); break;
+            case 'A': Config.Ack = true; break;
+            case 'a': Config.AckDropEvery = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'o': Config.LoseFirstSysCtl = true; break;
+            case 'l': Config.Rate_Hz[kStream_AudioBrightness] = atof(optarg); break;
+            case 'e': Config.SleepEvery_s = atof(optarg); break;
+            case 'm': Config.Sleep_ms = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'K': Config.SleepKeepBaud = true; break;
+            case 'S': Config.Seed = (unsigned)strtoul(optarg, NULL, 10); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    if ((Config.BaudRate == 0) || (socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets) != 0))
+    {
+        fprintf(stderr, "Failed to set up the link\n");
+        return 2;
+    }
+
+    // The same order as app_main(): the UART, then the link, then the Tx and Rx tasks
+#if CONFIG_CHROMATIC_FPGA_RX_EVENT_DRIVEN
+    (void) uart_driver_install(UART_NUM_1, kFPGA_TxConsts_BufferSize, kFPGA_RxConsts_BufferSize, kFPGA_RxConsts_EventQueueLen, FPGA_Rx_GetUartEventQueue(), 0);
+#else
+    (void) uart_driver_install(UART_NUM_1, kFPGA_TxConsts_BufferSize, kFPGA_RxConsts_BufferSize, 0, NULL, 0);
+#endif
+
+    // Negotiation always starts from the power-on default
+    const uint32_t InitialBaud = Config.V3 ? kSysMgmtConsts_DefaultBaudRate : Config.BaudRate;
+    (void) uart_set_baudrate(UART_NUM_1, InitialBaud);
+    atomic_store(&FPGABaud, InitialBaud);
+    MCUSeed = Config.Seed * 7927u;
+    Shim_Uart_Attach(Sockets[0], MCU_UartWrite, MCU_UartWaitTxDone);
+
+    FPGA_Link_Init(FPGA_GetLink(), Config.V3 ? Config.MCUMaxBaud : kSysMgmtConsts_DefaultBaudRate,
+        Config.Ack ? kFPGA_LinkFeature_Ack : kFPGA_LinkFeature_None);
+
+    for (size_t i = 0; i < kNumRxCmds; i++)
+    {
+        (void) FPGA_Rx_Subscribe((RxIDs_t)i, MCU_OnFrame, NULL);
+    }
+
+    FPGA_Stats_Reset();
+    Start_us = Now_us();
+
+    pthread_t FPGA;
+    pthread_create(&FPGA, NULL, FPGA_Thread, NULL);
+
+    (void) xTaskCreate(FPGA_TxTask, "fpga_tx_task", 8 * 1024, NULL, 1, FPGA_GetTxTaskHandle());
+    (void) xTaskCreate(FPGA_RxTask, "fpga_rx_task", 8 * 1024, NULL, 1, FPGA_GetRxTaskHandle());
+
+    const size_t kTransmitCfgCounts = 6;
+    for (size_t i = 0; (i < kTransmitCfgCounts) && !FPGA_Tx_IsConfigured(); i++)
+    {
+        FPGA_Tx_SendAll();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    FPGA_Tx_EndBootRepeats();
+
+    MCU_Run(Start_us + (int64_t)(Config.Duration_s * 1e6));
+
+    // The link has to settle on the fastest rate both ends offer that did not lose frames
+    uint32_t Expected = kSysMgmtConsts_DefaultBaudRate;
+    for (size_t i = 0; !Config.V1 && (i < kNumFPGA_Bauds); i++)
+    {
+        const uint32_t Rate = FPGA_BaudRates[i];
+        if ((Rate <= Config.FPGAMaxBaud) && (Rate <= Config.MCUMaxBaud) && ((Config.UnstableBaud == 0) || (Rate < Config.UnstableBaud)))
+        {
+            Expected = (Rate > Expected) ? Rate : Expected;
+        }
+    }
+
+    // A fallback can leave the FPGA at the old rate until its link loss timeout fires, and the next rate down is
+    // only tried after that, so give the negotiation a bounded time to converge
+    const FPGA_Link_t *const pLink = FPGA_GetLink();
+    const bool NoiseInjected = (Config.NoisePct > 0.0) || (Config.CorruptPct > 0.0) || (Config.DropPct > 0.0);
+    const int64_t SettleBy_us = Now_us() + 3 * (int64_t)kFPGA_LinkConsts_LinkLoss * 1000;
+    while (Config.V3 && (Now_us() < SettleBy_us) &&
+        ((Shim_Uart_GetBaudRate() != atomic_load(&FPGABaud)) || (pLink->eState == kFPGA_LinkState_Confirming) ||
+         (!NoiseInjected && (Shim_Uart_GetBaudRate() != Expected))))
+    {
+        Sleep_us(10000);
+    }
+
+    // Stop the Tx task and let the FPGA take in its last frames, then stop the FPGA and let the Rx task do the same
+    FPGA_Tx_Pause();
+    Sleep_us(50000);
+    Running = false;
+    pthread_join(FPGA, NULL);
+    Sleep_us(50000);
+    FPGA_Rx_Pause();
+
+    bool Pass = Report("FPGA->MCU", &ToMCU, NoiseInjected || Config.V1);
+    Pass = Report("MCU->FPGA", &ToFPGA, false) && Pass;
+
+    if (Config.V3)
+    {
+        const uint32_t Final = Shim_Uart_GetBaudRate();
+        printf("Link: MCU %u baud, FPGA %u baud, expected %u, %u fallbacks\n", Final, atomic_load(&FPGABaud), Expected, pLink->NumFallbacks);
+        // Injected errors look like a bad link at any rate, so only agreement between the ends can be checked then
+        Pass = Pass && (Final == atomic_load(&FPGABaud)) && (NoiseInjected || (Final == Expected));
+    }
+
+    const FPGA_Stats_t *const pStats = FPGA_Stats_Get();
+    uint32_t NumCRCErrors = 0;
+    uint32_t NumOversizeLen = 0;
+    for (size_t a = 0; a < kFPGA_StatsConsts_NumAddrs; a++)
+    {
+        NumCRCErrors += pStats->Cmds[kFPGA_Dir_Rx][a].NumCRCErrors;
+        NumOversizeLen += pStats->Cmds[kFPGA_Dir_Rx][a].NumOversizeLen;
+    }
+    printf("MCU decoder: %u CRC errors, %u oversize, %u bytes discarded; FW version round trips %u (max %u us)\n",
+        NumCRCErrors, NumOversizeLen, pStats->NumDiscardedBytes, NumFWVerReplies, MaxFWVerRoundTrip_us);
+
+    // A clean link only loses acks on purpose, and withholding some of them never exhausts the retries
+    const bool IsCleanLink = !NoiseInjected && (Config.UnstableBaud == 0) && (Config.AckDropEvery != 1);
+    // The feature rides on the V3 handshake, V1 FPGAs keep receiving plain writes
+    const bool ExpectAcks = Config.Ack && Config.V3 && !Config.V1;
+    if (Config.Ack)
+    {
+        printf("Config writes: %u acked, %u resent, %u given up, %u acks dropped\n",
+            pStats->NumConfigAcks, pStats->NumConfigResends, pStats->NumConfigGiveUps, NumAcksDropped);
+        Pass = Pass && (ExpectAcks == (pStats->NumConfigAcks > 0)) && (!IsCleanLink || (pStats->NumConfigGiveUps == 0));
+        // Every withheld ack has to be made up for by a resend
+        Pass = Pass && (!ExpectAcks || (Config.AckDropEvery == 0) || ((NumAcksDropped > 0) && (pStats->NumConfigResends > 0)));
+    }
+
+    // Whatever was lost on the way, the FPGA has to end up holding the MCU's setting
+    if (Config.LoseFirstSysCtl || (ExpectAcks && IsCleanLink))
+    {
+        const bool IsHeld = atomic_load(&IsSysCtlHeld) && (atomic_load(&HeldSysCtl) == atomic_load(&WantedSysCtl));
+        printf("SysCtl: MCU %04llx, FPGA %04llx%s\n", (unsigned long long)atomic_load(&WantedSysCtl),
+            (unsigned long long)atomic_load(&HeldSysCtl), atomic_load(&IsSysCtlHeld) ? "" : " (never received)");
+        Pass = Pass && IsHeld;
+    }
+
+    if (Config.SleepEvery_s > 0.0)
+    {
+        printf("Sleep: %u sleeps, %u resumed (slowest after %u us), %u FPGA frames slept through\n", NumSleeps,
+            atomic_load(&NumResumed), atomic_load(&MaxResume_us), atomic_load(&NumSleptThrough));
+        // A wake that never sees the brightness readback leaves the Tx task paused for good
+        Pass = Pass && (NumSleeps > 0) && (atomic_load(&NumResumed) == NumSleeps);
+    }
+    PrintHistogram("Rx inter-arrival", &pStats->RxInterArrival_us);
+    PrintHistogram("Rx latency", &pStats->RxLatency_us);
+
+    printf("%s\n", Pass ? "PASS" : "FAIL");
+    return Pass ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// The FPGA UART, carried over the simulator's socketpair, see shim.c
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int uart_port_t;
+
+#define UART_NUM_1  ((uart_port_t)1)
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
+
+esp_err_t uart_driver_install(uart_port_t Port, int RxBufferSize, int TxBufferSize, int QueueSize, QueueHandle_t *pQueue, int IntrFlags);
+int uart_write_bytes(uart_port_t Port, const void *pSrc, size_t Size);
+int uart_read_bytes(uart_port_t Port, void *pBuffer, uint32_t Length, TickType_t Ticks);
+esp_err_t uart_wait_tx_done(uart_port_t Port, TickType_t Ticks);
+esp_err_t uart_set_baudrate(uart_port_t Port, uint32_t BaudRate);
+esp_err_t uart_get_buffered_data_len(uart_port_t Port, size_t *pSize);
+esp_err_t uart_flush_input(uart_port_t Port);
+esp_err_t uart_flush(uart_port_t Port);
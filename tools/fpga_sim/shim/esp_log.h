@@ -0,0 +1,10 @@
+#pragma once
+
+// Errors and warnings go to stderr, the rest is dropped. No format checking, the firmware logs uint32_t with %lu.
+
+void Shim_Log(const char Level, const char *pTag, const char *pFormat, ...);
+
+#define ESP_LOGE(tag, ...)  Shim_Log('E', tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...)  Shim_Log('W', tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...)  do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, ...)  do { (void)(tag); } while (0)
@@ -0,0 +1,44 @@
+#pragma once
+
+// Just enough of FreeRTOS for the FPGA link tasks to run as host threads, see shim.c. One tick is a millisecond.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t EventBits_t;
+
+#define pdFALSE             ((BaseType_t)0)
+#define pdTRUE              ((BaseType_t)1)
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define portMAX_DELAY       ((TickType_t)UINT32_MAX)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+typedef struct ShimEventGroup* EventGroupHandle_t;
+typedef struct ShimQueue* QueueHandle_t;
+typedef struct ShimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+// Storage for a statically created event group, only ever used through its handle
+typedef struct StaticEventGroup {
+    uint8_t Storage[256];
+    long double Align;
+} StaticEventGroup_t;
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *const pBuffer);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xGroup, const EventBits_t Bits, const BaseType_t ClearOnExit, const BaseType_t WaitForAll, TickType_t Ticks);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xGroup, const EventBits_t Bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xGroup, const EventBits_t Bits);
+
+QueueHandle_t xQueueCreate(const UBaseType_t Length, const UBaseType_t ItemSize);
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *const pItem, TickType_t Ticks);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *const pItem, TickType_t Ticks);
+BaseType_t xQueueReset(QueueHandle_t xQueue);
+
+BaseType_t xTaskCreate(TaskFunction_t fnTask, const char *const pName, const uint32_t StackDepth, void *const pArg, UBaseType_t Priority, TaskHandle_t *const pHandle);
+void vTaskDelay(const TickType_t Ticks);
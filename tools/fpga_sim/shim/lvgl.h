@@ -0,0 +1,6 @@
+#pragma once
+
+// The OSD headers the FPGA tasks include only pass LVGL objects around by pointer
+
+typedef struct _lv_obj_t lv_obj_t;
+typedef struct _lv_style_t lv_style_t;
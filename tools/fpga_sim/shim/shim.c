@@ -0,0 +1,484 @@
+// Host threads standing in for the FreeRTOS objects and the UART driver the FPGA link tasks use, so that
+// main/fpga_rx.c, main/fpga_tx.c and main/fpga_common.c build unchanged for tools/fpga_sim.
+//
+// Tasks are threads. xTaskCreate() returns once the new task first blocks, as it would when creating a task of higher
+// priority, so that the event groups a task creates exist before anyone signals them.
+
+#include "shim.h"
+
+#include "driver/uart.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+struct ShimEventGroup {
+    pthread_mutex_t Lock;
+    pthread_cond_t Changed;
+    EventBits_t Bits;
+};
+
+_Static_assert(sizeof(struct ShimEventGroup) <= sizeof(((StaticEventGroup_t*)0)->Storage), "StaticEventGroup_t too small");
+
+struct ShimQueue {
+    pthread_mutex_t Lock;
+    pthread_cond_t Changed;
+    uint8_t *pItems;
+    UBaseType_t Length;
+    UBaseType_t ItemSize;
+    UBaseType_t Head;
+    UBaseType_t Count;
+};
+
+struct ShimTask {
+    pthread_t Thread;
+    TaskFunction_t fnTask;
+    void *pArg;
+    sem_t Started;
+};
+
+// The UART, one port is all the link uses
+typedef struct ShimUart {
+    pthread_mutex_t Lock;
+    pthread_cond_t Received;
+    pthread_mutex_t TxLock;
+    uint8_t *pRxBuffer;
+    size_t RxSize;
+    size_t RxHead;
+    size_t RxCount;
+    QueueHandle_t xEvents;
+    uint32_t BaudRate;
+    int Fd;
+    fnShim_UartWrite_t fnWrite;
+    fnShim_UartWaitTxDone_t fnWaitTxDone;
+} ShimUart_t;
+
+static __thread struct ShimTask *pCurrentTask;
+static ShimUart_t Uart = {
+    .Lock = PTHREAD_MUTEX_INITIALIZER,
+    .TxLock = PTHREAD_MUTEX_INITIALIZER,
+    .BaudRate = 115200,
+    .Fd = -1,
+};
+
+// First scheduling point of a task that is just starting hands control back to its creator
+static void Task_Yield(void)
+{
+    struct ShimTask *const pTask = pCurrentTask;
+    if (pTask != NULL)
+    {
+        pCurrentTask = NULL;
+        sem_post(&pTask->Started);
+    }
+}
+
+static void Cond_Init(pthread_cond_t *const pCond)
+{
+    pthread_condattr_t Attr;
+    pthread_condattr_init(&Attr);
+    pthread_condattr_setclock(&Attr, CLOCK_MONOTONIC);
+    pthread_cond_init(pCond, &Attr);
+    pthread_condattr_destroy(&Attr);
+}
+
+static struct timespec Deadline(const TickType_t Ticks)
+{
+    struct timespec When;
+    clock_gettime(CLOCK_MONOTONIC, &When);
+    When.tv_sec += Ticks / 1000;
+    When.tv_nsec += (long)(Ticks % 1000) * 1000000;
+    if (When.tv_nsec >= 1000000000)
+    {
+        When.tv_sec++;
+        When.tv_nsec -= 1000000000;
+    }
+    return When;
+}
+
+// Returns false once the deadline passed
+static bool Cond_Wait(pthread_cond_t *const pCond, pthread_mutex_t *const pLock, const TickType_t Ticks, const struct timespec *const pDeadline)
+{
+    if (Ticks == portMAX_DELAY)
+    {
+        pthread_cond_wait(pCond, pLock);
+        return true;
+    }
+
+    return (Ticks > 0) && (pthread_cond_timedwait(pCond, pLock, pDeadline) != ETIMEDOUT);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec Now;
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (int64_t)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+}
+
+const char *esp_err_to_name(esp_err_t Code)
+{
+    return (Code == ESP_OK) ? "ESP_OK" : "ESP_FAIL";
+}
+
+void Shim_Log(const char Level, const char *pTag, const char *pFormat, ...)
+{
+    va_list Args;
+    va_start(Args, pFormat);
+    fprintf(stderr, "%c (%s) ", Level, pTag);
+    vfprintf(stderr, pFormat, Args);
+    fprintf(stderr, "\n");
+    va_end(Args);
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *const pBuffer)
+{
+    struct ShimEventGroup *const pGroup = (struct ShimEventGroup*)pBuffer->Storage;
+    pthread_mutex_init(&pGroup->Lock, NULL);
+    Cond_Init(&pGroup->Changed);
+    pGroup->Bits = 0;
+    return pGroup;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xGroup, const EventBits_t Bits, const BaseType_t ClearOnExit, const BaseType_t WaitForAll, TickType_t Ticks)
+{
+    Task_Yield();
+
+    const struct timespec When = Deadline(Ticks);
+    pthread_mutex_lock(&xGroup->Lock);
+
+    EventBits_t Value = xGroup->Bits;
+    while (WaitForAll ? ((Value & Bits) != Bits) : ((Value & Bits) == 0))
+    {
+        if (!Cond_Wait(&xGroup->Changed, &xGroup->Lock, Ticks, &When))
+        {
+            Value = xGroup->Bits;
+            pthread_mutex_unlock(&xGroup->Lock);
+            return Value;
+        }
+        Value = xGroup->Bits;
+    }
+
+    if (ClearOnExit)
+    {
+        xGroup->Bits &= ~Bits;
+    }
+
+    pthread_mutex_unlock(&xGroup->Lock);
+    return Value;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xGroup, const EventBits_t Bits)
+{
+    pthread_mutex_lock(&xGroup->Lock);
+    xGroup->Bits |= Bits;
+    const EventBits_t Value = xGroup->Bits;
+    pthread_cond_broadcast(&xGroup->Changed);
+    pthread_mutex_unlock(&xGroup->Lock);
+    return Value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xGroup, const EventBits_t Bits)
+{
+    pthread_mutex_lock(&xGroup->Lock);
+    const EventBits_t Value = xGroup->Bits;
+    xGroup->Bits &= ~Bits;
+    pthread_mutex_unlock(&xGroup->Lock);
+    return Value;
+}
+
+QueueHandle_t xQueueCreate(const UBaseType_t Length, const UBaseType_t ItemSize)
+{
+    struct ShimQueue *const pQueue = calloc(1, sizeof(*pQueue));
+    if (pQueue == NULL)
+    {
+        return NULL;
+    }
+
+    pQueue->pItems = calloc(Length, ItemSize);
+    if (pQueue->pItems == NULL)
+    {
+        free(pQueue);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pQueue->Lock, NULL);
+    Cond_Init(&pQueue->Changed);
+    pQueue->Length = Length;
+    pQueue->ItemSize = ItemSize;
+    return pQueue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *const pItem, TickType_t Ticks)
+{
+    const struct timespec When = Deadline(Ticks);
+    pthread_mutex_lock(&xQueue->Lock);
+
+    while (xQueue->Count == xQueue->Length)
+    {
+        if (!Cond_Wait(&xQueue->Changed, &xQueue->Lock, Ticks, &When))
+        {
+            pthread_mutex_unlock(&xQueue->Lock);
+            return pdFALSE;
+        }
+    }
+
+    const UBaseType_t Tail = (xQueue->Head + xQueue->Count) % xQueue->Length;
+    memcpy(&xQueue->pItems[Tail * xQueue->ItemSize], pItem, xQueue->ItemSize);
+    xQueue->Count++;
+    pthread_cond_broadcast(&xQueue->Changed);
+
+    pthread_mutex_unlock(&xQueue->Lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *const pItem, TickType_t Ticks)
+{
+    Task_Yield();
+
+    const struct timespec When = Deadline(Ticks);
+    pthread_mutex_lock(&xQueue->Lock);
+
+    while (xQueue->Count == 0)
+    {
+        if (!Cond_Wait(&xQueue->Changed, &xQueue->Lock, Ticks, &When))
+        {
+            pthread_mutex_unlock(&xQueue->Lock);
+            return pdFALSE;
+        }
+    }
+
+    memcpy(pItem, &xQueue->pItems[xQueue->Head * xQueue->ItemSize], xQueue->ItemSize);
+    xQueue->Head = (xQueue->Head + 1) % xQueue->Length;
+    xQueue->Count--;
+    pthread_cond_broadcast(&xQueue->Changed);
+
+    pthread_mutex_unlock(&xQueue->Lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+    pthread_mutex_lock(&xQueue->Lock);
+    xQueue->Head = 0;
+    xQueue->Count = 0;
+    pthread_cond_broadcast(&xQueue->Changed);
+    pthread_mutex_unlock(&xQueue->Lock);
+    return pdPASS;
+}
+
+static void* Task_Entry(void *pArg)
+{
+    struct ShimTask *const pTask = (struct ShimTask*)pArg;
+    pCurrentTask = pTask;
+    pTask->fnTask(pTask->pArg);
+
+    // A task function that returns has failed, let its creator carry on
+    Task_Yield();
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fnTask, const char *const pName, const uint32_t StackDepth, void *const pArg, UBaseType_t Priority, TaskHandle_t *const pHandle)
+{
+    (void)pName;
+    (void)StackDepth;
+    (void)Priority;
+
+    struct ShimTask *const pTask = calloc(1, sizeof(*pTask));
+    if (pTask == NULL)
+    {
+        return pdFAIL;
+    }
+
+    pTask->fnTask = fnTask;
+    pTask->pArg = pArg;
+    sem_init(&pTask->Started, 0, 0);
+    if (pthread_create(&pTask->Thread, NULL, Task_Entry, pTask) != 0)
+    {
+        free(pTask);
+        return pdFAIL;
+    }
+
+    while ((sem_wait(&pTask->Started) != 0) && (errno == EINTR))
+    {
+    }
+
+    if (pHandle != NULL)
+    {
+        *pHandle = pTask;
+    }
+    return pdPASS;
+}
+
+void vTaskDelay(const TickType_t Ticks)
+{
+    Task_Yield();
+
+    const struct timespec Delay = { .tv_sec = Ticks / 1000, .tv_nsec = (long)(Ticks % 1000) * 1000000 };
+    nanosleep(&Delay, NULL);
+}
+
+// Takes in what arrives on the socket like the driver's Rx ISR: into the ring buffer, with an event per chunk that
+// says whether the line went idle after it
+static void* Uart_RxThread(void *pArg)
+{
+    (void)pArg;
+    uint8_t Chunk[128];
+
+    while (1)
+    {
+        struct pollfd Fd = { .fd = Uart.Fd, .events = POLLIN };
+        if (poll(&Fd, 1, -1) <= 0)
+        {
+            continue;
+        }
+
+        const ssize_t ByteCount = read(Uart.Fd, Chunk, sizeof(Chunk));
+        if (ByteCount <= 0)
+        {
+            return NULL;
+        }
+
+        pthread_mutex_lock(&Uart.Lock);
+        const size_t Free = Uart.RxSize - Uart.RxCount;
+        const size_t NumKept = ((size_t)ByteCount < Free) ? (size_t)ByteCount : Free;
+        for (size_t i = 0; i < NumKept; i++)
+        {
+            Uart.pRxBuffer[(Uart.RxHead + Uart.RxCount + i) % Uart.RxSize] = Chunk[i];
+        }
+        Uart.RxCount += NumKept;
+        pthread_cond_broadcast(&Uart.Received);
+        pthread_mutex_unlock(&Uart.Lock);
+
+        if (Uart.xEvents != NULL)
+        {
+            struct pollfd More = { .fd = Uart.Fd, .events = POLLIN };
+            const uart_event_t Event = {
+                .type = (NumKept < (size_t)ByteCount) ? UART_BUFFER_FULL : UART_DATA,
+                .size = NumKept,
+                .timeout_flag = (poll(&More, 1, 0) == 0),
+            };
+            (void) xQueueSend(Uart.xEvents, &Event, 0);
+        }
+    }
+}
+
+esp_err_t uart_driver_install(uart_port_t Port, int RxBufferSize, int TxBufferSize, int QueueSize, QueueHandle_t *pQueue, int IntrFlags)
+{
+    (void)Port;
+    (void)TxBufferSize;
+    (void)IntrFlags;
+
+    Uart.pRxBuffer = calloc((size_t)RxBufferSize, 1);
+    Uart.RxSize = (size_t)RxBufferSize;
+    Cond_Init(&Uart.Received);
+
+    if ((QueueSize > 0) && (pQueue != NULL))
+    {
+        *pQueue = xQueueCreate((UBaseType_t)QueueSize, sizeof(uart_event_t));
+        Uart.xEvents = *pQueue;
+    }
+
+    return (Uart.pRxBuffer != NULL) ? ESP_OK : ESP_FAIL;
+}
+
+void Shim_Uart_Attach(const int Fd, fnShim_UartWrite_t fnWrite, fnShim_UartWaitTxDone_t fnWaitTxDone)
+{
+    pthread_t Thread;
+
+    Uart.Fd = Fd;
+    Uart.fnWrite = fnWrite;
+    Uart.fnWaitTxDone = fnWaitTxDone;
+    pthread_create(&Thread, NULL, Uart_RxThread, NULL);
+}
+
+uint32_t Shim_Uart_GetBaudRate(void)
+{
+    return __atomic_load_n(&Uart.BaudRate, __ATOMIC_SEQ_CST);
+}
+
+int uart_write_bytes(uart_port_t Port, const void *pSrc, size_t Size)
+{
+    (void)Port;
+
+    pthread_mutex_lock(&Uart.TxLock);
+    Uart.fnWrite((const uint8_t*)pSrc, Size, Shim_Uart_GetBaudRate());
+    pthread_mutex_unlock(&Uart.TxLock);
+    return (int)Size;
+}
+
+// Blocks until Length bytes arrived or the time is up, like the driver
+int uart_read_bytes(uart_port_t Port, void *pBuffer, uint32_t Length, TickType_t Ticks)
+{
+    (void)Port;
+    Task_Yield();
+
+    uint8_t *const pOut = (uint8_t*)pBuffer;
+    const struct timespec When = Deadline(Ticks);
+    pthread_mutex_lock(&Uart.Lock);
+
+    while ((Uart.RxCount < Length) && Cond_Wait(&Uart.Received, &Uart.Lock, Ticks, &When))
+    {
+    }
+
+    const size_t NumRead = (Uart.RxCount < Length) ? Uart.RxCount : Length;
+    for (size_t i = 0; i < NumRead; i++)
+    {
+        pOut[i] = Uart.pRxBuffer[(Uart.RxHead + i) % Uart.RxSize];
+    }
+    Uart.RxHead = (Uart.RxHead + NumRead) % Uart.RxSize;
+    Uart.RxCount -= NumRead;
+
+    pthread_mutex_unlock(&Uart.Lock);
+    return (int)NumRead;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t Port, TickType_t Ticks)
+{
+    (void)Port;
+    Task_Yield();
+
+    pthread_mutex_lock(&Uart.TxLock);
+    const bool IsDone = Uart.fnWaitTxDone(Shim_Uart_GetBaudRate(), (Ticks == portMAX_DELAY) ? UINT32_MAX : Ticks);
+    pthread_mutex_unlock(&Uart.TxLock);
+    return IsDone ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t Port, uint32_t BaudRate)
+{
+    (void)Port;
+    __atomic_store_n(&Uart.BaudRate, BaudRate, __ATOMIC_SEQ_CST);
+    return ESP_OK;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t Port, size_t *pSize)
+{
+    (void)Port;
+    pthread_mutex_lock(&Uart.Lock);
+    *pSize = Uart.RxCount;
+    pthread_mutex_unlock(&Uart.Lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t Port)
+{
+    (void)Port;
+    pthread_mutex_lock(&Uart.Lock);
+    Uart.RxHead = 0;
+    Uart.RxCount = 0;
+    pthread_mutex_unlock(&Uart.Lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_flush(uart_port_t Port)
+{
+    return uart_flush_input(Port);
+}
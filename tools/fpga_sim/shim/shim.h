@@ -0,0 +1,16 @@
+#pragma once
+
+// Simulator side of the shim. The simulator owns the wire: every uart_write_bytes() is handed to fnWrite, which paces,
+// mangles and records the frames before putting them on the socket, and uart_wait_tx_done() asks fnWaitTxDone whether
+// the other end has taken in everything written so far. Bytes arriving on the socket are buffered by a reader thread,
+// which posts UART_DATA events to the queue given to uart_driver_install() the way the driver's ISR does.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*fnShim_UartWrite_t)(const uint8_t *pData, const size_t Length, const uint32_t BaudRate);
+typedef bool (*fnShim_UartWaitTxDone_t)(const uint32_t BaudRate, const uint32_t Timeout_ms);
+
+void Shim_Uart_Attach(const int Fd, fnShim_UartWrite_t fnWrite, fnShim_UartWaitTxDone_t fnWaitTxDone);
+uint32_t Shim_Uart_GetBaudRate(void);
@@ -0,0 +1,239 @@
+// Host-side driver for the OSD navigation benchmark.
+//
+// Walks the menu over the MCU console the way a user would: Down through the first items of a tab, then Right to the
+// next tab, for every tab and a number of rounds. Presses go in with the `poke` command, each followed by a release
+// since buttons are edge detected. The firmware times every frame that handled a press and samples the LVGL heap
+// after it (see `osd_nav`), so the tool only paces the presses and prints what the device measured.
+//
+// Build the firmware once with CONFIG_CHROMATIC_OSD_RETAINED=n and once with =y to compare creating the widgets on
+// every transition against keeping them. Open the OSD on the device first, presses are ignored while it is hidden.
+//
+// Build and run from this directory with:
+//   gcc -O2 osd_nav_bench.c -o osd_nav_bench
+//   ./osd_nav_bench --rounds 10 --items 4 /dev/ttyACM0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    kMaskDown  = 1 << 7,
+    kMaskRight = 1 << 5,
+    kNumTabs   = 5,
+    kPromptTimeout_ms = 2000,
+};
+
+static const char Prompt[] = "mcu> ";
+
+static struct {
+    unsigned Rounds;
+    unsigned Items;
+    unsigned Gap_ms;
+    bool Quiet;
+} Config = {
+    .Rounds = 10,
+    .Items = 4,
+    .Gap_ms = 60,
+};
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <serial device>\n"
+            "  --rounds N    Times to go through every tab (default %u)\n"
+            "  --items N     Down presses per tab (default %u)\n"
+            "  --gap-ms N    Delay after each press and release (default %u)\n"
+            "  --quiet       Don't echo the console during the presses\n"
+            "The OSD must be open on the device.\n",
+            pName, Config.Rounds, Config.Items, Config.Gap_ms);
+}
+
+static void Sleep_ms(const unsigned Delay_ms)
+{
+    struct timespec Ts = { .tv_sec = Delay_ms / 1000, .tv_nsec = (long)(Delay_ms % 1000) * 1000000L };
+    while ((nanosleep(&Ts, &Ts) != 0) && (errno == EINTR))
+    {
+    }
+}
+
+static int OpenSerial(const char *pPath)
+{
+    const int Fd = open(pPath, O_RDWR | O_NOCTTY);
+    if (Fd < 0)
+    {
+        fprintf(stderr, "Opening %s failed: %s\n", pPath, strerror(errno));
+        return -1;
+    }
+
+    struct termios Tio;
+    if (tcgetattr(Fd, &Tio) != 0)
+    {
+        fprintf(stderr, "%s is not a serial port: %s\n", pPath, strerror(errno));
+        close(Fd);
+        return -1;
+    }
+
+    cfmakeraw(&Tio);
+    cfsetispeed(&Tio, B115200);
+    cfsetospeed(&Tio, B115200);
+    Tio.c_cflag |= CLOCAL | CREAD;
+    Tio.c_cc[VMIN] = 0;
+    Tio.c_cc[VTIME] = 0;
+
+    if (tcsetattr(Fd, TCSANOW, &Tio) != 0)
+    {
+        fprintf(stderr, "Configuring %s failed: %s\n", pPath, strerror(errno));
+        close(Fd);
+        return -1;
+    }
+
+    (void) tcflush(Fd, TCIOFLUSH);
+    return Fd;
+}
+
+// Copies what the device sends to stdout until the prompt shows up or nothing arrives for a while
+static bool Drain(const int Fd, const bool Echo)
+{
+    size_t Matched = 0;
+
+    while (1)
+    {
+        struct pollfd Pfd = { .fd = Fd, .events = POLLIN };
+        const int Ready = poll(&Pfd, 1, kPromptTimeout_ms);
+        if (Ready <= 0)
+        {
+            return false;
+        }
+
+        char Buf[256];
+        const ssize_t Len = read(Fd, Buf, sizeof(Buf));
+        if (Len <= 0)
+        {
+            return false;
+        }
+
+        for (ssize_t i = 0; i < Len; i++)
+        {
+            if (Echo)
+            {
+                putchar(Buf[i]);
+            }
+
+            Matched = (Buf[i] == Prompt[Matched]) ? (Matched + 1) : ((Buf[i] == Prompt[0]) ? 1 : 0);
+            if (Matched == sizeof(Prompt) - 1)
+            {
+                fflush(stdout);
+                return true;
+            }
+        }
+    }
+}
+
+static bool Command(const int Fd, const char *pLine, const bool Echo)
+{
+    char Buf[64];
+    const int Len = snprintf(Buf, sizeof(Buf), "%s\r\n", pLine);
+
+    if (write(Fd, Buf, (size_t)Len) != Len)
+    {
+        fprintf(stderr, "Writing '%s' failed: %s\n", pLine, strerror(errno));
+        return false;
+    }
+
+    if (!Drain(Fd, Echo))
+    {
+        fprintf(stderr, "No prompt after '%s'\n", pLine);
+        return false;
+    }
+
+    return true;
+}
+
+static bool Press(const int Fd, const unsigned Mask)
+{
+    char Line[16];
+    (void) snprintf(Line, sizeof(Line), "poke %x", Mask);
+
+    if (!Command(Fd, Line, !Config.Quiet))
+    {
+        return false;
+    }
+
+    Sleep_ms(Config.Gap_ms);
+    const bool IsOk = Command(Fd, "poke 0", !Config.Quiet);
+    Sleep_ms(Config.Gap_ms);
+    return IsOk;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "rounds", required_argument, NULL, 'r' },
+        { "items",  required_argument, NULL, 'i' },
+        { "gap-ms", required_argument, NULL, 'g' },
+        { "quiet",  no_argument,       NULL, 'q' },
+        { "help",   no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'r': Config.Rounds = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'i': Config.Items = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'g': Config.Gap_ms = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'q': Config.Quiet = true; break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    if (optind != argc - 1)
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    const int Fd = OpenSerial(argv[optind]);
+    if (Fd < 0)
+    {
+        return 1;
+    }
+
+    // An empty line first so a half typed command on the device doesn't swallow the first one
+    bool IsOk = Command(Fd, "", false) && Command(Fd, "osd_nav -r", false) && Command(Fd, "osd_prof -r", false);
+
+    for (unsigned r = 0; IsOk && (r < Config.Rounds); r++)
+    {
+        for (unsigned t = 0; IsOk && (t < kNumTabs); t++)
+        {
+            for (unsigned i = 0; IsOk && (i < Config.Items); i++)
+            {
+                IsOk = Press(Fd, kMaskDown);
+            }
+
+            IsOk = IsOk && Press(Fd, kMaskRight);
+        }
+    }
+
+    const unsigned NumPresses = Config.Rounds * kNumTabs * (Config.Items + 1);
+    printf("\n%u presses sent\n", NumPresses);
+
+    IsOk = IsOk && Command(Fd, "osd_nav", true) && Command(Fd, "osd_prof", true);
+    putchar('\n');
+
+    close(Fd);
+    return IsOk ? 0 : 1;
+}
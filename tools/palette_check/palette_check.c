@@ -0,0 +1,428 @@
+// Host-side check for the 8-bit indexed OSD frame.
+//
+// Works out every RGB565 color the OSD can put in the frame and runs them through main/disp_palette.c, which must hold
+// them all without approximating any and expand each index back to the exact color it came from. The colors come from:
+//   - the image assets, as drawn: opaque pixels as they are, chroma keyed ones without the key, and alpha ones blended
+//     with LVGL's rounding over every color they could sit on,
+//   - the font glyphs at every opacity their bpp allows, in every UI color over every background,
+//   - the UI colors, found by scanning the given source trees for 0xRRGGBB literals and lv_color_make() calls.
+// Each image and glyph is then quantized into indices and expanded back the way the flush does, and compared bit for
+// bit. The union of all of the above is a worst case, the device only needs the colors of what it has drawn since the
+// last palette reset. A last pass overfills a palette to check that the nearest color fallback is counted.
+//
+// Build and run from this directory with:
+//   gcc -O2 -DLV_LVGL_H_INCLUDE_SIMPLE -I. -I../../main -I../../components/common palette_check.c ../../main/disp_palette.c ../../components/images/*.c ../../components/fonts/*.c -o palette_check
+//   ./palette_check ../../components ../../main
+//
+// The exit code is non-zero if the palette overflows or any color does not survive the round trip.
+
+#define _XOPEN_SOURCE 700
+
+#include "disp_palette.h"
+#include "lvgl.h"
+
+#include <ctype.h>
+#include <ftw.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    kWidth_px     = 160,
+    kHeight_px    = 144,
+    kNumPixels    = kWidth_px * kHeight_px,
+    kDrawRows     = 24,             // kDisp_FlushConsts_IndexedDrawPixels / kWidth_px
+    kNumBounce    = 4,              // kDisp_FlushConsts_NumBounceBufs
+    kBytesPerXfer = 1024,           // kDisp_FlushConsts_BytesPerXfer
+    kChromaKey    = 0xFF00FF,       // CONFIG_LV_COLOR_CHROMA_KEY_HEX
+    kMaxColors    = 1 << 16,
+    kMaxAssetPx   = 64 * 1024,
+};
+
+#define IMAGES(X)                                                                                                   \
+    X(icon_bat_large_g) X(icon_bat_large_r) X(icon_bat_large_y) X(icon_charging) X(icon_wifi) X(img_a_right)        \
+    X(img_arrow_down) X(img_arrow_up) X(img_b_left) X(img_brightness) X(img_chromatic) X(img_chromatic_eyebrow)     \
+    X(img_dot_grey) X(img_dot_white) X(img_option_dis) X(img_option_en) X(img_toggle_off) X(img_toggle_on)          \
+    X(menu_controls) X(menu_display) X(menu_palette) X(menu_status) X(menu_system)
+
+#define FONTS(X) X(chibit_mr) X(fingfai) X(jf_dot_k14)
+
+#define DECLARE_IMAGE(Name) extern const lv_img_dsc_t Name;
+#define DECLARE_FONT(Name) extern const lv_font_t Name;
+#define IMAGE_ENTRY(Name) { #Name, &Name },
+#define FONT_ENTRY(Name) { #Name, &Name },
+
+IMAGES(DECLARE_IMAGE)
+FONTS(DECLARE_FONT)
+
+static const struct {
+    const char *pName;
+    const lv_img_dsc_t *pImg;
+} Images[] = { IMAGES(IMAGE_ENTRY) };
+
+static const struct {
+    const char *pName;
+    const lv_font_t *pFont;
+} Fonts[] = { FONTS(FONT_ENTRY) };
+
+// A set of RGB565 colors, in the order they were first added
+typedef struct ColorSet {
+    bool IsMember[kMaxColors];
+    uint16_t Colors[kMaxColors];
+    size_t NumColors;
+} ColorSet_t;
+
+static struct {
+    bool IsVerbose;
+} Config = {
+    .IsVerbose = false,
+};
+
+static ColorSet_t UIColors;         // Literals in the sources
+static ColorSet_t Backgrounds;      // What a translucent pixel can land on
+static ColorSet_t AllColors;
+static unsigned NumFailures;
+
+// The font descriptors point at these, the check never calls them
+bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, void *dsc_out, uint32_t unicode_letter, uint32_t unicode_letter_next)
+{
+    (void) font;
+    (void) dsc_out;
+    (void) unicode_letter;
+    (void) unicode_letter_next;
+    return false;
+}
+
+const uint8_t *lv_font_get_bitmap_fmt_txt(const lv_font_t *font, uint32_t letter)
+{
+    (void) font;
+    (void) letter;
+    return NULL;
+}
+
+static void Add(ColorSet_t *const pSet, const uint16_t Color)
+{
+    if (!pSet->IsMember[Color])
+    {
+        pSet->IsMember[Color] = true;
+        pSet->Colors[pSet->NumColors++] = Color;
+    }
+}
+
+// lv_color_mix() at 16-bit depth, with the opacity thresholds of the software blend
+static uint16_t Mix(const uint16_t Fg, const uint16_t Bg, const uint8_t Opa)
+{
+    if (Opa >= 253)
+    {
+        return Fg;
+    }
+    if (Opa <= 2)
+    {
+        return Bg;
+    }
+
+    const uint32_t R = (((Fg >> 11) & 0x1F) * Opa + ((Bg >> 11) & 0x1F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    const uint32_t G = (((Fg >> 5) & 0x3F) * Opa + ((Bg >> 5) & 0x3F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    const uint32_t B = ((Fg & 0x1F) * Opa + (Bg & 0x1F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    return (uint16_t)((R << 11) | (G << 5) | B);
+}
+
+static void ScanSource(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    if (pFile == NULL)
+    {
+        return;
+    }
+
+    char Line[512];
+    while (fgets(Line, sizeof(Line), pFile) != NULL)
+    {
+        // 0xRRGGBB, exactly six digits so that register values and masks don't count
+        for (const char *p = Line; (p = strstr(p, "0x")) != NULL; p += 2)
+        {
+            size_t NumDigits = 0;
+            while (isxdigit((unsigned char)p[2 + NumDigits]))
+            {
+                NumDigits++;
+            }
+
+            if ((NumDigits == 6) && ((p == Line) || !isalnum((unsigned char)p[-1])))
+            {
+                Add(&UIColors, Disp_Palette_FromRGB888((uint32_t)strtoul(p, NULL, 16)));
+            }
+        }
+
+        unsigned R, G, B;
+        const char *pMake = strstr(Line, "lv_color_make(");
+        if ((pMake != NULL) && (sscanf(pMake, "lv_color_make(%i , %i , %i )", &R, &G, &B) == 3))
+        {
+            Add(&UIColors, Disp_Palette_FromRGB888(((R & 0xFF) << 16) | ((G & 0xFF) << 8) | (B & 0xFF)));
+        }
+    }
+
+    fclose(pFile);
+}
+
+static int OnSourceFile(const char *pPath, const struct stat *pStat, int Flag, struct FTW *pFtw)
+{
+    (void) pStat;
+    (void) pFtw;
+
+    const char *pExt = strrchr(pPath, '.');
+    if ((Flag == FTW_F) && (pExt != NULL) && ((strcmp(pExt, ".c") == 0) || (strcmp(pExt, ".h") == 0)))
+    {
+        ScanSource(pPath);
+    }
+
+    return 0;
+}
+
+// Quantizes the pixels and expands them back the way Disp_Flush does, one row at a time
+static void RoundTrip(Disp_Palette_t *const pPalette, const char *pName, const uint16_t *const pPixels, const size_t NumPixels, const size_t Width)
+{
+    static uint8_t Indices[kMaxAssetPx];
+    static uint16_t Expanded[kMaxAssetPx];
+
+    for (size_t i = 0; i < NumPixels; i += Width)
+    {
+        Disp_Palette_Quantize(pPalette, &pPixels[i], &Indices[i], Width);
+    }
+    Disp_Palette_Expand(pPalette, Indices, Expanded, NumPixels);
+
+    for (size_t i = 0; i < NumPixels; i++)
+    {
+        if (Expanded[i] != pPixels[i])
+        {
+            printf("%s: pixel %zu was 0x%04X, came back as 0x%04X\n", pName, i, pPixels[i], Expanded[i]);
+            NumFailures++;
+            return;
+        }
+    }
+}
+
+// Every way the image can show up in the frame, one row per background for the translucent formats
+static size_t Composite(const lv_img_dsc_t *const pImg, const uint16_t Bg, uint16_t *const pOut)
+{
+    const size_t NumPixels = (size_t)pImg->header.w * pImg->header.h;
+    const uint16_t Key = Disp_Palette_FromRGB888(kChromaKey);
+
+    for (size_t i = 0; i < NumPixels; i++)
+    {
+        switch (pImg->header.cf)
+        {
+            case LV_IMG_CF_TRUE_COLOR_ALPHA:
+            {
+                const uint8_t *const pPx = &pImg->data[i * LV_IMG_PX_SIZE_ALPHA_BYTE];
+                pOut[i] = Mix((uint16_t)(pPx[0] | (pPx[1] << 8)), Bg, pPx[2]);
+                break;
+            }
+
+            case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+            {
+                const uint16_t Px = (uint16_t)(pImg->data[i * 2] | (pImg->data[i * 2 + 1] << 8));
+                pOut[i] = (Px == Key) ? Bg : Px;
+                break;
+            }
+
+            default:
+                pOut[i] = (uint16_t)(pImg->data[i * 2] | (pImg->data[i * 2 + 1] << 8));
+                break;
+        }
+    }
+
+    return NumPixels;
+}
+
+static void CheckImages(Disp_Palette_t *const pPalette, const bool IsRoundTrip)
+{
+    static uint16_t Pixels[kMaxAssetPx];
+
+    for (size_t i = 0; i < sizeof(Images) / sizeof(Images[0]); i++)
+    {
+        const lv_img_dsc_t *const pImg = Images[i].pImg;
+        const bool IsOpaque = (pImg->header.cf == LV_IMG_CF_TRUE_COLOR);
+        const size_t NumBgs = IsOpaque ? 1 : Backgrounds.NumColors;
+        const size_t Before = AllColors.NumColors;
+
+        for (size_t b = 0; b < NumBgs; b++)
+        {
+            const size_t NumPixels = Composite(pImg, Backgrounds.Colors[b], Pixels);
+            if (IsRoundTrip)
+            {
+                RoundTrip(pPalette, Images[i].pName, Pixels, NumPixels, pImg->header.w);
+                continue;
+            }
+
+            for (size_t p = 0; p < NumPixels; p++)
+            {
+                Add(&AllColors, Pixels[p]);
+            }
+        }
+
+        if (!IsRoundTrip && Config.IsVerbose)
+        {
+            printf("  %-22s %3ux%-3u cf %u, %zu new colors\n", Images[i].pName, pImg->header.w, pImg->header.h,
+                   pImg->header.cf, AllColors.NumColors - Before);
+        }
+    }
+}
+
+// Glyph bitmaps are packed without row padding, so only the opacities that occur matter
+static void CheckFonts(Disp_Palette_t *const pPalette, const bool IsRoundTrip)
+{
+    static uint16_t Pixels[kMaxAssetPx];
+
+    for (size_t f = 0; f < sizeof(Fonts) / sizeof(Fonts[0]); f++)
+    {
+        const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)Fonts[f].pFont->dsc;
+        const unsigned Bpp = pDsc->bpp;
+        const unsigned NumLevels = 1u << Bpp;
+        const size_t Before = AllColors.NumColors;
+
+        for (size_t c = 0; c < UIColors.NumColors; c++)
+        {
+            for (size_t b = 0; b < Backgrounds.NumColors; b++)
+            {
+                for (unsigned Level = 0; Level < NumLevels; Level++)
+                {
+                    const uint8_t Opa = (uint8_t)((Level * 255u) / (NumLevels - 1));
+                    Pixels[Level] = Mix(UIColors.Colors[c], Backgrounds.Colors[b], Opa);
+                }
+
+                if (IsRoundTrip)
+                {
+                    RoundTrip(pPalette, Fonts[f].pName, Pixels, NumLevels, NumLevels);
+                    continue;
+                }
+
+                for (unsigned Level = 0; Level < NumLevels; Level++)
+                {
+                    Add(&AllColors, Pixels[Level]);
+                }
+            }
+        }
+
+        if (!IsRoundTrip && Config.IsVerbose)
+        {
+            printf("  %-22s %u bpp, %zu new colors\n", Fonts[f].pName, Bpp, AllColors.NumColors - Before);
+        }
+    }
+}
+
+static void CheckOverflow(void)
+{
+    static Disp_Palette_t Palette;
+    Disp_Palette_Init(&Palette);
+
+    const uint32_t NumSeeded = Palette.NumColors;
+    const uint32_t NumExtra = 64;
+    for (uint32_t i = 0; i < kDisp_PaletteConsts_NumColors + NumExtra; i++)
+    {
+        // Odd steps visit every 16-bit value once, none of them lands on a seeded color before the palette is full
+        (void) Disp_Palette_Lookup(&Palette, (uint16_t)(0x1000 + i * 0x9E37u));
+    }
+
+    const uint32_t Expected = NumSeeded + NumExtra;
+    if ((Palette.NumColors != kDisp_PaletteConsts_NumColors) || (Palette.NumApprox != Expected))
+    {
+        printf("Overfilled palette: %u colors and %lu approximated, expected %u and %lu\n", Palette.NumColors,
+               (unsigned long)Palette.NumApprox, kDisp_PaletteConsts_NumColors, (unsigned long)Expected);
+        NumFailures++;
+    }
+
+    // A color that made it in before the palette filled up still maps to itself
+    const uint16_t First = 0x1000;
+    if (Palette.Colors[Disp_Palette_Lookup(&Palette, First)] != First)
+    {
+        printf("Overfilled palette: 0x%04X no longer maps to itself\n", First);
+        NumFailures++;
+    }
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options] [source dirs...]\n"
+            "  --verbose  List the colors each asset adds\n"
+            "The source dirs are scanned for UI colors, ../../components and ../../main by default.\n",
+            pName);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "verbose", no_argument, NULL, 'v' },
+        { "help",    no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "vh", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'v': Config.IsVerbose = true; break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    static const char *DefaultDirs[] = { "../../components", "../../main" };
+    const char **ppDirs = (optind < argc) ? (const char**)&argv[optind] : DefaultDirs;
+    const int NumDirs = (optind < argc) ? (argc - optind) : (int)(sizeof(DefaultDirs) / sizeof(DefaultDirs[0]));
+
+    for (int d = 0; d < NumDirs; d++)
+    {
+        if (nftw(ppDirs[d], OnSourceFile, 16, FTW_PHYS) != 0)
+        {
+            fprintf(stderr, "Scanning %s failed\n", ppDirs[d]);
+            return 1;
+        }
+    }
+
+    // Anything translucent can land on the chroma key, on a UI fill or on an opaque image
+    Add(&Backgrounds, Disp_Palette_FromRGB888(kChromaKey));
+    for (size_t c = 0; c < UIColors.NumColors; c++)
+    {
+        Add(&Backgrounds, UIColors.Colors[c]);
+        Add(&AllColors, UIColors.Colors[c]);
+    }
+
+    printf("UI colors: %zu\n", UIColors.NumColors);
+    CheckImages(NULL, false);
+    printf("With images: %zu\n", AllColors.NumColors);
+    CheckFonts(NULL, false);
+    printf("With glyphs: %zu\n", AllColors.NumColors);
+
+    static Disp_Palette_t Palette;
+    Disp_Palette_Init(&Palette);
+    for (size_t c = 0; c < AllColors.NumColors; c++)
+    {
+        const uint16_t Color = AllColors.Colors[c];
+        if (Palette.Colors[Disp_Palette_Lookup(&Palette, Color)] != Color)
+        {
+            NumFailures++;
+        }
+    }
+
+    printf("Palette: %u of %u entries, %lu approximated\n", Palette.NumColors, kDisp_PaletteConsts_NumColors,
+           (unsigned long)Palette.NumApprox);
+
+    CheckImages(&Palette, true);
+    CheckFonts(&Palette, true);
+    CheckOverflow();
+
+    const size_t Direct = kNumPixels * 2;
+    const size_t Indexed = kNumPixels + kWidth_px * kDrawRows * 2 + kNumBounce * kBytesPerXfer;
+    printf("RAM: %zu bytes direct, %zu indexed (frame %u, draw buffer %u, bounce %u), %zu saved\n", Direct, Indexed,
+           kNumPixels, kWidth_px * kDrawRows * 2, kNumBounce * kBytesPerXfer, Direct - Indexed);
+
+    printf("%s\n", (NumFailures == 0) ? "PASS" : "FAIL");
+    return (NumFailures == 0) ? 0 : 1;
+}
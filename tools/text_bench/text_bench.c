@@ -0,0 +1,606 @@
+// Host-side check and micro-benchmark for the OSD text cache.
+//
+// Collects the OSD's label strings from the sources (the menu item names and the literals handed to
+// lv_label_set_text() and lv_label_set_text_static()) and draws each into a 160x144 RGB565 frame three ways, in every
+// OSD font and in white and grey:
+//   - The way LVGL 8's software renderer does. lv_draw_label() measures the line, then for every letter looks the
+//     glyph up once for its width and again in lv_draw_sw_letter(), which turns the glyph's bits into a mask byte per
+//     pixel and blends the color through the mask.
+//   - The same loop, with each letter drawn from the glyph atlas as the draw_letter hook in main/gfx.c does.
+//   - One lookup of the whole string in the cache and a single blit of its runs, as the labels' draw events do.
+// Each string is drawn at a spread of positions and clip areas, including partly off the frame, and all three frames
+// must match bit for bit. The frame is reset from the same random background before every draw.
+//
+// It then replays a navigation session against a range of budgets: every frame draws the strings of one screen (one
+// source file's worth), moving to another screen every few frames, and reports the hit rate, the bytes in use and
+// how many strings were dropped.
+//
+// Build and run from this directory with:
+//   gcc -O2 -DLV_LVGL_H_INCLUDE_SIMPLE -I../palette_check -I../../main text_bench.c ../../main/text_cache.c ../../components/fonts/*.c -o text_bench
+//   ./text_bench --iterations 2000
+//
+// The exit code is non-zero if the cached text differs from LVGL's or no strings were found.
+
+#include "text_cache.h"
+#include "lvgl.h"
+
+#include <dirent.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+    kWidth_px      = 160,
+    kHeight_px     = 144,
+    kNumPixels     = kWidth_px * kHeight_px,
+    kOpaMax        = 253,           // LV_OPA_MAX
+    kOpaMin        = 2,             // LV_OPA_MIN
+    kMaxStrings    = 256,
+    kMaxScreens    = 64,
+    kMaxLine       = 512,
+    kNumPositions  = 5,
+    kFramesPerScreen = 8,
+};
+
+#define FONTS(X) X(chibit_mr) X(fingfai) X(jf_dot_k14)
+
+#define DECLARE_FONT(Name) extern const lv_font_t Name;
+#define FONT_ENTRY(Name) { #Name, &Name },
+
+FONTS(DECLARE_FONT)
+
+static const struct {
+    const char *pName;
+    const lv_font_t *pFont;
+} Fonts[] = { FONTS(FONT_ENTRY) };
+
+#define NUM_FONTS (sizeof(Fonts) / sizeof(Fonts[0]))
+
+static const uint16_t Colors[] = { 0xFFFF, 0x8410 };
+
+static const size_t Budgets[] = { 256, 512, 1024, 2048, 4096, 8192, 12288, 16384 };
+
+static struct {
+    const char *pMain;
+    const char *pComponents;
+    unsigned Iterations;
+    unsigned Frames;
+    uint32_t Seed;
+} Config = {
+    .pMain = "../../main/osd_default.c",
+    .pComponents = "../../components/osd",
+    .Iterations = 2000,
+    .Frames = 2000,
+    .Seed = 1,
+};
+
+// Every string found, and which screen it was found on
+static struct {
+    char *pText;
+    size_t Screen;
+} Strings[kMaxStrings];
+static size_t NumStrings;
+static size_t NumScreens;
+
+static uint16_t Background[kNumPixels];
+static uint16_t FrameStock[kNumPixels];
+static uint16_t FrameGlyphs[kNumPixels];
+static uint16_t FrameCached[kNumPixels];
+static uint32_t Rng;
+
+static uint32_t Random(void)
+{
+    // xorshift32, the same sequence on every run for a given seed
+    Rng ^= Rng << 13;
+    Rng ^= Rng >> 17;
+    Rng ^= Rng << 5;
+    return Rng;
+}
+
+static uint64_t Now_ns(void)
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return (uint64_t)Ts.tv_sec * 1000000000ull + (uint64_t)Ts.tv_nsec;
+}
+
+// RGB565 per channel, rounded the way LVGL's LV_UDIV255 does
+static uint16_t Mix(const uint16_t Fg, const uint16_t Bg, const uint8_t Opa)
+{
+    const uint32_t R = (((Fg >> 11) & 0x1F) * Opa + ((Bg >> 11) & 0x1F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    const uint32_t G = (((Fg >> 5) & 0x3F) * Opa + ((Bg >> 5) & 0x3F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    const uint32_t B = ((Fg & 0x1F) * Opa + (Bg & 0x1F) * (255u - Opa) + 128u) * 0x8081u >> 23;
+    return (uint16_t)((R << 11) | (G << 5) | B);
+}
+
+// The fonts are linked in, but not LVGL's font engine
+bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, void *dsc_out, uint32_t unicode_letter, uint32_t unicode_letter_next)
+{
+    (void) font;
+    (void) dsc_out;
+    (void) unicode_letter;
+    (void) unicode_letter_next;
+    return false;
+}
+
+const uint8_t *lv_font_get_bitmap_fmt_txt(const lv_font_t *font, uint32_t letter)
+{
+    (void) font;
+    (void) letter;
+    return NULL;
+}
+
+static int CompareCodepoint(const void *pKey, const void *pElement)
+{
+    return (int)*(const uint16_t*)pKey - (int)*(const uint16_t*)pElement;
+}
+
+// get_glyph_dsc_id() in lv_font_fmt_txt.c, including its cache of the last letter
+static uint32_t LookupGlyph(const lv_font_t *const pFont, const uint32_t Letter)
+{
+    static const lv_font_t *pLastFont;
+    static uint32_t LastLetter;
+    static uint32_t LastId;
+    if ((pFont == pLastFont) && (Letter == LastLetter))
+    {
+        return LastId;
+    }
+
+    const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+    uint32_t Id = 0;
+    for (size_t c = 0; (c < pDsc->cmap_num) && (Id == 0); c++)
+    {
+        const lv_font_fmt_txt_cmap_t *const pCmap = &pDsc->cmaps[c];
+        const uint32_t Rcp = Letter - pCmap->range_start;
+        if ((Letter < pCmap->range_start) || (Rcp > pCmap->range_length))
+        {
+            continue;
+        }
+
+        if (pCmap->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY)
+        {
+            Id = pCmap->glyph_id_start + Rcp;
+        }
+        else if (pCmap->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL)
+        {
+            Id = pCmap->glyph_id_start + ((const uint8_t*)pCmap->glyph_id_ofs_list)[Rcp];
+        }
+        else
+        {
+            const uint16_t Key = (uint16_t)Rcp;
+            const uint16_t *const pFound = bsearch(&Key, pCmap->unicode_list, pCmap->list_length, sizeof(Key),
+                                                   CompareCodepoint);
+            const size_t i = (pFound != NULL) ? (size_t)(pFound - pCmap->unicode_list) : 0;
+            Id = (pFound == NULL) ? 0 : (pCmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY)
+                ? (pCmap->glyph_id_start + i) : (pCmap->glyph_id_start + ((const uint16_t*)pCmap->glyph_id_ofs_list)[i]);
+        }
+    }
+
+    pLastFont = pFont;
+    LastLetter = Letter;
+    LastId = Id;
+    return Id;
+}
+
+static int32_t GlyphWidth(const lv_font_t *const pFont, const uint32_t Letter)
+{
+    const uint32_t Id = LookupGlyph(pFont, Letter);
+    const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+    return (Id != 0) ? (int32_t)((pDsc->glyph_dsc[Id].adv_w + (1 << 3)) >> 4) : 0;
+}
+
+// Where the label's content box lands and which part of the frame may be drawn, like LVGL's coords and clip area
+typedef struct Placement {
+    int32_t x;
+    int32_t y;
+    TextCache_Rect_t Clip;
+} Placement_t;
+
+// lv_draw_sw_letter() for a 1 bpp glyph: the visible part of its box becomes a mask, blended through at full opacity
+static void StockLetter(const lv_font_t *const pFont, const uint32_t Letter, const uint16_t Color, const int32_t x, const int32_t y, const TextCache_Rect_t *const pClip, uint16_t *const pFrame)
+{
+    static const uint8_t Opa1Bpp[2] = { 0, 255 };
+    static uint8_t Mask[256 * 64];
+
+    const uint32_t Id = LookupGlyph(pFont, Letter);
+    if (Id == 0)
+    {
+        return;
+    }
+
+    const lv_font_fmt_txt_dsc_t *const pDsc = (const lv_font_fmt_txt_dsc_t*)pFont->dsc;
+    const lv_font_fmt_txt_glyph_dsc_t *const pGlyph = &pDsc->glyph_dsc[Id];
+    const uint8_t *const pBitmap = &pDsc->glyph_bitmap[pGlyph->bitmap_index];
+    const int32_t PosX = x + pGlyph->ofs_x;
+    const int32_t PosY = y + (pFont->line_height - pFont->base_line) - pGlyph->box_h - pGlyph->ofs_y;
+    if ((PosX + pGlyph->box_w < pClip->x1) || (PosX > pClip->x2) || (PosY + pGlyph->box_h < pClip->y1) ||
+        (PosY > pClip->y2))
+    {
+        return;
+    }
+
+    const int32_t ColStart = (PosX >= pClip->x1) ? 0 : (pClip->x1 - PosX);
+    const int32_t ColEnd = (PosX + pGlyph->box_w <= pClip->x2) ? pGlyph->box_w : (pClip->x2 - PosX + 1);
+    const int32_t RowStart = (PosY >= pClip->y1) ? 0 : (pClip->y1 - PosY);
+    const int32_t RowEnd = (PosY + pGlyph->box_h <= pClip->y2) ? pGlyph->box_h : (pClip->y2 - PosY + 1);
+    const int32_t MaskW = ColEnd - ColStart;
+
+    size_t m = 0;
+    for (int32_t Row = RowStart; Row < RowEnd; Row++)
+    {
+        for (int32_t Col = ColStart; Col < ColEnd; Col++)
+        {
+            const uint32_t Bit = (uint32_t)(Row * pGlyph->box_w + Col);
+            Mask[m++] = Opa1Bpp[(pBitmap[Bit >> 3] >> (7 - (Bit & 0x7))) & 0x1];
+        }
+    }
+
+    // The software blend with a mask
+    m = 0;
+    for (int32_t Row = RowStart; Row < RowEnd; Row++)
+    {
+        uint16_t *const pDst = &pFrame[(size_t)(PosY + Row) * kWidth_px + (size_t)(PosX + ColStart)];
+        for (int32_t i = 0; i < MaskW; i++, m++)
+        {
+            if (Mask[m] >= kOpaMax)
+            {
+                pDst[i] = Color;
+            }
+            else if (Mask[m] > kOpaMin)
+            {
+                pDst[i] = Mix(Color, pDst[i], Mask[m]);
+            }
+        }
+    }
+}
+
+// lv_draw_label() for one left aligned line: the line is measured first, then every letter is measured again as the
+// pen moves and drawn through the draw context's hook
+static void DrawLabel(const lv_font_t *const pFont, const char *const pText, const uint16_t Color, const Placement_t *const pPlace, uint16_t *const pFrame, const bool IsAtlas)
+{
+    int32_t LineWidth = 0;
+    for (const char *p = pText; *p != '\0'; p++)
+    {
+        LineWidth += GlyphWidth(pFont, (uint8_t)*p);
+    }
+
+    if (LineWidth > kWidth_px * 4)
+    {
+        return;
+    }
+
+    int32_t Pen = pPlace->x;
+    for (const char *p = pText; *p != '\0'; p++)
+    {
+        const uint32_t Letter = (uint8_t)*p;
+        const int32_t LetterW = GlyphWidth(pFont, Letter);
+        if (!IsAtlas ||
+            !TextCache_DrawGlyph(pFont, Letter, Color, Pen, pPlace->y, &pPlace->Clip, pFrame, kWidth_px))
+        {
+            StockLetter(pFont, Letter, Color, Pen, pPlace->y, &pPlace->Clip, pFrame);
+        }
+        Pen += LetterW;
+    }
+}
+
+static bool DrawCached(const lv_font_t *const pFont, const char *const pText, const uint16_t Color, const Placement_t *const pPlace, uint16_t *const pFrame)
+{
+    const TextCache_Entry_t *const pEntry = TextCache_Get(pFont, pText);
+    if (pEntry == NULL)
+    {
+        return false;
+    }
+
+    TextCache_Blit(pEntry, Color, pPlace->x, pPlace->y, &pPlace->Clip, pFrame, kWidth_px);
+    return true;
+}
+
+static void BuildPlacements(const int32_t Width, const int32_t Height, Placement_t *const pPlaces)
+{
+    const TextCache_Rect_t Frame = { 0, 0, kWidth_px - 1, kHeight_px - 1 };
+
+    // Inside, hanging off the left and the top, off the right and the bottom, and cut by a smaller clip area
+    pPlaces[0] = (Placement_t){ .x = 4, .y = 6, .Clip = Frame };
+    pPlaces[1] = (Placement_t){ .x = -Width / 3, .y = -Height / 2, .Clip = Frame };
+    pPlaces[2] = (Placement_t){ .x = kWidth_px - Width / 2, .y = kHeight_px - Height + 2, .Clip = Frame };
+    pPlaces[3] = (Placement_t){ .x = 13, .y = 41, .Clip = { 17, 43, 13 + Width / 2, 41 + Height - 3 } };
+    pPlaces[4] = (Placement_t){ .x = 7, .y = 97, .Clip = { 30, 0, kWidth_px - 1, 100 } };
+}
+
+static void AddString(const char *const pText, const size_t Length, const size_t Screen)
+{
+    for (size_t i = 0; i < Length; i++)
+    {
+        // Escapes such as \n make the label more than one line, which LVGL draws
+        if ((pText[i] == '\\') || (pText[i] == '%'))
+        {
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < NumStrings; i++)
+    {
+        if ((strlen(Strings[i].pText) == Length) && (strncmp(Strings[i].pText, pText, Length) == 0) &&
+            (Strings[i].Screen == Screen))
+        {
+            return;
+        }
+    }
+
+    if ((Length > 0) && (NumStrings < kMaxStrings))
+    {
+        Strings[NumStrings].pText = strndup(pText, Length);
+        Strings[NumStrings].Screen = Screen;
+        NumStrings++;
+    }
+}
+
+// One screen per file, made of the strings its widgets show
+static void ScanFile(const char *const pPath)
+{
+    FILE *const pFile = fopen(pPath, "r");
+    if ((pFile == NULL) || (NumScreens >= kMaxScreens))
+    {
+        if (pFile != NULL)
+        {
+            fclose(pFile);
+        }
+        return;
+    }
+
+    const size_t Before = NumStrings;
+    char Line[kMaxLine];
+    while (fgets(Line, sizeof(Line), pFile) != NULL)
+    {
+        const char *pStart = NULL;
+        if ((strstr(Line, ".Name = \"") != NULL) || (strstr(Line, "lv_label_set_text") != NULL))
+        {
+            pStart = strchr(Line, '"');
+        }
+
+        const char *const pEnd = (pStart != NULL) ? strchr(pStart + 1, '"') : NULL;
+        if (pEnd != NULL)
+        {
+            AddString(pStart + 1, (size_t)(pEnd - pStart - 1), NumScreens);
+        }
+    }
+    fclose(pFile);
+
+    NumScreens += (NumStrings > Before) ? 1 : 0;
+}
+
+static bool ScanDir(const char *const pPath)
+{
+    DIR *const pDir = opendir(pPath);
+    if (pDir == NULL)
+    {
+        return false;
+    }
+
+    const struct dirent *pEntry;
+    while ((pEntry = readdir(pDir)) != NULL)
+    {
+        const size_t Length = strlen(pEntry->d_name);
+        if (pEntry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        char Path[kMaxLine];
+        snprintf(Path, sizeof(Path), "%s/%s", pPath, pEntry->d_name);
+        if ((Length > 2) && (strcmp(&pEntry->d_name[Length - 2], ".c") == 0))
+        {
+            ScanFile(Path);
+        }
+        else
+        {
+            (void) ScanDir(Path);
+        }
+    }
+
+    closedir(pDir);
+    return true;
+}
+
+static void ReplaySession(const size_t Budget)
+{
+    TextCache_Clear();
+    TextCache_SetBudget(Budget);
+
+    const TextCache_Stats_t Start = *TextCache_GetStats();
+    uint32_t PeakBytes = 0;
+    size_t Screen = 0;
+    for (unsigned f = 0; f < Config.Frames; f++)
+    {
+        if ((f % kFramesPerScreen) == 0)
+        {
+            Screen = Random() % NumScreens;
+        }
+
+        // A label shows its text in one font, which differs between the titles and the items
+        for (size_t s = 0; s < NumStrings; s++)
+        {
+            if (Strings[s].Screen == Screen)
+            {
+                const lv_font_t *const pFont = Fonts[1 + (s % 2)].pFont;
+                (void) TextCache_Get(pFont, Strings[s].pText);
+            }
+        }
+
+        const uint32_t Bytes = TextCache_GetStats()->Bytes;
+        PeakBytes = (Bytes > PeakBytes) ? Bytes : PeakBytes;
+    }
+
+    const TextCache_Stats_t *const pEnd = TextCache_GetStats();
+    const uint32_t Lookups = pEnd->Lookups - Start.Lookups;
+    const uint32_t Hits = pEnd->Hits - Start.Hits;
+    printf("%8lu %8lu %7lu.%02lu%% %8lu %8lu %10lu\n", (unsigned long)Budget, (unsigned long)Lookups,
+           (unsigned long)((Lookups > 0) ? (Hits * 100ull) / Lookups : 0),
+           (unsigned long)((Lookups > 0) ? ((Hits * 10000ull) / Lookups) % 100 : 0),
+           (unsigned long)PeakBytes, (unsigned long)pEnd->NumEntries,
+           (unsigned long)(pEnd->Evictions - Start.Evictions));
+}
+
+static void Usage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --main PATH        OSD setup with the menu item names (default %s)\n"
+            "  --components PATH  Widget sources, one screen per file (default %s)\n"
+            "  --iterations N     Draws per string, font, position and path for the timings (default %u)\n"
+            "  --frames N         Frames in the replayed navigation session (default %u)\n"
+            "  --seed N           Seed for the background and the session (default %u)\n",
+            pName, Config.pMain, Config.pComponents, Config.Iterations, Config.Frames, Config.Seed);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option Options[] = {
+        { "main",       required_argument, NULL, 'm' },
+        { "components", required_argument, NULL, 'c' },
+        { "iterations", required_argument, NULL, 'i' },
+        { "frames",     required_argument, NULL, 'f' },
+        { "seed",       required_argument, NULL, 'S' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int Opt;
+    while ((Opt = getopt_long(argc, argv, "h", Options, NULL)) != -1)
+    {
+        switch (Opt)
+        {
+            case 'm': Config.pMain = optarg; break;
+            case 'c': Config.pComponents = optarg; break;
+            case 'i': Config.Iterations = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'f': Config.Frames = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'S': Config.Seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                Usage(argv[0]);
+                return (Opt == 'h') ? 0 : 2;
+        }
+    }
+
+    Config.Iterations = (Config.Iterations == 0) ? 1 : Config.Iterations;
+    Rng = (Config.Seed == 0) ? 1 : Config.Seed;
+
+    ScanFile(Config.pMain);
+    if (!ScanDir(Config.pComponents) || (NumStrings == 0))
+    {
+        fprintf(stderr, "No label strings found under %s and %s\n", Config.pMain, Config.pComponents);
+        return 1;
+    }
+
+    uint32_t AtlasBytes[NUM_FONTS];
+    for (size_t f = 0; f < NUM_FONTS; f++)
+    {
+        const uint32_t Before = TextCache_GetStats()->AtlasBytes;
+        const bool IsAdded = TextCache_AddFont(Fonts[f].pFont);
+        AtlasBytes[f] = TextCache_GetStats()->AtlasBytes - Before;
+        if (!IsAdded)
+        {
+            fprintf(stderr, "%s can't have a glyph atlas\n", Fonts[f].pName);
+            return 1;
+        }
+    }
+    printf("%zu strings on %zu screens, %lu bytes of glyph atlases for %zu fonts\n", NumStrings, NumScreens,
+           (unsigned long)TextCache_GetStats()->AtlasBytes, NUM_FONTS);
+
+    for (size_t i = 0; i < kNumPixels; i++)
+    {
+        Background[i] = (uint16_t)Random();
+    }
+
+    // Large enough to hold every string while they are timed
+    TextCache_SetBudget(1 << 20);
+
+    unsigned NumMismatches = 0;
+    unsigned NumUncached = 0;
+    printf("%-12s %6s %9s %9s %9s %8s %8s\n", "Font", "Atlas", "Stock", "Glyphs", "Cached", "Glyphs", "Cached");
+    for (size_t f = 0; f < NUM_FONTS; f++)
+    {
+        const lv_font_t *const pFont = Fonts[f].pFont;
+        uint64_t Stock_ns = 0;
+        uint64_t Glyphs_ns = 0;
+        uint64_t Cached_ns = 0;
+
+        for (size_t s = 0; s < NumStrings; s++)
+        {
+            const char *const pText = Strings[s].pText;
+            const TextCache_Entry_t *const pEntry = TextCache_Get(pFont, pText);
+            if (pEntry == NULL)
+            {
+                NumUncached++;
+                continue;
+            }
+
+            Placement_t Places[kNumPositions];
+            BuildPlacements(pEntry->Width, pFont->line_height, Places);
+
+            for (size_t c = 0; c < sizeof(Colors) / sizeof(Colors[0]); c++)
+            {
+                for (size_t p = 0; p < kNumPositions; p++)
+                {
+                    memcpy(FrameStock, Background, sizeof(FrameStock));
+                    memcpy(FrameGlyphs, Background, sizeof(FrameGlyphs));
+                    memcpy(FrameCached, Background, sizeof(FrameCached));
+                    DrawLabel(pFont, pText, Colors[c], &Places[p], FrameStock, false);
+                    DrawLabel(pFont, pText, Colors[c], &Places[p], FrameGlyphs, true);
+                    (void) DrawCached(pFont, pText, Colors[c], &Places[p], FrameCached);
+
+                    if ((memcmp(FrameStock, FrameGlyphs, sizeof(FrameStock)) != 0) ||
+                        (memcmp(FrameStock, FrameCached, sizeof(FrameStock)) != 0))
+                    {
+                        printf("%s \"%s\" at %ld,%ld: the atlas drew a different frame\n", Fonts[f].pName, pText,
+                               (long)Places[p].x, (long)Places[p].y);
+                        NumMismatches++;
+                    }
+                }
+            }
+
+            uint64_t Start_ns = Now_ns();
+            for (unsigned n = 0; n < Config.Iterations; n++)
+            {
+                DrawLabel(pFont, pText, Colors[0], &Places[n % kNumPositions], FrameStock, false);
+            }
+            Stock_ns += (Now_ns() - Start_ns) / Config.Iterations;
+
+            Start_ns = Now_ns();
+            for (unsigned n = 0; n < Config.Iterations; n++)
+            {
+                DrawLabel(pFont, pText, Colors[0], &Places[n % kNumPositions], FrameGlyphs, true);
+            }
+            Glyphs_ns += (Now_ns() - Start_ns) / Config.Iterations;
+
+            Start_ns = Now_ns();
+            for (unsigned n = 0; n < Config.Iterations; n++)
+            {
+                (void) DrawCached(pFont, pText, Colors[0], &Places[n % kNumPositions], FrameCached);
+            }
+            Cached_ns += (Now_ns() - Start_ns) / Config.Iterations;
+        }
+
+        printf("%-12s %6lu %6lu ns %6lu ns %6lu ns %7.2fx %7.2fx\n", Fonts[f].pName, (unsigned long)AtlasBytes[f],
+               (unsigned long)Stock_ns,
+               (unsigned long)Glyphs_ns, (unsigned long)Cached_ns,
+               (Glyphs_ns > 0) ? (double)Stock_ns / (double)Glyphs_ns : 0.0,
+               (Cached_ns > 0) ? (double)Stock_ns / (double)Cached_ns : 0.0);
+    }
+    printf("Times are for drawing every string once. %u of %zu strings couldn't be cached.\n", NumUncached,
+           NumStrings * NUM_FONTS);
+
+    printf("\nNavigation session, %u frames:\n", Config.Frames);
+    printf("%8s %8s %9s %8s %8s %10s\n", "Budget", "Lookups", "Hit rate", "Peak", "Strings", "Evictions");
+    for (size_t b = 0; b < sizeof(Budgets) / sizeof(Budgets[0]); b++)
+    {
+        ReplaySession(Budgets[b]);
+    }
+
+    printf("%s\n", (NumMismatches == 0) ? "PASS" : "FAIL");
+    return (NumMismatches == 0) ? 0 : 1;
+}